@@ -0,0 +1,177 @@
+/*
+ * await/yield benchmarks
+ *
+ * The async benchmarks cannot be timed by microbench.js because their
+ * frames are resumed from the job queue: each benchmark is an async
+ * function awaited by the driver, so the time includes the promise jobs.
+ *
+ * usage: qjs bench_async.js [name_prefix...]
+ */
+
+var get_clock = typeof performance !== "undefined" ?
+    () => performance.now() : Date.now;
+
+if (typeof os !== "undefined")
+    get_clock = os.now;
+
+var global_res;
+
+function pad_left(str, n) {
+    str += "";
+    while (str.length < n)
+        str = " " + str;
+    return str;
+}
+
+function pad_right(str, n) {
+    str += "";
+    while (str.length < n)
+        str += " ";
+    return str;
+}
+
+/* single frame resumed n times */
+async function await_loop(n) {
+    var i, r = 0;
+    for (i = 0; i < n; i++)
+        r += await i;
+    global_res = r;
+    return n;
+}
+
+/* n short-lived async frames awaiting once */
+async function await_call(n) {
+    async function f(a, b) {
+        return await a + b;
+    }
+    var i, r = 0;
+    for (i = 0; i < n; i++)
+        r += await f(i, 1);
+    global_res = r;
+    return n;
+}
+
+/* n short-lived async frames completing without suspending */
+async function async_call_sync(n) {
+    async function f(a, b) {
+        return a + b;
+    }
+    var i, p;
+    for (i = 0; i < n; i++)
+        p = f(i, 1);
+    global_res = await p;
+    return n;
+}
+
+/* n async frames alive at the same time */
+async function await_all(n) {
+    async function f(a) {
+        await null;
+        return a;
+    }
+    var i, tab = [];
+    for (i = 0; i < n; i++)
+        tab.push(f(i));
+    tab = await Promise.all(tab);
+    global_res = tab.length;
+    return n;
+}
+
+function generator_yield(n) {
+    function *g(n) {
+        for (var i = 0; i < n; i++)
+            yield i;
+    }
+    var r = 0;
+    for (var v of g(n))
+        r += v;
+    global_res = r;
+    return n;
+}
+
+function generator_create(n) {
+    function *g(a, b, c) {
+        yield a;
+        yield b + c;
+    }
+    var i, r = 0;
+    for (i = 0; i < n; i++) {
+        for (var v of g(i, 1, 2))
+            r += v;
+    }
+    global_res = r;
+    return n;
+}
+
+async function async_generator_yield(n) {
+    async function *g(n) {
+        for (var i = 0; i < n; i++)
+            yield i;
+    }
+    var r = 0;
+    for await (var v of g(n))
+        r += v;
+    global_res = r;
+    return n;
+}
+
+async function async_generator_create(n) {
+    async function *g(a) {
+        yield a;
+    }
+    var i, r = 0;
+    for (i = 0; i < n; i++) {
+        for await (var v of g(i))
+            r += v;
+    }
+    global_res = r;
+    return n;
+}
+
+var test_list = [
+    await_loop,
+    await_call,
+    async_call_sync,
+    await_all,
+    generator_yield,
+    generator_create,
+    async_generator_yield,
+    async_generator_create,
+];
+
+/* best time per operation in ns over a few runs of n operations */
+async function bench(f, n) {
+    var i, t, ti = Infinity;
+    for (i = 0; i < 5; i++) {
+        t = get_clock();
+        await f(n);
+        t = get_clock() - t;
+        if (t < ti)
+            ti = t;
+    }
+    return ti * 1e6 / n;
+}
+
+async function main(args) {
+    var tests = [], total = 0, i, j, f, ti;
+
+    for (i = 0; i < args.length; i++) {
+        for (j = 0; j < test_list.length; j++) {
+            if (test_list[j].name.startsWith(args[i]))
+                tests.push(test_list[j]);
+        }
+    }
+    if (tests.length == 0)
+        tests = test_list;
+
+    console.log(pad_right("TEST", 24) + pad_left("ns/op", 10));
+    for (f of tests) {
+        ti = await bench(f, 100000);
+        total += ti;
+        console.log(pad_right(f.name, 24) + pad_left(ti.toFixed(2), 10));
+    }
+    console.log(pad_right("total", 24) + pad_left(total.toFixed(2), 10));
+}
+
+main(typeof scriptArgs !== "undefined" ? scriptArgs.slice(1) :
+     typeof process !== "undefined" ? process.argv.slice(2) : []);
@@ -8,6 +8,12 @@ fi
 
 ./bin/qjs ./octane/run.js
 
+# await/yield
+./bin/qjs --std ./bench_async.js
+
+# parse + compile throughput
+./bin/compile_bench ./octane/*.js
+
 # echo "开始验证可执行文件..."
 # ./bin/qjsc -v -o ./octane.bin ./octane/run.js
 # ./octane.bin
@@ -0,0 +1,103 @@
+/*
+ * Parse + compile throughput of the QuickJS compiler.
+ *
+ *   compile_bench [-n iterations] file.js...
+ *
+ * Every file is compiled as a module with JS_EVAL_FLAG_COMPILE_ONLY, the
+ * imports are resolved to empty stub modules. The per-phase times come
+ * from JS_SetCompileStats().
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "QuickJS/extension/taro_js_module.h"
+#include "QuickJS/extension/taro_js_type.h"
+#include "QuickJS/quickjs-libc.h"
+#include "QuickJS/quickjs.h"
+
+static int stub_init(JSContext* ctx, JSModuleDef* m) {
+  return 0;
+}
+
+static JSModuleDef*
+stub_loader(JSContext* ctx, const char* module_name, void* opaque) {
+  return taro_js_new_c_module(ctx, module_name, stub_init);
+}
+
+static double ms(int64_t ns) {
+  return ns / 1e6;
+}
+
+int main(int argc, char** argv) {
+  int iterations = 10;
+  int first = 1;
+  JSCompileStats stats;
+
+  if (argc > 2 && !strcmp(argv[1], "-n")) {
+    iterations = atoi(argv[2]);
+    first = 3;
+  }
+  if (first >= argc) {
+    fprintf(stderr, "usage: compile_bench [-n iterations] file.js...\n");
+    return 1;
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  for (int i = first; i < argc; i++) {
+    /* one runtime per file so that the compiled modules do not pile up */
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(rt);
+    JS_SetModuleLoaderFunc(rt, NULL, stub_loader, NULL);
+
+    size_t len;
+    uint8_t* buf = js_load_file(ctx, &len, argv[i]);
+    if (!buf) {
+      fprintf(stderr, "could not load '%s'\n", argv[i]);
+      return 1;
+    }
+
+    for (int n = 0; n < iterations; n++) {
+      JS_SetCompileStats(rt, &stats);
+      JSValue obj = JS_Eval(
+          ctx,
+          (const char*)buf,
+          len,
+          argv[i],
+          JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+      JS_SetCompileStats(rt, NULL);
+      if (taro_is_exception(obj)) {
+        js_std_dump_error(ctx);
+        return 1;
+      }
+      /* the module stays in the loaded module list until the runtime
+         is freed */
+      JS_FreeValue(ctx, obj);
+    }
+
+    js_free(ctx, buf);
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+  }
+
+  int64_t total = stats.parse_time + stats.compile_time;
+  int64_t other = stats.compile_time - stats.resolve_variables_time -
+      stats.resolve_labels_time - stats.stack_size_time;
+
+  printf(
+      "%" PRId64 " sources, %" PRId64 " functions, %.1f MB\n",
+      stats.eval_count,
+      stats.function_count,
+      stats.source_size / 1e6);
+  printf("%-20s %10.1f ms\n", "parse", ms(stats.parse_time));
+  printf("%-20s %10.1f ms\n", "resolve_variables",
+         ms(stats.resolve_variables_time));
+  printf("%-20s %10.1f ms\n", "resolve_labels", ms(stats.resolve_labels_time));
+  printf("%-20s %10.1f ms\n", "compute_stack_size", ms(stats.stack_size_time));
+  printf("%-20s %10.1f ms\n", "create_function", ms(other));
+  printf("%-20s %10.1f ms\n", "total", ms(total));
+  printf("%-20s %10.1f KB\n", "arena peak", stats.arena_max_size / 1024.0);
+  printf("throughput %.2f MB/s\n", stats.source_size / 1e6 / (total / 1e9));
+  return 0;
+}
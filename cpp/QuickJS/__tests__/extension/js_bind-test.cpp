@@ -0,0 +1,148 @@
+#include "QuickJS/extension/taro_js_bind.h"
+
+#include <cmath>
+#include <iterator>
+
+#include "./settup.h"
+
+namespace {
+
+class Point {
+ public:
+  Point(double x, double y) : x_(x), y_(y) {}
+
+  double x() const {
+    return x_;
+  }
+  void set_x(double x) {
+    x_ = x;
+  }
+  double norm() const {
+    return std::sqrt(x_ * x_ + y_ * y_);
+  }
+  int32_t scale(int32_t factor, std::optional<int32_t> offset) {
+    x_ = x_ * factor + offset.value_or(0);
+    y_ = y_ * factor + offset.value_or(0);
+    return factor;
+  }
+  size_t label(std::string_view prefix, const std::string& suffix) {
+    name = std::string(prefix) + ":" + suffix;
+    return name.size();
+  }
+  bool same(Point* other) const {
+    return other->x_ == x_ && other->y_ == y_;
+  }
+
+  std::string name;
+  int64_t id = 0;
+
+ private:
+  double x_;
+  double y_;
+};
+
+int32_t add(int32_t a, int32_t b) {
+  return a + b;
+}
+
+std::optional<std::string> greet(const char* name, std::optional<bool> loud) {
+  if (!*name)
+    return std::nullopt;
+  std::string s = std::string("hello ") + name;
+  return loud.value_or(false) ? s + "!" : s;
+}
+
+constexpr JSCFunctionListEntry point_funcs[] = {
+    taro_js_bind_getset<&Point::x, &Point::set_x>("x"),
+    taro_js_bind_method<&Point::norm>("norm"),
+    taro_js_bind_method<&Point::scale>("scale"),
+    taro_js_bind_method<&Point::label>("label"),
+    taro_js_bind_method<&Point::same>("same"),
+    taro_js_bind_field<&Point::name>("name"),
+    taro_js_bind_field<&Point::id>("id"),
+};
+
+constexpr JSCFunctionListEntry util_funcs[] = {
+    taro_js_bind_function<&add>("add"),
+    taro_js_bind_function<&greet>("greet"),
+};
+
+static_assert(point_funcs[2].u.func.length == 1);
+static_assert(util_funcs[0].u.func.length == 2);
+
+void BindPoint() {
+  ASSERT_EQ(
+      taro_js_bind_class<Point>(
+          ctx, "Point", point_funcs, std::size(point_funcs)),
+      0);
+  JSValue global = JS_GetGlobalObject(ctx);
+  JS_SetPropertyStr(
+      ctx, global, "Point", taro_js_bind_constructor<Point, double, double>(
+                                ctx, "Point"));
+  JSValue util = JS_NewObject(ctx);
+  taro_js_set_property_function_list(
+      ctx, util, util_funcs, std::size(util_funcs));
+  JS_SetPropertyStr(ctx, global, "util", util);
+  JS_FreeValue(ctx, global);
+}
+
+} // namespace
+
+// 测试绑定类的构造函数、方法和访问器
+TEST(TaroJSBindTest, Class) {
+  BindPoint();
+
+  EXPECT_EQ(JSToInt32(EvalJS("new Point(3, 4).norm()")), 5);
+  EXPECT_TRUE(JSToBool(EvalJS("new Point(1, 2) instanceof Point")));
+  EXPECT_EQ(JSToInt32(EvalJS("Point.length")), 2);
+  EXPECT_EQ(JSToInt32(EvalJS("Point.prototype.scale.length")), 1);
+
+  // 访问器
+  EXPECT_EQ(JSToInt32(EvalJS("var p = new Point(1, 2); p.x = 5.5; p.x * 2")), 11);
+
+  // 可选参数
+  EXPECT_EQ(JSToInt32(EvalJS("p.scale(2); p.x")), 11);
+  EXPECT_EQ(JSToInt32(EvalJS("p.scale(1, 3); p.x")), 14);
+  EXPECT_EQ(JSToInt32(EvalJS("p.scale(1, undefined); p.x")), 14);
+
+  // 字符串参数和数据成员
+  EXPECT_EQ(JSToInt32(EvalJS("p.label('a', 'bc')")), 4);
+  JSValue name = EvalJS("p.name");
+  EXPECT_EQ(JSToString(name), "a:bc");
+  JS_FreeValue(ctx, name);
+  EXPECT_EQ(JSToInt32(EvalJS("p.name = 'z'; p.label('é', p.name)")), 4);
+  EXPECT_EQ(JSToInt32(EvalJS("p.id = 2 ** 40; p.id / 2 ** 30")), 1024);
+
+  // 绑定类的实例作为参数
+  EXPECT_TRUE(JSToBool(EvalJS("new Point(1, 2).same(new Point(1, 2))")));
+  EXPECT_FALSE(JSToBool(EvalJS("new Point(1, 2).same(new Point(2, 1))")));
+}
+
+// 测试绑定的静态函数
+TEST(TaroJSBindTest, Function) {
+  BindPoint();
+
+  EXPECT_EQ(JSToInt32(EvalJS("util.add(2, 3)")), 5);
+  EXPECT_EQ(JSToInt32(EvalJS("util.add(2.5, '3')")), 5);
+  JSValue s = EvalJS("util.greet('taro', true)");
+  EXPECT_EQ(JSToString(s), "hello taro!");
+  JS_FreeValue(ctx, s);
+  EXPECT_TRUE(JSToBool(EvalJS("util.greet('') === undefined")));
+}
+
+// 测试类型错误
+TEST(TaroJSBindTest, Exception) {
+  BindPoint();
+
+  EXPECT_TRUE(JSToBool(EvalJS(
+      "try { Point.prototype.norm.call({}); false } "
+      "catch (e) { e instanceof TypeError }")));
+  EXPECT_TRUE(JSToBool(EvalJS(
+      "try { new Point(1, 2).same({}); false } "
+      "catch (e) { e instanceof TypeError }")));
+  EXPECT_TRUE(JSToBool(EvalJS(
+      "try { util.add(1, Symbol()); false } "
+      "catch (e) { e instanceof TypeError }")));
+  EXPECT_TRUE(JSToBool(EvalJS(
+      "try { Point(1, 2); false } catch (e) { e instanceof TypeError }")));
+}
@@ -0,0 +1,169 @@
+#include "QuickJS/extension/taro_js_budget.h"
+
+#include <chrono>
+#include <string>
+
+#include "./settup.h"
+
+static const int64_t one_ms = 1000000;
+
+static std::string budget_exception_message(JSContext* ctx) {
+  JSValue exc = JS_GetException(ctx);
+  JSValue msg = JS_GetPropertyStr(ctx, exc, "message");
+  std::string ret = JSToString(ctx, msg);
+  JS_FreeValue(ctx, msg);
+  JS_FreeValue(ctx, exc);
+  return ret;
+}
+
+static int64_t budget_elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// 超出预算的循环被中断, 且不能被 JS 中的 catch 捕获
+TEST(TaroJSBudgetTest, InterruptLoop) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt1);
+
+  JSValue fn = EvalJS(
+      ctx1,
+      "(function () {"
+      "  for (;;) {"
+      "    try { for (;;) {} } catch (e) {}"
+      "  }"
+      "})");
+  auto start = std::chrono::steady_clock::now();
+  JSValue ret = taro_js_run_with_budget(ctx1, fn, 20 * one_ms);
+  EXPECT_TRUE(taro_is_exception(ret));
+  EXPECT_LT(budget_elapsed_ms(start), 2000);
+  EXPECT_EQ(budget_exception_message(ctx1), "interrupted");
+  JS_FreeValue(ctx1, fn);
+
+  JSBudgetStats s = taro_js_get_budget_stats(ctx1);
+  EXPECT_EQ(s.call_count, 1);
+  EXPECT_EQ(s.expired_count, 1);
+  EXPECT_GE(s.time, 20 * one_ms);
+
+  // 预算结束后不再中断
+  ret = EvalJS(ctx1, "let n = 0; for (let i = 0; i < 1000; i++) n += i; n");
+  EXPECT_EQ(JSToInt32(ctx1, ret), 499500);
+
+  JS_FreeContext(ctx1);
+  JS_FreeRuntime(rt1);
+}
+
+// 在预算内完成的调用返回其结果
+TEST(TaroJSBudgetTest, CompleteWithinBudget) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt1);
+
+  JSValue fn = EvalJS(
+      ctx1,
+      "(function (a, b) {"
+      "  let s = 0;"
+      "  for (let i = 0; i < 50000; i++) s += a;"
+      "  return s + b + this.c;"
+      "})");
+  JSValue self = EvalJS(ctx1, "({ c: 3 })");
+  JSValueConst argv[2] = {JS_NewInt32(ctx1, 2), JS_NewInt32(ctx1, 1)};
+  JSValue ret =
+      taro_js_run_with_budget(ctx1, fn, 10000 * one_ms, self, 2, argv);
+  EXPECT_EQ(JSToInt32(ctx1, ret), 100004);
+
+  JSBudgetStats s = taro_js_get_budget_stats(ctx1);
+  EXPECT_EQ(s.call_count, 1);
+  EXPECT_EQ(s.expired_count, 0);
+  EXPECT_GT(s.time, 0);
+  taro_js_reset_budget_stats(ctx1);
+  EXPECT_EQ(taro_js_get_budget_stats(ctx1).call_count, 0);
+
+  // INT64_MAX 表示不限时
+  ret = taro_js_run_with_budget(ctx1, fn, INT64_MAX, self, 2, argv);
+  EXPECT_EQ(JSToInt32(ctx1, ret), 100004);
+  s = taro_js_get_budget_stats(ctx1);
+  EXPECT_EQ(s.call_count, 1);
+  EXPECT_EQ(s.expired_count, 0);
+  JS_FreeValue(ctx1, self);
+  JS_FreeValue(ctx1, fn);
+
+  JS_FreeContext(ctx1);
+  JS_FreeRuntime(rt1);
+}
+
+// 正则表达式的回溯同样受预算限制
+TEST(TaroJSBudgetTest, InterruptRegExp) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt1);
+
+  JSValue fn = EvalJS(
+      ctx1,
+      "(function () {"
+      "  try { return /(a+)+b/.test('a'.repeat(40)); } catch (e) {}"
+      "  return 'caught';"
+      "})");
+  auto start = std::chrono::steady_clock::now();
+  JSValue ret = taro_js_run_with_budget(ctx1, fn, 20 * one_ms);
+  EXPECT_TRUE(taro_is_exception(ret));
+  EXPECT_LT(budget_elapsed_ms(start), 2000);
+  EXPECT_EQ(budget_exception_message(ctx1), "interrupted");
+  EXPECT_EQ(taro_js_get_budget_stats(ctx1).expired_count, 1);
+  JS_FreeValue(ctx1, fn);
+
+  JS_FreeContext(ctx1);
+  JS_FreeRuntime(rt1);
+}
+
+// 嵌套调用不能超过外层的预算, 每个上下文分别统计
+TEST(TaroJSBudgetTest, NestedTenants) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* host = JS_NewContext(rt1);
+  JSContext* tenant = JS_NewContext(rt1);
+
+  JSValue spin = EvalJS(tenant, "(function () { for (;;) {} })");
+  JSValue global = JS_GetGlobalObject(host);
+  JS_SetPropertyStr(host, global, "spin", JS_DupValue(host, spin));
+  JS_SetPropertyStr(
+      host,
+      global,
+      "runTenant",
+      JS_NewCFunction(
+          host,
+          [](JSContext* ctx,
+             JSValueConst this_val,
+             int argc,
+             JSValueConst* argv) -> JSValue {
+            return taro_js_run_with_budget(ctx, argv[0], 10000 * one_ms);
+          },
+          "runTenant",
+          1));
+  JS_FreeValue(host, global);
+
+  JSValue fn = EvalJS(host, "(function () { return runTenant(spin); })");
+  auto start = std::chrono::steady_clock::now();
+  JSValue ret = taro_js_run_with_budget(host, fn, 20 * one_ms);
+  EXPECT_TRUE(taro_is_exception(ret));
+  EXPECT_LT(budget_elapsed_ms(start), 2000);
+  EXPECT_EQ(budget_exception_message(host), "interrupted");
+  JS_FreeValue(host, fn);
+
+  // 内层调用由 host 上下文发起, 两次调用都因外层预算到期而中断
+  JSBudgetStats s = taro_js_get_budget_stats(host);
+  EXPECT_EQ(s.call_count, 2);
+  EXPECT_EQ(s.expired_count, 2);
+  EXPECT_EQ(taro_js_get_budget_stats(tenant).call_count, 0);
+
+  ret = taro_js_run_with_budget(tenant, spin, 10 * one_ms);
+  EXPECT_TRUE(taro_is_exception(ret));
+  JS_FreeValue(tenant, JS_GetException(tenant));
+  s = taro_js_get_budget_stats(tenant);
+  EXPECT_EQ(s.call_count, 1);
+  EXPECT_EQ(s.expired_count, 1);
+  EXPECT_GE(s.time, 10 * one_ms);
+  JS_FreeValue(tenant, spin);
+
+  JS_FreeContext(tenant);
+  JS_FreeContext(host);
+  JS_FreeRuntime(rt1);
+}
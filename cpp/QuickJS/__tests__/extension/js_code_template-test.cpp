@@ -0,0 +1,121 @@
+#include <string>
+
+#include "./settup.h"
+
+static const char* code_template_source =
+    "function getX(o) {\n"
+    "  return o.x;\n"
+    "}\n"
+    "function sum(points) {\n"
+    "  let s = 0;\n"
+    "  for (const p of points)\n"
+    "    s += getX(p);\n"
+    "  return s;\n"
+    "}\n"
+    "function fail() {\n"
+    "  throw new Error('fail');\n"
+    "}\n";
+
+static int64_t code_template_code_size(JSRuntime* rt) {
+  JSMemoryUsage s;
+  JS_ComputeMemoryUsage(rt, &s);
+  return s.js_func_code_size + s.js_func_pc2line_size;
+}
+
+static JSValue code_template_eval(JSContext* ctx, const char* expr) {
+  return JS_Eval(ctx, expr, strlen(expr), "<expr>", JS_EVAL_TYPE_GLOBAL);
+}
+
+TEST(TaroJSCodeTemplateTest, SharedAcrossContexts) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt);
+  JSContext* ctx2 = JS_NewContext(rt);
+
+  JSValue ret = JS_Eval(
+      ctx1,
+      code_template_source,
+      strlen(code_template_source),
+      "bundle.js",
+      JS_EVAL_TYPE_GLOBAL);
+  ASSERT_FALSE(taro_is_exception(ret));
+  JS_FreeValue(ctx1, ret);
+  /* patch the field opcodes with the inline cache of ctx1 */
+  ret = code_template_eval(ctx1, "sum([{ x: 1 }, { x: 2 }, { y: 0, x: 3 }])");
+  EXPECT_EQ(JSToInt32(ctx1, ret), 6);
+
+  int64_t size = code_template_code_size(rt);
+  ret = JS_Eval(
+      ctx2,
+      code_template_source,
+      strlen(code_template_source),
+      "bundle.js",
+      JS_EVAL_TYPE_GLOBAL);
+  ASSERT_FALSE(taro_is_exception(ret));
+  JS_FreeValue(ctx2, ret);
+  /* only the code of the global function is not shared: it is freed */
+  EXPECT_EQ(code_template_code_size(rt), size);
+
+  ret = code_template_eval(ctx2, "sum([{ z: 1, x: 10 }, { x: 20 }])");
+  EXPECT_EQ(JSToInt32(ctx2, ret), 30);
+  ret = code_template_eval(ctx2, "getX.toString()");
+  EXPECT_EQ(JSToString(ctx2, ret), "function getX(o) {\n  return o.x;\n}");
+  JS_FreeValue(ctx2, ret);
+  ret = code_template_eval(ctx2, "try { fail() } catch (e) { e.stack }");
+  EXPECT_NE(JSToString(ctx2, ret).find("bundle.js:11"), std::string::npos);
+  JS_FreeValue(ctx2, ret);
+
+  /* the code stays valid when the context which created it is freed */
+  JS_FreeContext(ctx1);
+  ret = code_template_eval(ctx2, "sum([{ x: 4 }, { x: 5 }])");
+  EXPECT_EQ(JSToInt32(ctx2, ret), 9);
+
+  JS_FreeContext(ctx2);
+  JS_FreeRuntime(rt);
+}
+
+TEST(TaroJSCodeTemplateTest, WritePatchedCode) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt);
+  JSContext* ctx2 = JS_NewContext(rt);
+
+  JSValue ret = JS_Eval(
+      ctx1,
+      code_template_source,
+      strlen(code_template_source),
+      "bundle.js",
+      JS_EVAL_TYPE_GLOBAL);
+  ASSERT_FALSE(taro_is_exception(ret));
+  JS_FreeValue(ctx1, ret);
+  ret = code_template_eval(ctx1, "sum([{ x: 1 }, { x: 2 }])");
+  EXPECT_EQ(JSToInt32(ctx1, ret), 3);
+
+  /* the code compiled in ctx2 is already patched by ctx1 */
+  JSValue func = JS_Eval(
+      ctx2,
+      code_template_source,
+      strlen(code_template_source),
+      "bundle.js",
+      JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+  ASSERT_FALSE(taro_is_exception(func));
+  size_t len;
+  uint8_t* buf = JS_WriteObject(ctx2, &len, func, JS_WRITE_OBJ_BYTECODE);
+  JS_FreeValue(ctx2, func);
+  ASSERT_NE(buf, nullptr);
+
+  JSRuntime* rt2 = JS_NewRuntime();
+  JSContext* ctx3 = JS_NewContext(rt2);
+  func = JS_ReadObject(ctx3, buf, len, JS_READ_OBJ_BYTECODE);
+  js_free(ctx2, buf);
+  ASSERT_FALSE(taro_is_exception(func));
+  ret = JS_EvalFunction(ctx3, func);
+  ASSERT_FALSE(taro_is_exception(ret));
+  JS_FreeValue(ctx3, ret);
+  ret = code_template_eval(ctx3, "sum([{ x: 7 }, { y: 1, x: 8 }])");
+  EXPECT_EQ(JSToInt32(ctx3, ret), 15);
+
+  JS_FreeContext(ctx3);
+  JS_FreeRuntime(rt2);
+  JS_FreeContext(ctx1);
+  JS_FreeContext(ctx2);
+  JS_FreeRuntime(rt);
+}
@@ -0,0 +1,106 @@
+#include "QuickJS/extension/taro_js_compile.h"
+
+#include <string>
+
+#include "./settup.h"
+
+static std::vector<TaroJSCompileSource> make_sources(int count) {
+  std::vector<TaroJSCompileSource> sources;
+  for (int i = 0; i < count; i++) {
+    sources.push_back(
+        {"import { dep } from './dep.js';\n"
+         "export const value = " +
+             std::to_string(i) +
+             ";\n"
+             "export function get() { return /a+/.test('aa') ? value : -1; }",
+         "module_" + std::to_string(i) + ".js"});
+  }
+  return sources;
+}
+
+TEST(TaroJSCompileTest, CompileBatch) {
+  auto sources = make_sources(16);
+  std::vector<TaroJSCompileResult> results;
+
+  int failed = taro_js_compile_batch(sources, results, nullptr,
+                                     JS_EVAL_TYPE_MODULE, 4);
+  EXPECT_EQ(failed, 0);
+  ASSERT_EQ(results.size(), sources.size());
+
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.error.empty());
+    ASSERT_FALSE(result.bytecode.empty());
+
+    JSValue m = JS_ReadObject(
+        ctx, result.bytecode.data(), result.bytecode.size(),
+        JS_READ_OBJ_BYTECODE);
+    ASSERT_FALSE(taro_is_exception(m));
+    EXPECT_EQ(JS_VALUE_GET_TAG(m), JS_TAG_MODULE);
+    JS_FreeValue(ctx, m);
+  }
+}
+
+TEST(TaroJSCompileTest, CompileBatchError) {
+  auto sources = make_sources(3);
+  sources[1].source = "export const = ;";
+  std::vector<TaroJSCompileResult> results;
+
+  int failed = taro_js_compile_batch(sources, results);
+  EXPECT_EQ(failed, 1);
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_FALSE(results[0].bytecode.empty());
+  EXPECT_TRUE(results[1].bytecode.empty());
+  EXPECT_NE(results[1].error.find("SyntaxError"), std::string::npos);
+  EXPECT_FALSE(results[2].bytecode.empty());
+}
+
+TEST(TaroJSCompileTest, CompileBatchBundle) {
+  auto sources = make_sources(8);
+  std::vector<TaroJSCompileResult> results;
+  std::vector<uint8_t> bundle;
+
+  int failed = taro_js_compile_batch(sources, results, &bundle);
+  EXPECT_EQ(failed, 0);
+  ASSERT_FALSE(bundle.empty());
+
+  size_t separate = 0;
+  for (const auto& result : results)
+    separate += result.bytecode.size();
+  /* the shared atom table makes the bundle smaller than the parts */
+  EXPECT_LT(bundle.size(), separate);
+
+  JSValue arr = JS_ReadObject(
+      ctx, bundle.data(), bundle.size(), JS_READ_OBJ_BYTECODE);
+  ASSERT_FALSE(taro_is_exception(arr));
+  ASSERT_TRUE(taro_is_array(ctx, arr));
+  JSValue len = JS_GetPropertyStr(ctx, arr, "length");
+  EXPECT_EQ(JSToInt32(len), 8);
+
+  JSValue m = JS_GetPropertyUint32(ctx, arr, 0);
+  EXPECT_EQ(JS_VALUE_GET_TAG(m), JS_TAG_MODULE);
+  JS_FreeValue(ctx, m);
+  JS_FreeValue(ctx, arr);
+}
+
+TEST(TaroJSCompileTest, CompileStats) {
+  JSCompileStats stats = {};
+  const char* source = "function f(a) { return () => a + 1; }\nf(1);";
+
+  JS_SetCompileStats(rt, &stats);
+  JSValue obj = JS_Eval(
+      ctx, source, strlen(source), "stats.js", JS_EVAL_FLAG_COMPILE_ONLY);
+  JS_SetCompileStats(rt, NULL);
+  ASSERT_FALSE(taro_is_exception(obj));
+  JS_FreeValue(ctx, obj);
+
+  EXPECT_EQ(stats.eval_count, 1);
+  EXPECT_EQ(stats.source_size, (int64_t)strlen(source));
+  /* the eval code, f and the arrow function */
+  EXPECT_EQ(stats.function_count, 3);
+  EXPECT_GT(stats.parse_time, 0);
+  EXPECT_GE(
+      stats.compile_time,
+      stats.resolve_variables_time + stats.resolve_labels_time +
+          stats.stack_size_time);
+  EXPECT_GT(stats.arena_max_size, 0);
+}
@@ -302,6 +302,46 @@ TEST(TaroJSErrorTest, ErrorWithStackTrace) {
   JS_FreeRuntime(rt);
 }
 
+// 测试延迟格式化的 stack 属性
+TEST(TaroJSErrorTest, LazyStackTrace) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  JSValue ret = EvalJS(
+      ctx,
+      "function inner() { return new Error('lazy'); }\n"
+      "function outer() { return inner(); }\n"
+      "var e = outer();\n"
+      "var desc = Object.getOwnPropertyDescriptor(e, 'stack');\n"
+      "[desc.writable, desc.enumerable, desc.configurable,\n"
+      " e.stack.split('\\n')[0], e.stack.split('\\n')[1]].join('|')");
+  EXPECT_EQ(
+      JSToString(ctx, ret),
+      "true|false|true|    at inner (<test>:1:36)|    at outer (<test>:2:20)");
+  JS_FreeValue(ctx, ret);
+
+  // 未读取的 stack 引用了函数，循环引用需要被 GC 回收
+  ret = EvalJS(
+      ctx,
+      "for (var i = 0; i < 100; i++) {\n"
+      "  var f = function () { return new Error('cycle'); };\n"
+      "  f.error = f();\n"
+      "}\n"
+      "f = undefined;\n"
+      "var s = new Error('set'); s.stack = 'custom'; s.stack");
+  EXPECT_EQ(JSToString(ctx, ret), "custom");
+  JS_FreeValue(ctx, ret);
+
+  JSMemoryUsage before, after;
+  JS_ComputeMemoryUsage(rt, &before);
+  JS_RunGC(rt);
+  JS_ComputeMemoryUsage(rt, &after);
+  EXPECT_LE(after.obj_count + 100, before.obj_count);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
+
 // 测试 JavaScript 执行过程中抛出的错误
 TEST(TaroJSErrorTest, JavaScriptErrorHandling) {
   JSRuntime* rt = JS_NewRuntime();
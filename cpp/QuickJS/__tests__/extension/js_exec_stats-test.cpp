@@ -0,0 +1,52 @@
+#include "QuickJS/extension/taro_js_exec_stats.h"
+
+#include <string>
+
+#include "./settup.h"
+
+TEST(TaroJSExecStatsTest, FunctionCounters) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  if (taro_js_exec_stats_start(rt) < 0) {
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    GTEST_SKIP() << "built without ENABLE_EXEC_STATS";
+  }
+  EXPECT_TRUE(taro_js_exec_stats_is_running(rt));
+  JSValue ret = EvalJS(
+      ctx,
+      "function sumPoints(points) {\n"
+      "  let sum = 0;\n"
+      "  for (let i = 0; i < points.length; i++)\n"
+      "    sum += points[i].x;\n"
+      "  return sum;\n"
+      "}\n"
+      "var points = [];\n"
+      "for (let i = 0; i < 10; i++)\n"
+      "  points.push({ x: i });\n"
+      "var total = 0;\n"
+      "for (let j = 0; j < 3; j++)\n"
+      "  total += sumPoints(points);\n"
+      "total");
+  EXPECT_EQ(JSToInt32(ctx, ret), 135);
+  taro_js_exec_stats_stop(rt);
+  EXPECT_FALSE(taro_js_exec_stats_is_running(rt));
+
+  std::string out;
+  ASSERT_EQ(taro_js_exec_stats_write(rt, out), 0);
+  EXPECT_NE(out.find("\"name\":\"sumPoints\""), std::string::npos);
+  EXPECT_NE(out.find("\"calls\":3,\"back_edges\":30"), std::string::npos);
+  EXPECT_NE(out.find("{\"property\":\"x\",\"hits\":"), std::string::npos);
+  EXPECT_NE(out.find("\"get_field\":"), std::string::npos);
+
+  /* the counters are reset by the next start */
+  ASSERT_EQ(taro_js_exec_stats_start(rt), 0);
+  taro_js_exec_stats_stop(rt);
+  out.clear();
+  ASSERT_EQ(taro_js_exec_stats_write(rt, out), 0);
+  EXPECT_EQ(out, "{\"functions\":[],\"opcodes\":{}}");
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
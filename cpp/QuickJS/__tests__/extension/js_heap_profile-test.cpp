@@ -0,0 +1,53 @@
+#include "QuickJS/extension/taro_js_heap_profile.h"
+
+#include <algorithm>
+#include <string>
+
+#include "./settup.h"
+
+static bool contains(const std::vector<uint8_t>& buf, const std::string& str) {
+  return std::search(buf.begin(), buf.end(), str.begin(), str.end()) !=
+      buf.end();
+}
+
+TEST(TaroJSHeapProfileTest, StartStop) {
+  JSRuntime* rt = JS_NewRuntime();
+
+  EXPECT_FALSE(taro_js_heap_profile_is_running(rt));
+  EXPECT_EQ(taro_js_heap_profile_start(rt), 0);
+  EXPECT_TRUE(taro_js_heap_profile_is_running(rt));
+  EXPECT_EQ(taro_js_heap_profile_start(rt), -1);
+  taro_js_heap_profile_stop(rt);
+  EXPECT_FALSE(taro_js_heap_profile_is_running(rt));
+
+  std::vector<uint8_t> out;
+  EXPECT_EQ(taro_js_heap_profile_write(rt, out), -1);
+  JS_FreeRuntime(rt);
+}
+
+TEST(TaroJSHeapProfileTest, LiveAllocations) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  ASSERT_EQ(taro_js_heap_profile_start(rt, 4096), 0);
+  JSValue ret = EvalJS(
+      ctx,
+      "var retained = [];\n"
+      "function leakyAllocator() {\n"
+      "  for (let i = 0; i < 2000; i++)\n"
+      "    retained.push({ index: i, payload: 'x'.repeat(64) + i });\n"
+      "}\n"
+      "leakyAllocator();\n"
+      "retained.length");
+  EXPECT_EQ(JSToInt32(ctx, ret), 2000);
+
+  std::vector<uint8_t> out;
+  ASSERT_EQ(taro_js_heap_profile_write(rt, out), 0);
+  ASSERT_FALSE(out.empty());
+  EXPECT_TRUE(contains(out, "inuse_space"));
+  EXPECT_TRUE(contains(out, "leakyAllocator"));
+
+  /* the runtime releases the profile if it is still running */
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
@@ -0,0 +1,94 @@
+#include "QuickJS/extension/taro_js_heap_snapshot.h"
+
+#include <cstdio>
+#include <string>
+
+#include "./settup.h"
+
+static std::string WriteSnapshot(JSRuntime* rt) {
+  std::string out;
+  FILE* f = tmpfile();
+  if (!f)
+    return out;
+  if (taro_js_heap_snapshot_write(rt, fileno(f)) == 0) {
+    char buf[4096];
+    size_t n;
+    rewind(f);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+      out.append(buf, n);
+  }
+  fclose(f);
+  return out;
+}
+
+TEST(TaroJSHeapSnapshotTest, ObjectGraph) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  JSValue ret = EvalJS(
+      ctx,
+      "class Widget { constructor() { this.payload = 'x'.repeat(1000); } }\n"
+      "function makeGetter() {\n"
+      "  let secret = new Widget();\n"
+      "  return () => secret;\n"
+      "}\n"
+      "globalThis.getter = makeGetter();\n"
+      "globalThis.list = [new Widget(), { name: 'plain' }];\n"
+      "list.length");
+  EXPECT_EQ(JSToInt32(ctx, ret), 2);
+
+  std::string snapshot = WriteSnapshot(rt);
+  ASSERT_FALSE(snapshot.empty());
+
+  /* check the snapshot from another runtime */
+  JSRuntime* rt2 = JS_NewRuntime();
+  JSContext* ctx2 = JS_NewContext(rt2);
+  JSValue json =
+      JS_ParseJSON(ctx2, snapshot.c_str(), snapshot.size(), "snapshot");
+  ASSERT_EQ(JS_VALUE_GET_TAG(json), JS_TAG_OBJECT);
+  JSValue global = JS_GetGlobalObject(ctx2);
+  JS_SetPropertyStr(ctx2, global, "s", json);
+  JS_FreeValue(ctx2, global);
+
+  ret = EvalJS(
+      ctx2,
+      "var meta = s.snapshot.meta;\n"
+      "var NF = meta.node_fields.length, EF = meta.edge_fields.length;\n"
+      "var nodeTypes = meta.node_types[0], edgeTypes = meta.edge_types[0];\n"
+      "var count = 0;\n"
+      "for (var i = 0; i < s.nodes.length; i += NF) count += s.nodes[i + 4];\n"
+      "var hasEdge = function (type, name, toType, minSize) {\n"
+      "  for (var n = 0, e = 0; n < s.nodes.length; n += NF) {\n"
+      "    for (var k = 0; k < s.nodes[n + 4]; k++, e += EF) {\n"
+      "      var to = s.edges[e + 2];\n"
+      "      if (edgeTypes[s.edges[e]] == type &&\n"
+      "          s.strings[s.edges[e + 1]] == name &&\n"
+      "          nodeTypes[s.nodes[to]] == toType &&\n"
+      "          s.nodes[to + 3] >= minSize)\n"
+      "        return true;\n"
+      "    }\n"
+      "  }\n"
+      "  return false;\n"
+      "};\n"
+      "var widgets = 0;\n"
+      "for (var i = 0; i < s.nodes.length; i += NF) {\n"
+      "  if (nodeTypes[s.nodes[i]] == 'object' &&\n"
+      "      s.strings[s.nodes[i + 1]] == 'Widget')\n"
+      "    widgets++;\n"
+      "}\n"
+      "[s.nodes.length == s.snapshot.node_count * NF,\n"
+      " s.edges.length == s.snapshot.edge_count * EF,\n"
+      " count == s.snapshot.edge_count,\n"
+      " hasEdge('property', 'payload', 'string', 1000),\n"
+      " hasEdge('context', 'secret', 'hidden', 0),\n"
+      " hasEdge('property', 'getter', 'closure', 0),\n"
+      " widgets == 2].join()");
+  EXPECT_EQ(
+      JSToString(ctx2, ret), "true,true,true,true,true,true,true");
+  JS_FreeValue(ctx2, ret);
+
+  JS_FreeContext(ctx2);
+  JS_FreeRuntime(rt2);
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
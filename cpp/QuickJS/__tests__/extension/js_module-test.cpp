@@ -92,3 +92,33 @@ TEST(TaroJSModuleTest, HostResolveImportedModule) {
   JS_FreeContext(ctx);
   JS_FreeRuntime(rt);
 }
+
+TEST(TaroJSModuleTest, UnloadCompiledModule) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  const char* js_module_code = "export const testValue = 42;";
+
+  JSModuleInfoArray before = JS_GetAllModulesInfo(ctx);
+  for (int i = 0; i < 3; i++) {
+    JSValue module_val = JS_Eval(
+        ctx,
+        js_module_code,
+        strlen(js_module_code),
+        "test_module.js",
+        JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    ASSERT_FALSE(taro_is_exception(module_val));
+
+    taro_js_unload_module(ctx, (JSModuleDef*)JS_VALUE_GET_PTR(module_val));
+    JS_FreeValue(ctx, module_val);
+  }
+
+  /* compiling on a reused context does not accumulate modules */
+  JSModuleInfoArray after = JS_GetAllModulesInfo(ctx);
+  EXPECT_EQ(after.len, before.len);
+  JS_FreeAllModulesInfo(ctx, before);
+  JS_FreeAllModulesInfo(ctx, after);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
@@ -0,0 +1,149 @@
+#include "QuickJS/extension/taro_js_property_key.h"
+
+#include "./settup.h"
+
+// 测试同一形状的多个对象批量读取属性
+TEST(TaroJSPropertyKeyTest, GetProperties) {
+  const char* names[] = {"x", "y", "z"};
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_new(ctx, names, 3);
+  ASSERT_NE(set, nullptr);
+  EXPECT_EQ(taro_js_property_key_set_size(set), 3);
+
+  JSValue points = EvalJS(
+      "[1, 2, 3].map(i => ({ x: i, y: i * 10, z: i * 100 }))");
+  for (uint32_t i = 0; i < 3; i++) {
+    JSValue point = JS_GetPropertyUint32(ctx, points, i);
+    JSValue values[3];
+    EXPECT_EQ(taro_js_get_properties(ctx, point, set, values), 0);
+    EXPECT_EQ(JSToInt32(values[0]), (int32_t)(i + 1));
+    EXPECT_EQ(JSToInt32(values[1]), (int32_t)(i + 1) * 10);
+    EXPECT_EQ(JSToInt32(values[2]), (int32_t)(i + 1) * 100);
+    JS_FreeValue(ctx, point);
+  }
+
+  // 缺失的属性、getter 和原型上的属性
+  JSValue obj = EvalJS(
+      "var proto = { z: 7 };"
+      "var o = Object.create(proto);"
+      "o.x = 1;"
+      "Object.defineProperty(o, 'y', { get() { return this.x + 1; } });"
+      "o");
+  JSValue values[3];
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(values[0]), 1);
+  EXPECT_EQ(JSToInt32(values[1]), 2);
+  EXPECT_EQ(JSToInt32(values[2]), 7);
+  JS_FreeValue(ctx, obj);
+
+  obj = EvalJS("({ y: 2 })");
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), 0);
+  EXPECT_TRUE(taro_is_undefined(values[0]));
+  EXPECT_EQ(JSToInt32(values[1]), 2);
+  EXPECT_TRUE(taro_is_undefined(values[2]));
+  JS_FreeValue(ctx, obj);
+
+  JS_FreeValue(ctx, points);
+  taro_js_property_key_set_free(ctx, set);
+}
+
+// 测试形状变化后缓存失效
+TEST(TaroJSPropertyKeyTest, ShapeChange) {
+  taro_js_property_key keys[2] = {
+      taro_js_property_key_new(ctx, "a"), taro_js_property_key_new(ctx, "b")};
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_new(ctx, keys, 2);
+  taro_js_property_key_free(ctx, keys[0]);
+  taro_js_property_key_free(ctx, keys[1]);
+
+  JSValue obj = EvalJS("var s = { a: 1, b: 2 }; s");
+  JSValue values[2];
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(values[0]), 1);
+  EXPECT_EQ(JSToInt32(values[1]), 2);
+
+  JS_FreeValue(ctx, EvalJS("delete s.a; s.c = 3; s.a = 4; s"));
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(values[0]), 4);
+  EXPECT_EQ(JSToInt32(values[1]), 2);
+
+  // getter 修改对象的形状
+  JS_FreeValue(ctx, EvalJS(
+      "delete s.a;"
+      "Object.defineProperty(s, 'a', {"
+      "  get() { delete this.b; this.b = 5; return 6; },"
+      "  configurable: true"
+      "}); s"));
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(values[0]), 6);
+  EXPECT_EQ(JSToInt32(values[1]), 5);
+
+  JS_FreeValue(ctx, obj);
+  taro_js_property_key_set_free(ctx, set);
+}
+
+// 测试批量设置属性
+TEST(TaroJSPropertyKeyTest, SetProperties) {
+  const char* names[] = {"a", "b", "c"};
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_new(ctx, names, 3);
+
+  JSValue obj = EvalJS("var t = { a: 1, b: 2 }; t");
+  JSValue values[3] = {
+      JS_NewInt32(ctx, 10), JS_NewInt32(ctx, 20), JS_NewInt32(ctx, 30)};
+  EXPECT_EQ(taro_js_set_properties(ctx, obj, set, values), 0);
+  for (int i = 0; i < 3; i++)
+    EXPECT_TRUE(taro_is_undefined(values[i]));
+  EXPECT_EQ(JSToInt32(EvalJS("t.a + t.b + t.c")), 10 + 20 + 30);
+
+  values[0] = JS_NewInt32(ctx, 11);
+  values[1] = JS_NewInt32(ctx, 21);
+  values[2] = JS_NewInt32(ctx, 31);
+  EXPECT_EQ(taro_js_set_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(EvalJS("t.a + t.b + t.c")), 11 + 21 + 31);
+
+  // 只读属性
+  JS_FreeValue(ctx, EvalJS("Object.defineProperty(t, 'b', { writable: false })"));
+  values[0] = JS_NewInt32(ctx, 12);
+  values[1] = JS_NewInt32(ctx, 22);
+  values[2] = JS_NewInt32(ctx, 32);
+  EXPECT_EQ(taro_js_set_properties(ctx, obj, set, values), -1);
+  JS_FreeValue(ctx, JS_GetException(ctx));
+  EXPECT_EQ(JSToInt32(EvalJS("t.a + t.b + t.c")), 12 + 21 + 31);
+  JS_FreeValue(ctx, obj);
+
+  // setter
+  obj = EvalJS(
+      "var u = { log: 0, set a(v) { this.log = v * 2; } }; u");
+  values[0] = JS_NewInt32(ctx, 4);
+  values[1] = JS_NewInt32(ctx, 5);
+  values[2] = JS_NewInt32(ctx, 6);
+  EXPECT_EQ(taro_js_set_properties(ctx, obj, set, values), 0);
+  EXPECT_EQ(JSToInt32(EvalJS("u.log + u.b + u.c")), 8 + 5 + 6);
+  JS_FreeValue(ctx, obj);
+
+  taro_js_property_key_set_free(ctx, set);
+}
+
+// 测试异常
+TEST(TaroJSPropertyKeyTest, Exception) {
+  const char* names[] = {"a", "b", "c"};
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_new(ctx, names, 3);
+
+  JSValue obj = EvalJS(
+      "({ a: {}, get b() { throw new Error('b'); }, c: 'c' })");
+  JSValue values[3];
+  EXPECT_EQ(taro_js_get_properties(ctx, obj, set, values), -1);
+  for (int i = 0; i < 3; i++)
+    EXPECT_TRUE(taro_is_undefined(values[i]));
+  JS_FreeValue(ctx, JS_GetException(ctx));
+  JS_FreeValue(ctx, obj);
+
+  // 非对象
+  values[0] = JS_NewObject(ctx);
+  values[1] = JS_NewObject(ctx);
+  values[2] = JS_NewObject(ctx);
+  EXPECT_EQ(taro_js_set_properties(ctx, JS_UNDEFINED, set, values), -1);
+  for (int i = 0; i < 3; i++)
+    EXPECT_TRUE(taro_is_undefined(values[i]));
+  JS_FreeValue(ctx, JS_GetException(ctx));
+
+  taro_js_property_key_set_free(ctx, set);
+}
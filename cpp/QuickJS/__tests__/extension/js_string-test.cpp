@@ -555,3 +555,87 @@ TEST(TaroJSStringTest, PerformanceEdgeCases) {
   JS_FreeValue(ctx, shortSep);
   JS_FreeValue(ctx, longJSStr);
 }
+
+// 子串共享父字符串的存储
+TEST(TaroJSStringTest, SliceTest) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt1);
+  JSMemoryUsage base, before, after;
+
+  JS_ComputeMemoryUsage(rt1, &base);
+  JSValue ret = EvalJS(
+      ctx1,
+      "globalThis.doc = 'abcdefgh'.repeat(1 << 17);"
+      "globalThis.pieces = [];"
+      "for (let i = 0; i < 1000; i++)"
+      "  pieces.push(doc.substring(i * 1024 + 3, i * 1024 + 1003));");
+  JS_FreeValue(ctx1, ret);
+  JS_ComputeMemoryUsage(rt1, &before);
+  // 1MB 的父字符串, 而 1000 个长度为 1000 的子串复制字符时需要另外约 1MB
+  EXPECT_LT(before.malloc_size - base.malloc_size, (1 << 20) + (1 << 18));
+
+  ret = EvalJS(
+      ctx1,
+      "pieces[5] === doc.slice(5 * 1024 + 3, 5 * 1024 + 1003) &&"
+      "pieces[5].slice(1, 41) === 'efgh' + 'abcdefgh'.repeat(4) + 'abcd' &&"
+      "new Map([[pieces[7], 1]]).get(pieces[9]) === 1");
+  EXPECT_TRUE(JSToBool(ctx1, ret));
+
+  // 父字符串只被一个较短的子串引用时, GC 后不再保留父字符串
+  ret = EvalJS(ctx1, "pieces.length = 1; doc = null;");
+  JS_FreeValue(ctx1, ret);
+  JS_RunGC(rt1);
+  JS_ComputeMemoryUsage(rt1, &after);
+  EXPECT_LT(after.malloc_size + (1 << 19), before.malloc_size);
+  ret = EvalJS(ctx1, "pieces[0] === 'defgh' + 'abcdefgh'.repeat(124) + 'abc'");
+  EXPECT_TRUE(JSToBool(ctx1, ret));
+
+  JS_FreeContext(ctx1);
+  JS_FreeRuntime(rt1);
+}
+
+// GC 后合并对象属性和数组中相同的短字符串
+TEST(TaroJSStringTest, DedupTest) {
+  JSRuntime* rt1 = JS_NewRuntime();
+  JSContext* ctx1 = JS_NewContext(rt1);
+  JSMemoryUsage before, after;
+
+  JSValue ret = EvalJS(
+      ctx1,
+      "globalThis.items = [];"
+      "for (let i = 0; i < 2000; i++)"
+      "  items.push({ id: 'item-' + (i % 10), state: ['s', i % 3].join('') });"
+      "globalThis.list = JSON.parse(JSON.stringify(items.map(o => o.id)));"
+      "globalThis.long = ['x'.repeat(100) + 1, 'x'.repeat(100) + 1];");
+  JS_FreeValue(ctx1, ret);
+
+  // 默认不合并
+  JS_RunGC(rt1);
+  JS_ComputeMemoryUsage(rt1, &before);
+  EXPECT_EQ(before.str_dedup_count, 0);
+  EXPECT_EQ(before.str_dedup_size, 0);
+
+  JS_SetStringDedup(rt1, 64);
+  JS_RunGC(rt1);
+  JS_ComputeMemoryUsage(rt1, &after);
+  // 每组相同的字符串只保留一份
+  EXPECT_GE(after.str_dedup_count, 3 * 2000 - 20);
+  EXPECT_GT(after.str_dedup_size, 0);
+  EXPECT_LT(after.str_count, before.str_count - 5000);
+  EXPECT_LE(after.malloc_size + after.str_dedup_size, before.malloc_size);
+
+  ret = EvalJS(
+      ctx1,
+      "items[25].id === 'item-5' && items[25].state === 's1' &&"
+      "list[1999] === 'item-9' && list.join('').length === 2000 * 6 &&"
+      "long[0] === long[1] && long[0].length === 101");
+  EXPECT_TRUE(JSToBool(ctx1, ret));
+
+  // 已合并的字符串不会重复计数
+  JS_RunGC(rt1);
+  JS_ComputeMemoryUsage(rt1, &before);
+  EXPECT_EQ(before.str_dedup_count, after.str_dedup_count);
+
+  JS_FreeContext(ctx1);
+  JS_FreeRuntime(rt1);
+}
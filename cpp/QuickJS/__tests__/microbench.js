@@ -227,6 +227,19 @@ function date_parse(n) {
     return n * 6;
 }
 
+/* local time fields of timestamps, as when formatting a log view */
+function date_local_fields(n)
+{
+    var j, d, r = 0, t0 = Date.UTC(2024, 0, 1);
+    for(j = 0; j < n; j++) {
+        d = new Date(t0 + j * 61001);
+        r += d.getFullYear() + d.getMonth() + d.getDate() +
+            d.getHours() + d.getMinutes() + d.getSeconds();
+    }
+    global_res = r;
+    return n * 6;
+}
+
 function prop_read(n)
 {
     var obj, sum, j;
@@ -329,6 +342,59 @@ function prop_delete(n)
     return n * 20;
 }
 
+function object_as_map(n)
+{
+    var obj, keys, i, j, sum, len = 1000;
+    keys = [];
+    for(i = 0; i < len; i++)
+        keys.push("key" + i);
+    for(j = 0; j < n; j++) {
+        obj = { size: 0 };
+        for(i = 0; i < len; i++) {
+            obj[keys[i]] = i;
+            obj.size++;
+        }
+        sum = 0;
+        for(i = 0; i < len; i++)
+            sum += obj[keys[i]];
+        for(i = 0; i < len; i += 2)
+            delete obj[keys[i]];
+        for(i = 0; i < len; i += 2)
+            obj[keys[i]] = i;
+        global_res = sum;
+    }
+    return n * len * 3.5;
+}
+
+function object_for_in(n)
+{
+    var objs, obj, i, j, k, sum;
+    objs = [];
+    for(i = 0; i < 4; i++)
+        objs.push({ id: i, x: 1, y: 2, width: 10, height: 20, visible: true });
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        obj = objs[j & 3];
+        for(k in obj)
+            sum++;
+    }
+    global_res = sum;
+    return n * 6;
+}
+
+function object_keys(n)
+{
+    var objs, i, j, sum;
+    objs = [];
+    for(i = 0; i < 4; i++)
+        objs.push({ id: i, x: 1, y: 2, width: 10, height: 20, visible: true });
+    sum = 0;
+    for(j = 0; j < n; j++)
+        sum += Object.keys(objs[j & 3]).length;
+    global_res = sum;
+    return n * 6;
+}
+
 function array_read(n)
 {
     var tab, len, sum, i, j;
@@ -510,6 +576,95 @@ function typed_array_write(n)
     return len * n;
 }
 
+function typed_array_sort_f32(n)
+{
+    var ref, tab, len, i, j;
+    len = 10000;
+    ref = new Float32Array(len);
+    for(i = 0; i < len; i++)
+        ref[i] = Math.sin(i) * 1000;
+    for(j = 0; j < n; j++) {
+        tab = ref.slice();
+        tab.sort();
+    }
+    global_res = tab;
+    return len * n;
+}
+
+function typed_array_sort_u8(n)
+{
+    var ref, tab, len, i, j;
+    len = 10000;
+    ref = new Uint8Array(len);
+    for(i = 0; i < len; i++)
+        ref[i] = i * 7919;
+    for(j = 0; j < n; j++) {
+        tab = ref.slice();
+        tab.sort();
+    }
+    global_res = tab;
+    return len * n;
+}
+
+function typed_array_sort_i32(n)
+{
+    var ref, tab, len, i, j;
+    len = 10000;
+    ref = new Int32Array(len);
+    for(i = 0; i < len; i++)
+        ref[i] = (i * 2654435761) | 0;
+    for(j = 0; j < n; j++) {
+        tab = ref.slice();
+        tab.sort();
+    }
+    global_res = tab;
+    return len * n;
+}
+
+function typed_array_indexOf(n)
+{
+    var tab, len, i, j, sum;
+    len = 10000;
+    tab = new Float32Array(len);
+    for(i = 0; i < len; i++)
+        tab[i] = i;
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        sum += tab.indexOf(len - 1);
+        sum += tab.lastIndexOf(0);
+        sum += tab.includes(NaN);
+    }
+    global_res = sum;
+    return len * 3 * n;
+}
+
+function typed_array_index_u16(n)
+{
+    var tab, len, j, sum;
+    len = 10000;
+    tab = new Uint16Array(len);
+    tab[len - 1] = 1;
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        sum += tab.indexOf(1);
+        sum += tab.lastIndexOf(2);
+    }
+    global_res = sum;
+    return len * 2 * n;
+}
+
+function typed_array_fill(n)
+{
+    var tab, len, j;
+    len = 10000;
+    tab = new Float64Array(len);
+    for(j = 0; j < n; j++) {
+        tab.fill(j);
+    }
+    global_res = tab;
+    return len * n;
+}
+
 var global_var0;
 
 function global_read(n)
@@ -655,6 +810,59 @@ function func_closure_call(n)
     return n * 4;
 }
 
+function closure_const_capture(n)
+{
+    var j, sum;
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        const a = j, b = 1, c = 2;
+        var f = () => a + b + c;
+        sum += f();
+    }
+    global_res = sum;
+    return n;
+}
+
+function error_throw_catch(n)
+{
+    function f(a)
+    {
+        throw new Error("error");
+    }
+
+    var j, sum;
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        try {
+            f(j);
+        } catch (e) {
+            sum++;
+        }
+    }
+    global_res = sum;
+    return n;
+}
+
+function error_stack(n)
+{
+    function f(a)
+    {
+        throw new Error("error");
+    }
+
+    var j, sum;
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        try {
+            f(j);
+        } catch (e) {
+            sum += e.stack.length;
+        }
+    }
+    global_res = sum;
+    return n;
+}
+
 function int_arith(n)
 {
     var i, j, sum;
@@ -720,6 +928,95 @@ function bigint256_arith(n)
     return bigint_arith(n, 256);
 }
 
+/* operands of 'bits' bits, used to tune the thresholds of the
+   subquadratic algorithms */
+function bigint_large_operand(bits)
+{
+    return (BigInt(1) << BigInt(bits)) / BigInt(7);
+}
+
+function bigint_mul_large(n, bits)
+{
+    var j, a, b;
+    a = bigint_large_operand(bits);
+    b = bigint_large_operand(bits - 7) + BigInt(12345);
+    for(j = 0; j < n; j++) {
+        global_res = a * b;
+    }
+    return n;
+}
+
+function bigint_div_large(n, bits)
+{
+    var j, a, b;
+    a = bigint_large_operand(2 * bits);
+    b = bigint_large_operand(bits) + BigInt(12345);
+    for(j = 0; j < n; j++) {
+        global_res = a / b;
+    }
+    return n;
+}
+
+function bigint_to_string_large(n, bits)
+{
+    var j, a;
+    a = bigint_large_operand(bits);
+    for(j = 0; j < n; j++) {
+        global_res = a.toString();
+    }
+    return n;
+}
+
+function bigint_parse_large(n, bits)
+{
+    var j, s;
+    s = bigint_large_operand(bits).toString();
+    for(j = 0; j < n; j++) {
+        global_res = BigInt(s);
+    }
+    return n;
+}
+
+function bigint4k_mul(n)
+{
+    return bigint_mul_large(n, 4096);
+}
+
+function bigint64k_mul(n)
+{
+    return bigint_mul_large(n, 65536);
+}
+
+function bigint4k_div(n)
+{
+    return bigint_div_large(n, 4096);
+}
+
+function bigint64k_div(n)
+{
+    return bigint_div_large(n, 65536);
+}
+
+function bigint4k_toString(n)
+{
+    return bigint_to_string_large(n, 4096);
+}
+
+function bigint64k_toString(n)
+{
+    return bigint_to_string_large(n, 65536);
+}
+
+function bigint4k_parse(n)
+{
+    return bigint_parse_large(n, 4096);
+}
+
+function bigint64k_parse(n)
+{
+    return bigint_parse_large(n, 65536);
+}
+
 function map_set_string(n)
 {
     var s, i, j, len = 1000;
@@ -1015,6 +1312,69 @@ function string_build_large2(n)
     return n * len;
 }
 
+/* long substrings of a large document */
+function string_slice(n)
+{
+    var i, j, doc, r, len = 1000;
+    doc = "the quick brown fox jumps over the lazy dog. ".repeat(10000);
+    for(j = 0; j < n; j++) {
+        r = [];
+        for(i = 0; i < len; i++)
+            r.push(doc.slice(i * 100, i * 100 + 400));
+        global_res = r;
+    }
+    return n * len;
+}
+
+/* case conversion of mostly ASCII strings */
+function string_to_lower(n)
+{
+    var i, j, words, r, len = 1000;
+    words = [];
+    for(i = 0; i < len; i++)
+        words.push(((i & 1) ? "Content-Type-" : "content-length-") + i);
+    for(j = 0; j < n; j++) {
+        r = 0;
+        for(i = 0; i < len; i++)
+            r += words[i].toLowerCase().length;
+        global_res = r;
+    }
+    return n * len;
+}
+
+/* property accesses thru proxies sharing a handler (reactive state) */
+function proxy_reactive(n)
+{
+    var i, j, handler, items, r, len = 100, deps = 0, dirty = 0;
+    handler = {
+        get(target, key, receiver) {
+            deps++;
+            return Reflect.get(target, key, receiver);
+        },
+        set(target, key, value, receiver) {
+            dirty++;
+            return Reflect.set(target, key, value, receiver);
+        },
+        has(target, key) {
+            return key in target;
+        },
+    };
+    items = [];
+    for(i = 0; i < len; i++)
+        items.push(new Proxy({ id: i, done: false, count: 0 }, handler));
+    for(j = 0; j < n; j++) {
+        r = 0;
+        for(i = 0; i < len; i++) {
+            var item = items[i];
+            if (!item.done && "count" in item)
+                item.count = item.count + item.id;
+            r += item.count;
+        }
+        global_res = r;
+    }
+    return n * len;
+}
+
 /* sort bench */
 
 function sort_bench(text) {
@@ -1351,12 +1711,16 @@ function main(argc, argv, g)
         empty_do_loop,
         date_now,
         date_parse,
+        date_local_fields,
         prop_read,
         prop_write,
         prop_update,
         prop_create,
         prop_clone,
         prop_delete,
+        object_as_map,
+        object_for_in,
+        object_keys,
         array_read,
         array_write,
         array_prop_create,
@@ -1367,6 +1731,12 @@ function main(argc, argv, g)
         array_pop,
         typed_array_read,
         typed_array_write,
+        typed_array_sort_f32,
+        typed_array_sort_u8,
+        typed_array_sort_i32,
+        typed_array_indexOf,
+        typed_array_index_u16,
+        typed_array_fill,
         global_read,
         global_write,
         global_write_strict,
@@ -1376,6 +1746,9 @@ function main(argc, argv, g)
         global_func_call,
         func_call,
         func_closure_call,
+        closure_const_capture,
+        error_throw_catch,
+        error_stack,
         int_arith,
         float_arith,
         map_set_string,
@@ -1398,6 +1771,9 @@ function main(argc, argv, g)
         string_build4,
         string_build_large1,
         string_build_large2,
+        string_slice,
+        string_to_lower,
+        proxy_reactive,
         int_to_string,
         int_toString,
         float_to_string,
@@ -1417,6 +1793,14 @@ function main(argc, argv, g)
         test_list.push(bigint32_arith);
         test_list.push(bigint64_arith);
         test_list.push(bigint256_arith);
+        test_list.push(bigint4k_mul);
+        test_list.push(bigint64k_mul);
+        test_list.push(bigint4k_div);
+        test_list.push(bigint64k_div);
+        test_list.push(bigint4k_toString);
+        test_list.push(bigint64k_toString);
+        test_list.push(bigint4k_parse);
+        test_list.push(bigint64k_parse);
     }
     test_list.push(sort_bench);
 
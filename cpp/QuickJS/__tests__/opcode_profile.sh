@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Most frequent opcode pairs and triples executed by octane and the given
+# scripts. bin/qjs must be built with -DENABLE_OPCODE_PROFILE=ON.
+#
+# usage: ./opcode_profile.sh [script.js...]
+
+set -e
+
+out=$(mktemp)
+
+# octane/run.js imports benchmarks which are not in the tree: run the
+# ones which are present
+driver=$(mktemp --suffix=.js)
+trap 'rm -f "$out" "$driver"' EXIT
+dir=$(cd octane && pwd)
+{
+  echo "import { BenchmarkSuite } from '$dir/base.js'"
+  sed -n "s|^import '\./\(.*\)'|\1|p" octane/run.js | while read -r f; do
+    [ -f "octane/$f" ] && echo "import '$dir/$f'"
+  done
+  echo "BenchmarkSuite.RunSuites({ NotifyResult() {}, NotifyError() {}, NotifyScore() {} })"
+} > "$driver"
+
+export QJS_OPCODE_PROFILE="$out"
+./bin/qjs -m "$driver" > /dev/null
+for f in "$@"; do
+  ./bin/qjs --std "$f" > /dev/null
+done
+
+if [ ! -s "$out" ]; then
+  echo "no profile: bin/qjs was not built with ENABLE_OPCODE_PROFILE" >&2
+  exit 1
+fi
+
+# sum the counts of each sequence over all the runtimes
+report() {
+  awk -v n="$1" 'NF == n + 1 {
+    key = $2; for (i = 3; i <= NF; i++) key = key " " $i
+    count[key] += $1; total += $1
+  }
+  END {
+    for (k in count) printf "%14d %6.2f%%  %s\n", count[k], 100 * count[k] / total, k
+  }' "$out" | sort -rn | head -n "$2"
+}
+
+echo "opcodes:"
+report 1 30
+echo "pairs:"
+report 2 40
+echo "triples:"
+report 3 40
@@ -141,6 +141,29 @@ function test_bigint3()
     assert((7n) ** 20n, 79792266297612001n);
 }
 
+/* operands large enough for the subquadratic algorithms */
+function test_bigint_large()
+{
+    var a, b, q, r, s, i;
+    a = (1n << 20000n) / 7n - 12345n;
+    b = -((1n << 9000n) / 3n + 1n);
+    q = a / b;
+    r = a % b;
+    assert(q * b + r, a);
+    assert(r >= 0n && r < -b, true);
+    assert((a * b) / a, b);
+    assert((a * a) % a, 0n);
+    assert((2n ** 6000n - 1n) * (2n ** 6000n + 1n), 2n ** 12000n - 1n);
+
+    s = "9".repeat(5000);
+    assert(BigInt(s), 10n ** 5000n - 1n);
+    assert((10n ** 5000n - 1n).toString(), s);
+    assert((-(10n ** 4000n)).toString(), "-1" + "0".repeat(4000));
+    for(i = 2; i <= 36; i += 7)
+        assert(BigInt(a.toString(10)).toString(i), a.toString(i));
+    assert(BigInt("0x" + b.toString(16).slice(1)), -b);
+}
+
 /* pi computation */
 
 /* return floor(log2(a)) for a > 0 and 0 for a = 0 */
@@ -246,4 +269,5 @@ function test_pi()
 test_bigint1();
 test_bigint2();
 test_bigint3();
+test_bigint_large();
 test_pi();
@@ -144,6 +144,37 @@ function bjson_test_reference()
     }
 }
 
+/* objects with the same shape share the property names */
+function bjson_test_shape()
+{
+    var a, r, buf, i, n;
+    n = 100;
+    a = [];
+    for(i = 0; i < n; i++)
+        a.push({ id: i, name: "n" + i, pos: { x: i, y: -i } });
+    /* same keys in another order, a deleted and a non enumerable property */
+    a.push({ name: "last", id: n, pos: null });
+    a[1].extra = true;
+    delete a[2].name;
+    Object.defineProperty(a[3], "hidden", { value: 1, enumerable: false });
+    bjson_test(a);
+
+    buf = bjson.write(a);
+    r = bjson.read(buf, 0, buf.byteLength);
+    assert(Object.keys(r[0]).join(), "id,name,pos");
+    assert(Object.keys(r[n]).join(), "name,id,pos");
+    assert(Object.keys(r[2]).join(), "id,pos");
+    assert(r[3].hidden, undefined);
+    /* the objects read with the same shape are independent */
+    r[4].id = "x";
+    r[4].added = 1;
+    delete r[5].name;
+    assert(r[6].id, 6);
+    assert(r[6].added, undefined);
+    assert(r[6].name, "n6");
+    assert(Object.keys(r[5]).join(), "id,pos");
+}
+
 function bjson_test_all()
 {
     var obj;
@@ -172,6 +203,7 @@ function bjson_test_all()
     }
 
     bjson_test_reference();
+    bjson_test_shape();
 }
 
 bjson_test_all();
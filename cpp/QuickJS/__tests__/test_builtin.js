@@ -188,6 +188,95 @@ function test_enum()
     assert(tab, ["1","4294967294","x","18014398509481984","9007199254740992","9007199254740991","4294967296","4294967295","y"], "keys");
 }
 
+function test_enum_cache()
+{
+    var a, b, tab, k, i;
+    function P() {}
+    function for_in_keys(o) {
+        var r = [];
+        for(var k in o)
+            r.push(k);
+        return r.join();
+    }
+
+    /* objects with the same shape share the enumeration */
+    for(i = 0; i < 3; i++) {
+        a = { b: 1, 2: 1, a: 1, 1: 1 };
+        assert(for_in_keys(a), "1,2,b,a", "for-in");
+        assert(Object.keys(a).join(), "1,2,b,a", "keys");
+        assert(JSON.stringify(a), '{"1":1,"2":1,"b":1,"a":1}', "stringify");
+    }
+
+    /* deleted and added properties during the enumeration */
+    tab = [];
+    for(k in a) {
+        tab.push(k);
+        if (k == "2")
+            delete a.a;
+        a.z = 1;
+    }
+    assert(tab.join(), "1,2,b", "for-in delete");
+
+    /* non enumerable properties */
+    b = { x: 1, y: 2 };
+    Object.defineProperty(b, "x", { enumerable: false });
+    assert(for_in_keys(b), "y", "for-in non enumerable");
+    assert(Object.keys(b).join(), "y", "keys non enumerable");
+    assert(Object.getOwnPropertyNames(b).join(), "x,y", "names");
+
+    /* enumerable properties added to the prototype */
+    a = new P();
+    a.x = 1;
+    assert(for_in_keys(a), "x", "for-in proto");
+    P.prototype.y = 1;
+    assert(for_in_keys(a), "x,y", "for-in proto");
+    a.y = 2;
+    assert(for_in_keys(a), "x,y", "for-in proto shadowed");
+}
+
+function test_dictionary_object()
+{
+    var a, b, i, n = 300, tab, sum;
+
+    /* objects with many properties switch to the dictionary mode */
+    a = {};
+    b = {};
+    for(i = 0; i < n; i++) {
+        a["k" + i] = i;
+        b["k" + i] = -i;
+    }
+    assert(Object.keys(a).length, n, "dict keys");
+    assert(a.k0 + a.k150 + a["k" + (n - 1)], 150 + n - 1, "dict get");
+    assert(b.k150, -150, "dict get");
+    a.k1 = 100;
+    assert(a.k1, 100, "dict set");
+    assert(b.k1, -1, "dict set");
+
+    /* deletions and compaction keep the enumeration order */
+    for(i = 0; i < n; i += 2)
+        delete a["k" + i];
+    assert(a.k0, undefined, "dict delete");
+    assert(Object.keys(a).length, n / 2, "dict delete");
+    tab = Object.keys(a);
+    assert(tab[0], "k1", "dict order");
+    assert(tab[tab.length - 1], "k" + (n - 1), "dict order");
+
+    /* an object which shrinks returns to the fast mode */
+    for(i = 1; i < n - 20; i += 2)
+        delete a["k" + i];
+    assert(Object.keys(a).join(), Object.keys(a).sort(function(x, y) {
+        return (x.slice(1) | 0) - (y.slice(1) | 0);
+    }).join(), "dict order");
+    a.z = 1;
+    Object.defineProperty(a, "g", { get: function() { return 2; } });
+    sum = 0;
+    for(i = 0; i < 10; i++)
+        sum += a.z + a.g;
+    assert(sum, 30, "fast get");
+    assert(Object.getOwnPropertyDescriptor(a, "g").configurable, false, "fast define");
+    assert(Object.keys(a).length, 11, "fast keys");
+}
+
 function test_array()
 {
     var a, err;
@@ -510,6 +599,43 @@ function test_typed_array()
     assert(a.toString(), "1,2,3,4");
     a.set([10, 11], 2);
     assert(a.toString(), "1,2,10,11");
+
+    /* large arrays use a radix sort */
+    for (var T of [Int8Array, Int16Array, Int32Array, Float16Array,
+                   Float32Array, Float64Array]) {
+        a = new T(300);
+        for(i = 0; i < a.length; i++)
+            a[i] = (i * 37) % 100 - 50;
+        a[10] = NaN;
+        a[20] = -0;
+        a[30] = 0;
+        a[40] = -Infinity;
+        a.sort();
+        assert(a[0], a instanceof Float32Array ||
+               a instanceof Float64Array || a instanceof Float16Array ?
+               -Infinity : -50);
+        for(i = 1; i < a.length; i++)
+            assert(a[i - 1] <= a[i] || a[i] !== a[i], true);
+        if (T !== Int8Array && T !== Int16Array && T !== Int32Array) {
+            assert(a[a.length - 1], NaN);
+            i = a.indexOf(0);
+            assert(Object.is(a[i], -0) && Object.is(a[i + 1], 0), true);
+        }
+    }
+
+    a = new Int8Array(100);
+    a[5] = -3;
+    assert(a.lastIndexOf(-3), 5);
+    assert(a.indexOf(-3, 6), -1);
+    a.fill(-1, 2, 98);
+    assert(a.lastIndexOf(-1), 97);
+    a = new Float64Array(100);
+    a[70] = NaN;
+    assert(a.includes(NaN), true);
+    assert(a.indexOf(NaN), -1);
+    a.fill(0.5, 1);
+    assert(a.lastIndexOf(0.5, 50), 50);
+    assert(a.indexOf(0), 0);
 }
 
 /* return [s, line_num, col_num] where line_num and col_num are the
@@ -703,6 +829,43 @@ function test_date()
     assert(Date.UTC(2017, 9, 22, 18, 10, 11 - 1e12, 91 + 1000e12), 1508695811091);
 }
 
+function test_date_timezone()
+{
+    var tz, d, i, t;
+
+    if (typeof std === 'undefined' ||
+        (typeof os !== 'undefined' && ['win32', 'cygwin'].includes(os.platform)))
+        return;
+    tz = std.getenv("TZ");
+    try {
+        /* POSIX rules: no need for the timezone database */
+        std.setenv("TZ", "EST5EDT,M3.2.0,M11.1.0");
+        for(i = 0; i < 3; i++) {
+            /* the offsets are cached after the first use of a period */
+            assert(new Date(2024, 2, 10, 1, 59).getTimezoneOffset(), 300);
+            assert(new Date(2024, 2, 10, 3, 0).getTimezoneOffset(), 240);
+            assert(new Date(2024, 10, 3, 0, 59).getTimezoneOffset(), 240);
+            assert(new Date(2024, 10, 3, 2, 0).getTimezoneOffset(), 300);
+            assert(new Date(2024, 5, 1, 12).toISOString(), "2024-06-01T16:00:00.000Z");
+            assert(new Date(Date.UTC(2024, 2, 10, 6, 59, 59)).getHours(), 1);
+            assert(new Date(Date.UTC(2024, 2, 10, 7)).getHours(), 3);
+            assert(Date.parse("2024-01-15T10:30"), Date.UTC(2024, 0, 15, 15, 30));
+            assert(Date.parse("2024-07-15T10:30:00.250"), Date.UTC(2024, 6, 15, 14, 30, 0, 250));
+        }
+        /* the cache is refreshed when TZ changes */
+        std.setenv("TZ", "JST-9");
+        assert(new Date(2024, 5, 1).getTimezoneOffset(), -540);
+        assert(new Date(2024, 5, 1, 12).toISOString(), "2024-06-01T03:00:00.000Z");
+    } finally {
+        if (tz === undefined)
+            std.unsetenv("TZ");
+        else
+            std.setenv("TZ", tz);
+    }
+    t = Date.UTC(2024, 5, 1, 12);
+    assert(new Date(t).getHours(), new Date(t).getUTCHours() - new Date(t).getTimezoneOffset() / 60);
+}
+
 function test_regexp()
 {
     var a, str;
@@ -1060,6 +1223,174 @@ function test_rope()
     rope_concat(100000, -1);
 }
 
+function test_string_slice()
+{
+    var doc, a, b, w, r, m;
+
+    /* long substrings share the characters of their parent */
+    doc = "0123456789abcdef".repeat(64);
+    a = doc.substring(3, 100);
+    b = doc.slice(3, 100);
+    assert(a, b);
+    assert(a.length, 97);
+    assert(a.slice(13, 53), doc.substr(16, 40));
+    assert(a.slice(13, 53).slice(3, 40), doc.slice(19, 56));
+    assert(a < doc.slice(4, 5), true);
+    assert(a.indexOf("f"), 12);
+    assert(a + "!", doc.slice(3, 100) + "!");
+    m = new Map([[a, 1]]);
+    assert(m.get(b), 1);
+    assert({ [a]: 2 }[b], 2);
+    assert(JSON.stringify(a.slice(0, 34)), '"3456789abcdef0123456789abcdef01234"');
+
+    w = "\u4e2d\u6587".repeat(10) + doc;
+    assert(w.slice(2, 60).length, 58);
+    assert(w.slice(2, 60).charCodeAt(0), 0x4e2d);
+    assert(w.slice(2, 60), w.substring(2, 60));
+    /* no 16 bit characters in the slice */
+    assert(w.slice(30, 100), doc.slice(10, 80));
+
+    r = /(0\w{40})(\w+)/.exec(doc);
+    assert(r[1], doc.slice(0, 41));
+    assert(r[2].length, doc.length - 41);
+    assert(doc.split("f0").length, 64);
+    assert(doc.split("f0")[1], "123456789abcde");
+
+    /* regexps on a 16 bit slice starting at an odd offset */
+    w = "\u20ac\u20ac\u20acxxxxx\u20acabc".repeat(10).substring(1, 61);
+    assert(w.charCodeAt(0), 0x20ac);
+    assert(w.search(/a/), 8);
+    r = /a(bc)/.exec(w);
+    assert(r.index, 8);
+    assert(r[1], "bc");
+    assert(w.replace(/abc/, "Z").slice(0, 10), "\u20ac\u20acxxxxx\u20acZ\u20ac");
+    assert(w.split(/a/).length, 6);
+    assert(w.match(/abc/g).length, 5);
+}
+
+function test_case_conversion()
+{
+    var s, i, c;
+
+    s = "Hello World, abcdefghijklmnopqrstuvwxyz @[`{";
+    assert(s.toUpperCase(), "HELLO WORLD, ABCDEFGHIJKLMNOPQRSTUVWXYZ @[`{");
+    assert(s.toUpperCase().toLowerCase(), "hello world, abcdefghijklmnopqrstuvwxyz @[`{");
+    assert("already lower case".toLowerCase(), "already lower case");
+    assert("ALREADY UPPER CASE".toUpperCase(), "ALREADY UPPER CASE");
+    /* Latin-1 characters */
+    assert("\xc0\xc9\xd7\xde \xe0\xe9\xf7\xfe".toLowerCase(),
+           "\xe0\xe9\xd7\xfe \xe0\xe9\xf7\xfe");
+    assert("\xc0\xc9\xd7\xde \xe0\xe9\xf7\xfe".toUpperCase(),
+           "\xc0\xc9\xd7\xde \xc0\xc9\xf7\xde");
+    /* the upper case of these characters is not Latin-1 */
+    assert("stra\xdfe \xb5 \xff".toUpperCase(), "STRASSE \u039c \u0178");
+    assert("\u0391\u03a3 \u0130".toLowerCase(), "\u03b1\u03c2 i\u0307");
+    /* same result as the generic 16 bit path */
+    for(i = 0; i < 256; i++) {
+        c = ("abcdefghXYZ" + String.fromCharCode(i)).repeat(3);
+        assert(c.toLowerCase(), (c + "\u0100").toLowerCase().slice(0, -1));
+        assert(c.toUpperCase(), (c + "\u0100").toUpperCase().slice(0, -1));
+    }
+
+    /* Unicode properties of BMP characters */
+    assert(/^\p{ID_Start}+$/u.test("a\xaa\xc0\u0561\u4e2d\uffda"), true);
+    assert(/\p{ID_Start}/u.test("0\xd7\u0300\uffff"), false);
+    assert(/^\p{ID_Continue}+$/u.test("a0\u0300\u203f"), true);
+    assert(/\p{ID_Continue}/u.test(" -\u2000"), false);
+    assert(/^\p{Cased}+$/u.test("aZ\xb5\u0561\u2160"), true);
+    assert(/^\p{Case_Ignorable}+$/u.test("'.:^\u0300\u02b0"), true);
+    assert(/\u0101/ui.test("\u0100"), true);
+    assert(/\u4e2d/ui.test("\u4e2e"), false);
+}
+
+function test_proxy()
+{
+    var handler, target, p1, p2, log, n, get_count, r, a;
+
+    log = [];
+    handler = {
+        get(t, k, r) { log.push("get " + k); return t[k]; },
+        set(t, k, v, r) { log.push("set " + k); t[k] = v; return true; },
+    };
+    p1 = new Proxy({ x: 1 }, handler);
+    p2 = new Proxy({ x: 2 }, handler);
+    assert(p1.x + p2.x, 3);
+    p1.y = 3;
+    assert(log.join(), "get x,get x,set y");
+
+    /* the traps are read from the handler at each operation */
+    handler.get = function(t, k) { return k + "!"; };
+    assert(p1.x, "x!");
+    assert(p2.z, "z!");
+    delete handler.get;
+    assert(p1.x, 1);
+    assert(p1.y, 3);
+    assert("x" in p1, true);
+
+    /* trap defined in the prototype of the handler */
+    Object.prototype.has = function(t, k) { return k == "magic"; };
+    try {
+        assert("magic" in p1, true);
+        assert("x" in p1, false);
+    } finally {
+        delete Object.prototype.has;
+    }
+    assert("magic" in p1, false);
+    assert("x" in p1, true);
+
+    /* trap getter */
+    get_count = 0;
+    handler = {};
+    Object.defineProperty(handler, "get", {
+        get() { get_count++; return function(t, k) { return 42; }; }
+    });
+    p1 = new Proxy({}, handler);
+    assert(p1.a + p1.b, 84);
+    assert(get_count, 2);
+
+    handler = Object.create({ get(t, k) { return "proto " + k; } });
+    p1 = new Proxy({}, handler);
+    assert(p1.a, "proto a");
+    Object.getPrototypeOf(handler).get = null;
+    assert(p1.a, undefined);
+
+    /* invariants of the traps */
+    handler = {
+        get(t, k) { return 0; },
+        has(t, k) { return false; },
+        deleteProperty(t, k) { return true; },
+    };
+    target = { a: 1 };
+    p1 = new Proxy(target, handler);
+    assert(p1.a, 0);
+    assert("a" in p1, false);
+    assert(delete p1.a, true);
+    Object.defineProperty(target, "b", { value: 1 });
+    assert_throws(TypeError, () => p1.b);
+    assert_throws(TypeError, () => "b" in p1);
+    assert_throws(TypeError, () => delete p1.b);
+    Object.preventExtensions(target);
+    assert(p1.a, 0);
+    assert_throws(TypeError, () => "a" in p1);
+    assert_throws(TypeError, () => delete p1.a);
+    assert("c" in p1, false);
+
+    a = [1, 2, 3];
+    p1 = new Proxy(a, handler);
+    assert(p1[0], 0);
+    assert(0 in p1, false);
+    Object.preventExtensions(a);
+    assert_throws(TypeError, () => 0 in p1);
+    assert(5 in p1, false);
+    Object.freeze(a);
+    assert_throws(TypeError, () => p1[0]);
+
+    r = Proxy.revocable({}, handler);
+    assert(r.proxy.x, 0);
+    r.revoke();
+    assert_throws(TypeError, () => r.proxy.x);
+}
+
 function eval_error(eval_str, expected_error, level)
 {
     var err = false;
@@ -1147,6 +1478,8 @@ function test_line_column_numbers()
 test();
 test_function();
 test_enum();
+test_enum_cache();
+test_dictionary_object();
 test_array();
 test_string();
 test_math();
@@ -1155,6 +1488,7 @@ test_eval();
 test_typed_array();
 test_json();
 test_date();
+test_date_timezone();
 test_regexp();
 test_symbol();
 test_map();
@@ -1164,4 +1498,7 @@ test_weak_ref();
 test_finalization_registry();
 test_generator();
 test_rope();
+test_string_slice();
+test_case_conversion();
+test_proxy();
 test_line_column_numbers();
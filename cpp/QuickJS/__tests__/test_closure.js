@@ -212,6 +212,95 @@ function test_eval_const()
     assert(success);
 }
 
+function test_const_capture()
+{
+    var tab, i;
+
+    /* captured before the initialization */
+    function f1() {
+        var g = () => c;
+        var ok = false;
+        try {
+            g();
+        } catch(e) {
+            ok = (e instanceof ReferenceError);
+        }
+        const c = 1;
+        return ok && g() === 1;
+    }
+    assert(f1());
+
+    /* hoisted function created before the initialization */
+    function f3() {
+        function g() { return k; }
+        const k = 2;
+        return g;
+    }
+    assert(f3()() === 2);
+
+    tab = [];
+    for(i = 0; i < 3; i++) {
+        if (i > 0)
+            tab.push(() => x);
+        const x = i;
+    }
+    assert(tab.map(g => g()).join(), "1,2");
+
+    tab = [];
+    for(const v of [1, 2, 3]) {
+        const w = v * 10;
+        tab.push(() => v + w);
+    }
+    assert(tab.map(g => g()).join(), "11,22,33");
+
+    tab = [];
+    for(i = 0; i < 3; i++) {
+        const j = i;
+        tab.push(function () { return () => j; });
+    }
+    assert(tab[2]()() === 2);
+
+    class C {
+        static self() { return C; }
+    }
+    assert(C.self() === C);
+
+    class D extends C {
+        constructor() {
+            var before = () => this;
+            super();
+            const after = () => this;
+            assert(before() === this && after() === this);
+        }
+    }
+    new D();
+
+    /* the closures of a frame share the captured value while it does
+       not change */
+    tab = [];
+    for(i = 0; i < 6; i++) {
+        const z = (i & 2) ? -0 : 0, o = { i: i >> 1 };
+        tab.push(() => 1 / z, () => o);
+    }
+    assert(tab.map(g => typeof g() == "number" ? g() : g().i).join(),
+           "Infinity,0,Infinity,0,-Infinity,1,-Infinity,1,Infinity,2,Infinity,2");
+
+    function* gen() {
+        for(const n of ["a", "b"]) {
+            yield () => n;
+            yield () => n + n;
+        }
+    }
+    assert(Array.from(gen(), g => g()).join(), "a,aa,b,bb");
+
+    async function f2() {
+        const a = { v: 1 };
+        await null;
+        return () => a;
+    }
+    f2().then(g => assert(g().v, 1));
+}
+
 test_closure1();
 test_closure2();
 test_closure3();
@@ -219,3 +308,4 @@ test_arrow_function();
 test_with();
 test_eval_closure();
 test_eval_const();
+test_const_capture();
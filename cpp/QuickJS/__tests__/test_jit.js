@@ -0,0 +1,293 @@
+/*
+ * Native code of the hot functions. Run with:
+ *
+ *   qjs --jit-threshold 1 test_jit.js
+ *
+ * so that every function is compiled. The results must be the same as
+ * with the interpreter.
+ */
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+function assert_throws(expected_error, func)
+{
+    var err = false;
+    try {
+        func();
+    } catch(e) {
+        err = true;
+        if (!(e instanceof expected_error)) {
+            throw Error("unexpected exception type");
+        }
+    }
+    if (!err) {
+        throw Error("expected exception");
+    }
+}
+
+// load more elaborate version of assert if available
+try { __loadScript("test_assert.js"); } catch(e) {}
+
+/*----------------*/
+
+function test_int_loop()
+{
+    var i, s = 0;
+    for (i = 0; i < 1000; i++)
+        s = (s + i) | 0;
+    assert(s, 499500);
+
+    /* overflow to float64 */
+    s = 0x7ffffff0;
+    for (i = 0; i < 32; i++)
+        s += 1;
+    assert(s, 0x80000010);
+
+    s = 0;
+    for (i = 10; i > 0; i--)
+        s -= i;
+    assert(s, -55);
+
+    s = 0;
+    i = 0;
+    do {
+        s ^= i << 1;
+    } while (++i < 100);
+    assert(s, 0);
+}
+
+function test_compare()
+{
+    function cmp(a, b) {
+        return [a < b, a <= b, a > b, a >= b, a == b, a != b,
+                a === b, a !== b].join();
+    }
+    assert(cmp(1, 2), "true,true,false,false,false,true,false,true");
+    assert(cmp(2, 2), "false,true,false,true,true,false,true,false");
+    assert(cmp(1.5, 1), "false,false,true,true,false,true,false,true");
+    assert(cmp("a", "b"), "true,true,false,false,false,true,false,true");
+    assert(cmp(1, "1"), "false,true,false,true,true,false,false,true");
+    assert(cmp(NaN, NaN), "false,false,false,false,false,true,false,true");
+    assert(cmp(1n, 2), "true,true,false,false,false,true,false,true");
+
+    function count(a, limit) {
+        var i, n = 0;
+        for (i = 0; i < a.length; i++) {
+            if (a[i] < limit)
+                n++;
+        }
+        return n;
+    }
+    assert(count([1, 5, 2.5, "3", 10, null, undefined], 3), 3);
+}
+
+function test_arith()
+{
+    function f(a, b) {
+        return [a + b, a - b, a * b, a / b, a % b, a & b, a | b, a ^ b,
+                a << 1, a >> 1, a >>> 1, -a, ~a, !a].join();
+    }
+    assert(f(7, 2), "9,5,14,3.5,1,2,7,5,14,3,3,-7,-8,false");
+    assert(f(-7, 2), "-5,-9,-14,-3.5,-1,0,-5,-5,-14,-4,2147483644,7,6,false");
+    assert(f(0, 0), "0,0,0,NaN,NaN,0,0,0,0,0,0,0,-1,true");
+    assert(f("7", 2), "72,5,14,3.5,1,2,7,5,14,3,3,-7,-8,false");
+    assert(f(1.5, 0.5), "2,1,0.75,3,0,0,1,1,2,0,0,-1.5,-2,false");
+
+    var x = -2147483648;
+    x--;
+    assert(x, -2147483649);
+    assert(-0 === 0 && 1 / -(0) === -Infinity);
+}
+
+function test_exception()
+{
+    function thrower(n) {
+        var i;
+        for (i = 0; i < n; i++) {
+            if (i == 5)
+                throw new RangeError("i=" + i);
+        }
+        return i;
+    }
+    assert(thrower(3), 3);
+    assert_throws(RangeError, () => thrower(10));
+
+    /* exception raised by a slow path and caught in the same loop */
+    var i, n = 0, o = null;
+    for (i = 0; i < 10; i++) {
+        try {
+            if (i & 1)
+                o.x;
+            n++;
+        } catch (e) {
+            assert(e instanceof TypeError);
+            n += 10;
+        } finally {
+            n += 100;
+        }
+    }
+    assert(n, 1055);
+
+    function undefined_var() {
+        return not_defined_var + 1;
+    }
+    assert_throws(ReferenceError, undefined_var);
+
+    function tdz() {
+        x = 1;
+        let x;
+    }
+    assert_throws(ReferenceError, tdz);
+}
+
+function test_closure()
+{
+    function counter() {
+        var c = 0;
+        return function () { return ++c; };
+    }
+    var f = counter(), i;
+    for (i = 0; i < 100; i++)
+        f();
+    assert(f(), 101);
+
+    var fns = [];
+    for (let j = 0; j < 5; j++)
+        fns.push(() => j);
+    assert(fns.map(g => g()).join(), "0,1,2,3,4");
+}
+
+function test_calls()
+{
+    function fib(n) {
+        return n < 2 ? n : fib(n - 1) + fib(n - 2);
+    }
+    assert(fib(20), 6765);
+
+    function sum() {
+        var s = 0, i;
+        for (i = 0; i < arguments.length; i++)
+            s += arguments[i];
+        return s;
+    }
+    assert(sum(1, 2, 3), 6);
+    assert(sum.apply(null, [4, 5]), 9);
+    assert(sum(...[1, 2], 3), 6);
+
+    function rest(a, ...b) {
+        return a + b.length;
+    }
+    assert(rest(1, 2, 3), 3);
+
+    class A {
+        constructor(x) { this.x = x; }
+        get double() { return this.x * 2; }
+        add(y) { return this.x + y; }
+    }
+    class B extends A {
+        constructor(x) { super(x + 1); }
+        add(y) { return super.add(y) * 10; }
+    }
+    var b = new B(1);
+    assert(b.double, 4);
+    assert(b.add(3), 50);
+    assert(new.target, undefined);
+
+    /* tail call in a loop */
+    function loop(n, acc) {
+        if (n == 0)
+            return acc;
+        return loop(n - 1, acc + n);
+    }
+    assert(loop(100, 0), 5050);
+}
+
+function test_objects()
+{
+    var o = { a: 1, b: 2 }, i, s = 0, k;
+    for (i = 0; i < 100; i++) {
+        o.a += i;
+        o["b"] = o.b + 1;
+    }
+    assert(o.a, 4951);
+    assert(o.b, 102);
+
+    for (k in o)
+        s += o[k];
+    assert(s, 5053);
+
+    var a = [];
+    for (i = 0; i < 10; i++)
+        a[i] = i * i;
+    assert(a.length, 10);
+    s = 0;
+    for (var v of a)
+        s += v;
+    assert(s, 285);
+
+    var { a: x, ...rest } = { a: 1, b: 2, c: 3 };
+    assert(x, 1);
+    assert(Object.keys(rest).join(), "b,c");
+    assert(typeof o, "object");
+    assert(delete o.a);
+    assert("a" in o, false);
+    assert(a instanceof Array);
+}
+
+function test_unsupported_ops()
+{
+    /* opcodes which are not compiled continue in the interpreter */
+    function* gen(n) {
+        for (var i = 0; i < n; i++)
+            yield i;
+    }
+    var s = 0, i;
+    for (i of gen(10))
+        s += i;
+    assert(s, 45);
+
+    async function af() {
+        var r = 0;
+        for (var i = 0; i < 3; i++)
+            r += await i;
+        return r;
+    }
+    af().then((r) => assert(r, 3));
+
+    var obj = { w: 1 };
+    s = 0;
+    for (i = 0; i < 3; i++) {
+        with (obj) {
+            s += w;
+        }
+    }
+    assert(s, 3);
+
+    s = 0;
+    for (i = 0; i < 10; i++)
+        s += eval("i");
+    assert(s, 45);
+}
+
+test_int_loop();
+test_compare();
+test_arith();
+test_exception();
+test_closure();
+test_calls();
+test_objects();
+test_unsupported_ops();
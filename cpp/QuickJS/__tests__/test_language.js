@@ -622,6 +622,33 @@ function test_optional_chaining()
     assert((a?.["b"])().c, 42);
 }
 
+/* fused local/argument + field access */
+function test_get_loc_field()
+{
+    function f(o, a) {
+        var p = o;
+        return p.x + a.y + p.length;
+    }
+    var i, r = 0;
+    for (i = 0; i < 3; i++)
+        r += f({ x: 1, length: 2 }, { y: i });
+    assert(r, 12);
+
+    /* the getter modifies the variable holding the object */
+    function g(o) {
+        var p = o;
+        Object.defineProperty(p, "x", { get() { p = null; return 1; } });
+        return p.x + (p === null ? 10 : 0);
+    }
+    assert(g({}), 11);
+    assert(g({}), 11);
+
+    function h(o) {
+        return o.x;
+    }
+    assert_throws(TypeError, () => h(undefined));
+}
+
 function test_unicode_ident()
 {
     var Ãµ = 3;
@@ -650,5 +677,6 @@ test_argument_scope();
 test_function_expr_name();
 test_parse_semicolon();
 test_optional_chaining();
+test_get_loc_field();
 test_parse_arrow_function();
 test_unicode_ident();
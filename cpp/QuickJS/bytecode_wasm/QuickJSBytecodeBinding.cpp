@@ -39,35 +39,63 @@ namespace quickjs {
   /// @brief
   QuickJSBytecodeBinding::QuickJSBytecodeBinding() {}
 
-  JSContext *QuickJSBytecodeBinding::prepare(std::vector<std::string> modules) {
-    JSRuntime *runtime = JS_NewRuntime();
-    JSContext *context = JS_NewContext(runtime);
+  QuickJSBytecodeBinding::~QuickJSBytecodeBinding() {
+    reset();
+  }
 
-    auto defaultExport = [](JSContext *context, JSModuleDef *m) { return 0; };
+  void QuickJSBytecodeBinding::reset() {
+    if (context) {
+      JSRuntime *runtime = JS_GetRuntime(context);
+      JS_FreeContext(context);
+      JS_FreeRuntime(runtime);
+      context = nullptr;
+    }
+    registered.clear();
+  }
 
-    JS_SetModuleLoaderFunc(runtime, nullptr, QuickJSBytecodeBinding::resolve, nullptr);
+  /// @brief create the runtime on first use and register the stub modules
+  /// that are not known yet. The runtime is kept across compiles.
+  JSContext *QuickJSBytecodeBinding::prepare(const std::vector<std::string> &modules) {
+    if (!context) {
+      JSRuntime *runtime = JS_NewRuntime();
+      if (!runtime) {
+        throw std::runtime_error("Failed to create runtime");
+      }
+      context = JS_NewContext(runtime);
+      if (!context) {
+        JS_FreeRuntime(runtime);
+        throw std::runtime_error("Failed to create context");
+      }
+      JS_SetModuleLoaderFunc(runtime, nullptr, QuickJSBytecodeBinding::resolve, nullptr);
+    }
+
+    auto defaultExport = [](JSContext *context, JSModuleDef *m) { return 0; };
 
     for (const auto &module : modules) {
+      if (registered.count(module)) {
+        continue;
+      }
       JSModuleDef *m = taro_js_new_c_module(context, module.c_str(), defaultExport);
       if (!m) {
         throw std::runtime_error("Failed to create module: " + module);
       }
+      registered.insert(module);
     }
 
     return context;
   }
 
-  /// @brief
-  std::vector<uint8_t> QuickJSBytecodeBinding::compile(
-    std::string input, 
-    std::string sourceURL,
-    std::vector<std::string> modules
+  /// @brief compile one module on the warm runtime. The compiled module is
+  /// unloaded right away so that only the stub modules outlive the call.
+  uint8_t *QuickJSBytecodeBinding::write(
+    const std::string &input,
+    const std::string &sourceURL,
+    size_t *byteLength
   ) {
-    JSContext *context = prepare(modules);
     JSValue m = JS_Eval(
       context,
       input.c_str(),
-      strlen(input.c_str()),
+      input.length(),
       sourceURL.c_str(),
       JS_EVAL_FLAG_COMPILE_ONLY | JS_EVAL_TYPE_MODULE
     );
@@ -78,26 +106,64 @@ namespace quickjs {
       throw std::runtime_error("Failed to compile module detail: " + exception);
     }
 
-    size_t byteLength;
     uint8_t *bytes = JS_WriteObject(
       context,
-      &byteLength,
+      byteLength,
       m,
       JS_WRITE_OBJ_BYTECODE
     );
 
+    taro_js_unload_module(context, (JSModuleDef *)JS_VALUE_GET_PTR(m));
     JS_FreeValue(context, m);
 
     if (!bytes) {
-      delete bytes;
-      JS_FreeContext(context);
-      JS_FreeRuntime(JS_GetRuntime(context));
+      JS_FreeValue(context, JS_GetException(context));
       throw std::runtime_error("Failed to write bytecode");
     }
 
-    JS_FreeContext(context);
-    JS_FreeRuntime(JS_GetRuntime(context));
+    return bytes;
+  }
+
+  /// @brief
+  std::vector<uint8_t> QuickJSBytecodeBinding::compile(
+    std::string input,
+    std::string sourceURL,
+    std::vector<std::string> modules
+  ) {
+    prepare(modules);
+
+    size_t byteLength;
+    uint8_t *bytes = write(input, sourceURL, &byteLength);
+    std::vector<uint8_t> result(bytes, bytes + byteLength);
+    js_free(context, bytes);
+
+    return result;
+  }
+
+  /// @brief
+  val QuickJSBytecodeBinding::compileMany(
+    val inputs,
+    std::vector<std::string> modules
+  ) {
+    prepare(modules);
+
+    val Uint8Array = val::global("Uint8Array");
+    unsigned length = inputs["length"].as<unsigned>();
+    val results = val::array();
+
+    for (unsigned i = 0; i < length; i++) {
+      val item = inputs[i];
+      std::string input = item["input"].as<std::string>();
+      std::string sourceURL = item["sourceURL"].as<std::string>();
+
+      size_t byteLength;
+      uint8_t *bytes = write(input, sourceURL, &byteLength);
+      /* copy the wasm heap view once, straight into a JS owned buffer */
+      results.call<void>(
+        "push", Uint8Array.new_(typed_memory_view(byteLength, bytes)));
+      js_free(context, bytes);
+    }
 
-    return std::vector<uint8_t>(bytes, bytes + byteLength);
+    return results;
   }
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <emscripten/val.h>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include "QuickJS/quickjs.h"
 
@@ -14,12 +16,30 @@ class QuickJSBytecodeBinding {
   resolve(JSContext* context, const char* moduleName, void* opaque);
 
   QuickJSBytecodeBinding();
+  ~QuickJSBytecodeBinding();
 
   std::vector<uint8_t> compile(
     std::string input,
-    std::string sourceURL, 
+    std::string sourceURL,
     std::vector<std::string> modules);
 
-  JSContext* prepare(std::vector<std::string> modules);
+  /// @brief compile an array of { input, sourceURL } on the warm runtime,
+  /// returns an array of Uint8Array
+  val compileMany(val inputs, std::vector<std::string> modules);
+
+  /// @brief drop the warm runtime, the next compile starts from scratch
+  void reset();
+
+  JSContext* prepare(const std::vector<std::string>& modules);
+
+ private:
+  uint8_t* write(
+    const std::string& input,
+    const std::string& sourceURL,
+    size_t* byteLength);
+
+  JSContext* context = nullptr;
+  /* stub modules already registered in 'context' */
+  std::unordered_set<std::string> registered;
 };
 } // namespace quickjs
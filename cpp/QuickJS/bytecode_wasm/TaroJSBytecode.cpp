@@ -15,6 +15,8 @@ EMSCRIPTEN_BINDINGS(quickjs_bytecode_wasm) {
   class_<QuickJSBytecodeBinding>("QuickJSBytecode")
     .constructor<>()
     .function("compile", &QuickJSBytecodeBinding::compile)
+    .function("compileMany", &QuickJSBytecodeBinding::compileMany)
+    .function("reset", &QuickJSBytecodeBinding::reset)
     .smart_ptr<std::shared_ptr<QuickJSBytecodeBinding>>("shared_ptr<QuickJSBytecodeBinding>");
   emscripten::function("taro_js_bc_get_version", &taro_bc_get_version);
   emscripten::function("taro_js_bc_get_binary_version",
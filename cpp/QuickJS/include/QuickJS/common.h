@@ -338,6 +338,44 @@ static inline JSValue __JS_NewShortBigInt(JSContext* ctx, int64_t d) {
 
 typedef struct JSModuleDef JSModuleDef;
 
+typedef enum JSProxyTrapEnum {
+  JS_PROXY_TRAP_GET_PROTOTYPE_OF,
+  JS_PROXY_TRAP_SET_PROTOTYPE_OF,
+  JS_PROXY_TRAP_IS_EXTENSIBLE,
+  JS_PROXY_TRAP_PREVENT_EXTENSIONS,
+  JS_PROXY_TRAP_GET_OWN_PROPERTY_DESCRIPTOR,
+  JS_PROXY_TRAP_DEFINE_PROPERTY,
+  JS_PROXY_TRAP_HAS,
+  JS_PROXY_TRAP_GET,
+  JS_PROXY_TRAP_SET,
+  JS_PROXY_TRAP_DELETE_PROPERTY,
+  JS_PROXY_TRAP_OWN_KEYS,
+  JS_PROXY_TRAP_APPLY,
+  JS_PROXY_TRAP_CONSTRUCT,
+  JS_PROXY_TRAP_COUNT,
+} JSProxyTrapEnum;
+
+#define JS_PROXY_TRAP_CACHE_SIZE 4 /* entries per trap */
+
+/* time consumed by the calls of taro_js_run_with_budget() of a context,
+   in nanoseconds */
+typedef struct JSBudgetStats {
+  int64_t call_count;
+  int64_t expired_count; /* calls interrupted by their budget */
+  int64_t time;
+} JSBudgetStats;
+
+/* location of a proxy trap in the handlers of shape 'shape'. The shape
+   is hashed and referenced by the cache, so it is never modified. */
+typedef struct JSProxyTrapCacheEntry {
+  JSShape* shape; /* NULL if the entry is not used */
+  /* if the trap is not an own property of the handler: hashed shape of
+     the prototype of the handler (which has no prototype), NULL if the
+     handler has no prototype */
+  JSShape* proto_shape;
+  int prop_index; /* index in the handler properties, -1 if no trap */
+} JSProxyTrapCacheEntry;
+
 struct JSContext {
   JSGCObjectHeader header; /* must come first */
   JSRuntime* rt;
@@ -347,6 +385,8 @@ struct JSContext {
   int binary_object_size;
 
   JSShape* array_shape; /* initial shape for Array objects */
+  JSProxyTrapCacheEntry proxy_trap_cache[JS_PROXY_TRAP_COUNT]
+                                        [JS_PROXY_TRAP_CACHE_SIZE];
 
   JSValue* class_proto;
   JSValue function_proto;
@@ -368,6 +408,7 @@ struct JSContext {
 
   /* when the counter reaches zero, JSRutime.interrupt_handler is called */
   int interrupt_counter;
+  JSBudgetStats budget_stats;
 
   struct list_head loaded_modules; /* list of JSModuleDef.link */
 
@@ -414,6 +455,8 @@ struct JSShape {
   JSShape* shape_hash_next; /* in JSRuntime.shape_hash[h] list */
   JSObject* proto;
   struct list_head* watchpoint;
+  /* enumeration of the string keys, only for hashed shapes */
+  struct JSShapeEnumCache* enum_cache;
   JSShapeProperty prop[0]; /* prop_size elements */
 };
 
@@ -0,0 +1,555 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "QuickJS/quickjs.h"
+#include "QuickJS/extension/taro_js_class.h"
+#include "QuickJS/extension/taro_js_runtime.h"
+#include "QuickJS/extension/taro_js_type.h"
+
+/* Bindings of C++ classes and functions generated at compile time.
+
+   The function list entries are constexpr and point to thunks specialized
+   for the signature of the bound member, so a table such as
+
+     static constexpr JSCFunctionListEntry point_funcs[] = {
+         taro_js_bind_method<&Point::norm>("norm"),
+         taro_js_bind_getset<&Point::x, &Point::set_x>("x"),
+         taro_js_bind_field<&Point::tag>("tag"),
+     };
+
+   is equivalent to the hand written JS_CFUNC_DEF/JS_CGETSET_DEF entries.
+   The arguments are converted by TaroJSArg<T>: the numbers are read
+   directly from the JSValue tag when possible, the strings are passed as
+   std::string_view or const char* without copy, a std::optional<T>
+   argument is empty when the JS argument is missing or undefined and a
+   JSValue argument is borrowed. A JSValue result is owned by the caller. */
+
+template <typename T, typename = void>
+struct TaroJSArg;
+
+/* class id of a bound class, allocated by taro_js_bind_class() */
+template <typename T>
+struct TaroJSClass {
+  static inline JSClassID class_id = 0;
+};
+
+template <>
+struct TaroJSArg<bool> {
+  using Storage = bool;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    if (js_likely(JS_VALUE_GET_TAG(v) == JS_TAG_BOOL)) {
+      s = JS_VALUE_GET_BOOL(v);
+      return 0;
+    }
+    s = JS_ToBool(ctx, v) > 0;
+    return 0;
+  }
+  static bool get(Storage& s) {
+    return s;
+  }
+  static JSValue to(JSContext* ctx, bool v) {
+    return JS_NewBool(ctx, v);
+  }
+};
+
+template <typename T>
+struct TaroJSArg<
+    T,
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+  static_assert(sizeof(T) <= 8, "unsupported integer type");
+  using Storage = T;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    if (js_likely(JS_VALUE_GET_TAG(v) == JS_TAG_INT)) {
+      s = (T)JS_VALUE_GET_INT(v);
+      return 0;
+    }
+    if constexpr (sizeof(T) <= 4) {
+      int32_t i;
+      if (JS_ToInt32(ctx, &i, v))
+        return -1;
+      s = (T)i;
+    } else {
+      int64_t i;
+      if (JS_ToInt64(ctx, &i, v))
+        return -1;
+      s = (T)i;
+    }
+    return 0;
+  }
+  static T get(Storage& s) {
+    return s;
+  }
+  static JSValue to(JSContext* ctx, T v) {
+    if constexpr (std::is_signed_v<T> && sizeof(T) <= 4)
+      return JS_NewInt32(ctx, v);
+    else if constexpr (sizeof(T) <= 4)
+      return JS_NewUint32(ctx, v);
+    else if constexpr (std::is_signed_v<T>)
+      return JS_NewInt64(ctx, v);
+    else
+      return JS_NewFloat64(ctx, (double)v);
+  }
+};
+
+template <typename T>
+struct TaroJSArg<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  using Storage = T;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    int tag = JS_VALUE_GET_TAG(v);
+    if (js_likely(JS_TAG_IS_FLOAT64(tag))) {
+      s = (T)JS_VALUE_GET_FLOAT64(v);
+      return 0;
+    }
+    if (tag == JS_TAG_INT) {
+      s = (T)JS_VALUE_GET_INT(v);
+      return 0;
+    }
+    double d;
+    if (JS_ToFloat64(ctx, &d, v))
+      return -1;
+    s = (T)d;
+    return 0;
+  }
+  static T get(Storage& s) {
+    return s;
+  }
+  static JSValue to(JSContext* ctx, T v) {
+    return JS_NewFloat64(ctx, v);
+  }
+};
+
+/* UTF-8 contents of a string argument. ASCII strings are not copied (see
+   JS_ToCStringLen2()), the reference is released after the call. */
+struct TaroJSStringStorage {
+  JSContext* ctx = nullptr;
+  const char* str = nullptr;
+  size_t len = 0;
+
+  TaroJSStringStorage() = default;
+  TaroJSStringStorage(const TaroJSStringStorage&) = delete;
+  TaroJSStringStorage& operator=(const TaroJSStringStorage&) = delete;
+  ~TaroJSStringStorage() {
+    if (str)
+      JS_FreeCString(ctx, str);
+  }
+
+  int from(JSContext* c, JSValueConst v) {
+    ctx = c;
+    str = JS_ToCStringLen(c, &len, v);
+    return str ? 0 : -1;
+  }
+};
+
+template <>
+struct TaroJSArg<std::string_view> {
+  using Storage = TaroJSStringStorage;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    return s.from(ctx, v);
+  }
+  static std::string_view get(Storage& s) {
+    return std::string_view(s.str, s.len);
+  }
+  static JSValue to(JSContext* ctx, std::string_view v) {
+    return JS_NewStringLen(ctx, v.data(), v.size());
+  }
+};
+
+template <>
+struct TaroJSArg<const char*> {
+  using Storage = TaroJSStringStorage;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    return s.from(ctx, v);
+  }
+  static const char* get(Storage& s) {
+    return s.str;
+  }
+  static JSValue to(JSContext* ctx, const char* v) {
+    if (!v)
+      return JS_NULL;
+    return JS_NewString(ctx, v);
+  }
+};
+
+template <>
+struct TaroJSArg<std::string> {
+  using Storage = TaroJSStringStorage;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    return s.from(ctx, v);
+  }
+  static std::string get(Storage& s) {
+    return std::string(s.str, s.len);
+  }
+  static JSValue to(JSContext* ctx, const std::string& v) {
+    return JS_NewStringLen(ctx, v.data(), v.size());
+  }
+};
+
+template <>
+struct TaroJSArg<JSValue> {
+  using Storage = JSValue;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    s = v;
+    return 0;
+  }
+  static JSValueConst get(Storage& s) {
+    return s;
+  }
+  static JSValue to(JSContext* ctx, JSValue v) {
+    return v;
+  }
+};
+
+template <typename T>
+struct TaroJSArg<std::optional<T>> {
+  using Storage = std::optional<typename TaroJSArg<T>::Storage>;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    if (taro_is_undefined(v))
+      return 0;
+    return TaroJSArg<T>::from(ctx, v, s.emplace());
+  }
+  static std::optional<T> get(Storage& s) {
+    if (!s)
+      return std::nullopt;
+    return TaroJSArg<T>::get(*s);
+  }
+  static JSValue to(JSContext* ctx, const std::optional<T>& v) {
+    if (!v)
+      return JS_UNDEFINED;
+    return TaroJSArg<T>::to(ctx, *v);
+  }
+};
+
+/* instance of a bound class, not owned */
+template <typename T>
+struct TaroJSArg<T*, std::enable_if_t<std::is_class_v<T>>> {
+  using Storage = T*;
+  static int from(JSContext* ctx, JSValueConst v, Storage& s) {
+    s = static_cast<T*>(
+        taro_js_get_opaque(ctx, v, TaroJSClass<std::remove_cv_t<T>>::class_id));
+    return s ? 0 : -1;
+  }
+  static T* get(Storage& s) {
+    return s;
+  }
+};
+
+template <typename T>
+using TaroJSArgOf = TaroJSArg<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename T>
+inline constexpr bool taro_js_bind_is_optional = false;
+
+template <typename T>
+inline constexpr bool taro_js_bind_is_optional<std::optional<T>> = true;
+
+/* conversion of the arguments and of the result of a native call */
+template <typename R, typename... Args>
+struct TaroJSSignature {
+  /* JS 'length': number of arguments before the first optional one */
+  static constexpr int length() {
+    int n = 0;
+    bool optional[] = {
+        taro_js_bind_is_optional<
+            std::remove_cv_t<std::remove_reference_t<Args>>>...,
+        true};
+    while (!optional[n])
+      n++;
+    return n;
+  }
+
+  template <typename F, size_t... I>
+  static JSValue invoke_impl(
+      JSContext* ctx,
+      int argc,
+      JSValueConst* argv,
+      F&& f,
+      std::index_sequence<I...>) {
+    std::tuple<typename TaroJSArgOf<Args>::Storage...> storage;
+    if (!((TaroJSArgOf<Args>::from(
+               ctx,
+               (int)I < argc ? argv[I] : JS_UNDEFINED,
+               std::get<I>(storage)) == 0) &&
+          ...))
+      return JS_EXCEPTION;
+    if constexpr (std::is_void_v<R>) {
+      f(TaroJSArgOf<Args>::get(std::get<I>(storage))...);
+      return JS_UNDEFINED;
+    } else {
+      return TaroJSArgOf<R>::to(
+          ctx, f(TaroJSArgOf<Args>::get(std::get<I>(storage))...));
+    }
+  }
+
+  template <typename F>
+  static JSValue
+  invoke(JSContext* ctx, int argc, JSValueConst* argv, F&& f) {
+    return invoke_impl(
+        ctx,
+        argc,
+        argv,
+        std::forward<F>(f),
+        std::index_sequence_for<Args...>{});
+  }
+};
+
+template <typename F>
+struct TaroJSFunctionTraits;
+
+template <typename R, typename... Args>
+struct TaroJSFunctionTraits<R (*)(Args...)> : TaroJSSignature<R, Args...> {};
+
+template <typename R, typename... Args>
+struct TaroJSFunctionTraits<R (*)(Args...) noexcept>
+    : TaroJSSignature<R, Args...> {};
+
+template <typename C, typename R, typename... Args>
+struct TaroJSFunctionTraits<R (C::*)(Args...)> : TaroJSSignature<R, Args...> {
+  using Class = C;
+};
+
+template <typename C, typename R, typename... Args>
+struct TaroJSFunctionTraits<R (C::*)(Args...) const>
+    : TaroJSSignature<R, Args...> {
+  using Class = C;
+};
+
+template <typename C, typename R, typename... Args>
+struct TaroJSFunctionTraits<R (C::*)(Args...) noexcept>
+    : TaroJSSignature<R, Args...> {
+  using Class = C;
+};
+
+template <typename C, typename R, typename... Args>
+struct TaroJSFunctionTraits<R (C::*)(Args...) const noexcept>
+    : TaroJSSignature<R, Args...> {
+  using Class = C;
+};
+
+template <typename C, typename T>
+struct TaroJSFunctionTraits<T C::*> {
+  using Class = C;
+  using Field = T;
+};
+
+template <auto Member>
+using TaroJSClassOf = typename TaroJSFunctionTraits<decltype(Member)>::Class;
+
+template <typename C>
+inline C* taro_js_bind_this(JSContext* ctx, JSValueConst this_val) {
+  return static_cast<C*>(
+      taro_js_get_opaque(ctx, this_val, TaroJSClass<C>::class_id));
+}
+
+template <auto Method>
+JSValue taro_js_bind_method_thunk(
+    JSContext* ctx,
+    JSValueConst this_val,
+    int argc,
+    JSValueConst* argv) {
+  using Traits = TaroJSFunctionTraits<decltype(Method)>;
+  auto* self = taro_js_bind_this<typename Traits::Class>(ctx, this_val);
+  if (!self)
+    return JS_EXCEPTION;
+  return Traits::invoke(ctx, argc, argv, [self](auto&&... args) {
+    return (self->*Method)(std::forward<decltype(args)>(args)...);
+  });
+}
+
+template <auto Func>
+JSValue taro_js_bind_function_thunk(
+    JSContext* ctx,
+    JSValueConst this_val,
+    int argc,
+    JSValueConst* argv) {
+  return TaroJSFunctionTraits<decltype(Func)>::invoke(
+      ctx, argc, argv, [](auto&&... args) {
+        return Func(std::forward<decltype(args)>(args)...);
+      });
+}
+
+template <auto Getter>
+JSValue taro_js_bind_getter_thunk(JSContext* ctx, JSValueConst this_val) {
+  using Traits = TaroJSFunctionTraits<decltype(Getter)>;
+  auto* self = taro_js_bind_this<typename Traits::Class>(ctx, this_val);
+  if (!self)
+    return JS_EXCEPTION;
+  if constexpr (std::is_member_object_pointer_v<decltype(Getter)>) {
+    return TaroJSArgOf<typename Traits::Field>::to(ctx, self->*Getter);
+  } else {
+    return Traits::invoke(
+        ctx, 0, nullptr, [self]() { return (self->*Getter)(); });
+  }
+}
+
+template <auto Setter>
+JSValue
+taro_js_bind_setter_thunk(JSContext* ctx, JSValueConst this_val, JSValueConst val) {
+  using Traits = TaroJSFunctionTraits<decltype(Setter)>;
+  auto* self = taro_js_bind_this<typename Traits::Class>(ctx, this_val);
+  if (!self)
+    return JS_EXCEPTION;
+  if constexpr (std::is_member_object_pointer_v<decltype(Setter)>) {
+    using Arg = TaroJSArgOf<typename Traits::Field>;
+    typename Arg::Storage s;
+    if (Arg::from(ctx, val, s))
+      return JS_EXCEPTION;
+    self->*Setter = Arg::get(s);
+    return JS_UNDEFINED;
+  } else {
+    JSValue ret = Traits::invoke(ctx, 1, &val, [self](auto&& arg) {
+      return (self->*Setter)(std::forward<decltype(arg)>(arg));
+    });
+    if (taro_is_exception(ret))
+      return ret;
+    JS_FreeValue(ctx, ret);
+    return JS_UNDEFINED;
+  }
+}
+
+/* function list entry calling the member function 'Method' of 'this' */
+template <auto Method>
+constexpr JSCFunctionListEntry taro_js_bind_method(const char* name) {
+  JSCFunctionListEntry e{};
+  e.name = name;
+  e.prop_flags = JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE;
+  e.def_type = JS_DEF_CFUNC;
+  e.u.func.length = TaroJSFunctionTraits<decltype(Method)>::length();
+  e.u.func.cproto = JS_CFUNC_generic;
+  e.u.func.cfunc.generic = taro_js_bind_method_thunk<Method>;
+  return e;
+}
+
+/* function list entry calling the static function 'Func', 'this' is
+   ignored */
+template <auto Func>
+constexpr JSCFunctionListEntry taro_js_bind_function(const char* name) {
+  JSCFunctionListEntry e{};
+  e.name = name;
+  e.prop_flags = JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE;
+  e.def_type = JS_DEF_CFUNC;
+  e.u.func.length = TaroJSFunctionTraits<decltype(Func)>::length();
+  e.u.func.cproto = JS_CFUNC_generic;
+  e.u.func.cfunc.generic = taro_js_bind_function_thunk<Func>;
+  return e;
+}
+
+/* accessor property, read-only if 'Setter' is nullptr. The getter and the
+   setter are member functions or a pointer to a data member. */
+template <auto Getter, auto Setter = nullptr>
+constexpr JSCFunctionListEntry taro_js_bind_getset(const char* name) {
+  JSCFunctionListEntry e{};
+  e.name = name;
+  e.prop_flags = JS_PROP_CONFIGURABLE;
+  e.def_type = JS_DEF_CGETSET;
+  e.u.getset.get.getter = taro_js_bind_getter_thunk<Getter>;
+  if constexpr (!std::is_null_pointer_v<decltype(Setter)>)
+    e.u.getset.set.setter = taro_js_bind_setter_thunk<Setter>;
+  return e;
+}
+
+/* read/write accessor property of the data member 'Field' */
+template <auto Field>
+constexpr JSCFunctionListEntry taro_js_bind_field(const char* name) {
+  return taro_js_bind_getset<Field, Field>(name);
+}
+
+/* Register T in the runtime of 'ctx' (once per runtime) and set its class
+   prototype in 'ctx' from 'tab'. The instances own their T, it is deleted
+   by the finalizer. Return -1 if exception. */
+template <typename T>
+int taro_js_bind_class(
+    JSContext* ctx,
+    const char* name,
+    const JSCFunctionListEntry* tab,
+    int len) {
+  JSRuntime* rt = JS_GetRuntime(ctx);
+  JSClassID class_id = taro_js_new_class_id(&TaroJSClass<T>::class_id);
+  if (!taro_js_is_registered_class(rt, class_id)) {
+    JSClassDef def = {
+        .class_name = name,
+        .finalizer =
+            [](JSRuntime* rt, JSValue val) {
+              delete static_cast<T*>(
+                  taro_js_get_opaque(val, TaroJSClass<T>::class_id));
+            },
+    };
+    if (taro_js_new_class(rt, class_id, &def) < 0)
+      return -1;
+  }
+  JSValue proto = JS_NewObject(ctx);
+  if (taro_is_exception(proto))
+    return -1;
+  taro_js_set_property_function_list(ctx, proto, tab, len);
+  taro_js_set_class_proto(ctx, class_id, proto);
+  return 0;
+}
+
+/* wrap 'obj' in a new instance of its bound class, the instance takes the
+   ownership of 'obj' */
+template <typename T>
+JSValue taro_js_bind_new_object(JSContext* ctx, T* obj) {
+  JSValue val = taro_js_new_object_class(ctx, TaroJSClass<T>::class_id);
+  if (taro_is_exception(val)) {
+    delete obj;
+    return val;
+  }
+  taro_js_set_opaque(val, obj);
+  return val;
+}
+
+template <typename T, typename... Args>
+JSValue taro_js_bind_constructor_thunk(
+    JSContext* ctx,
+    JSValueConst new_target,
+    int argc,
+    JSValueConst* argv) {
+  JSValue proto = JS_GetPropertyStr(ctx, new_target, "prototype");
+  if (taro_is_exception(proto))
+    return proto;
+  JSValue val =
+      taro_js_new_object_class_proto(ctx, TaroJSClass<T>::class_id, proto);
+  JS_FreeValue(ctx, proto);
+  if (taro_is_exception(val))
+    return val;
+  JSValue ret = TaroJSSignature<void, Args...>::invoke(
+      ctx, argc, argv, [val](auto&&... args) {
+        taro_js_set_opaque(val, new T(std::forward<decltype(args)>(args)...));
+      });
+  if (taro_is_exception(ret)) {
+    JS_FreeValue(ctx, val);
+    return ret;
+  }
+  return val;
+}
+
+/* Constructor of the bound class T (see taro_js_bind_class()) calling
+   T(Args...). Its 'prototype' is the class prototype of 'ctx'. */
+template <typename T, typename... Args>
+JSValue taro_js_bind_constructor(JSContext* ctx, const char* name) {
+  JSValue ctor = JS_NewCFunction2(
+      ctx,
+      taro_js_bind_constructor_thunk<T, Args...>,
+      name,
+      TaroJSSignature<void, Args...>::length(),
+      JS_CFUNC_constructor,
+      0);
+  if (taro_is_exception(ctor))
+    return ctor;
+  JSValue proto = taro_js_get_class_proto(ctx, TaroJSClass<T>::class_id);
+  JS_SetConstructor(ctx, ctor, proto);
+  JS_FreeValue(ctx, proto);
+  return ctor;
+}
+
+#endif // __cplusplus
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+/* Call 'fn' and interrupt it with an uncatchable "interrupted"
+   InternalError once 'budget_ns' nanoseconds of monotonic time have
+   elapsed. The clock is checked each time the interrupt counter of the
+   context expires, in loops, calls and RegExp execution. A call made
+   while another budget is running cannot outlive the enclosing budget.
+   The time of the call is added to the budget stats of 'ctx'. */
+JSValue taro_js_run_with_budget(
+    JSContext* ctx,
+    JSValueConst fn,
+    int64_t budget_ns,
+    JSValueConst this_obj,
+    int argc,
+    JSValueConst* argv);
+
+JSValue
+taro_js_run_with_budget(JSContext* ctx, JSValueConst fn, int64_t budget_ns);
+
+/* Time consumed by the budgeted calls of 'ctx'. The time of nested calls
+   is counted by each enclosing call. */
+JSBudgetStats taro_js_get_budget_stats(JSContext* ctx);
+
+void taro_js_reset_budget_stats(JSContext* ctx);
+
+#endif // __cplusplus
@@ -11,6 +11,7 @@ int taro_js_new_class(
     JSRuntime* rt,
     JSClassID class_id,
     const JSClassDef* class_def);
+bool taro_js_is_registered_class(JSRuntime* rt, JSClassID class_id);
 JSValue taro_js_new_object_class_proto(
     JSContext* ctx,
     JSClassID class_id,
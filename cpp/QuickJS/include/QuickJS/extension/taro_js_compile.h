@@ -0,0 +1,39 @@
+#pragma once
+
+#include "QuickJS/common.h"
+#include "QuickJS/quickjs.h"
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TaroJSCompileSource {
+  std::string source;
+  std::string filename;
+};
+
+struct TaroJSCompileResult {
+  /* JS_WriteObject(JS_WRITE_OBJ_BYTECODE) output, empty on failure */
+  std::vector<uint8_t> bytecode;
+  /* compile error message and stack, empty on success */
+  std::string error;
+};
+
+/* Compile 'sources' on a pool of 'thread_count' worker threads (0 = one per
+   hardware thread). Every worker owns a compile-only JSRuntime, imports are
+   resolved to empty stub modules. 'results' receives one entry per source,
+   in order. If 'bundle' is not NULL, the compiled modules are merged into a
+   single JS_WriteObject array (one shared atom table) readable with
+   JS_ReadObject(JS_READ_OBJ_BYTECODE).
+   Return the number of sources that failed to compile, or -1 if the bundle
+   could not be written. */
+int taro_js_compile_batch(
+    const std::vector<TaroJSCompileSource>& sources,
+    std::vector<TaroJSCompileResult>& results,
+    std::vector<uint8_t>* bundle = nullptr,
+    int eval_flags = JS_EVAL_TYPE_MODULE,
+    int thread_count = 0);
+
+#endif // __cplusplus
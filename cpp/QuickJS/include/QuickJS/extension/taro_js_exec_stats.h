@@ -0,0 +1,36 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+#include <string>
+
+/* Reset the execution counters of 'rt' and start counting: calls, taken
+   loop back edges and self time of each bytecode function, hits and
+   misses of its inline caches, and the executed opcodes.
+   Return -1 if the engine was built without the ENABLE_EXEC_STATS CMake
+   option. */
+int taro_js_exec_stats_start(JSRuntime* rt);
+
+/* Stop counting. The counters are kept until the next start. */
+void taro_js_exec_stats_stop(JSRuntime* rt);
+
+bool taro_js_exec_stats_is_running(JSRuntime* rt);
+
+/* Write the counters of the live functions as JSON:
+
+     {"functions":[{"name":"f","file":"a.js","line":1,"column":1,
+                    "calls":10,"back_edges":100,"self_time_ns":5000,
+                    "ic":[{"property":"x","hits":90,"misses":10}]}, ...],
+      "opcodes":{"get_loc":1000, ...}}
+
+   The functions are sorted by decreasing self time, the ones which did
+   not run are omitted. Return -1 if the engine was built without
+   ENABLE_EXEC_STATS. */
+int taro_js_exec_stats_write(JSRuntime* rt, std::string& out);
+
+/* Same as taro_js_exec_stats_write() to 'filename' */
+int taro_js_exec_stats_dump(JSRuntime* rt, const char* filename);
+
+#endif // __cplusplus
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+
+/* Start sampling the allocations of 'rt': the allocation that crosses each
+   'interval' bytes allocated through js_malloc_rt() records the current JS
+   stack. The sampled blocks are tracked until they are freed.
+   Return -1 if a heap profile is already running on 'rt'. */
+int taro_js_heap_profile_start(JSRuntime* rt, size_t interval = 512 * 1024);
+
+/* Stop sampling and drop the recorded allocations. */
+void taro_js_heap_profile_stop(JSRuntime* rt);
+
+bool taro_js_heap_profile_is_running(JSRuntime* rt);
+
+/* Write the live sampled allocations grouped by JS stack as a pprof
+   profile (uncompressed profile.proto, "inuse_objects" and "inuse_space"
+   sample values scaled by the sampling interval).
+   Return -1 if no heap profile is running. */
+int taro_js_heap_profile_write(JSRuntime* rt, std::vector<uint8_t>& out);
+
+/* Same as taro_js_heap_profile_write() to 'filename' */
+int taro_js_heap_profile_dump(JSRuntime* rt, const char* filename);
+
+#endif // __cplusplus
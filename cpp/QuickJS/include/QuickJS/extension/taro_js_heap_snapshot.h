@@ -0,0 +1,18 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+/* Run the GC and write the object graph of 'rt' to 'fd' in the Chrome
+   DevTools .heapsnapshot JSON format. The nodes are the GC objects and the
+   strings they reference, the edges are named after the properties, the
+   array indexes and the closure variables. The JSON is streamed through a
+   fixed size buffer, only the node table and the names are kept in memory.
+   Return -1 on write error. */
+int taro_js_heap_snapshot_write(JSRuntime* rt, int fd);
+
+/* Same as taro_js_heap_snapshot_write() to 'filename' */
+int taro_js_heap_snapshot_dump(JSRuntime* rt, const char* filename);
+
+#endif // __cplusplus
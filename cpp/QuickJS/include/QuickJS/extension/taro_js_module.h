@@ -58,4 +58,9 @@ int taro_js_set_function_bytecode_name(
 void taro_js_free_module_def(JSContext* ctx, JSModuleDef* m);
 void taro_js_free_module_def(JSRuntime* rt, JSModuleDef* m);
 
+/* Remove the module from the context module list and release the list
+   reference, e.g. after a compile-only eval so that a long-lived context
+   does not accumulate compiled modules. */
+void taro_js_unload_module(JSContext* ctx, JSModuleDef* m);
+
 #endif
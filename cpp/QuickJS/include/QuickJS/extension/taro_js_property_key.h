@@ -0,0 +1,52 @@
+#pragma once
+
+#include "QuickJS/common.h"
+
+#ifdef __cplusplus
+
+/* Property key interned once: the atom is kept until
+   taro_js_property_key_free() so it can be passed to JS_GetProperty() and
+   JS_SetProperty() without interning the name at each call. */
+typedef JSAtom taro_js_property_key;
+
+taro_js_property_key taro_js_property_key_new(JSContext* ctx, const char* name);
+
+void taro_js_property_key_free(JSContext* ctx, taro_js_property_key key);
+
+/* Keys read or written together by taro_js_get_properties() and
+   taro_js_set_properties(). The set remembers where its keys are stored in
+   the last shapes seen, so the objects sharing a shape (same literal or
+   same constructor) are accessed without any property lookup. The set must
+   be freed before its context. */
+struct TaroJSPropertyKeySet;
+
+TaroJSPropertyKeySet*
+taro_js_property_key_set_new(JSContext* ctx, const char* const* names, int count);
+
+TaroJSPropertyKeySet* taro_js_property_key_set_new(
+    JSContext* ctx,
+    const taro_js_property_key* keys,
+    int count);
+
+void taro_js_property_key_set_free(JSContext* ctx, TaroJSPropertyKeySet* set);
+
+int taro_js_property_key_set_size(const TaroJSPropertyKeySet* set);
+
+/* values[i] = obj[key i] for each key of 'set'. Return -1 if exception,
+   the values are then all JS_UNDEFINED. */
+int taro_js_get_properties(
+    JSContext* ctx,
+    JSValueConst obj,
+    TaroJSPropertyKeySet* set,
+    JSValue* values);
+
+/* obj[key i] = values[i] for each key of 'set' as JS_SetProperty(), in
+   order. The values are freed and set to JS_UNDEFINED, even
+   if an exception occurs. Return -1 if exception. */
+int taro_js_set_properties(
+    JSContext* ctx,
+    JSValueConst obj,
+    TaroJSPropertyKeySet* set,
+    JSValue* values);
+
+#endif // __cplusplus
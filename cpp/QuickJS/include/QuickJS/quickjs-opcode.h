@@ -369,6 +369,10 @@ DEF(get_field_ic, 5, 1, 1, none)
 DEF(get_field2_ic, 5, 1, 2, none)
 DEF(put_field_ic, 5, 2, 0, none)
 DEF(debugger, 1, 0, 0, none)
+/* get_loc(n)/get_arg(n) get_field(atom): the u8 is the local variable
+   index, or 0x80 | the argument index */
+DEF(get_loc_field, 6, 0, 1, atom_u8)
+DEF(get_loc_field_ic, 6, 0, 1, none)
 
 #undef DEF
 #undef def
@@ -224,6 +224,7 @@ typedef struct JSMemoryUsage {
   int64_t c_func_count, array_count;
   int64_t fast_array_count, fast_array_elements;
   int64_t binary_object_count, binary_object_size;
+  int64_t str_dedup_count, str_dedup_size; /* see JS_SetStringDedup() */
 } JSMemoryUsage;
 
 void JS_ComputeMemoryUsage(JSRuntime* rt, JSMemoryUsage* s);
@@ -775,6 +776,34 @@ void JS_SetCanBlock(JSRuntime* rt, JS_BOOL can_block);
 void JS_SetStripInfo(JSRuntime *rt, int flags);
 int JS_GetStripInfo(JSRuntime *rt);
 
+/* compiler statistics, the times are in nanoseconds */
+typedef struct JSCompileStats {
+  int64_t eval_count; /* number of compiled sources */
+  int64_t source_size; /* total size of the compiled sources */
+  int64_t function_count;
+  int64_t parse_time;
+  int64_t compile_time; /* total time of the bytecode generation */
+  int64_t resolve_variables_time; /* part of compile_time */
+  int64_t resolve_labels_time; /* part of compile_time */
+  int64_t stack_size_time; /* part of compile_time */
+  int64_t arena_max_size; /* peak size of the compiler arena */
+} JSCompileStats;
+/* accumulate the statistics of the following compilations in 's'. Use
+   NULL to stop. */
+void JS_SetCompileStats(JSRuntime* rt, JSCompileStats* s);
+
+#define JS_JIT_DEFAULT_THRESHOLD 1000
+/* compile a function to native code after 'threshold' calls and loop
+   iterations. 0 (default) disables the JIT. Return FALSE if the JIT is not
+   available (see the ENABLE_JIT CMake option). */
+JS_BOOL JS_SetJITThreshold(JSRuntime* rt, int threshold);
+
+/* after each JS_RunGC(), merge the identical strings of at most 'max_len'
+   characters held by object properties and fast arrays. 0 (default)
+   disables the pass. The merged strings are reported by
+   JS_ComputeMemoryUsage(). */
+void JS_SetStringDedup(JSRuntime* rt, uint32_t max_len);
+
 /* set the [IsHTMLDDA] internal slot */
 void JS_SetIsHTMLDDA(JSContext* ctx, JSValueConst obj);
 
@@ -292,6 +292,8 @@ void help(void) {
       "-d  --dump         dump the memory usage stats\n"
       "    --memory-limit n  limit the memory usage to 'n' bytes (SI suffixes allowed)\n"
       "    --stack-size n    limit the stack size to 'n' bytes (SI suffixes allowed)\n"
+      "    --jit             compile the hot functions to native code\n"
+      "    --jit-threshold n compile the functions after 'n' calls or loop iterations\n"
       "    --no-unhandled-rejection  ignore unhandled promise rejections\n"
       "-s                    strip all the debug info\n"
       "    --strip-source    strip the source code\n"
@@ -317,6 +319,7 @@ int main(int argc, char** argv) {
   int i, include_count = 0;
   int strip_flags = 0;
   size_t stack_size = 0;
+  int jit_threshold = 0;
 
   /* cannot use getopt because we want to pass the command line to
      the script */
@@ -415,6 +418,18 @@ int main(int argc, char** argv) {
         stack_size = get_suffixed_size(argv[optind++]);
         continue;
       }
+      if (!strcmp(longopt, "jit")) {
+        jit_threshold = JS_JIT_DEFAULT_THRESHOLD;
+        continue;
+      }
+      if (!strcmp(longopt, "jit-threshold")) {
+        if (optind >= argc) {
+          fprintf(stderr, "expecting JIT threshold");
+          exit(1);
+        }
+        jit_threshold = atoi(argv[optind++]);
+        continue;
+      }
       if (opt == 's') {
         strip_flags = JS_STRIP_DEBUG;
         continue;
@@ -446,6 +461,8 @@ int main(int argc, char** argv) {
     JS_SetMemoryLimit(rt, memory_limit);
   if (stack_size != 0)
     JS_SetMaxStackSize(rt, stack_size);
+  if (jit_threshold != 0 && !JS_SetJITThreshold(rt, jit_threshold))
+    fprintf(stderr, "qjs: JIT not available in this build\n");
   JS_SetStripInfo(rt, strip_flags);
   js_std_set_worker_new_context_func(JS_NewCustomContext);
   js_std_init_handlers(rt);
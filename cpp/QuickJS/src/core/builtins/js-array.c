@@ -1188,7 +1188,7 @@ JSValue js_array_join(
       goto exception;
     p = JS_VALUE_GET_STRING(sep);
     if (p->len == 1 && !p->is_wide_char)
-      c = p->u.str8[0];
+      c = js_string_str8(p)[0];
     else
       c = -1;
   }
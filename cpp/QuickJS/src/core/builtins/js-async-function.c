@@ -35,6 +35,16 @@
 
 /* AsyncFunction */
 
+/* index of the frame pool bucket for 'len' values or -1 if too large */
+static int async_frame_bucket(int len) {
+  int bucket = 0;
+  while ((JS_ASYNC_FRAME_POOL_MIN << bucket) < len) {
+    if (++bucket >= JS_ASYNC_FRAME_POOL_BUCKETS)
+      return -1;
+  }
+  return bucket;
+}
+
 /* JSAsyncFunctionState (used by generator and async functions) */
 JSAsyncFunctionState* async_func_init(
     JSContext* ctx,
@@ -42,31 +52,56 @@ JSAsyncFunctionState* async_func_init(
     JSValueConst this_obj,
     int argc,
     JSValueConst* argv) {
+  JSRuntime* rt = ctx->rt;
   JSAsyncFunctionState* s;
   JSObject* p;
   JSFunctionBytecode* b;
   JSStackFrame* sf;
-  int local_count, i, arg_buf_len, n;
+  JSValue* arg_buf;
+  int local_count, i, arg_buf_len, n, bucket;
 
-  s = js_mallocz(ctx, sizeof(*s));
-  if (!s)
-    return NULL;
+  p = JS_VALUE_GET_OBJ(func_obj);
+  b = p->u.func.function_bytecode;
+  arg_buf_len = max_int(b->arg_count, argc);
+  local_count = max_int(arg_buf_len + b->var_count + b->stack_size, 1);
+
+  /* the frame and the state are recycled through the runtime pools: most
+     generators and async calls are short lived */
+  bucket = async_frame_bucket(local_count);
+  if (bucket >= 0 && rt->async_frame_pool[bucket]) {
+    arg_buf = rt->async_frame_pool[bucket];
+    rt->async_frame_pool[bucket] = *(void**)arg_buf;
+    rt->async_frame_pool_count[bucket]--;
+  } else {
+    if (bucket >= 0)
+      local_count = JS_ASYNC_FRAME_POOL_MIN << bucket;
+    arg_buf = js_malloc(ctx, sizeof(JSValue) * local_count);
+    if (!arg_buf)
+      return NULL;
+  }
+  if (rt->async_state_pool) {
+    s = rt->async_state_pool;
+    rt->async_state_pool = *(void**)s;
+    rt->async_state_pool_count--;
+    memset(s, 0, sizeof(*s));
+  } else {
+    s = js_mallocz(ctx, sizeof(*s));
+    if (!s) {
+      async_func_free_buf(rt, arg_buf, bucket);
+      return NULL;
+    }
+  }
   s->header.ref_count = 1;
-  add_gc_object(ctx->rt, &s->header, JS_GC_OBJ_TYPE_ASYNC_FUNCTION);
+  add_gc_object(rt, &s->header, JS_GC_OBJ_TYPE_ASYNC_FUNCTION);
 
   sf = &s->frame;
   init_list_head(&sf->var_ref_list);
-  p = JS_VALUE_GET_OBJ(func_obj);
-  b = p->u.func.function_bytecode;
+  sf->const_var_refs = NULL;
+  sf->const_var_ref_count = 0;
   sf->js_mode = b->js_mode | JS_MODE_ASYNC;
   sf->cur_pc = b->byte_code_buf;
-  arg_buf_len = max_int(b->arg_count, argc);
-  local_count = arg_buf_len + b->var_count + b->stack_size;
-  sf->arg_buf = js_malloc(ctx, sizeof(JSValue) * max_int(local_count, 1));
-  if (!sf->arg_buf) {
-    js_free(ctx, s);
-    return NULL;
-  }
+  sf->arg_buf = arg_buf;
+  s->frame_bucket = bucket;
   sf->cur_func = JS_DupValue(ctx, func_obj);
   s->this_val = JS_DupValue(ctx, this_obj);
   s->argc = argc;
@@ -84,6 +119,47 @@ JSAsyncFunctionState* async_func_init(
   return s;
 }
 
+void async_func_free_buf(JSRuntime* rt, JSValue* arg_buf, int bucket) {
+  if (bucket >= 0 &&
+      rt->async_frame_pool_count[bucket] < JS_ASYNC_FRAME_POOL_MAX) {
+    *(void**)arg_buf = rt->async_frame_pool[bucket];
+    rt->async_frame_pool[bucket] = arg_buf;
+    rt->async_frame_pool_count[bucket]++;
+  } else {
+    js_free_rt(rt, arg_buf);
+  }
+}
+
+void async_func_free_state(JSRuntime* rt, JSAsyncFunctionState* s) {
+  if (rt->async_state_pool_count < JS_ASYNC_FRAME_POOL_MAX) {
+    *(void**)s = rt->async_state_pool;
+    rt->async_state_pool = s;
+    rt->async_state_pool_count++;
+  } else {
+    js_free_rt(rt, s);
+  }
+}
+
+void async_func_pool_free(JSRuntime* rt) {
+  void *p, *next;
+  int i;
+
+  for (p = rt->async_state_pool; p; p = next) {
+    next = *(void**)p;
+    js_free_rt(rt, p);
+  }
+  rt->async_state_pool = NULL;
+  rt->async_state_pool_count = 0;
+  for (i = 0; i < JS_ASYNC_FRAME_POOL_BUCKETS; i++) {
+    for (p = rt->async_frame_pool[i]; p; p = next) {
+      next = *(void**)p;
+      js_free_rt(rt, p);
+    }
+    rt->async_frame_pool[i] = NULL;
+    rt->async_frame_pool_count[i] = 0;
+  }
+}
+
 void async_func_free(JSRuntime* rt, JSAsyncFunctionState* s) {
   if (--s->header.ref_count == 0) {
     if (rt->gc_phase != JS_GC_PHASE_REMOVE_CYCLES) {
@@ -38,6 +38,9 @@ JSAsyncFunctionState* async_func_init(
     int argc,
     JSValueConst* argv);
 void async_func_free(JSRuntime* rt, JSAsyncFunctionState* s);
+void async_func_free_buf(JSRuntime* rt, JSValue* arg_buf, int bucket);
+void async_func_free_state(JSRuntime* rt, JSAsyncFunctionState* s);
+void async_func_pool_free(JSRuntime* rt);
 
 void js_async_function_terminate(JSRuntime* rt, JSAsyncFunctionData* s);
 void js_async_function_free0(JSRuntime* rt, JSAsyncFunctionData* s);
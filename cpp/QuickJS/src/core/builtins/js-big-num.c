@@ -1645,6 +1645,200 @@ static js_limb_t mp_shr(
   return l & (((js_limb_t)1 << shift) - 1);
 }
 
+/* Karatsuba multiplication is used when both operands have at least
+   MP_MUL_KARATSUBA_THRESHOLD limbs, the recursive division when the
+   divisor and the quotient have at least MP_DIV_DC_THRESHOLD limbs and the
+   divide and conquer radix conversions above MP_RADIX_DC_THRESHOLD limbs.
+   The thresholds were tuned with the bigint benchmarks of microbench.js. */
+#define MP_MUL_KARATSUBA_THRESHOLD 32
+#define MP_DIV_DC_THRESHOLD 48
+#define MP_RADIX_DC_THRESHOLD 80
+
+/* tabr[0..n-1] += taba[0..na-1] with na <= n. Return the carry */
+static js_limb_t
+mp_add_in(js_limb_t* tabr, int n, const js_limb_t* taba, int na) {
+  js_limb_t carry;
+  int i;
+
+  carry = mp_add(tabr, tabr, taba, na, 0);
+  for (i = na; i < n && carry != 0; i++) {
+    tabr[i]++;
+    carry = (tabr[i] == 0);
+  }
+  return carry;
+}
+
+/* tabr[0..n-1] -= taba[0..na-1] with na <= n. Return the borrow */
+static js_limb_t
+mp_sub_in(js_limb_t* tabr, int n, const js_limb_t* taba, int na) {
+  js_limb_t borrow;
+  int i;
+
+  borrow = mp_sub(tabr, tabr, taba, na, 0);
+  for (i = na; i < n && borrow != 0; i++) {
+    borrow = (tabr[i] == 0);
+    tabr[i]--;
+  }
+  return borrow;
+}
+
+static int mp_cmp(const js_limb_t* taba, const js_limb_t* tabb, int n) {
+  int i;
+  for (i = n - 1; i >= 0; i--) {
+    if (taba[i] != tabb[i])
+      return taba[i] < tabb[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+/* number of temporary limbs needed by mp_mul() for operands of at most n
+   limbs */
+static int mp_mul_scratch_size(int n) {
+  int size = 0;
+  while (n >= MP_MUL_KARATSUBA_THRESHOLD) {
+    n = (n + 1) / 2 + 1;
+    size += 4 * n;
+  }
+  return size;
+}
+
+/* result[0..na+nb-1] = op1 * op2. 'tmp' must have
+   mp_mul_scratch_size(max(na, nb)) limbs. */
+static void mp_mul(
+    js_limb_t* result,
+    const js_limb_t* op1,
+    int na,
+    const js_limb_t* op2,
+    int nb,
+    js_limb_t* tmp) {
+  js_limb_t *sa, *sb, *t;
+  int m, i, len;
+
+  if (na < nb) {
+    const js_limb_t* op = op1;
+    op1 = op2;
+    op2 = op;
+    m = na;
+    na = nb;
+    nb = m;
+  }
+  if (nb < MP_MUL_KARATSUBA_THRESHOLD) {
+    mp_mul_basecase(result, op1, na, op2, nb);
+    return;
+  }
+  m = (na + 1) / 2;
+  if (nb <= m) {
+    /* unbalanced operands: multiply 'op2' by slices of 'op1' */
+    memset(result, 0, (na + nb) * sizeof(result[0]));
+    for (i = 0; i < na; i += nb) {
+      len = min_int(nb, na - i);
+      mp_mul(tmp, op1 + i, len, op2, nb, tmp + len + nb);
+      mp_add_in(result + i, na + nb - i, tmp, len + nb);
+    }
+    return;
+  }
+  /* op1 = a1 * B^m + a0, op2 = b1 * B^m + b0:
+     op1 * op2 = a1 * b1 * B^2m + a0 * b0 +
+                 ((a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1) * B^m */
+  sa = tmp;
+  sb = sa + m + 1;
+  t = sb + m + 1;
+  mp_mul(result, op1, m, op2, m, t);
+  mp_mul(result + 2 * m, op1 + m, na - m, op2 + m, nb - m, t);
+  memcpy(sa, op1, m * sizeof(sa[0]));
+  sa[m] = mp_add_in(sa, m, op1 + m, na - m);
+  memcpy(sb, op2, m * sizeof(sb[0]));
+  sb[m] = mp_add_in(sb, m, op2 + m, nb - m);
+  mp_mul(t, sa, m + 1, sb, m + 1, t + 2 * (m + 1));
+  mp_sub_in(t, 2 * m + 2, result, 2 * m);
+  mp_sub_in(t, 2 * m + 2, result + 2 * m, na + nb - 2 * m);
+  /* the high limbs of 't' which do not fit are zero */
+  mp_add_in(result + m, na + nb - m, t, min_int(2 * m + 2, na + nb - m));
+}
+
+static int mp_div_scratch_size(int n) {
+  return n + mp_mul_scratch_size(n);
+}
+
+/* recursive division of taba[0..n+k-1] by tabb[0..n-1] with k <= n and
+   tabb normalized as in mp_divnorm(). The quotient is stored in
+   tabq[0..k-1] and its high limb (0 or 1) is returned. taba[0..n-1]
+   contains the remainder. 'tmp' must have mp_div_scratch_size(n) limbs.
+   The quotient of the high limbs is corrected with the product of the
+   quotient by the low limbs of the divisor (Burnikel-Ziegler). */
+static js_limb_t mp_divnorm_rec(
+    js_limb_t* tabq,
+    js_limb_t* taba,
+    const js_limb_t* tabb,
+    int n,
+    int k,
+    js_limb_t* tmp) {
+  static const js_limb_t one = 1;
+  js_limb_t qh, c, save;
+  int lo, hi;
+
+  if (k < MP_DIV_DC_THRESHOLD) {
+    /* mp_divnorm() stores the high limb in tabq[k] */
+    save = tabq[k];
+    mp_divnorm(tabq, taba, n + k, tabb, n);
+    qh = tabq[k];
+    tabq[k] = save;
+    return qh;
+  }
+  if (k == n) {
+    lo = n / 2;
+    hi = n - lo;
+    qh = mp_divnorm_rec(tabq + lo, taba + lo, tabb, n, hi, tmp);
+    /* the remainder is < tabb so the high limb is zero */
+    mp_divnorm_rec(tabq, taba, tabb, n, lo, tmp);
+    return qh;
+  }
+  qh = mp_divnorm_rec(tabq, taba + n - k, tabb + n - k, k, k, tmp);
+  mp_mul(tmp, tabq, k, tabb, n - k, tmp + n);
+  c = mp_sub(taba, taba, tmp, n, 0);
+  if (qh != 0)
+    c += mp_sub(taba + k, taba + k, tabb, n - k, 0);
+  while (c != 0) {
+    qh -= mp_sub_in(tabq, k, &one, 1);
+    c -= mp_add(taba, taba, tabb, n, 0);
+  }
+  return qh;
+}
+
+/* same as mp_divnorm() but use the recursive division for large
+   operands. tabq must have na - nb + 2 limbs. Return -1 if memory
+   error. */
+static int mp_divnorm_large(
+    JSContext* ctx,
+    js_limb_t* tabq,
+    js_limb_t* taba,
+    int na,
+    const js_limb_t* tabb,
+    int nb) {
+  js_limb_t* tmp;
+  int n, i, k;
+
+  n = na - nb;
+  if (nb < MP_DIV_DC_THRESHOLD || n < MP_DIV_DC_THRESHOLD) {
+    mp_divnorm(tabq, taba, na, tabb, nb);
+    return 0;
+  }
+  tmp = js_malloc(ctx, mp_div_scratch_size(nb) * sizeof(tmp[0]));
+  if (!tmp)
+    return -1;
+  /* the high limb of the quotient is 0 or 1 */
+  tabq[n] = mp_cmp(taba + n, tabb, nb) >= 0;
+  if (tabq[n])
+    mp_sub(taba + n, taba + n, tabb, nb, 0);
+  /* divide by blocks of at most nb quotient limbs */
+  for (i = n; i > 0; i -= k) {
+    k = min_int(i, nb);
+    mp_divnorm_rec(tabq + i - k, taba + i - k, tabb, nb, k, tmp);
+  }
+  js_free(ctx, tmp);
+  return 0;
+}
+
 JSBigInt* js_bigint_new(JSContext* ctx, int len) {
   JSBigInt* r;
   if (len > JS_BIGINT_MAX_SIZE) {
@@ -1906,7 +2100,20 @@ JSBigInt* js_bigint_mul(JSContext* ctx, const JSBigInt* a, const JSBigInt* b) {
   r = js_bigint_new(ctx, a->len + b->len);
   if (!r)
     return NULL;
-  mp_mul_basecase(r->tab, a->tab, a->len, b->tab, b->len);
+  if (min_int(a->len, b->len) < MP_MUL_KARATSUBA_THRESHOLD) {
+    mp_mul_basecase(r->tab, a->tab, a->len, b->tab, b->len);
+  } else {
+    js_limb_t* tmp;
+    tmp = js_malloc(
+        ctx,
+        mp_mul_scratch_size(max_int(a->len, b->len)) * sizeof(tmp[0]));
+    if (!tmp) {
+      js_free(ctx, r);
+      return NULL;
+    }
+    mp_mul(r->tab, a->tab, a->len, b->tab, b->len, tmp);
+    js_free(ctx, tmp);
+  }
   /* correct the result if negative operands (no overflow is
      possible) */
   if (js_bigint_sign(a))
@@ -1998,7 +2205,12 @@ JSBigInt* js_bigint_divrem(
 
   //    js_bigint_dump1(ctx, "a", r->tab, na);
   //    js_bigint_dump1(ctx, "b", tabb, nb);
-  mp_divnorm(q->tab, r->tab, na, tabb, nb);
+  if (mp_divnorm_large(ctx, q->tab, r->tab, na, tabb, nb)) {
+    js_free(ctx, q);
+    js_free(ctx, r);
+    js_free(ctx, tabb);
+    return NULL;
+  }
   js_free(ctx, tabb);
 
   if (is_rem) {
@@ -2478,6 +2690,141 @@ static const js_limb_t js_pow_dec[JS_LIMB_DIGITS + 1] = {
 #endif
 };
 
+/* powers radix_base^(2^i) used by the divide and conquer radix
+   conversions */
+#define MP_RADIX_POW_MAX 32
+
+typedef struct {
+  js_limb_t* tab;
+  js_limb_t* norm; /* tab << shift for mp_divnorm_large() */
+  int len;
+  int shift;
+} JSRadixPow;
+
+static void mp_radix_pow_free(JSContext* ctx, JSRadixPow* pows, int count) {
+  int i;
+  for (i = 0; i < count; i++)
+    js_free(ctx, pows[i].tab);
+}
+
+/* compute the powers of 'radix_base' up to about 'n' limbs. Return their
+   count or -1 if memory error. */
+static int mp_radix_pow_init(
+    JSContext* ctx,
+    JSRadixPow* pows,
+    js_limb_t radix_base,
+    int n) {
+  JSRadixPow* pw;
+  js_limb_t *buf, *tmp;
+  int count, len;
+
+  buf = js_malloc(ctx, 2 * sizeof(buf[0]));
+  if (!buf)
+    return -1;
+  buf[0] = radix_base;
+  len = 1;
+  count = 0;
+  for (;;) {
+    pw = &pows[count++];
+    pw->tab = buf;
+    pw->norm = buf + len;
+    pw->len = len;
+    pw->shift = js_limb_clz(buf[len - 1]);
+    if (pw->shift != 0)
+      mp_shl(pw->norm, pw->tab, len, pw->shift);
+    else
+      memcpy(pw->norm, pw->tab, len * sizeof(buf[0]));
+    if (2 * len > n || count == MP_RADIX_POW_MAX)
+      break;
+    buf = js_malloc(ctx, 4 * len * sizeof(buf[0]));
+    tmp = js_malloc(ctx, mp_mul_scratch_size(len) * sizeof(tmp[0]) + 1);
+    if (!buf || !tmp) {
+      js_free(ctx, buf);
+      js_free(ctx, tmp);
+      mp_radix_pow_free(ctx, pows, count);
+      return -1;
+    }
+    mp_mul(buf, pw->tab, len, pw->tab, len, tmp);
+    js_free(ctx, tmp);
+    len *= 2;
+    while (buf[len - 1] == 0)
+      len--;
+  }
+  return count;
+}
+
+/* number of limbs sufficient to hold a number of 'n_digits' decimal
+   digits */
+static int mp_dec_limbs(int n_digits) {
+  return (int)(((int64_t)n_digits * 27 / 8) / JS_LIMB_BITS) + 2;
+}
+
+/* Parse the 'n_digits' decimal digits at 'p' to the unsigned number
+   tabr[0..mp_dec_limbs(n_digits)-1]. The high part is multiplied by the
+   power radix_base^(2^level) and added to the low part. Return the number
+   of limbs of the result or -1 if memory error. */
+static int mp_from_dec(
+    JSContext* ctx,
+    js_limb_t* tabr,
+    const char* p,
+    int n_digits,
+    const JSRadixPow* pows,
+    int level) {
+  const JSRadixPow* pw;
+  js_limb_t *buf, *hi, *lo, *tmp, v, h;
+  int low_digits, hi_size, lo_size, hi_len, lo_len, len, i;
+
+  while (level >= 0 && (JS_LIMB_DIGITS << level) >= n_digits)
+    level--;
+  if (level < 0 || n_digits < MP_RADIX_DC_THRESHOLD * JS_LIMB_DIGITS) {
+    len = 1;
+    tabr[0] = 0;
+    while (n_digits > 0) {
+      v = 0;
+      for (i = 0; i < JS_LIMB_DIGITS && i < n_digits; i++)
+        v = v * 10 + (p[i] - '0');
+      p += i;
+      n_digits -= i;
+      h = mp_mul1(tabr, tabr, len, js_pow_dec[i], v);
+      if (h != 0)
+        tabr[len++] = h;
+    }
+    return len;
+  }
+
+  pw = &pows[level];
+  low_digits = JS_LIMB_DIGITS << level;
+  hi_size = mp_dec_limbs(n_digits - low_digits);
+  lo_size = mp_dec_limbs(low_digits);
+  buf = js_malloc(
+      ctx,
+      (hi_size + lo_size + mp_mul_scratch_size(max_int(hi_size, pw->len))) *
+          sizeof(buf[0]));
+  if (!buf)
+    return -1;
+  hi = buf;
+  lo = hi + hi_size;
+  tmp = lo + lo_size;
+  hi_len = mp_from_dec(ctx, hi, p, n_digits - low_digits, pows, level);
+  if (hi_len < 0)
+    goto fail;
+  lo_len = mp_from_dec(
+      ctx, lo, p + n_digits - low_digits, low_digits, pows, level - 1);
+  if (lo_len < 0)
+    goto fail;
+  /* hi * radix_base^(2^level) + lo fits in hi_len + pw->len limbs */
+  mp_mul(tabr, hi, hi_len, pw->tab, pw->len, tmp);
+  len = hi_len + pw->len;
+  mp_add_in(tabr, len, lo, lo_len);
+  js_free(ctx, buf);
+  while (len > 1 && tabr[len - 1] == 0)
+    len--;
+  return len;
+fail:
+  js_free(ctx, buf);
+  return -1;
+}
+
 /* syntax: [-]digits in base radix. Return NULL if memory error. radix
    = 10, 2, 8 or 16. */
 JSBigInt* js_bigint_from_string(JSContext* ctx, const char* str, int radix) {
@@ -2504,10 +2851,33 @@ JSBigInt* js_bigint_from_string(JSContext* ctx, const char* str, int radix) {
   }
   /* we add one extra bit for the sign */
   n_limbs = max_int(1, n_bits / JS_LIMB_BITS + 1);
+  if (radix == 10 && n_limbs >= MP_RADIX_DC_THRESHOLD)
+    n_limbs = mp_dec_limbs(n_digits) + 1;
   r = js_bigint_new(ctx, n_limbs);
   if (!r)
     return NULL;
-  if (radix == 10) {
+  if (radix == 10 && n_limbs >= MP_RADIX_DC_THRESHOLD) {
+    JSRadixPow pows[MP_RADIX_POW_MAX];
+    int count;
+
+    /* divide and conquer conversion */
+    count = mp_radix_pow_init(
+        ctx, pows, js_pow_dec[JS_LIMB_DIGITS], n_limbs / 2);
+    if (count < 0) {
+      js_free(ctx, r);
+      return NULL;
+    }
+    len = mp_from_dec(ctx, r->tab, p, n_digits, pows, count - 1);
+    mp_radix_pow_free(ctx, pows, count);
+    if (len < 0) {
+      js_free(ctx, r);
+      return NULL;
+    }
+    /* add one extra limb to have the correct sign*/
+    if ((r->tab[len - 1] >> (JS_LIMB_BITS - 1)) != 0)
+      r->tab[len++] = 0;
+    r->len = len;
+  } else if (radix == 10) {
     int digits_per_limb = JS_LIMB_DIGITS;
     len = 1;
     r->tab[0] = 0;
@@ -2649,6 +3019,98 @@ static const js_limb_t radix_base_table[JS_RADIX_MAX - 1] = {
 #endif
 };
 
+/* write the digits of tab[0..len-1] (destroyed) before 'q' */
+static char*
+mp_to_radix_basecase(char* q, js_limb_t* tab, int len, unsigned int radix) {
+  js_limb_t radix_base, v;
+
+  radix_base = radix_base_table[radix - 2];
+  for (;;) {
+    /* remove leading zero limbs */
+    while (len > 1 && tab[len - 1] == 0)
+      len--;
+    if (len == 1 && tab[0] < radix_base) {
+      v = tab[0];
+      if (v != 0) {
+        q = js_u64toa(q, v, radix);
+      }
+      break;
+    } else {
+      v = mp_div1(tab, tab, len, radix_base, 0);
+      q = limb_to_a(q, v, radix, digits_per_limb_table[radix - 2]);
+    }
+  }
+  return q;
+}
+
+/* Write the digits of tab[0..len-1] (destroyed) before 'q'. If 'pad' >=
+   0, exactly 'pad' digits are written. The number is divided by the
+   largest power radix_base^(2^level) <= tab and the quotient and the
+   remainder are converted recursively. Return NULL if memory error. */
+static char* mp_to_radix(
+    JSContext* ctx,
+    char* q,
+    js_limb_t* tab,
+    int len,
+    unsigned int radix,
+    int pad,
+    const JSRadixPow* pows,
+    int level) {
+  const JSRadixPow* pw;
+  js_limb_t *buf, *tabq;
+  char* q_end;
+  int low_digits, qlen;
+
+  while (len > 1 && tab[len - 1] == 0)
+    len--;
+  /* use the largest power <= tab */
+  while (level >= 0 &&
+         (len < pows[level].len ||
+          (len == pows[level].len && mp_cmp(tab, pows[level].tab, len) < 0)))
+    level--;
+  if (level < 0 || len < MP_RADIX_DC_THRESHOLD) {
+    q_end = q;
+    q = mp_to_radix_basecase(q, tab, len, radix);
+    while (q_end - q < pad)
+      *--q = '0';
+    return q;
+  }
+
+  pw = &pows[level];
+  qlen = len + 1 - pw->len + 2;
+  buf = js_malloc(ctx, (len + 1 + qlen) * sizeof(buf[0]));
+  if (!buf)
+    return NULL;
+  tabq = buf + len + 1;
+  if (pw->shift != 0) {
+    buf[len] = mp_shl(buf, tab, len, pw->shift);
+  } else {
+    memcpy(buf, tab, len * sizeof(buf[0]));
+    buf[len] = 0;
+  }
+  if (mp_divnorm_large(ctx, tabq, buf, len + 1, pw->norm, pw->len)) {
+    js_free(ctx, buf);
+    return NULL;
+  }
+  if (pw->shift != 0)
+    mp_shr(buf, buf, pw->len, pw->shift, 0);
+  low_digits = digits_per_limb_table[radix - 2] << level;
+  q = mp_to_radix(ctx, q, buf, pw->len, radix, low_digits, pows, level - 1);
+  if (q) {
+    q = mp_to_radix(
+        ctx,
+        q,
+        tabq,
+        qlen - 1,
+        radix,
+        pad < 0 ? -1 : pad - low_digits,
+        pows,
+        level);
+  }
+  js_free(ctx, buf);
+  return q;
+}
+
 JSValue js_bigint_to_string1(JSContext* ctx, JSValueConst val, int radix) {
   if (JS_VALUE_GET_TAG(val) == JS_TAG_SHORT_BIG_INT) {
     char buf[66];
@@ -2698,24 +3160,24 @@ JSValue js_bigint_to_string1(JSContext* ctx, JSValueConst val, int radix) {
     *--q = '\0';
     buf_end = q;
     if (!is_binary_radix) {
-      int len;
-      js_limb_t radix_base, v;
-      radix_base = radix_base_table[radix - 2];
-      len = r->len;
-      for (;;) {
-        /* remove leading zero limbs */
-        while (len > 1 && r->tab[len - 1] == 0)
-          len--;
-        if (len == 1 && r->tab[0] < radix_base) {
-          v = r->tab[0];
-          if (v != 0) {
-            q = js_u64toa(q, v, radix);
-          }
-          break;
-        } else {
-          v = mp_div1(r->tab, r->tab, len, radix_base, 0);
-          q = limb_to_a(q, v, radix, digits_per_limb_table[radix - 2]);
+      if (r->len >= MP_RADIX_DC_THRESHOLD) {
+        JSRadixPow pows[MP_RADIX_POW_MAX];
+        int count;
+
+        /* divide and conquer conversion */
+        count = mp_radix_pow_init(
+            ctx, pows, radix_base_table[radix - 2], r->len / 2);
+        if (count >= 0) {
+          q = mp_to_radix(ctx, q, r->tab, r->len, radix, -1, pows, count - 1);
+          mp_radix_pow_free(ctx, pows, count);
         }
+        if (count < 0 || !q) {
+          js_free(ctx, buf);
+          js_free(ctx, tmp);
+          return JS_EXCEPTION;
+        }
+      } else {
+        q = mp_to_radix_basecase(q, r->tab, r->len, radix);
       }
     } else {
       int i, shift;
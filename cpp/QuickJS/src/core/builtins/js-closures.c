@@ -31,6 +31,7 @@
 #include "QuickJS/list.h"
 #include "js-async-function.h"
 #include "js-function.h"
+#include "js-operator.h"
 
 JSVarRef*
 get_var_ref(JSContext* ctx, JSStackFrame* sf, int var_idx, BOOL is_arg) {
@@ -76,6 +77,71 @@ get_var_ref(JSContext* ctx, JSStackFrame* sf, int var_idx, BOOL is_arg) {
   return var_ref;
 }
 
+/* reference to a copy of 'val' which is not linked to any stack frame, so
+   creating it is cheaper than get_var_ref() and it neither keeps an async
+   frame alive nor needs to be closed when the variable goes out of scope */
+static JSVarRef* new_detached_var_ref(JSContext* ctx, JSValueConst val) {
+  JSVarRef* var_ref;
+
+  var_ref = js_malloc(ctx, sizeof(JSVarRef));
+  if (!var_ref)
+    return NULL;
+  var_ref->header.ref_count = 1;
+  add_gc_object(ctx->rt, &var_ref->header, JS_GC_OBJ_TYPE_VAR_REF);
+  var_ref->is_detached = TRUE;
+  var_ref->value = JS_DupValue(ctx, val);
+  var_ref->pvalue = &var_ref->value;
+  return var_ref;
+}
+
+/* Return a detached reference to the immutable variable 'var_idx'. The
+   closures created by the frame share it while the variable holds the
+   same value, e.g. until a new loop iteration binds it again. */
+static JSVarRef*
+get_const_var_ref(JSContext* ctx, JSStackFrame* sf, int var_idx) {
+  JSVarRef** tab = sf->const_var_refs;
+  JSVarRef* var_ref;
+  JSValueConst val = sf->var_buf[var_idx];
+
+  if (var_idx < sf->const_var_ref_count) {
+    var_ref = tab[var_idx];
+    if (var_ref && js_same_value(ctx, var_ref->value, val)) {
+      var_ref->header.ref_count++;
+      return var_ref;
+    }
+  } else {
+    int new_count = max_int(var_idx + 1, sf->const_var_ref_count * 3 / 2);
+    tab = js_realloc(ctx, tab, sizeof(tab[0]) * new_count);
+    if (!tab)
+      return NULL;
+    memset(
+        tab + sf->const_var_ref_count,
+        0,
+        sizeof(tab[0]) * (new_count - sf->const_var_ref_count));
+    sf->const_var_refs = tab;
+    sf->const_var_ref_count = new_count;
+  }
+  var_ref = new_detached_var_ref(ctx, val);
+  if (!var_ref)
+    return NULL;
+  free_var_ref(ctx->rt, tab[var_idx]);
+  /* one reference for the frame */
+  var_ref->header.ref_count++;
+  tab[var_idx] = var_ref;
+  return var_ref;
+}
+
+/* release the references kept by get_const_var_ref() */
+void close_const_var_refs(JSRuntime* rt, JSStackFrame* sf) {
+  int i;
+
+  for (i = 0; i < sf->const_var_ref_count; i++)
+    free_var_ref(rt, sf->const_var_refs[i]);
+  js_free_rt(rt, sf->const_var_refs);
+  sf->const_var_refs = NULL;
+  sf->const_var_ref_count = 0;
+}
+
 JSValue js_closure2(
     JSContext* ctx,
     JSValue func_obj,
@@ -98,7 +164,12 @@ JSValue js_closure2(
     for (i = 0; i < b->closure_var_count; i++) {
       JSClosureVar* cv = &b->closure_var[i];
       JSVarRef* var_ref;
-      if (cv->is_local) {
+      if (cv->is_immutable && !JS_IsUninitialized(sf->var_buf[cv->var_idx])) {
+        /* the variable is initialized and never changes: capture its value */
+        var_ref = get_const_var_ref(ctx, sf, cv->var_idx);
+        if (!var_ref)
+          goto fail;
+      } else if (cv->is_local) {
         /* reuse the existing variable reference if it already exists */
         var_ref = get_var_ref(ctx, sf, cv->var_idx, cv->is_arg);
         if (!var_ref)
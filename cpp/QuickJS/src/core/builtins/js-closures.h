@@ -49,5 +49,6 @@ JSValue js_closure(
     JSStackFrame* sf);
 
 void close_var_refs(JSRuntime* rt, JSStackFrame* sf);
+void close_const_var_refs(JSRuntime* rt, JSStackFrame* sf);
 
 #endif
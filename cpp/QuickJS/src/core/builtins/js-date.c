@@ -124,13 +124,12 @@ int64_t floor_div(int64_t a, int64_t b) {
   return (a - (m + (m < 0) * b)) / b;
 }
 
-/* OS dependent. d = argv[0] is in ms from 1970. Return the difference
-   between UTC time and local time 'd' in minutes */
-int getTimezoneOffset(int64_t time) {
+/* OS dependent. 'time' is in seconds from 1970. Return the difference
+   between UTC time and local time 'time' in minutes */
+static int compute_timezone_offset(int64_t time) {
   time_t ti;
   int res;
 
-  time /= 1000; /* convert to seconds */
   if (sizeof(time_t) == 4) {
     /* on 32-bit systems, we need to clamp the time value to the
        range of `time_t`. This is better than truncating values to
@@ -179,6 +178,109 @@ int getTimezoneOffset(int64_t time) {
   return res;
 }
 
+/* check that the cached offsets were computed with the current value
+   of TZ. localtime_r() may not notice that TZ changed, so tzset() is
+   called when it does. Return FALSE if the cache cannot be used. */
+static BOOL timezone_cache_check_tz(JSRuntime* rt) {
+  JSTimezoneCache* c = &rt->timezone_cache;
+  const char* tz = getenv("TZ");
+  size_t len;
+
+  if (likely(c->tz_valid && (tz ? c->tz && !strcmp(tz, c->tz) : !c->tz)))
+    return TRUE;
+  js_free_rt(rt, c->tz);
+  memset(c, 0, sizeof(*c));
+#if !defined(_WIN32)
+  tzset();
+#endif
+  if (tz) {
+    len = strlen(tz);
+    c->tz = js_malloc_rt(rt, len + 1);
+    if (!c->tz)
+      return FALSE;
+    memcpy(c->tz, tz, len + 1);
+  }
+  c->tz_valid = TRUE;
+  return TRUE;
+}
+
+/* the offset is sampled every week: as most implementations, assume
+   that the offset does not change twice in less than a week */
+#define JS_TZ_SAMPLE_STEP (7 * 86400)
+
+/* find the transitions of the period 'tp' */
+static void timezone_cache_build_period(JSTimezonePeriod* tp) {
+  int64_t start, end, t, t0, lo, hi, mid;
+  int off0, off, hi_off;
+
+  start = tp->period * ((int64_t)1 << JS_TZ_PERIOD_BITS);
+  end = start + ((int64_t)1 << JS_TZ_PERIOD_BITS) - 1;
+  off0 = compute_timezone_offset(start);
+  tp->offset = off0;
+  tp->transition_count = 0;
+  t0 = start;
+  while (t0 < end) {
+    t = min_int64(t0 + JS_TZ_SAMPLE_STEP, end);
+    off = compute_timezone_offset(t);
+    if (off == off0) {
+      t0 = t;
+      continue;
+    }
+    /* find the first second with a different offset */
+    lo = t0;
+    hi = t;
+    hi_off = off;
+    while (hi - lo > 1) {
+      mid = lo + (hi - lo) / 2;
+      off = compute_timezone_offset(mid);
+      if (off == off0) {
+        lo = mid;
+      } else {
+        hi = mid;
+        hi_off = off;
+      }
+    }
+    if (tp->transition_count == JS_TZ_MAX_TRANSITIONS) {
+      tp->state = JS_TZ_PERIOD_UNCACHEABLE;
+      return;
+    }
+    tp->transition_time[tp->transition_count] = hi;
+    tp->transition_offset[tp->transition_count] = hi_off;
+    tp->transition_count++;
+    t0 = hi;
+    off0 = hi_off;
+  }
+  tp->state = JS_TZ_PERIOD_READY;
+}
+
+/* 'time' is in ms from 1970. Return the difference between UTC time and
+   local time 'time' in minutes. The offsets of the periods which are
+   used more than once are cached. */
+int getTimezoneOffset(JSRuntime* rt, int64_t time) {
+  JSTimezonePeriod* tp;
+  int64_t period;
+  int i, res;
+
+  time /= 1000; /* convert to seconds */
+  if (!timezone_cache_check_tz(rt))
+    return compute_timezone_offset(time);
+  period = floor_div(time, (int64_t)1 << JS_TZ_PERIOD_BITS);
+  tp = &rt->timezone_cache.periods[period & (JS_TZ_CACHE_SIZE - 1)];
+  if (tp->period != period || tp->state == JS_TZ_PERIOD_EMPTY) {
+    tp->period = period;
+    tp->state = JS_TZ_PERIOD_SEEN;
+    return compute_timezone_offset(time);
+  }
+  if (tp->state == JS_TZ_PERIOD_SEEN)
+    timezone_cache_build_period(tp);
+  if (tp->state != JS_TZ_PERIOD_READY)
+    return compute_timezone_offset(time);
+  res = tp->offset;
+  for (i = 0; i < tp->transition_count && time >= tp->transition_time[i]; i++)
+    res = tp->transition_offset[i];
+  return res;
+}
+
 #if 0
 JSValue js___date_getTimezoneOffset(JSContext *ctx, JSValueConst this_val,
                                            int argc, JSValueConst *argv)
@@ -190,7 +292,7 @@ JSValue js___date_getTimezoneOffset(JSContext *ctx, JSValueConst this_val,
     if (isnan(dd))
         return __JS_NewFloat64(ctx, dd);
     else
-        return JS_NewInt32(ctx, getTimezoneOffset((int64_t)dd));
+        return JS_NewInt32(ctx, getTimezoneOffset(ctx->rt, (int64_t)dd));
 }
 
 JSValue js_get_prototype_from_ctor(JSContext *ctx, JSValueConst ctor,
@@ -307,7 +409,7 @@ __exception int get_date_fields(
   } else {
     d = dval; /* assuming -8.64e15 <= dval <= -8.64e15 */
     if (is_local) {
-      tz = -getTimezoneOffset(d);
+      tz = -getTimezoneOffset(ctx->rt, d);
       d += tz * 60000;
     }
   }
@@ -353,7 +455,10 @@ double time_clip(double t) {
 
 /* The spec mandates the use of 'double' and it specifies the order
    of the operations */
-double set_date_fields(double fields[static 7], int is_local) {
+double set_date_fields(
+    JSContext* ctx,
+    double fields[static 7],
+    int is_local) {
   double y, m, dt, ym, mn, day, h, s, milli, time, tv;
   int yi, mi, i;
   int64_t days;
@@ -407,7 +512,7 @@ double set_date_fields(double fields[static 7], int is_local) {
     int64_t ti = tv < INT64_MIN ? INT64_MIN
         : tv >= 0x1p63          ? INT64_MAX
                                 : (int64_t)tv;
-    tv += getTimezoneOffset(ti) * 60000;
+    tv += getTimezoneOffset(ctx->rt, ti) * 60000;
   }
   return time_clip(tv);
 }
@@ -471,7 +576,7 @@ JSValue set_date_field(
     return JS_NAN; /* thisTimeValue is NaN */
 
   if (res && argc > 0)
-    d = set_date_fields(fields, is_local);
+    d = set_date_fields(ctx, fields, is_local);
 
   return JS_SetThisTimeValue(ctx, this_val, d);
 }
@@ -673,7 +778,7 @@ JSValue js_date_constructor(
       if (i == 0 && fields[0] >= 0 && fields[0] < 100)
         fields[0] += 1900;
     }
-    val = (i == n) ? set_date_fields(fields, 1) : NAN;
+    val = (i == n) ? set_date_fields(ctx, fields, 1) : NAN;
   }
 has_val:
 #if 0
@@ -721,7 +826,7 @@ JSValue js_Date_UTC(
     if (i == 0 && fields[0] >= 0 && fields[0] < 100)
       fields[0] += 1900;
   }
-  return JS_NewFloat64(ctx, set_date_fields(fields, 0));
+  return JS_NewFloat64(ctx, set_date_fields(ctx, fields, 0));
 }
 
 /* Date string parsing */
@@ -1123,6 +1228,100 @@ BOOL js_date_parse_otherstring(
   return TRUE;
 }
 
+static inline int date_get_2digits(const uint8_t* p) {
+  if ((unsigned)(p[0] - '0') > 9 || (unsigned)(p[1] - '0') > 9)
+    return -1;
+  return (p[0] - '0') * 10 + p[1] - '0';
+}
+
+/* fast path for the common forms of the toISOString() format:
+   YYYY-MM-DD, YYYY-MM-DDTHH:mm, YYYY-MM-DDTHH:mm:ss or
+   YYYY-MM-DDTHH:mm:ss.sss, optionally followed by Z or [+-]HH:mm.
+   Return FALSE if the string must be parsed by the generic parser. */
+static BOOL js_date_parse_isostring_fast(
+    JSContext* ctx,
+    JSString* sp,
+    double* pval) {
+  const uint8_t* p;
+  double fields[7] = {0, 0, 1, 0, 0, 0, 0};
+  int len, pos, i, v, hh, mm, tz = 0;
+  BOOL is_local = FALSE;
+
+  if (sp->is_wide_char)
+    return FALSE;
+  p = js_string_str8(sp);
+  len = sp->len;
+  if (len < 10 || p[4] != '-' || p[7] != '-')
+    return FALSE;
+  v = date_get_2digits(p);
+  i = date_get_2digits(p + 2);
+  if (v < 0 || i < 0)
+    return FALSE;
+  fields[0] = v * 100 + i;
+  v = date_get_2digits(p + 5);
+  if (v < 1 || v > 12)
+    return FALSE;
+  fields[1] = v - 1;
+  v = date_get_2digits(p + 8);
+  if (v < 1 || v > 31)
+    return FALSE;
+  fields[2] = v;
+  pos = 10;
+  if (pos < len && p[pos] == 'T') {
+    is_local = TRUE;
+    if (len < 16 || p[13] != ':')
+      return FALSE;
+    hh = date_get_2digits(p + 11);
+    mm = date_get_2digits(p + 14);
+    if (hh < 0 || hh > 24 || mm < 0 || mm > 59)
+      return FALSE;
+    fields[3] = hh;
+    fields[4] = mm;
+    pos = 16;
+    if (pos < len && p[pos] == ':') {
+      v = pos + 3 <= len ? date_get_2digits(p + pos + 1) : -1;
+      if (v < 0 || v > 59)
+        return FALSE;
+      fields[5] = v;
+      pos += 3;
+      if (pos < len && p[pos] == '.') {
+        if (pos + 4 > len || (unsigned)(p[pos + 1] - '0') > 9)
+          return FALSE;
+        v = date_get_2digits(p + pos + 2);
+        if (v < 0)
+          return FALSE;
+        fields[6] = (p[pos + 1] - '0') * 100 + v;
+        pos += 4;
+      }
+    }
+    /* 24:00 is only valid at the end of the day */
+    if (hh == 24 && (mm | (int)fields[5] | (int)fields[6]))
+      return FALSE;
+  }
+  if (pos < len) {
+    is_local = FALSE;
+    if (p[pos] == 'Z') {
+      pos++;
+    } else if ((p[pos] == '+' || p[pos] == '-') && pos + 6 <= len &&
+               p[pos + 3] == ':') {
+      hh = date_get_2digits(p + pos + 1);
+      mm = date_get_2digits(p + pos + 4);
+      if (hh < 0 || hh > 23 || mm < 0 || mm > 59)
+        return FALSE;
+      tz = hh * 60 + mm;
+      if (p[pos] == '-')
+        tz = -tz;
+      pos += 6;
+    } else {
+      return FALSE;
+    }
+    if (pos != len)
+      return FALSE;
+  }
+  *pval = set_date_fields(ctx, fields, is_local) - tz * 60000;
+  return TRUE;
+}
+
 JSValue js_Date_parse(
     JSContext* ctx,
     JSValueConst this_val,
@@ -1144,6 +1343,10 @@ JSValue js_Date_parse(
     return JS_EXCEPTION;
 
   sp = JS_VALUE_GET_STRING(s);
+  if (js_date_parse_isostring_fast(ctx, sp, &d)) {
+    JS_FreeValue(ctx, s);
+    return JS_NewFloat64(ctx, d);
+  }
   /* convert the string as a byte array */
   for (i = 0; i < sp->len && i < (int)countof(buf) - 1; i++) {
     c = string_get(sp, i);
@@ -1167,7 +1370,7 @@ JSValue js_Date_parse(
     if (valid) {
       for (i = 0; i < 7; i++)
         fields1[i] = fields[i];
-      d = set_date_fields(fields1, is_local) - fields[8] * 60000;
+      d = set_date_fields(ctx, fields1, is_local) - fields[8] * 60000;
       rv = JS_NewFloat64(ctx, d);
     }
   }
@@ -1232,7 +1435,7 @@ JSValue js_date_getTimezoneOffset(
     return JS_NAN;
   else
     /* assuming -8.64e15 <= v <= -8.64e15 */
-    return JS_NewInt64(ctx, getTimezoneOffset((int64_t)trunc(v)));
+    return JS_NewInt64(ctx, getTimezoneOffset(ctx->rt, (int64_t)trunc(v)));
 }
 
 JSValue js_date_getTime(
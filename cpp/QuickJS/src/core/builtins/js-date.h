@@ -42,10 +42,16 @@ __exception int get_date_fields(
     double fields[9],
     int is_local,
     int force);
+/* 'time' is in ms from 1970. Return the difference between UTC time and
+   local time 'time' in minutes */
+int getTimezoneOffset(JSRuntime* rt, int64_t time);
 double time_clip(double t);
 /* The spec mandates the use of 'double' and it fixes the order
    of the operations */
-double set_date_fields(double fields[static 7], int is_local);
+double set_date_fields(
+    JSContext* ctx,
+    double fields[static 7],
+    int is_local);
 JSValue get_date_field(
     JSContext* ctx,
     JSValueConst this_val,
@@ -34,18 +34,29 @@
 #include "js-big-num.h"
 #include "js-object.h"
 
-void js_for_in_iterator_finalizer(JSRuntime* rt, JSValue val) {
-  JSObject* p = JS_VALUE_GET_OBJ(val);
-  JSForInIterator* it = p->u.for_in_iterator;
+static void js_for_in_free_tab_atom(JSRuntime* rt, JSForInIterator* it) {
   int i;
 
-  JS_FreeValueRT(rt, it->obj);
-  if (!it->is_array) {
+  if (it->enum_shape) {
+    /* the atoms belong to the shape */
+    js_free_shape(rt, it->enum_shape);
+    it->enum_shape = NULL;
+  } else {
     for (i = 0; i < it->atom_count; i++) {
       JS_FreeAtomRT(rt, it->tab_atom[i].atom);
     }
     js_free_rt(rt, it->tab_atom);
   }
+  it->tab_atom = NULL;
+}
+
+void js_for_in_iterator_finalizer(JSRuntime* rt, JSValue val) {
+  JSObject* p = JS_VALUE_GET_OBJ(val);
+  JSForInIterator* it = p->u.for_in_iterator;
+
+  JS_FreeValueRT(rt, it->obj);
+  if (!it->is_array)
+    js_for_in_free_tab_atom(rt, it);
   js_free_rt(rt, it);
 }
 
@@ -420,6 +431,7 @@ JSValue js_build_rest(JSContext* ctx, int first, int argc, JSValueConst* argv) {
 JSValue build_for_in_iterator(JSContext* ctx, JSValue obj) {
   JSObject *p, *p1;
   JSPropertyEnum* tab_atom;
+  JSShapeEnumCache* ec;
   int i;
   JSValue enum_obj;
   JSForInIterator* it;
@@ -447,6 +459,7 @@ JSValue build_for_in_iterator(JSContext* ctx, JSValue obj) {
   it->tab_atom = NULL;
   it->atom_count = 0;
   it->in_prototype_chain = FALSE;
+  it->enum_shape = NULL;
   p1 = JS_VALUE_GET_OBJ(enum_obj);
   p1->u.for_in_iterator = it;
 
@@ -469,6 +482,15 @@ JSValue build_for_in_iterator(JSContext* ctx, JSValue obj) {
     it->atom_count = p->u.array.count;
   } else {
   normal_case:
+    ec = js_object_get_enum_cache(ctx, p);
+    if (ec) {
+      /* share the enumeration of the shape, which cannot be modified
+         while the iterator references it */
+      it->enum_shape = js_dup_shape(p->shape);
+      it->tab_atom = ec->tab;
+      it->atom_count = ec->count;
+      return enum_obj;
+    }
     if (JS_GetOwnPropertyNamesInternal(
             ctx,
             &tab_atom,
@@ -488,9 +510,10 @@ JSValue build_for_in_iterator(JSContext* ctx, JSValue obj) {
 static __exception int js_for_in_prepare_prototype_chain_enum(
     JSContext* ctx,
     JSValueConst enum_obj) {
-  JSObject* p;
+  JSObject *p, *p1;
   JSForInIterator* it;
   JSPropertyEnum* tab_atom;
+  JSShapeEnumCache* ec;
   uint32_t tab_atom_count, i;
   JSValue obj1;
 
@@ -506,16 +529,22 @@ static __exception int js_for_in_prepare_prototype_chain_enum(
       break;
     if (JS_IsException(obj1))
       goto fail;
-    if (JS_GetOwnPropertyNamesInternal(
-            ctx,
-            &tab_atom,
-            &tab_atom_count,
-            JS_VALUE_GET_OBJ(obj1),
-            JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY)) {
-      JS_FreeValue(ctx, obj1);
-      goto fail;
+    p1 = JS_VALUE_GET_OBJ(obj1);
+    ec = js_object_get_enum_cache(ctx, p1);
+    if (ec) {
+      tab_atom_count = ec->enum_count;
+    } else {
+      if (JS_GetOwnPropertyNamesInternal(
+              ctx,
+              &tab_atom,
+              &tab_atom_count,
+              p1,
+              JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY)) {
+        JS_FreeValue(ctx, obj1);
+        goto fail;
+      }
+      JS_FreePropertyEnum(ctx, tab_atom, tab_atom_count);
     }
-    JS_FreePropertyEnum(ctx, tab_atom, tab_atom_count);
     if (tab_atom_count != 0) {
       JS_FreeValue(ctx, obj1);
       goto slow_path;
@@ -614,7 +643,7 @@ __exception int js_for_in_next(JSContext* ctx, JSValue* sp) {
               JS_GPN_STRING_MASK | JS_GPN_SET_ENUM)) {
         return -1;
       }
-      JS_FreePropertyEnum(ctx, it->tab_atom, it->atom_count);
+      js_for_in_free_tab_atom(ctx->rt, it);
       it->tab_atom = tab_atom;
       it->atom_count = tab_atom_count;
       it->idx = 0;
@@ -643,7 +672,11 @@ __exception int js_for_in_next(JSContext* ctx, JSValue* sp) {
         if (!is_enumerable)
           continue;
       }
-      /* check if the property was deleted */
+      /* check if the property was deleted. The shape of 'obj' changes
+         when one of its properties is deleted. */
+      if (it->enum_shape &&
+          JS_VALUE_GET_OBJ(it->obj)->shape == it->enum_shape)
+        break;
       ret =
           JS_GetOwnPropertyInternal(ctx, NULL, JS_VALUE_GET_OBJ(it->obj), prop);
       if (ret < 0)
@@ -72,12 +72,105 @@ JSValue JS_ThrowTypeErrorRevokedProxy(JSContext* ctx) {
   return JS_ThrowTypeError(ctx, "revoked proxy");
 }
 
+static const JSAtom js_proxy_trap_atoms[JS_PROXY_TRAP_COUNT] = {
+    JS_ATOM_getPrototypeOf,
+    JS_ATOM_setPrototypeOf,
+    JS_ATOM_isExtensible,
+    JS_ATOM_preventExtensions,
+    JS_ATOM_getOwnPropertyDescriptor,
+    JS_ATOM_defineProperty,
+    JS_ATOM_has,
+    JS_ATOM_get,
+    JS_ATOM_set,
+    JS_ATOM_deleteProperty,
+    JS_ATOM_ownKeys,
+    JS_ATOM_apply,
+    JS_ATOM_construct,
+};
+
+static inline JSProxyTrapCacheEntry*
+js_proxy_trap_cache_entry(JSContext* ctx, JSShape* sh, JSProxyTrapEnum trap) {
+  uintptr_t h = (uintptr_t)sh;
+  h = (h >> 4) ^ (h >> 10);
+  return &ctx->proxy_trap_cache[trap][h % JS_PROXY_TRAP_CACHE_SIZE];
+}
+
+static void js_proxy_free_trap_cache_entry(
+    JSRuntime* rt,
+    JSProxyTrapCacheEntry* e) {
+  js_free_shape_null(rt, e->shape);
+  js_free_shape_null(rt, e->proto_shape);
+  e->shape = NULL;
+  e->proto_shape = NULL;
+}
+
+void js_proxy_free_trap_cache(JSRuntime* rt, JSContext* ctx) {
+  int i, j;
+  for (i = 0; i < JS_PROXY_TRAP_COUNT; i++) {
+    for (j = 0; j < JS_PROXY_TRAP_CACHE_SIZE; j++)
+      js_proxy_free_trap_cache_entry(rt, &ctx->proxy_trap_cache[i][j]);
+  }
+}
+
+void js_proxy_mark_trap_cache(
+    JSRuntime* rt,
+    JSContext* ctx,
+    JS_MarkFunc* mark_func) {
+  int i, j;
+  for (i = 0; i < JS_PROXY_TRAP_COUNT; i++) {
+    for (j = 0; j < JS_PROXY_TRAP_CACHE_SIZE; j++) {
+      JSProxyTrapCacheEntry* e = &ctx->proxy_trap_cache[i][j];
+      if (e->shape)
+        mark_func(rt, &e->shape->header);
+      if (e->proto_shape)
+        mark_func(rt, &e->proto_shape->header);
+    }
+  }
+}
+
+/* remember where the trap 'trap' of the handler 'p' is. Only the plain
+   handlers with a hashed shape are cached: the trap must be an own data
+   property or be absent from the handler and from its prototype. */
+static void js_proxy_update_trap_cache(
+    JSContext* ctx,
+    JSObject* p,
+    JSProxyTrapEnum trap) {
+  JSAtom atom = js_proxy_trap_atoms[trap];
+  JSShape *sh = p->shape, *proto_sh = NULL;
+  JSShapeProperty* prs;
+  JSProperty* pr;
+  JSProxyTrapCacheEntry* e;
+  int prop_index = -1;
+
+  if (p->is_exotic || !sh->is_hashed)
+    return;
+  prs = find_own_property(&pr, p, atom);
+  if (prs) {
+    if (prs->flags & JS_PROP_TMASK)
+      return;
+    prop_index = pr - p->prop;
+  } else if (sh->proto) {
+    JSObject* proto = sh->proto;
+    if (proto->is_exotic || !proto->shape->is_hashed || proto->shape->proto ||
+        find_own_property(&pr, proto, atom))
+      return;
+    proto_sh = proto->shape;
+  }
+  e = js_proxy_trap_cache_entry(ctx, sh, trap);
+  js_proxy_free_trap_cache_entry(ctx->rt, e);
+  e->shape = js_dup_shape(sh);
+  e->proto_shape = proto_sh ? js_dup_shape(proto_sh) : NULL;
+  e->prop_index = prop_index;
+}
+
 JSProxyData* get_proxy_method(
     JSContext* ctx,
     JSValue* pmethod,
     JSValueConst obj,
-    JSAtom name) {
+    JSProxyTrapEnum trap) {
   JSProxyData* s = JS_GetOpaque(obj, JS_CLASS_PROXY);
+  JSProxyTrapCacheEntry* e;
+  JSObject* p;
   JSValue method;
 
   /* safer to test recursion in all proxy methods */
@@ -91,21 +184,53 @@ JSProxyData* get_proxy_method(
     JS_ThrowTypeErrorRevokedProxy(ctx);
     return NULL;
   }
-  method = JS_GetProperty(ctx, s->handler, name);
+  p = JS_VALUE_GET_OBJ(s->handler);
+  e = js_proxy_trap_cache_entry(ctx, p->shape, trap);
+  if (e->shape == p->shape && !p->is_exotic) {
+    if (e->prop_index >= 0) {
+      method = JS_DupValue(ctx, p->prop[e->prop_index].u.value);
+      goto done;
+    }
+    if (!e->proto_shape || e->proto_shape == e->shape->proto->shape) {
+      *pmethod = JS_UNDEFINED;
+      return s;
+    }
+  }
+  method = JS_GetProperty(ctx, s->handler, js_proxy_trap_atoms[trap]);
   if (JS_IsException(method))
     return NULL;
+  js_proxy_update_trap_cache(ctx, p, trap);
+done:
   if (JS_IsNull(method))
     method = JS_UNDEFINED;
   *pmethod = method;
   return s;
 }
 
+/* return TRUE if the trap results for the property 'atom' of the target
+   'p' cannot violate an invariant of get, set, has and deleteProperty:
+   the property is absent or configurable in an extensible object. */
+static BOOL js_proxy_target_is_unconstrained(JSObject* p, JSAtom atom) {
+  JSShapeProperty* prs;
+  JSProperty* pr;
+
+  if (p->is_exotic) {
+    /* the elements of fast arrays are configurable */
+    if (p->class_id == JS_CLASS_ARRAY && p->fast_array &&
+        __JS_AtomIsTaggedInt(atom))
+      return __JS_AtomToUInt32(atom) >= p->u.array.count || p->extensible;
+    return FALSE;
+  }
+  prs = find_own_property(&pr, p, atom);
+  return !prs || ((prs->flags & JS_PROP_CONFIGURABLE) && p->extensible);
+}
+
 JSValue js_proxy_get_prototype(JSContext* ctx, JSValueConst obj) {
   JSProxyData* s;
   JSValue method, ret, proto1;
   int res;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_getPrototypeOf);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_GET_PROTOTYPE_OF);
   if (!s)
     return JS_EXCEPTION;
   if (JS_IsUndefined(method))
@@ -150,7 +275,7 @@ int js_proxy_set_prototype(
   BOOL res;
   int res2;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_setPrototypeOf);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_SET_PROTOTYPE_OF);
   if (!s)
     return -1;
   if (JS_IsUndefined(method))
@@ -186,7 +311,7 @@ int js_proxy_is_extensible(JSContext* ctx, JSValueConst obj) {
   BOOL res;
   int res2;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_isExtensible);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_IS_EXTENSIBLE);
   if (!s)
     return -1;
   if (JS_IsUndefined(method))
@@ -211,7 +336,7 @@ int js_proxy_prevent_extensions(JSContext* ctx, JSValueConst obj) {
   BOOL res;
   int res2;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_preventExtensions);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_PREVENT_EXTENSIONS);
   if (!s)
     return -1;
   if (JS_IsUndefined(method))
@@ -240,7 +365,7 @@ int js_proxy_has(JSContext* ctx, JSValueConst obj, JSAtom atom) {
   JSValueConst args[2];
   BOOL res2;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_has);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_HAS);
   if (!s)
     return -1;
   if (JS_IsUndefined(method))
@@ -257,9 +382,9 @@ int js_proxy_has(JSContext* ctx, JSValueConst obj, JSAtom atom) {
   if (JS_IsException(ret1))
     return -1;
   ret = JS_ToBoolFree(ctx, ret1);
-  if (!ret) {
+  p = JS_VALUE_GET_OBJ(s->target);
+  if (!ret && !js_proxy_target_is_unconstrained(p, atom)) {
     JSPropertyDescriptor desc;
-    p = JS_VALUE_GET_OBJ(s->target);
     res = JS_GetOwnPropertyInternal(ctx, &desc, p, atom);
     if (res < 0)
       return -1;
@@ -286,7 +411,7 @@ JSValue js_proxy_get(
   JSValueConst args[3];
   JSPropertyDescriptor desc;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_get);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_GET);
   if (!s)
     return JS_EXCEPTION;
   /* Note: recursion is possible thru the prototype of s->target */
@@ -305,6 +430,8 @@ JSValue js_proxy_get(
   JS_FreeValue(ctx, atom_val);
   if (JS_IsException(ret))
     return JS_EXCEPTION;
+  if (js_proxy_target_is_unconstrained(JS_VALUE_GET_OBJ(s->target), atom))
+    return ret;
   res =
       JS_GetOwnPropertyInternal(ctx, &desc, JS_VALUE_GET_OBJ(s->target), atom);
   if (res < 0) {
@@ -344,7 +471,7 @@ int js_proxy_set(
   int ret, res;
   JSValueConst args[4];
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_set);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_SET);
   if (!s)
     return -1;
   if (JS_IsUndefined(method)) {
@@ -373,6 +500,8 @@ int js_proxy_set(
   ret = JS_ToBoolFree(ctx, ret1);
   if (ret) {
     JSPropertyDescriptor desc;
+    if (js_proxy_target_is_unconstrained(JS_VALUE_GET_OBJ(s->target), atom))
+      return ret;
     res = JS_GetOwnPropertyInternal(
         ctx, &desc, JS_VALUE_GET_OBJ(s->target), atom);
     if (res < 0)
@@ -465,7 +594,8 @@ int js_proxy_get_own_property(
   JSValueConst args[2];
   JSPropertyDescriptor result_desc, target_desc;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_getOwnPropertyDescriptor);
+  s = get_proxy_method(
+      ctx, &method, obj, JS_PROXY_TRAP_GET_OWN_PROPERTY_DESCRIPTOR);
   if (!s)
     return -1;
   p = JS_VALUE_GET_OBJ(s->target);
@@ -575,7 +705,7 @@ int js_proxy_define_own_property(
   JSPropertyDescriptor desc;
   BOOL setting_not_configurable;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_defineProperty);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_DEFINE_PROPERTY);
   if (!s)
     return -1;
   if (JS_IsUndefined(method)) {
@@ -667,7 +797,7 @@ int js_proxy_delete_property(JSContext* ctx, JSValueConst obj, JSAtom atom) {
   int res, res2, is_extensible;
   JSValueConst args[2];
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_deleteProperty);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_DELETE_PROPERTY);
   if (!s)
     return -1;
   if (JS_IsUndefined(method)) {
@@ -686,7 +816,8 @@ int js_proxy_delete_property(JSContext* ctx, JSValueConst obj, JSAtom atom) {
   if (JS_IsException(ret))
     return -1;
   res = JS_ToBoolFree(ctx, ret);
-  if (res) {
+  if (res &&
+      !js_proxy_target_is_unconstrained(JS_VALUE_GET_OBJ(s->target), atom)) {
     JSPropertyDescriptor desc;
     res2 = JS_GetOwnPropertyInternal(
         ctx, &desc, JS_VALUE_GET_OBJ(s->target), atom);
@@ -735,7 +866,7 @@ int js_proxy_get_own_property_names(
   JSPropertyDescriptor desc;
   int res, is_extensible, idx;
 
-  s = get_proxy_method(ctx, &method, obj, JS_ATOM_ownKeys);
+  s = get_proxy_method(ctx, &method, obj, JS_PROXY_TRAP_OWN_KEYS);
   if (!s)
     return -1;
   if (JS_IsUndefined(method)) {
@@ -861,7 +992,7 @@ JSValue js_proxy_call_constructor(
   JSValue method, arg_array, ret;
   JSValueConst args[3];
 
-  s = get_proxy_method(ctx, &method, func_obj, JS_ATOM_construct);
+  s = get_proxy_method(ctx, &method, func_obj, JS_PROXY_TRAP_CONSTRUCT);
   if (!s)
     return JS_EXCEPTION;
   if (!JS_IsConstructor(ctx, s->target))
@@ -901,7 +1032,7 @@ JSValue js_proxy_call(
   if (flags & JS_CALL_FLAG_CONSTRUCTOR)
     return js_proxy_call_constructor(ctx, func_obj, this_obj, argc, argv);
 
-  s = get_proxy_method(ctx, &method, func_obj, JS_ATOM_apply);
+  s = get_proxy_method(ctx, &method, func_obj, JS_PROXY_TRAP_APPLY);
   if (!s)
     return JS_EXCEPTION;
   if (!s->is_func) {
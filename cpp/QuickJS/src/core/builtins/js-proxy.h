@@ -32,6 +32,11 @@
 extern "C" {
 #endif
 
+void js_proxy_free_trap_cache(JSRuntime* rt, JSContext* ctx);
+void js_proxy_mark_trap_cache(
+    JSRuntime* rt,
+    JSContext* ctx,
+    JS_MarkFunc* mark_func);
 int js_proxy_is_extensible(JSContext* ctx, JSValueConst obj);
 int js_proxy_prevent_extensions(JSContext* ctx, JSValueConst obj);
 int js_proxy_has(JSContext* ctx, JSValueConst obj, JSAtom atom);
@@ -490,8 +490,8 @@ int lre_check_stack_overflow(void* opaque, size_t alloca_size) {
 int lre_check_timeout(void* opaque) {
   JSContext* ctx = opaque;
   JSRuntime* rt = ctx->rt;
-  return (
-      rt->interrupt_handler && rt->interrupt_handler(rt, rt->interrupt_opaque));
+  return js_check_budget(rt) ||
+      (rt->interrupt_handler && rt->interrupt_handler(rt, rt->interrupt_opaque));
 }
 
 void* lre_realloc(void* opaque, void* ptr, size_t size) {
@@ -596,7 +596,7 @@ static JSValue js_regexp_exec(JSContext *ctx, JSValueConst this_val,
       goto fail;
   }
   shift = str->is_wide_char;
-  str_buf = str->u.str8;
+  str_buf = shift ? (uint8_t*)js_string_str16(str) : (uint8_t*)js_string_str8(str);
   if (last_index > str->len) {
     rc = 2;
   } else {
@@ -795,7 +795,7 @@ JS_RegExpDelete(JSContext* ctx, JSValueConst this_val, JSValueConst arg) {
       goto fail;
   }
   shift = str->is_wide_char;
-  str_buf = str->u.str8;
+  str_buf = shift ? (uint8_t*)js_string_str16(str) : (uint8_t*)js_string_str8(str);
   next_src_pos = 0;
   for (;;) {
     if (last_index > str->len)
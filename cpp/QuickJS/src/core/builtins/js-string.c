@@ -434,14 +434,16 @@ int string_indexof_char(JSString* p, int c, int from) {
   /* assuming 0 <= from <= p->len */
   int i, len = p->len;
   if (p->is_wide_char) {
+    const uint16_t* str16 = js_string_str16(p);
     for (i = from; i < len; i++) {
-      if (p->u.str16[i] == c)
+      if (str16[i] == c)
         return i;
     }
   } else {
     if ((c & ~0xff) == 0) {
+      const uint8_t* str8 = js_string_str8(p);
       for (i = from; i < len; i++) {
-        if (p->u.str8[i] == (uint8_t)c)
+        if (str8[i] == (uint8_t)c)
           return i;
       }
     }
@@ -478,14 +480,16 @@ int64_t string_advance_index(JSString* p, int64_t index, BOOL unicode) {
 /* return the position of the first invalid character in the string or
    -1 if none */
 int js_string_find_invalid_codepoint(JSString* p) {
+  const uint16_t* str16;
   int i;
   if (!p->is_wide_char)
     return -1;
+  str16 = js_string_str16(p);
   for (i = 0; i < p->len; i++) {
-    uint32_t c = p->u.str16[i];
+    uint32_t c = str16[i];
     if (is_surrogate(c)) {
       if (is_hi_surrogate(c) && (i + 1) < p->len &&
-          is_lo_surrogate(p->u.str16[i + 1])) {
+          is_lo_surrogate(str16[i + 1])) {
         i++;
       } else {
         return i;
@@ -532,7 +536,7 @@ JSValue js_string_toWellFormed(
   if (i < 0)
     return str;
 
-  ret = js_new_string16_len(ctx, p->u.str16, p->len);
+  ret = js_new_string16_len(ctx, js_string_str16(p), p->len);
   JS_FreeValue(ctx, str);
   if (JS_IsException(ret))
     return JS_EXCEPTION;
@@ -1353,16 +1357,17 @@ int string_prevc(JSString* p, int* pidx) {
     return 0;
   idx--;
   if (p->is_wide_char) {
-    c = p->u.str16[idx];
+    const uint16_t* str16 = js_string_str16(p);
+    c = str16[idx];
     if (is_lo_surrogate(c) && idx > 0) {
-      c1 = p->u.str16[idx - 1];
+      c1 = str16[idx - 1];
       if (is_hi_surrogate(c1)) {
         c = from_surrogate(c1, c);
         idx--;
       }
     }
   } else {
-    c = p->u.str8[idx];
+    c = js_string_str8(p)[idx];
   }
   *pidx = idx;
   return c;
@@ -1395,6 +1400,87 @@ BOOL test_final_sigma(JSString* p, int sigma_pos) {
   return !lre_is_cased(c1);
 }
 
+#define CASE_CONV8_ONES 0x0101010101010101ULL
+
+/* case conversion of an 8 bit character. Return -1 if the result is
+   not a single 8 bit character (0xb5, 0xdf and 0xff to upper case) */
+static inline int case_conv8(int c, int to_lower) {
+  if (to_lower) {
+    if ((unsigned)(c - 'A') < 26 || ((unsigned)(c - 0xc0) < 0x1f && c != 0xd7))
+      c += 0x20;
+  } else {
+    if ((unsigned)(c - 'a') < 26 || ((unsigned)(c - 0xe0) < 0x1f && c != 0xf7))
+      c -= 0x20;
+    else if (c == 0xb5 || c == 0xdf || c == 0xff)
+      return -1;
+  }
+  return c;
+}
+
+/* 'w' contains 8 ASCII characters. Return 0x80 in the bytes which
+   are modified by the case conversion */
+static inline uint64_t case_conv8_ascii_mask(uint64_t w, int to_lower) {
+  uint64_t first = to_lower ? 'A' : 'a';
+  uint64_t a = w + (0x80 - first) * CASE_CONV8_ONES;
+  uint64_t b = w + (0x80 - first - 26) * CASE_CONV8_ONES;
+  return a & ~b & (0x80 * CASE_CONV8_ONES);
+}
+
+/* Case conversion of an 8 bit string, 8 ASCII characters at a
+   time. 'val' is returned if it is not modified. Return JS_UNDEFINED
+   (and 'val' is not freed) if the result is not an 8 bit string. */
+static JSValue js_string_case_conv8(JSContext* ctx, JSValue val, int to_lower) {
+  JSString* p = JS_VALUE_GET_STRING(val);
+  const uint8_t* src = js_string_str8(p);
+  uint32_t i, len = p->len;
+  JSString* str;
+  uint64_t w;
+  int c;
+
+  i = 0;
+  while (i < len) {
+    if (i + 8 <= len) {
+      w = get_u64(src + i);
+      if (!(w & (0x80 * CASE_CONV8_ONES)) &&
+          !case_conv8_ascii_mask(w, to_lower)) {
+        i += 8;
+        continue;
+      }
+    }
+    if (case_conv8(src[i], to_lower) != src[i])
+      break;
+    i++;
+  }
+  if (i == len)
+    return val;
+
+  str = js_alloc_string(ctx, len, 0);
+  if (!str) {
+    JS_FreeValue(ctx, val);
+    return JS_EXCEPTION;
+  }
+  memcpy(str->u.str8, src, i);
+  while (i < len) {
+    if (i + 8 <= len) {
+      w = get_u64(src + i);
+      if (!(w & (0x80 * CASE_CONV8_ONES))) {
+        put_u64(str->u.str8 + i, w ^ (case_conv8_ascii_mask(w, to_lower) >> 2));
+        i += 8;
+        continue;
+      }
+    }
+    c = case_conv8(src[i], to_lower);
+    if (c < 0) {
+      js_free_string(ctx->rt, str);
+      return JS_UNDEFINED;
+    }
+    str->u.str8[i++] = c;
+  }
+  str->u.str8[len] = '\0';
+  JS_FreeValue(ctx, val);
+  return JS_MKPTR(JS_TAG_STRING, str);
+}
+
 JSValue js_string_toLowerCase(
     JSContext* ctx,
     JSValueConst this_val,
@@ -1413,6 +1499,11 @@ JSValue js_string_toLowerCase(
   p = JS_VALUE_GET_STRING(val);
   if (p->len == 0)
     return val;
+  if (!p->is_wide_char) {
+    JSValue ret = js_string_case_conv8(ctx, val, to_lower);
+    if (!JS_IsUndefined(ret))
+      return ret;
+  }
   if (string_buffer_init(ctx, b, p->len))
     goto fail;
   for (i = 0; i < p->len;) {
@@ -1730,7 +1821,7 @@ JSValue js_string_iterator_next(
   if (c <= 0xffff) {
     return js_new_string_char(ctx, c);
   } else {
-    return js_new_string16_len(ctx, p->u.str16 + start, 2);
+    return js_new_string16_len(ctx, js_string_str16(p) + start, 2);
   }
 }
 
@@ -1051,28 +1051,36 @@ JSValue js_typed_array_fill(
   if (typed_array_is_detached(ctx, p))
     return JS_ThrowTypeErrorDetachedArrayBuffer(ctx);
 
+  if (k >= final)
+    return JS_DupValue(ctx, this_val);
+
   shift = typed_array_size_log2(p->class_id);
+  /* a value made of identical bytes (0, -1...) is filled with memset() */
+  if (shift == 0 ||
+      ((v64 ^ ((v64 & 0xff) * 0x0101010101010101)) &
+       (~(uint64_t)0 >> (64 - (8 << shift)))) == 0) {
+    memset(p->u.array.u.uint8_ptr + (k << shift), v64, (final - k) << shift);
+    return JS_DupValue(ctx, this_val);
+  }
+  /* the loops use a local pointer so that the compiler can vectorize them */
   switch (shift) {
-    case 0:
-      if (k < final) {
-        memset(p->u.array.u.uint8_ptr + k, v64, final - k);
-      }
-      break;
-    case 1:
-      for (; k < final; k++) {
-        p->u.array.u.uint16_ptr[k] = v64;
-      }
-      break;
-    case 2:
-      for (; k < final; k++) {
-        p->u.array.u.uint32_ptr[k] = v64;
-      }
-      break;
-    case 3:
-      for (; k < final; k++) {
-        p->u.array.u.uint64_ptr[k] = v64;
-      }
-      break;
+    case 1: {
+      uint16_t* pv = p->u.array.u.uint16_ptr;
+      uint16_t v = v64;
+      for (; k < final; k++)
+        pv[k] = v;
+    } break;
+    case 2: {
+      uint32_t* pv = p->u.array.u.uint32_ptr;
+      uint32_t v = v64;
+      for (; k < final; k++)
+        pv[k] = v;
+    } break;
+    case 3: {
+      uint64_t* pv = p->u.array.u.uint64_ptr;
+      for (; k < final; k++)
+        pv[k] = v64;
+    } break;
     default:
       abort();
   }
@@ -1148,6 +1156,64 @@ exception:
 #define special_lastIndexOf 1
 #define special_includes -1
 
+/* The scans of indexOf/lastIndexOf/includes test blocks of TA_SCAN_BLOCK
+   elements without early exit so that the compiler can vectorize the
+   comparisons, only the block with a match is searched element by element.
+   Search from 'k' up to 'stop' excluded in the direction of 'inc' and
+   return the index of the first element 'x' satisfying 'cond' or -1. */
+#define TA_SCAN_BLOCK 32
+
+#define DEF_TA_SCAN(name, type, cond)                                 \
+  static int name(const type* pv, int k, int stop, int inc, type v) { \
+    int i, found;                                                     \
+    type x;                                                           \
+    if (inc > 0) {                                                    \
+      for (; stop - k >= TA_SCAN_BLOCK; k += TA_SCAN_BLOCK) {         \
+        found = 0;                                                    \
+        for (i = 0; i < TA_SCAN_BLOCK; i++) {                         \
+          x = pv[k + i];                                              \
+          found |= (cond);                                            \
+        }                                                             \
+        if (found)                                                    \
+          break;                                                      \
+      }                                                               \
+      for (; k < stop; k++) {                                         \
+        x = pv[k];                                                    \
+        if (cond)                                                     \
+          return k;                                                   \
+      }                                                               \
+    } else {                                                          \
+      for (; k - stop >= TA_SCAN_BLOCK; k -= TA_SCAN_BLOCK) {         \
+        found = 0;                                                    \
+        for (i = 0; i < TA_SCAN_BLOCK; i++) {                         \
+          x = pv[k - TA_SCAN_BLOCK + 1 + i];                          \
+          found |= (cond);                                            \
+        }                                                             \
+        if (found)                                                    \
+          break;                                                      \
+      }                                                               \
+      for (; k > stop; k--) {                                         \
+        x = pv[k];                                                    \
+        if (cond)                                                     \
+          return k;                                                   \
+      }                                                               \
+    }                                                                 \
+    return -1;                                                        \
+  }
+
+DEF_TA_SCAN(js_TA_scan_u8, uint8_t, x == v)
+DEF_TA_SCAN(js_TA_scan_u16, uint16_t, x == v)
+DEF_TA_SCAN(js_TA_scan_u32, uint32_t, x == v)
+#ifdef CONFIG_BIGNUM
+DEF_TA_SCAN(js_TA_scan_u64, uint64_t, x == v)
+#endif
+DEF_TA_SCAN(js_TA_scan_f32, float, x == v)
+DEF_TA_SCAN(js_TA_scan_f64, double, x == v)
+DEF_TA_SCAN(js_TA_scan_nan_f32, float, x != x)
+DEF_TA_SCAN(js_TA_scan_nan_f64, double, x != x)
+DEF_TA_SCAN(js_TA_scan_nan_f16, uint16_t, (x & 0x7fff) > 0x7c00)
+DEF_TA_SCAN(js_TA_scan_zero_f16, uint16_t, (x & 0x7fff) == 0)
+
 JSValue js_typed_array_indexOf(
     JSContext* ctx,
     JSValueConst this_val,
@@ -1277,12 +1343,7 @@ JSValue js_typed_array_indexOf(
           if (pp)
             res = pp - pv;
         } else {
-          for (; k != stop; k += inc) {
-            if (pv[k] == v) {
-              res = k;
-              break;
-            }
-          }
+          res = js_TA_scan_u8(pv, k, stop, inc, v);
         }
       }
       break;
@@ -1297,12 +1358,7 @@ JSValue js_typed_array_indexOf(
       scan16:
         pv = p->u.array.u.uint16_ptr;
         v = v64;
-        for (; k != stop; k += inc) {
-          if (pv[k] == v) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_u16(pv, k, stop, inc, v);
       }
       break;
     case JS_CLASS_INT32_ARRAY:
@@ -1316,12 +1372,7 @@ JSValue js_typed_array_indexOf(
       scan32:
         pv = p->u.array.u.uint32_ptr;
         v = v64;
-        for (; k != stop; k += inc) {
-          if (pv[k] == v) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_u32(pv, k, stop, inc, v);
       }
       break;
     case JS_CLASS_FLOAT16_ARRAY:
@@ -1332,29 +1383,14 @@ JSValue js_typed_array_indexOf(
         /* special case: indexOf returns -1, includes finds NaN */
         if (special != special_includes)
           goto done;
-        for (; k != stop; k += inc) {
-          if (isfp16nan(pv[k])) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_nan_f16(pv, k, stop, inc, 0);
       } else if (d == 0) {
         // special case: includes also finds negative zero
         const uint16_t* pv = p->u.array.u.fp16_ptr;
-        for (; k != stop; k += inc) {
-          if (isfp16zero(pv[k])) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_zero_f16(pv, k, stop, inc, 0);
       } else if (hf = tofp16(d), d == fromfp16(hf)) {
         const uint16_t* pv = p->u.array.u.fp16_ptr;
-        for (; k != stop; k += inc) {
-          if (pv[k] == hf) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_u16(pv, k, stop, inc, hf);
       }
       break;
     case JS_CLASS_FLOAT32_ARRAY:
@@ -1365,20 +1401,10 @@ JSValue js_typed_array_indexOf(
         /* special case: indexOf returns -1, includes finds NaN */
         if (special != special_includes)
           goto done;
-        for (; k != stop; k += inc) {
-          if (isnan(pv[k])) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_nan_f32(pv, k, stop, inc, 0);
       } else if ((f = (float)d) == d) {
         const float* pv = p->u.array.u.float_ptr;
-        for (; k != stop; k += inc) {
-          if (pv[k] == f) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_f32(pv, k, stop, inc, f);
       }
       break;
     case JS_CLASS_FLOAT64_ARRAY:
@@ -1389,20 +1415,10 @@ JSValue js_typed_array_indexOf(
         /* special case: indexOf returns -1, includes finds NaN */
         if (special != special_includes)
           goto done;
-        for (; k != stop; k += inc) {
-          if (isnan(pv[k])) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_nan_f64(pv, k, stop, inc, 0);
       } else {
         const double* pv = p->u.array.u.double_ptr;
-        for (; k != stop; k += inc) {
-          if (pv[k] == d) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_f64(pv, k, stop, inc, d);
       }
       break;
 #ifdef CONFIG_BIGNUM
@@ -1418,12 +1434,7 @@ JSValue js_typed_array_indexOf(
       scan64:
         pv = p->u.array.u.uint64_ptr;
         v = v64;
-        for (; k != stop; k += inc) {
-          if (pv[k] == v) {
-            res = k;
-            break;
-          }
-        }
+        res = js_TA_scan_u64(pv, k, stop, inc, v);
       }
       break;
 #endif
@@ -1462,7 +1473,7 @@ JSValue js_typed_array_join(
       goto exception;
     p = JS_VALUE_GET_STRING(sep);
     if (p->len == 1 && !p->is_wide_char)
-      c = p->u.str8[0];
+      c = js_string_str8(p)[0];
     else
       c = -1;
   }
@@ -1874,6 +1885,200 @@ int js_TA_cmp_generic(const void* a, const void* b, void* opaque) {
   return cmp;
 }
 
+/* Default order of TypedArray.prototype.sort(): the arrays of at least
+   TA_RADIX_SORT_MIN_LEN elements are sorted with a LSD radix sort on the
+   bit patterns of the elements. The signed integers and the floats are
+   mapped to unsigned keys with the same order, so -0 comes before +0. The
+   NaNs are moved to the end of the array before sorting. */
+#define TA_RADIX_SORT_MIN_LEN 128
+
+#define DEF_TA_RADIX_SORT(name, type)                          \
+  static void name(type* a, type* tmp, size_t len) {           \
+    uint32_t count[sizeof(type)][256];                         \
+    uint32_t *c, sum, n;                                       \
+    type *src, *dst, *t, x;                                    \
+    size_t i;                                                  \
+    int b, j, shift;                                           \
+                                                               \
+    if (len < 2)                                               \
+      return;                                                  \
+    memset(count, 0, sizeof(count));                           \
+    for (i = 0; i < len; i++) {                                \
+      x = a[i];                                                \
+      for (b = 0; b < sizeof(type); b++)                       \
+        count[b][(x >> (8 * b)) & 0xff]++;                     \
+    }                                                          \
+    src = a;                                                   \
+    dst = tmp;                                                 \
+    for (b = 0; b < sizeof(type); b++) {                       \
+      c = count[b];                                            \
+      shift = 8 * b;                                           \
+      /* skip the pass if all the keys have the same byte */   \
+      if (c[(src[0] >> shift) & 0xff] == len)                  \
+        continue;                                              \
+      sum = 0;                                                 \
+      for (j = 0; j < 256; j++) {                              \
+        n = c[j];                                              \
+        c[j] = sum;                                            \
+        sum += n;                                              \
+      }                                                        \
+      for (i = 0; i < len; i++) {                              \
+        x = src[i];                                            \
+        dst[c[(x >> shift) & 0xff]++] = x;                     \
+      }                                                        \
+      t = src;                                                 \
+      src = dst;                                               \
+      dst = t;                                                 \
+    }                                                          \
+    if (src != a)                                              \
+      memcpy(a, src, len * sizeof(type));                      \
+  }
+
+DEF_TA_RADIX_SORT(js_TA_radix_sort_u16, uint16_t)
+DEF_TA_RADIX_SORT(js_TA_radix_sort_u32, uint32_t)
+DEF_TA_RADIX_SORT(js_TA_radix_sort_u64, uint64_t)
+
+/* Map the floats to unsigned keys: the negative numbers are complemented and
+   the positive numbers get their sign bit set. The NaNs are copied to 'tmp'
+   and the keys of the other elements packed at the start of 'a'. Return the
+   number of NaNs. */
+#define DEF_TA_FLOAT_KEYS(name, type, sign, is_nan)                     \
+  static size_t name(type* a, type* tmp, size_t len) {                 \
+    size_t i, m = 0, nan_count = 0;                                    \
+    type x;                                                            \
+    for (i = 0; i < len; i++) {                                        \
+      x = a[i];                                                        \
+      if (unlikely(is_nan))                                            \
+        tmp[nan_count++] = x;                                          \
+      else                                                             \
+        a[m++] = x ^ ((x & (sign)) ? (type) ~(type)0 : (type)(sign));  \
+    }                                                                  \
+    return nan_count;                                                  \
+  }                                                                    \
+                                                                       \
+  static void name##_restore(type* a, size_t len) {                    \
+    size_t i;                                                          \
+    type x;                                                            \
+    for (i = 0; i < len; i++) {                                        \
+      x = a[i];                                                        \
+      a[i] = x ^ ((x & (sign)) ? (type)(sign) : (type) ~(type)0);      \
+    }                                                                  \
+  }
+
+DEF_TA_FLOAT_KEYS(js_TA_float16_keys, uint16_t, 0x8000, isfp16nan(x))
+DEF_TA_FLOAT_KEYS(
+    js_TA_float32_keys,
+    uint32_t,
+    0x80000000,
+    (x & 0x7fffffff) > 0x7f800000)
+DEF_TA_FLOAT_KEYS(
+    js_TA_float64_keys,
+    uint64_t,
+    0x8000000000000000,
+    (x & 0x7fffffffffffffff) > 0x7ff0000000000000)
+
+/* counting sort of the bytes, 'bias' maps the elements to their order */
+static void js_TA_counting_sort_u8(uint8_t* a, size_t len, int bias) {
+  size_t count[256], i, pos;
+  int j;
+
+  memset(count, 0, sizeof(count));
+  for (i = 0; i < len; i++)
+    count[a[i] ^ bias]++;
+  pos = 0;
+  for (j = 0; j < 256; j++) {
+    memset(a + pos, j ^ bias, count[j]);
+    pos += count[j];
+  }
+}
+
+/* Sort the elements of 'a' in the default order. Return -1 if the
+   temporary buffer cannot be allocated. */
+static int js_TA_radix_sort(
+    JSContext* ctx,
+    JSClassID class_id,
+    void* a,
+    size_t len) {
+  size_t elt_size, i, nan_count;
+  void* tmp;
+
+  switch (class_id) {
+    case JS_CLASS_INT8_ARRAY:
+      js_TA_counting_sort_u8(a, len, 0x80);
+      return 0;
+    case JS_CLASS_UINT8C_ARRAY:
+    case JS_CLASS_UINT8_ARRAY:
+      js_TA_counting_sort_u8(a, len, 0);
+      return 0;
+    default:
+      break;
+  }
+
+  elt_size = 1 << typed_array_size_log2(class_id);
+  tmp = js_malloc(ctx, len * elt_size);
+  if (!tmp)
+    return -1;
+  switch (class_id) {
+    case JS_CLASS_INT16_ARRAY:
+      for (i = 0; i < len; i++)
+        ((uint16_t*)a)[i] ^= 0x8000;
+      js_TA_radix_sort_u16(a, tmp, len);
+      for (i = 0; i < len; i++)
+        ((uint16_t*)a)[i] ^= 0x8000;
+      break;
+    case JS_CLASS_UINT16_ARRAY:
+      js_TA_radix_sort_u16(a, tmp, len);
+      break;
+    case JS_CLASS_INT32_ARRAY:
+      for (i = 0; i < len; i++)
+        ((uint32_t*)a)[i] ^= 0x80000000;
+      js_TA_radix_sort_u32(a, tmp, len);
+      for (i = 0; i < len; i++)
+        ((uint32_t*)a)[i] ^= 0x80000000;
+      break;
+    case JS_CLASS_UINT32_ARRAY:
+      js_TA_radix_sort_u32(a, tmp, len);
+      break;
+#ifdef CONFIG_BIGNUM
+    case JS_CLASS_BIG_INT64_ARRAY:
+      for (i = 0; i < len; i++)
+        ((uint64_t*)a)[i] ^= 0x8000000000000000;
+      js_TA_radix_sort_u64(a, tmp, len);
+      for (i = 0; i < len; i++)
+        ((uint64_t*)a)[i] ^= 0x8000000000000000;
+      break;
+    case JS_CLASS_BIG_UINT64_ARRAY:
+      js_TA_radix_sort_u64(a, tmp, len);
+      break;
+#endif
+    case JS_CLASS_FLOAT16_ARRAY:
+      nan_count = js_TA_float16_keys(a, tmp, len);
+      len -= nan_count;
+      memcpy((uint16_t*)a + len, tmp, nan_count * elt_size);
+      js_TA_radix_sort_u16(a, tmp, len);
+      js_TA_float16_keys_restore(a, len);
+      break;
+    case JS_CLASS_FLOAT32_ARRAY:
+      nan_count = js_TA_float32_keys(a, tmp, len);
+      len -= nan_count;
+      memcpy((uint32_t*)a + len, tmp, nan_count * elt_size);
+      js_TA_radix_sort_u32(a, tmp, len);
+      js_TA_float32_keys_restore(a, len);
+      break;
+    case JS_CLASS_FLOAT64_ARRAY:
+      nan_count = js_TA_float64_keys(a, tmp, len);
+      len -= nan_count;
+      memcpy((uint64_t*)a + len, tmp, nan_count * elt_size);
+      js_TA_radix_sort_u64(a, tmp, len);
+      js_TA_float64_keys_restore(a, len);
+      break;
+    default:
+      abort();
+  }
+  js_free(ctx, tmp);
+  return 0;
+}
+
 JSValue js_typed_array_sort(
     JSContext* ctx,
     JSValueConst this_val,
@@ -2009,6 +2214,9 @@ JSValue js_typed_array_sort(
         js_free(ctx, array_tmp);
       }
       js_free(ctx, array_idx);
+    } else if (len >= TA_RADIX_SORT_MIN_LEN) {
+      if (js_TA_radix_sort(ctx, p->class_id, array_ptr, len))
+        return JS_EXCEPTION;
     } else {
       rqsort(array_ptr, len, elt_size, cmpfun, &tsc);
       if (tsc.exception)
@@ -33,6 +33,7 @@
 #include "exception.h"
 #include "function.h"
 #include "gc.h"
+#include "jit.h"
 #include "malloc.h"
 #include "module.h"
 #include "object.h"
@@ -57,9 +58,18 @@ void free_function_bytecode(JSRuntime* rt, JSFunctionBytecode* b) {
                JS_AtomGetStrRT(rt, buf, sizeof(buf), b->func_name));
     }
 #endif
-  free_bytecode_atoms(rt, b->byte_code_buf, b->byte_code_len, TRUE);
+  if (b->code_template) {
+    js_code_template_free(rt, b->code_template);
+  } else if (b->byte_code_buf) {
+    free_bytecode_atoms(rt, b->byte_code_buf, b->byte_code_len, TRUE);
+    if (!b->read_only_bytecode)
+      js_free_rt(rt, b->byte_code_buf);
+  }
   if (b->ic != NULL)
     free_ic(b->ic);
+#ifdef ENABLE_JIT
+  js_jit_free(rt, b);
+#endif
 
   if (b->vardefs) {
     for (i = 0; i < b->arg_count + b->var_count; i++) {
@@ -79,8 +89,11 @@ void free_function_bytecode(JSRuntime* rt, JSFunctionBytecode* b) {
   JS_FreeAtomRT(rt, b->func_name);
   if (b->has_debug) {
     JS_FreeAtomRT(rt, b->debug.filename);
-    js_free_rt(rt, b->debug.pc2line_buf);
-    js_free_rt(rt, b->debug.source);
+    if (!b->code_template) {
+      js_free_rt(rt, b->debug.pc2line_buf);
+      js_free_rt(rt, b->debug.pc2column_buf);
+      js_free_rt(rt, b->debug.source);
+    }
 #if QUICKJS_DEBUG
     if (b->debugger.breakpoints)
       js_free_rt(rt, b->debugger.breakpoints);
@@ -155,6 +168,7 @@ typedef enum BCTagEnum {
   BC_TAG_DATE,
   BC_TAG_OBJECT_VALUE,
   BC_TAG_OBJECT_REFERENCE,
+  BC_TAG_OBJECT_SHAPE,
 } BCTagEnum;
 
 typedef struct BCWriterState {
@@ -174,6 +188,9 @@ typedef struct BCWriterState {
   int sab_tab_size;
   /* list of referenced objects (used if allow_reference = TRUE) */
   JSObjectList object_list;
+  /* hashed shapes of the written objects, used as a set of pointers.
+     Their reference count is incremented. */
+  JSObjectList shape_list;
 } BCWriterState;
 
 #ifdef DUMP_READ_OBJECT
@@ -198,6 +215,7 @@ static const char* const bc_tag_str[] = {
     "Date",
     "ObjectValue",
     "ObjectReference",
+    "ObjectShape",
 };
 #endif
 
@@ -355,21 +373,298 @@ static void bc_byte_swap(uint8_t* bc_buf, int bc_len) {
   }
 }
 
-static int
-JS_WriteFunctionBytecode(BCWriterState* s, const uint8_t* bc_buf1, int bc_len) {
+/* Code templates */
+
+/* return the opcode patched to 'op' by the inline cache or -1 */
+static int js_ic_unpatched_opcode(int op) {
+  switch (op) {
+    case OP_get_field_ic:
+      return OP_get_field;
+    case OP_get_field2_ic:
+      return OP_get_field2;
+    case OP_put_field_ic:
+      return OP_put_field;
+    case OP_get_loc_field_ic:
+      return OP_get_loc_field;
+    default:
+      return -1;
+  }
+}
+
+static uint32_t code_template_hash_buf(uint32_t h, const void* buf, int len) {
+  const uint8_t* p = (const uint8_t*)buf;
+  int i;
+  for (i = 0; i < len; i++)
+    h = (h + p[i]) * 0x9e370001;
+  return (h + len) * 0x9e370001;
+}
+
+static uint32_t code_template_hash(JSFunctionBytecode* b) {
+  uint32_t h, i;
+
+  h = code_template_hash_buf(1, b->byte_code_buf, b->byte_code_len);
+  if (b->ic) {
+    for (i = 0; i < b->ic->count; i++)
+      h = (h + b->ic->cache[i].atom) * 0x9e370001;
+  }
+  if (b->has_debug) {
+    h = code_template_hash_buf(h, b->debug.pc2line_buf, b->debug.pc2line_len);
+    h = code_template_hash_buf(
+        h, b->debug.pc2column_buf, b->debug.pc2column_len);
+    h = code_template_hash_buf(h, b->debug.source, b->debug.source_len);
+  }
+  return h;
+}
+
+static BOOL code_template_equal_buf(
+    const void* buf1,
+    int len1,
+    const void* buf2,
+    int len2) {
+  return len1 == len2 && (len1 == 0 || !memcmp(buf1, buf2, len1));
+}
+
+/* compare the unpatched bytecode 'bc_buf' with the bytecode of 't'
+   which may have been patched since its creation */
+static BOOL code_template_equal_code(
+    JSCodeTemplate* t,
+    const uint8_t* bc_buf,
+    int bc_len) {
+  const uint8_t* tc_buf = t->byte_code_buf;
   int pos, len, op;
+  uint32_t idx;
+
+  if (t->byte_code_len != bc_len)
+    return FALSE;
+  if (!memcmp(tc_buf, bc_buf, bc_len))
+    return TRUE;
+  pos = 0;
+  while (pos < bc_len) {
+    op = tc_buf[pos];
+    len = short_opcode_info(op).size;
+    if (pos + len > bc_len)
+      return FALSE;
+    if (op != bc_buf[pos]) {
+      if (js_ic_unpatched_opcode(op) != bc_buf[pos])
+        return FALSE;
+      idx = get_u32(tc_buf + pos + 1);
+      if (idx >= t->ic_count || t->ic_atoms[idx] != get_u32(bc_buf + pos + 1))
+        return FALSE;
+      if (memcmp(tc_buf + pos + 5, bc_buf + pos + 5, len - 5))
+        return FALSE;
+    } else if (memcmp(tc_buf + pos + 1, bc_buf + pos + 1, len - 1)) {
+      return FALSE;
+    }
+    pos += len;
+  }
+  return TRUE;
+}
+
+static BOOL code_template_equal(
+    JSCodeTemplate* t,
+    uint32_t hash,
+    JSFunctionBytecode* b) {
+  uint32_t ic_count = b->ic ? b->ic->count : 0;
+  uint32_t i;
+
+  if (t->hash != hash || t->ic_count != ic_count)
+    return FALSE;
+  for (i = 0; i < ic_count; i++) {
+    if (t->ic_atoms[i] != b->ic->cache[i].atom)
+      return FALSE;
+  }
+  if (b->has_debug) {
+    if (!code_template_equal_buf(
+            t->pc2line_buf,
+            t->pc2line_len,
+            b->debug.pc2line_buf,
+            b->debug.pc2line_len) ||
+        !code_template_equal_buf(
+            t->pc2column_buf,
+            t->pc2column_len,
+            b->debug.pc2column_buf,
+            b->debug.pc2column_len) ||
+        !code_template_equal_buf(
+            t->source, t->source_len, b->debug.source, b->debug.source_len) ||
+        !t->source != !b->debug.source)
+      return FALSE;
+  } else if (t->pc2line_len || t->pc2column_len || t->source_len) {
+    return FALSE;
+  }
+  return code_template_equal_code(t, b->byte_code_buf, b->byte_code_len);
+}
+
+static int resize_code_template_hash(JSRuntime* rt, int new_hash_bits) {
+  int new_hash_size, i;
+  uint32_t h;
+  JSCodeTemplate **new_hash, *t, *t_next;
+
+  new_hash_size = 1 << new_hash_bits;
+  new_hash = (JSCodeTemplate**)js_mallocz_rt(
+      rt, sizeof(rt->code_template_hash[0]) * new_hash_size);
+  if (!new_hash)
+    return -1;
+  for (i = 0; i < rt->code_template_hash_size; i++) {
+    for (t = rt->code_template_hash[i]; t != NULL; t = t_next) {
+      t_next = t->hash_next;
+      h = get_shape_hash(t->hash, new_hash_bits);
+      t->hash_next = new_hash[h];
+      new_hash[h] = t;
+    }
+  }
+  js_free_rt(rt, rt->code_template_hash);
+  rt->code_template_hash_bits = new_hash_bits;
+  rt->code_template_hash_size = new_hash_size;
+  rt->code_template_hash = new_hash;
+  return 0;
+}
+
+static JSCodeTemplate* js_new_code_template(
+    JSContext* ctx,
+    uint32_t hash,
+    JSFunctionBytecode* b) {
+  JSRuntime* rt = ctx->rt;
+  JSCodeTemplate* t;
+  uint32_t ic_count = b->ic ? b->ic->count : 0;
+  int pc2line_len = 0, pc2column_len = 0, source_len = 0;
+  uint32_t i, h;
+  size_t size;
+  uint8_t* p;
+
+  if (b->has_debug) {
+    pc2line_len = b->debug.pc2line_len;
+    pc2column_len = b->debug.pc2column_len;
+    source_len = b->debug.source_len;
+  }
+  if (2 * (rt->code_template_count + 1) > rt->code_template_hash_size) {
+    if (resize_code_template_hash(
+            rt, max_int(rt->code_template_hash_bits + 1, 4)))
+      return NULL;
+  }
+  size = sizeof(*t) + sizeof(t->ic_atoms[0]) * ic_count + b->byte_code_len +
+      pc2line_len + pc2column_len;
+  if (b->has_debug && b->debug.source)
+    size += source_len + 1;
+  t = (JSCodeTemplate*)js_malloc(ctx, size);
+  if (!t)
+    return NULL;
+  memset(t, 0, sizeof(*t));
+  t->ref_count = 1;
+  t->hash = hash;
+  t->ic_count = ic_count;
+  t->ic_atoms = (JSAtom*)(t + 1);
+  for (i = 0; i < ic_count; i++)
+    t->ic_atoms[i] = JS_DupAtom(ctx, b->ic->cache[i].atom);
+  p = (uint8_t*)(t->ic_atoms + ic_count);
+  /* the template takes the atom references of the bytecode */
+  t->byte_code_buf = p;
+  t->byte_code_len = b->byte_code_len;
+  memcpy(p, b->byte_code_buf, b->byte_code_len);
+  p += b->byte_code_len;
+  if (pc2line_len) {
+    t->pc2line_buf = p;
+    t->pc2line_len = pc2line_len;
+    memcpy(p, b->debug.pc2line_buf, pc2line_len);
+    p += pc2line_len;
+  }
+  if (pc2column_len) {
+    t->pc2column_buf = p;
+    t->pc2column_len = pc2column_len;
+    memcpy(p, b->debug.pc2column_buf, pc2column_len);
+    p += pc2column_len;
+  }
+  if (b->has_debug && b->debug.source) {
+    t->source = (char*)p;
+    t->source_len = source_len;
+    memcpy(p, b->debug.source, source_len);
+    p[source_len] = '\0';
+  }
+
+  h = get_shape_hash(hash, rt->code_template_hash_bits);
+  t->hash_next = rt->code_template_hash[h];
+  rt->code_template_hash[h] = t;
+  rt->code_template_count++;
+  return t;
+}
+
+void js_function_set_code_template(JSContext* ctx, JSFunctionBytecode* b) {
+  JSRuntime* rt = ctx->rt;
+  JSCodeTemplate* t;
+  uint32_t hash;
+
+  if (b->code_template || b->read_only_bytecode)
+    return;
+  hash = code_template_hash(b);
+  t = NULL;
+  if (rt->code_template_hash_size != 0) {
+    t = rt->code_template_hash[get_shape_hash(
+        hash, rt->code_template_hash_bits)];
+    for (; t != NULL; t = t->hash_next) {
+      if (code_template_equal(t, hash, b))
+        break;
+    }
+  }
+  if (t) {
+    t->ref_count++;
+    free_bytecode_atoms(rt, b->byte_code_buf, b->byte_code_len, TRUE);
+  } else {
+    t = js_new_code_template(ctx, hash, b);
+    if (!t)
+      return; /* 'b' keeps its own code */
+  }
+
+  js_free(ctx, b->byte_code_buf);
+  b->byte_code_buf = t->byte_code_buf;
+  if (b->has_debug) {
+    js_free(ctx, b->debug.pc2line_buf);
+    js_free(ctx, b->debug.pc2column_buf);
+    js_free(ctx, b->debug.source);
+    b->debug.pc2line_buf = t->pc2line_buf;
+    b->debug.pc2column_buf = t->pc2column_buf;
+    b->debug.source = t->source;
+  }
+  b->code_template = t;
+}
+
+void js_code_template_free(JSRuntime* rt, JSCodeTemplate* t) {
+  JSCodeTemplate** pt;
+  uint32_t i;
+
+  if (--t->ref_count > 0)
+    return;
+  pt = &rt->code_template_hash[get_shape_hash(
+      t->hash, rt->code_template_hash_bits)];
+  while (*pt != t)
+    pt = &(*pt)->hash_next;
+  *pt = t->hash_next;
+  rt->code_template_count--;
+
+  free_bytecode_atoms(rt, t->byte_code_buf, t->byte_code_len, TRUE);
+  for (i = 0; i < t->ic_count; i++)
+    JS_FreeAtomRT(rt, t->ic_atoms[i]);
+  js_free_rt(rt, t);
+}
+
+static int JS_WriteFunctionBytecode(BCWriterState* s, JSFunctionBytecode* b) {
+  int pos, len, op, bc_len;
   JSAtom atom;
   uint8_t* bc_buf;
   uint32_t val;
 
+  bc_len = b->byte_code_len;
   bc_buf = (uint8_t*)js_malloc(s->ctx, bc_len);
   if (!bc_buf)
     return -1;
-  memcpy(bc_buf, bc_buf1, bc_len);
+  memcpy(bc_buf, b->byte_code_buf, bc_len);
 
   pos = 0;
   while (pos < bc_len) {
     op = bc_buf[pos];
+    if (js_ic_unpatched_opcode(op) >= 0) {
+      /* the inline cache indexes are not serialized */
+      bc_buf[pos] = op = js_ic_unpatched_opcode(op);
+      put_u32(bc_buf + pos + 1, get_ic_atom(b->ic, get_u32(bc_buf + pos + 1)));
+    }
     len = short_opcode_info(op).size;
     switch (short_opcode_info(op).fmt) {
       case OP_FMT_atom:
@@ -404,10 +699,11 @@ static void JS_WriteString(BCWriterState* s, JSString* p) {
   int i;
   bc_put_leb128(s, ((uint32_t)p->len << 1) | p->is_wide_char);
   if (p->is_wide_char) {
+    const uint16_t* str16 = js_string_str16(p);
     for (i = 0; i < p->len; i++)
-      bc_put_u16(s, p->u.str16[i]);
+      bc_put_u16(s, str16[i]);
   } else {
-    dbuf_put(&s->dbuf, p->u.str8, p->len);
+    dbuf_put(&s->dbuf, js_string_str8(p), p->len);
   }
 }
 
@@ -525,7 +821,7 @@ static int JS_WriteFunctionTag(BCWriterState* s, JSValueConst obj) {
     bc_put_u8(s, flags);
   }
 
-  if (JS_WriteFunctionBytecode(s, b->byte_code_buf, b->byte_code_len))
+  if (JS_WriteFunctionBytecode(s, b))
     goto fail;
 
   if (b->has_debug) {
@@ -649,38 +945,80 @@ fail1:
   return -1;
 }
 
+/* return TRUE if the property is written by JS_WriteObjectTag() */
+static BOOL bc_is_written_prop(JSContext* ctx, JSShapeProperty* pr) {
+  return pr->atom != JS_ATOM_NULL && JS_AtomIsString(ctx, pr->atom) &&
+      (pr->flags & JS_PROP_ENUMERABLE);
+}
+
+/* The objects with a hashed shape are written as BC_TAG_OBJECT_SHAPE
+   followed by the index of the shape in the written shapes. The first
+   time a shape is written, its index is followed by its property names.
+   Then only the property values are written. */
 static int JS_WriteObjectTag(BCWriterState* s, JSValueConst obj) {
   JSObject* p = JS_VALUE_GET_OBJ(obj);
   uint32_t i, prop_count;
   JSShape* sh;
   JSShapeProperty* pr;
-  int pass;
-  JSAtom atom;
+  int shape_idx;
+  BOOL is_new_shape;
 
-  bc_put_u8(s, BC_TAG_OBJECT);
-  prop_count = 0;
   sh = p->shape;
-  for (pass = 0; pass < 2; pass++) {
-    if (pass == 1)
-      bc_put_leb128(s, prop_count);
+  shape_idx = -1;
+  is_new_shape = TRUE;
+  if (sh->is_hashed) {
+    shape_idx = js_object_list_find(s->ctx, &s->shape_list, (JSObject*)sh);
+    if (shape_idx >= 0) {
+      is_new_shape = FALSE;
+    } else {
+      if (js_object_list_add(s->ctx, &s->shape_list, (JSObject*)sh))
+        goto fail;
+      js_dup_shape(sh);
+      shape_idx = s->shape_list.object_count - 1;
+    }
+  }
+
+  prop_count = 0;
+  if (is_new_shape) {
     for (i = 0, pr = get_shape_prop(sh); i < sh->prop_count; i++, pr++) {
-      atom = pr->atom;
-      if (atom != JS_ATOM_NULL && JS_AtomIsString(s->ctx, atom) &&
-          (pr->flags & JS_PROP_ENUMERABLE)) {
+      if (bc_is_written_prop(s->ctx, pr)) {
         if (pr->flags & JS_PROP_TMASK) {
           JS_ThrowTypeError(s->ctx, "only value properties are supported");
           goto fail;
         }
-        if (pass == 0) {
-          prop_count++;
-        } else {
-          bc_put_atom(s, atom);
-          if (JS_WriteObjectRec(s, p->prop[i].u.value))
-            goto fail;
-        }
+        prop_count++;
       }
     }
   }
+
+  if (shape_idx < 0) {
+    bc_put_u8(s, BC_TAG_OBJECT);
+    bc_put_leb128(s, prop_count);
+    for (i = 0, pr = get_shape_prop(sh); i < (uint32_t)sh->prop_count; i++, pr++) {
+      if (bc_is_written_prop(s->ctx, pr)) {
+        bc_put_atom(s, pr->atom);
+        if (JS_WriteObjectRec(s, p->prop[i].u.value))
+          goto fail;
+      }
+    }
+    return 0;
+  }
+
+  bc_put_u8(s, BC_TAG_OBJECT_SHAPE);
+  bc_put_leb128(s, shape_idx);
+  if (is_new_shape) {
+    bc_put_leb128(s, prop_count);
+    for (i = 0, pr = get_shape_prop(sh); i < (uint32_t)sh->prop_count; i++, pr++) {
+      if (bc_is_written_prop(s->ctx, pr))
+        bc_put_atom(s, pr->atom);
+    }
+  }
+  for (i = 0, pr = get_shape_prop(sh); i < (uint32_t)sh->prop_count; i++, pr++) {
+    if (bc_is_written_prop(s->ctx, pr)) {
+      if (JS_WriteObjectRec(s, p->prop[i].u.value))
+        goto fail;
+    }
+  }
   return 0;
 fail:
   return -1;
@@ -897,6 +1235,13 @@ fail:
   return -1;
 }
 
+static void bc_writer_free_shapes(BCWriterState* s) {
+  int i;
+  for (i = 0; i < s->shape_list.object_count; i++)
+    js_free_shape(s->ctx->rt, (JSShape*)s->shape_list.object_tab[i].obj);
+  js_object_list_end(s->ctx, &s->shape_list);
+}
+
 uint8_t* JS_WriteObject2(
     JSContext* ctx,
     size_t* psize,
@@ -918,11 +1263,13 @@ uint8_t* JS_WriteObject2(
     s->first_atom = 1;
   js_dbuf_init(ctx, &s->dbuf);
   js_object_list_init(&s->object_list);
+  js_object_list_init(&s->shape_list);
 
   if (JS_WriteObjectRec(s, obj))
     goto fail;
   if (JS_WriteObjectAtoms(s))
     goto fail;
+  bc_writer_free_shapes(s);
   js_object_list_end(ctx, &s->object_list);
   js_free(ctx, s->atom_to_idx);
   js_free(ctx, s->idx_to_atom);
@@ -933,6 +1280,7 @@ uint8_t* JS_WriteObject2(
     *psab_tab_len = s->sab_tab_len;
   return s->dbuf.buf;
 fail:
+  bc_writer_free_shapes(s);
   js_object_list_end(ctx, &s->object_list);
   js_free(ctx, s->atom_to_idx);
   js_free(ctx, s->idx_to_atom);
@@ -950,6 +1298,15 @@ JS_WriteObject(JSContext* ctx, size_t* psize, JSValueConst obj, int flags) {
   return JS_WriteObject2(ctx, psize, obj, flags, NULL, NULL);
 }
 
+typedef struct BCReaderShape {
+  uint32_t prop_count;
+  JSAtom* atoms;
+  /* shape of the objects with these properties, NULL if not known yet
+     or if the objects do not have a hashed shape */
+  JSShape* sh;
+  BOOL sh_checked;
+} BCReaderShape;
+
 typedef struct BCReaderState {
   JSContext* ctx;
   const uint8_t *buf_start, *ptr, *buf_end;
@@ -965,6 +1322,10 @@ typedef struct BCReaderState {
   JSObject** objects;
   int objects_count;
   int objects_size;
+  /* shapes of BC_TAG_OBJECT_SHAPE */
+  struct BCReaderShape* shapes;
+  int shapes_count;
+  int shapes_size;
 
 #ifdef DUMP_READ_OBJECT
   const uint8_t* ptr_last;
@@ -1198,7 +1559,6 @@ static uint32_t bc_get_flags(uint32_t flags, int* pidx, int n) {
 static int JS_ReadFunctionBytecode(
     BCReaderState* s,
     JSFunctionBytecode* b,
-    int byte_code_offset,
     uint32_t bc_len) {
   uint8_t* bc_buf;
   int pos, len, op;
@@ -1212,9 +1572,15 @@ static int JS_ReadFunctionBytecode(
     bc_buf = (uint8_t*)s->ptr;
     s->ptr += bc_len;
   } else {
-    bc_buf = (uint8_t*)((uint8_t*)b + byte_code_offset);
-    if (bc_get_buf(s, bc_buf, bc_len))
+    /* moved to the code template of the function */
+    bc_buf = (uint8_t*)js_malloc(s->ctx, bc_len);
+    if (!bc_buf)
       return -1;
+    b->byte_code_buf = bc_buf;
+    if (bc_get_buf(s, bc_buf, bc_len)) {
+      b->byte_code_len = 0;
+      return -1;
+    }
   }
   b->byte_code_buf = bc_buf;
 
@@ -1335,7 +1701,7 @@ static JSValue JS_ReadFunctionTag(BCReaderState* s) {
   uint16_t v16;
   uint8_t v8;
   int idx, i, local_count;
-  int function_size, cpool_offset, byte_code_offset;
+  int function_size, cpool_offset;
   int closure_var_offset, vardefs_offset;
 
   memset(&bc, 0, sizeof(bc));
@@ -1390,10 +1756,6 @@ static JSValue JS_ReadFunctionTag(BCReaderState* s) {
   function_size += local_count * sizeof(*bc.vardefs);
   closure_var_offset = function_size;
   function_size += bc.closure_var_count * sizeof(*bc.closure_var);
-  byte_code_offset = function_size;
-  if (!bc.read_only_bytecode) {
-    function_size += bc.byte_code_len;
-  }
 
   b = (JSFunctionBytecode*)js_mallocz(ctx, function_size);
   if (!b)
@@ -1479,6 +1841,8 @@ static JSValue JS_ReadFunctionTag(BCReaderState* s) {
       cv->is_const = bc_get_flags(v8, &idx, 1);
       cv->is_lexical = bc_get_flags(v8, &idx, 1);
       cv->var_kind = bc_get_flags(v8, &idx, 4);
+      /* not serialized: the closure keeps a reference to the variable */
+      cv->is_immutable = FALSE;
 #ifdef DUMP_READ_OBJECT
       bc_read_trace(s, "name: ");
       print_atom(s->ctx, cv->var_name);
@@ -1489,7 +1853,7 @@ static JSValue JS_ReadFunctionTag(BCReaderState* s) {
   }
   {
     bc_read_trace(s, "bytecode {\n");
-    if (JS_ReadFunctionBytecode(s, b, byte_code_offset, b->byte_code_len))
+    if (JS_ReadFunctionBytecode(s, b, b->byte_code_len))
       goto fail;
     bc_read_trace(s, "}\n");
   }
@@ -1551,6 +1915,7 @@ static JSValue JS_ReadFunctionTag(BCReaderState* s) {
     }
     bc_read_trace(s, "}\n");
   }
+  js_function_set_code_template(ctx, b);
   b->realm = JS_DupContext(ctx);
   return obj;
 fail:
@@ -1757,6 +2122,113 @@ fail:
   return JS_EXCEPTION;
 }
 
+/* return the shape of 'obj' if its properties are exactly 'rs' */
+static JSShape* bc_get_reader_shape(JSValueConst obj, BCReaderShape* rs) {
+  JSShape* sh = JS_VALUE_GET_OBJ(obj)->shape;
+  JSShapeProperty* pr;
+  uint32_t i;
+
+  if (!sh->is_hashed || (uint32_t)sh->prop_count != rs->prop_count)
+    return NULL;
+  for (i = 0, pr = get_shape_prop(sh); i < (uint32_t)sh->prop_count; i++, pr++) {
+    if (pr->atom != rs->atoms[i] ||
+        (pr->flags & (JS_PROP_TMASK | JS_PROP_C_W_E)) != JS_PROP_C_W_E)
+      return NULL;
+  }
+  return js_dup_shape(sh);
+}
+
+static JSValue JS_ReadObjectShapeTag(BCReaderState* s) {
+  JSContext* ctx = s->ctx;
+  JSValue obj, val;
+  JSObject* p;
+  BCReaderShape* rs;
+  uint32_t idx, i, prop_count, shapes_count;
+  const JSAtom* atoms;
+  int ret;
+
+  if (bc_get_leb128(s, &idx))
+    return JS_EXCEPTION;
+  shapes_count = s->shapes_count;
+  if (idx == shapes_count) {
+    if (js_resize_array(
+            ctx,
+            (void**)&s->shapes,
+            sizeof(s->shapes[0]),
+            &s->shapes_size,
+            s->shapes_count + 1))
+      return JS_EXCEPTION;
+    rs = &s->shapes[s->shapes_count];
+    memset(rs, 0, sizeof(*rs));
+    if (bc_get_leb128(s, &prop_count))
+      return JS_EXCEPTION;
+    /* each property name takes at least one byte */
+    if (prop_count > (uint32_t)(s->buf_end - s->ptr)) {
+      bc_read_error_end(s);
+      return JS_EXCEPTION;
+    }
+    rs->atoms = (JSAtom*)js_malloc(
+        ctx, sizeof(rs->atoms[0]) * max_int(prop_count, 1));
+    if (!rs->atoms)
+      return JS_EXCEPTION;
+    s->shapes_count++;
+    for (i = 0; i < prop_count; i++) {
+      if (bc_get_atom(s, &rs->atoms[i]))
+        return JS_EXCEPTION;
+      rs->prop_count++;
+    }
+  } else if (idx > shapes_count) {
+    return JS_ThrowSyntaxError(
+        ctx, "invalid shape index (%u > %u)", idx, shapes_count);
+  }
+  /* Note: s->shapes may be reallocated when reading the values */
+  rs = &s->shapes[idx];
+  prop_count = rs->prop_count;
+  atoms = rs->atoms;
+
+  if (rs->sh) {
+    /* the values are stored directly in the properties of the shape */
+    obj = JS_NewObjectFromShape(ctx, js_dup_shape(rs->sh), JS_CLASS_OBJECT);
+    if (JS_IsException(obj))
+      return obj;
+    p = JS_VALUE_GET_OBJ(obj);
+    for (i = 0; i < prop_count; i++)
+      p->prop[i].u.value = JS_UNDEFINED;
+    if (BC_add_object_ref(s, obj))
+      goto fail;
+    for (i = 0; i < prop_count; i++) {
+      val = JS_ReadObjectRec(s);
+      if (JS_IsException(val))
+        goto fail;
+      p->prop[i].u.value = val;
+    }
+    return obj;
+  }
+
+  obj = JS_NewObject(ctx);
+  if (JS_IsException(obj))
+    return obj;
+  if (BC_add_object_ref(s, obj))
+    goto fail;
+  for (i = 0; i < prop_count; i++) {
+    val = JS_ReadObjectRec(s);
+    if (JS_IsException(val))
+      goto fail;
+    ret = JS_DefinePropertyValue(ctx, obj, atoms[i], val, JS_PROP_C_W_E);
+    if (ret < 0)
+      goto fail;
+  }
+  rs = &s->shapes[idx];
+  if (!rs->sh_checked) {
+    rs->sh_checked = TRUE;
+    rs->sh = bc_get_reader_shape(obj, rs);
+  }
+  return obj;
+fail:
+  JS_FreeValue(ctx, obj);
+  return JS_EXCEPTION;
+}
+
 static JSValue JS_ReadTypedArray(BCReaderState* s) {
   JSContext* ctx = s->ctx;
   JSValue obj = JS_UNDEFINED, array_buffer = JS_UNDEFINED;
@@ -1960,6 +2432,9 @@ static JSValue JS_ReadObjectRec(BCReaderState* s) {
     case BC_TAG_OBJECT:
       obj = JS_ReadObjectTag(s);
       break;
+    case BC_TAG_OBJECT_SHAPE:
+      obj = JS_ReadObjectShapeTag(s);
+      break;
     case BC_TAG_ARRAY:
     case BC_TAG_TEMPLATE_OBJECT:
       obj = JS_ReadArray(s, tag);
@@ -2049,6 +2524,7 @@ static int JS_ReadObjectAtoms(BCReaderState* s) {
 }
 
 static void bc_reader_free(BCReaderState* s) {
+  uint32_t j;
   int i;
   if (s->idx_to_atom) {
     for (i = 0; i < s->idx_to_atom_count; i++) {
@@ -2057,6 +2533,14 @@ static void bc_reader_free(BCReaderState* s) {
     js_free(s->ctx, s->idx_to_atom);
   }
   js_free(s->ctx, s->objects);
+  for (i = 0; i < s->shapes_count; i++) {
+    BCReaderShape* rs = &s->shapes[i];
+    for (j = 0; j < rs->prop_count; j++)
+      JS_FreeAtom(s->ctx, rs->atoms[j]);
+    js_free(s->ctx, rs->atoms);
+    js_free_shape_null(s->ctx->rt, rs->sh);
+  }
+  js_free(s->ctx, s->shapes);
 }
 
 JSValue
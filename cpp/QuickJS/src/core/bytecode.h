@@ -42,6 +42,13 @@ void free_bytecode_atoms(
     int bc_len,
     BOOL use_short_opcodes);
 
+/* Share the code of 'b' with the other functions of the runtime having
+   the same code (see JSCodeTemplate). 'b' must own its unpatched
+   bytecode and debug buffers: they are freed or moved to the template.
+   'b' keeps its own code if there is not enough memory. */
+void js_function_set_code_template(JSContext* ctx, JSFunctionBytecode* b);
+void js_code_template_free(JSRuntime* rt, JSCodeTemplate* t);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,129 @@
+/*
+ * QuickJS Javascript Engine
+ *
+ * Copyright (c) 2017-2025 Fabrice Bellard
+ * Copyright (c) 2017-2025 Charlie Gordon
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#ifdef ENABLE_EXEC_STATS
+
+#include <time.h>
+#if defined(_WIN32)
+#include <sys/time.h>
+#endif
+
+/* Execution counters updated by JS_CallInternal() while
+   rt->exec_stats.enabled is set (see taro_js_exec_stats_start()):
+
+   - per JSFunctionBytecode: calls, taken loop back edges and self time
+     (time in the function minus the time in the bytecode functions it
+     calls, the C functions it calls are included);
+   - per inline cache slot (one per property name of a function): the
+     hits and misses of the shape lookups;
+   - per runtime: the executed opcodes.
+
+   The opcodes and back edges run in the native code of the JIT are not
+   counted. */
+
+/* monotonic clock in nanoseconds */
+static inline int64_t js_exec_stats_clock(void) {
+#if defined(_WIN32)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* state of a JS_CallInternal() frame */
+typedef struct JSExecStatsFrame {
+  int64_t start; /* 0 if the frame is not timed */
+  int64_t callee_time; /* saved JSExecStats.callee_time of the caller */
+} JSExecStatsFrame;
+
+/* 'is_call' is FALSE when a generator or async function is resumed */
+static inline void js_exec_stats_enter(
+    JSRuntime* rt,
+    JSFunctionBytecode* b,
+    JSExecStatsFrame* f,
+    BOOL is_call) {
+  JSExecStats* s = &rt->exec_stats;
+
+  if (likely(!s->enabled)) {
+    f->start = 0;
+    return;
+  }
+  if (is_call)
+    b->exec_stats.call_count++;
+  f->callee_time = s->callee_time;
+  s->callee_time = 0;
+  f->start = js_exec_stats_clock();
+}
+
+static inline void js_exec_stats_leave(
+    JSRuntime* rt,
+    JSFunctionBytecode* b,
+    JSExecStatsFrame* f) {
+  JSExecStats* s = &rt->exec_stats;
+  int64_t t;
+
+  if (likely(!f->start))
+    return;
+  t = js_exec_stats_clock() - f->start;
+  if (s->enabled)
+    b->exec_stats.self_time += t - s->callee_time;
+  s->callee_time = f->callee_time + t;
+}
+
+static inline void js_exec_stats_back_edge(
+    JSRuntime* rt,
+    JSFunctionBytecode* b) {
+  if (unlikely(rt->exec_stats.enabled))
+    b->exec_stats.back_edge_count++;
+}
+
+/* return 'op' */
+static inline int js_exec_stats_op(JSRuntime* rt, int op) {
+  if (unlikely(rt->exec_stats.enabled))
+    rt->exec_stats.op_count[op]++;
+  return op;
+}
+
+static inline void js_exec_stats_ic(
+    InlineCache* ic,
+    InlineCacheRingSlot* cr,
+    BOOL hit) {
+  if (unlikely(ic->ctx->rt->exec_stats.enabled)) {
+    if (hit)
+      cr->hit_count++;
+    else
+      cr->miss_count++;
+  }
+}
+
+#endif /* ENABLE_EXEC_STATS */
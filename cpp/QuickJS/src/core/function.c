@@ -36,9 +36,12 @@
 #include "common.h"
 #include "convertion.h"
 #include "exception.h"
+#include "exec-stats.h"
 #include "gc.h"
+#include "jit.h"
 #include "module.h"
 #include "object.h"
+#include "opcode-profile.h"
 #include "parser.h"
 #include "runtime.h"
 #include "string-utils.h"
@@ -224,9 +227,38 @@ JSValue JS_CallInternal(
   JSVarRef** var_refs;
   size_t alloca_size;
   InlineCache* ic;
+#ifdef ENABLE_EXEC_STATS
+  JSExecStatsFrame exec_frame;
+#define READ_OPCODE(pc) js_exec_stats_op(rt, *pc++)
+#define EXEC_STATS_BACK_EDGE() js_exec_stats_back_edge(rt, b)
+#else
+#define READ_OPCODE(pc) (*pc++)
+#define EXEC_STATS_BACK_EDGE()
+#endif
+#ifdef ENABLE_OPCODE_PROFILE
+  uint32_t op_history = OP_invalid;
+#define FETCH_OPCODE(pc) \
+  js_opcode_profile_add(rt->opcode_profile, &op_history, READ_OPCODE(pc))
+#else
+#define FETCH_OPCODE(pc) READ_OPCODE(pc)
+#endif
+#ifdef ENABLE_JIT
+/* continue in the native code if the function is hot */
+#define JIT_BACK_EDGE()     \
+  if (js_jit_is_hot(rt, b)) \
+  goto jit_enter
+#else
+#define JIT_BACK_EDGE()
+#endif
+/* taken backward jump */
+#define BACK_EDGE(is_back_edge) \
+  if (unlikely(is_back_edge)) { \
+    EXEC_STATS_BACK_EDGE();     \
+    JIT_BACK_EDGE();            \
+  }
 
 #if !DIRECT_DISPATCH
-#define SWITCH(pc) switch (opcode = *pc++)
+#define SWITCH(pc) switch (opcode = FETCH_OPCODE(pc))
 #if QUICKJS_DEBUG
 #define CASE(op)                                       \
   case op:                                             \
@@ -258,7 +290,7 @@ JSValue JS_CallInternal(
 #endif
 #include "QuickJS/quickjs-opcode.h"
       [OP_COUNT... 255] = &&case_default};
-#define SWITCH(pc) goto* active_dispatch_table[opcode = *pc++];
+#define SWITCH(pc) goto* active_dispatch_table[opcode = FETCH_OPCODE(pc)];
 
 #define CASE(op)                                                   \
   case_debugger_##op                                               \
@@ -271,7 +303,7 @@ JSValue JS_CallInternal(
       caller_ctx->rt->debugger_info.notify_fun ? debugger_dispatch_table
                                                : dispatch_table;
 #else
-#define SWITCH(pc) goto* dispatch_table[opcode = *pc++];
+#define SWITCH(pc) goto* dispatch_table[opcode = FETCH_OPCODE(pc)];
 #define CASE(op) case_##op
 #define DEFAULT case_default
 #define BREAK SWITCH(pc)
@@ -299,6 +331,9 @@ JSValue JS_CallInternal(
       sf->prev_frame = rt->current_stack_frame;
       rt->current_stack_frame = sf;
       ic = b->ic;
+#ifdef ENABLE_EXEC_STATS
+      js_exec_stats_enter(rt, b, &exec_frame, FALSE);
+#endif
       if (s->throw_flag)
         goto exception;
       else
@@ -336,6 +371,8 @@ JSValue JS_CallInternal(
   sf->arg_count = argc;
   sf->cur_func = (JSValue)func_obj;
   init_list_head(&sf->var_ref_list);
+  sf->const_var_refs = NULL;
+  sf->const_var_ref_count = 0;
   var_refs = p->u.func.var_refs;
 
   local_buf = alloca(alloca_size);
@@ -362,6 +399,13 @@ JSValue JS_CallInternal(
   rt->current_stack_frame = sf;
   ctx = b->realm; /* set the current realm */
   ic = b->ic;
+#ifdef ENABLE_EXEC_STATS
+  js_exec_stats_enter(rt, b, &exec_frame, TRUE);
+#endif
+#ifdef ENABLE_JIT
+  if (js_jit_is_hot(rt, b))
+    goto jit_enter;
+#endif
 
 restart:
   for (;;) {
@@ -1381,18 +1425,30 @@ restart:
       }
       BREAK;
 
-      CASE(OP_goto) : pc += (int32_t)get_u32(pc);
-      if (unlikely(js_poll_interrupts(ctx)))
-        goto exception;
+      CASE(OP_goto) : {
+        int32_t diff = get_u32(pc);
+        pc += diff;
+        if (unlikely(js_poll_interrupts(ctx)))
+          goto exception;
+        BACK_EDGE(diff < 0);
+      }
       BREAK;
 #if SHORT_OPCODES
-      CASE(OP_goto16) : pc += (int16_t)get_u16(pc);
-      if (unlikely(js_poll_interrupts(ctx)))
-        goto exception;
+      CASE(OP_goto16) : {
+        int32_t diff = (int16_t)get_u16(pc);
+        pc += diff;
+        if (unlikely(js_poll_interrupts(ctx)))
+          goto exception;
+        BACK_EDGE(diff < 0);
+      }
       BREAK;
-      CASE(OP_goto8) : pc += (int8_t)pc[0];
-      if (unlikely(js_poll_interrupts(ctx)))
-        goto exception;
+      CASE(OP_goto8) : {
+        int32_t diff = (int8_t)pc[0];
+        pc += diff;
+        if (unlikely(js_poll_interrupts(ctx)))
+          goto exception;
+        BACK_EDGE(diff < 0);
+      }
       BREAK;
 #endif
       CASE(OP_if_true) : {
@@ -1408,10 +1464,14 @@ restart:
         }
         sp--;
         if (res) {
-          pc += (int32_t)get_u32(pc - 4) - 4;
-        }
-        if (unlikely(js_poll_interrupts(ctx)))
+          int32_t diff = get_u32(pc - 4);
+          pc += diff - 4;
+          if (unlikely(js_poll_interrupts(ctx)))
+            goto exception;
+          BACK_EDGE(diff < 0);
+        } else if (unlikely(js_poll_interrupts(ctx))) {
           goto exception;
+        }
       }
       BREAK;
       CASE(OP_if_false) : {
@@ -1429,10 +1489,14 @@ restart:
         }
         sp--;
         if (!res) {
-          pc += (int32_t)get_u32(pc - 4) - 4;
-        }
-        if (unlikely(js_poll_interrupts(ctx)))
+          int32_t diff = get_u32(pc - 4);
+          pc += diff - 4;
+          if (unlikely(js_poll_interrupts(ctx)))
+            goto exception;
+          BACK_EDGE(diff < 0);
+        } else if (unlikely(js_poll_interrupts(ctx))) {
           goto exception;
+        }
       }
       BREAK;
 #if SHORT_OPCODES
@@ -1449,10 +1513,14 @@ restart:
         }
         sp--;
         if (res) {
-          pc += (int8_t)pc[-1] - 1;
-        }
-        if (unlikely(js_poll_interrupts(ctx)))
+          int32_t diff = (int8_t)pc[-1];
+          pc += diff - 1;
+          if (unlikely(js_poll_interrupts(ctx)))
+            goto exception;
+          BACK_EDGE(diff < 0);
+        } else if (unlikely(js_poll_interrupts(ctx))) {
           goto exception;
+        }
       }
       BREAK;
       CASE(OP_if_false8) : {
@@ -1468,10 +1536,14 @@ restart:
         }
         sp--;
         if (!res) {
-          pc += (int8_t)pc[-1] - 1;
-        }
-        if (unlikely(js_poll_interrupts(ctx)))
+          int32_t diff = (int8_t)pc[-1];
+          pc += diff - 1;
+          if (unlikely(js_poll_interrupts(ctx)))
+            goto exception;
+          BACK_EDGE(diff < 0);
+        } else if (unlikely(js_poll_interrupts(ctx))) {
           goto exception;
+        }
       }
       BREAK;
 #endif
@@ -1687,6 +1759,56 @@ restart:
       }
       BREAK;
 
+      CASE(OP_get_loc_field) : {
+        JSValue val, obj;
+        JSAtom atom;
+        int idx;
+        atom = get_u32(pc);
+        idx = pc[4];
+        pc += 5;
+        /* the getter may modify the variable */
+        obj = JS_DupValue(
+            ctx, (idx & 0x80) ? arg_buf[idx & 0x7f] : var_buf[idx]);
+
+        sf->cur_pc = pc;
+        val = JS_GetPropertyInternal(ctx, obj, atom, obj, FALSE, ic);
+        JS_FreeValue(ctx, obj);
+        if (unlikely(JS_IsException(val)))
+          goto exception;
+        if (ic != NULL && ic->updated == TRUE) {
+          ic->updated = FALSE;
+          put_u8(pc - 6, OP_get_loc_field_ic);
+          put_u32(pc - 5, ic->updated_offset);
+          // safe free call because ic struct will retain atom
+          JS_FreeAtom(ctx, atom);
+        }
+        *sp++ = val;
+      }
+      BREAK;
+
+      CASE(OP_get_loc_field_ic) : {
+        JSValue val, obj;
+        JSAtom atom;
+        int32_t ic_offset;
+        int idx;
+        ic_offset = get_u32(pc);
+        atom = get_ic_atom(ic, ic_offset);
+        idx = pc[4];
+        pc += 5;
+        obj = JS_DupValue(
+            ctx, (idx & 0x80) ? arg_buf[idx & 0x7f] : var_buf[idx]);
+
+        sf->cur_pc = pc;
+        val = JS_GetPropertyInternalWithIC(
+            ctx, obj, atom, obj, FALSE, ic, ic_offset);
+        ic->updated = FALSE;
+        JS_FreeValue(ctx, obj);
+        if (unlikely(JS_IsException(val)))
+          goto exception;
+        *sp++ = val;
+      }
+      BREAK;
+
       CASE(OP_get_field2) : {
         JSValue val;
         JSAtom atom;
@@ -2877,6 +2999,40 @@ restart:
       goto exception;
     }
   }
+#ifdef ENABLE_JIT
+jit_enter : {
+  JSJitFrame jf;
+  jf.ctx = ctx;
+  jf.caller_ctx = caller_ctx;
+  jf.sf = sf;
+  jf.b = b;
+  jf.var_buf = var_buf;
+  jf.arg_buf = arg_buf;
+  jf.stack_buf = stack_buf;
+  jf.var_refs = var_refs;
+  jf.this_obj = this_obj;
+  jf.new_target = new_target;
+  jf.argc = argc;
+  jf.argv = argv;
+  switch (js_jit_run(&jf, sp, pc)) {
+    case JS_JIT_RETURN:
+      sp = jf.sp;
+      ret_val = jf.ret_val;
+      goto done;
+    case JS_JIT_EXCEPTION:
+      sp = jf.sp;
+      pc = (uint8_t*)jf.pc;
+      goto exception;
+    case JS_JIT_DEOPT:
+      sp = jf.sp;
+      pc = (uint8_t*)jf.pc;
+      break;
+    default:
+      break;
+  }
+  goto restart;
+}
+#endif
 exception:
   if (is_backtrace_needed(ctx, rt->current_exception)) {
     /* add the backtrace information now (it is not done
@@ -2919,11 +3075,16 @@ exception:
       /* variable references reference the stack: must close them */
       close_var_refs(rt, sf);
     }
+    if (unlikely(sf->const_var_refs))
+      close_const_var_refs(rt, sf);
     /* free the local variables and stack */
     for (pval = local_buf; pval < sp; pval++) {
       JS_FreeValue(ctx, *pval);
     }
   }
+#ifdef ENABLE_EXEC_STATS
+  js_exec_stats_leave(rt, b, &exec_frame);
+#endif
   rt->current_stack_frame = sf->prev_frame;
   return ret_val;
 }
@@ -25,6 +25,7 @@
 
 #include "gc.h"
 #include "builtins/js-async-function.h"
+#include "builtins/js-closures.h"
 #include "builtins/js-map.h"
 #include "builtins/js-proxy.h"
 #include "builtins/js-weak-ref.h"
@@ -344,9 +345,11 @@ void async_func_free_frame(JSRuntime* rt, JSAsyncFunctionState* s) {
     for (sp = sf->arg_buf; sp < sf->cur_sp; sp++) {
       JS_FreeValueRT(rt, *sp);
     }
-    js_free_rt(rt, sf->arg_buf);
+    async_func_free_buf(rt, sf->arg_buf, s->frame_bucket);
     sf->arg_buf = NULL;
   }
+  if (sf->const_var_refs)
+    close_const_var_refs(rt, sf);
   JS_FreeValueRT(rt, sf->cur_func);
   JS_FreeValueRT(rt, s->this_val);
 }
@@ -365,7 +368,7 @@ static void __async_func_free(JSRuntime* rt, JSAsyncFunctionState* s) {
   if (rt->gc_phase == JS_GC_PHASE_REMOVE_CYCLES && s->header.ref_count != 0) {
     list_add_tail(&s->header.link, &rt->gc_zero_ref_count_list);
   } else {
-    js_free_rt(rt, s);
+    async_func_free_state(rt, s);
   }
 }
 
@@ -430,6 +433,8 @@ void __JS_FreeValueRT(JSRuntime* rt, JSValue v) {
       JSString* p = JS_VALUE_GET_STRING(v);
       if (p->atom_type) {
         JS_FreeAtomStruct(rt, p);
+      } else if (p->is_slice) {
+        js_free_string_slice(rt, p);
       } else {
 #ifdef DUMP_LEAKS
         list_del(&p->link);
@@ -597,6 +602,7 @@ void JS_MarkContext(JSRuntime* rt, JSContext* ctx, JS_MarkFunc* mark_func) {
 
   if (ctx->array_shape)
     mark_func(rt, &ctx->array_shape->header);
+  js_proxy_mark_trap_cache(rt, ctx, mark_func);
 }
 
 void mark_children(
@@ -681,6 +687,7 @@ void mark_children(
       JSAsyncFunctionState* s = (JSAsyncFunctionState*)gp;
       JSStackFrame* sf = &s->frame;
       JSValue* sp;
+      int i;
 
       if (!s->is_completed) {
         JS_MarkValue(rt, sf->cur_func, mark_func);
@@ -694,6 +701,10 @@ void mark_children(
           for (sp = sf->arg_buf; sp < sf->cur_sp; sp++)
             JS_MarkValue(rt, *sp, mark_func);
         }
+        for (i = 0; i < sf->const_var_ref_count; i++) {
+          if (sf->const_var_refs[i])
+            mark_func(rt, &sf->const_var_refs[i]->header);
+        }
       }
       JS_MarkValue(rt, s->resolving_funcs[0], mark_func);
       JS_MarkValue(rt, s->resolving_funcs[1], mark_func);
@@ -860,10 +871,15 @@ void JS_RunGCInternal(JSRuntime* rt, BOOL remove_weak_objects) {
 
   /* free the GC objects in a cycle */
   gc_free_cycles(rt);
+
+  /* release the parent strings mostly unused by their slices */
+  js_flatten_string_slices(rt);
 }
 
 void JS_RunGC(JSRuntime* rt) {
   JS_RunGCInternal(rt, TRUE);
+  if (rt->string_dedup_max_len)
+    js_dedup_strings(rt);
 }
 
 void JS_TurnOffGC(JSRuntime* rt) {
@@ -2,6 +2,7 @@
 
 #include "QuickJS/quickjs.h"
 #include "exception.h"
+#include "exec-stats.h"
 #include "shape.h"
 #include "types.h"
 
@@ -147,6 +148,9 @@ static force_inline int32_t get_ic_prop_offset(
     if (likely(buffer->shape == shape)) {
       cr->index = i;
       *prototype = buffer->proto;
+#ifdef ENABLE_EXEC_STATS
+      js_exec_stats_ic(ic, cr, TRUE);
+#endif
       return buffer->prop_offset;
     }
 
@@ -156,6 +160,9 @@ static force_inline int32_t get_ic_prop_offset(
     }
   }
 
+#ifdef ENABLE_EXEC_STATS
+  js_exec_stats_ic(ic, cr, FALSE);
+#endif
   *prototype = NULL;
   return -1;
 }
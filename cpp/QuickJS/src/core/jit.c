@@ -0,0 +1,2605 @@
+/*
+ * QuickJS Javascript Engine
+ *
+ * Copyright (c) 2017-2025 Fabrice Bellard
+ * Copyright (c) 2017-2025 Charlie Gordon
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "jit.h"
+
+#ifdef ENABLE_JIT
+
+#if !defined(__x86_64__)
+#error "ENABLE_JIT requires x86-64"
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "QuickJS/cutils.h"
+#include "builtins/js-array.h"
+#include "builtins/js-big-num.h"
+#include "builtins/js-closures.h"
+#include "builtins/js-function.h"
+#include "builtins/js-operator.h"
+#include "common.h"
+#include "convertion.h"
+#include "exception.h"
+#include "function.h"
+#include "ic.h"
+#include "object.h"
+#include "parser.h"
+#include "runtime.h"
+#include "string-utils.h"
+
+typedef struct JSJitCode {
+  uint8_t* code; /* executable mapping */
+  size_t code_size; /* size of the mapping */
+  /* offset in 'code' of each bytecode instruction, -1 if it cannot be
+     entered */
+  int32_t pc2native[0];
+} JSJitCode;
+
+/* entry point of the native code of a function: the prologue jumps to
+   'entry' */
+typedef int JSJitEntry(JSJitFrame* f, JSValue* sp, const uint8_t* entry);
+
+/* Slow path of an opcode called from the native code. 'pc' points to the
+   opcode. Return the new stack pointer or NULL if an exception was raised
+   (see js_jit_throw()). */
+typedef JSValue* JSJitHelper(JSJitFrame* f, JSValue* sp, const uint8_t* pc);
+
+/* exception at the bytecode position 'pc' (after the instruction, as
+   sf->cur_pc in the interpreter) */
+static JSValue* js_jit_throw(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  f->sp = sp;
+  f->pc = pc;
+  return NULL;
+}
+
+static inline void js_jit_set_pc(JSJitFrame* f, const uint8_t* pc) {
+  f->sf->cur_pc = (uint8_t*)pc;
+}
+
+/* called with the value popped by if_true/if_false at 'sp' when it is not
+   an int, bool, null or undefined */
+static int js_jit_to_bool(JSJitFrame* f, JSValue* sp) {
+  return JS_ToBoolFree(f->ctx, *sp);
+}
+
+/* loop back edge after the interrupt counter expired. 'pc' is after the
+   jump instruction. */
+static JSValue* js_jit_poll(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  if (__js_poll_interrupts(f->ctx))
+    return js_jit_throw(f, sp, pc);
+  return sp;
+}
+
+/* constants */
+
+static JSValue* js_jit_push_const(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  uint32_t idx = (*pc == OP_push_const8) ? pc[1] : get_u32(pc + 1);
+  *sp++ = JS_DupValue(f->ctx, f->b->cpool[idx]);
+  return sp;
+}
+
+static JSValue* js_jit_fclosure(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  const uint8_t* pc_end;
+  uint32_t idx;
+
+  if (*pc == OP_fclosure8) {
+    idx = pc[1];
+    pc_end = pc + 2;
+  } else {
+    idx = get_u32(pc + 1);
+    pc_end = pc + 5;
+  }
+  *sp++ = js_closure(ctx, JS_DupValue(ctx, f->b->cpool[idx]), f->var_refs, f->sf);
+  if (unlikely(JS_IsException(sp[-1])))
+    return js_jit_throw(f, sp, pc_end);
+  return sp;
+}
+
+static JSValue* js_jit_push_value(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+
+  switch (*pc) {
+    case OP_push_atom_value:
+      *sp++ = JS_AtomToValue(ctx, get_u32(pc + 1));
+      break;
+    case OP_push_empty_string:
+      *sp++ = JS_AtomToString(ctx, JS_ATOM_empty_string);
+      break;
+    case OP_push_bigint_i32:
+      *sp++ = __JS_NewShortBigInt(ctx, (int)get_u32(pc + 1));
+      break;
+    default: /* OP_object */
+      *sp++ = JS_NewObject(ctx);
+      if (unlikely(JS_IsException(sp[-1])))
+        return js_jit_throw(f, sp, pc + 1);
+      break;
+  }
+  return sp;
+}
+
+static JSValue* js_jit_push_this(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue val;
+
+  if (!(f->b->js_mode & JS_MODE_STRICT)) {
+    uint32_t tag = JS_VALUE_GET_TAG(f->this_obj);
+    if (likely(tag == JS_TAG_OBJECT)) {
+      val = JS_DupValue(ctx, f->this_obj);
+    } else if (tag == JS_TAG_NULL || tag == JS_TAG_UNDEFINED) {
+      val = JS_DupValue(ctx, ctx->global_obj);
+    } else {
+      val = JS_ToObject(ctx, f->this_obj);
+      if (JS_IsException(val))
+        return js_jit_throw(f, sp, pc + 1);
+    }
+  } else {
+    val = JS_DupValue(ctx, f->this_obj);
+  }
+  *sp++ = val;
+  return sp;
+}
+
+static JSValue* js_jit_special_object(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+
+  switch (pc[1]) {
+    case OP_SPECIAL_OBJECT_ARGUMENTS:
+      *sp++ = js_build_arguments(ctx, f->argc, (JSValueConst*)f->argv);
+      break;
+    case OP_SPECIAL_OBJECT_MAPPED_ARGUMENTS:
+      *sp++ = js_build_mapped_arguments(
+          ctx,
+          f->argc,
+          (JSValueConst*)f->argv,
+          f->sf,
+          min_int(f->argc, f->b->arg_count));
+      break;
+    case OP_SPECIAL_OBJECT_THIS_FUNC:
+      *sp++ = JS_DupValue(ctx, f->sf->cur_func);
+      break;
+    case OP_SPECIAL_OBJECT_NEW_TARGET:
+      *sp++ = JS_DupValue(ctx, f->new_target);
+      break;
+    case OP_SPECIAL_OBJECT_HOME_OBJECT: {
+      JSObject* p1 = JS_VALUE_GET_OBJ(f->sf->cur_func)->u.func.home_object;
+      if (unlikely(!p1))
+        *sp++ = JS_UNDEFINED;
+      else
+        *sp++ = JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, p1));
+    } break;
+    case OP_SPECIAL_OBJECT_VAR_OBJECT:
+      *sp++ = JS_NewObjectProto(ctx, JS_NULL);
+      break;
+    case OP_SPECIAL_OBJECT_IMPORT_META:
+      *sp++ = js_import_meta(ctx);
+      break;
+    default:
+      abort();
+  }
+  if (unlikely(JS_IsException(sp[-1])))
+    return js_jit_throw(f, sp, pc + 2);
+  return sp;
+}
+
+static JSValue* js_jit_rest(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  *sp++ = js_build_rest(
+      f->ctx, get_u16(pc + 1), f->argc, (JSValueConst*)f->argv);
+  if (unlikely(JS_IsException(sp[-1])))
+    return js_jit_throw(f, sp, pc + 3);
+  return sp;
+}
+
+/* stack manipulation, see the interpreter for the layouts */
+static JSValue* js_jit_stack_op(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue tmp, tmp2;
+
+  switch (*pc) {
+    case OP_nip:
+      JS_FreeValue(ctx, sp[-2]);
+      sp[-2] = sp[-1];
+      sp--;
+      break;
+    case OP_nip1:
+      JS_FreeValue(ctx, sp[-3]);
+      sp[-3] = sp[-2];
+      sp[-2] = sp[-1];
+      sp--;
+      break;
+    case OP_dup1:
+      sp[0] = sp[-1];
+      sp[-1] = JS_DupValue(ctx, sp[-2]);
+      sp++;
+      break;
+    case OP_dup2:
+      sp[0] = JS_DupValue(ctx, sp[-2]);
+      sp[1] = JS_DupValue(ctx, sp[-1]);
+      sp += 2;
+      break;
+    case OP_dup3:
+      sp[0] = JS_DupValue(ctx, sp[-3]);
+      sp[1] = JS_DupValue(ctx, sp[-2]);
+      sp[2] = JS_DupValue(ctx, sp[-1]);
+      sp += 3;
+      break;
+    case OP_insert2:
+      sp[0] = sp[-1];
+      sp[-1] = sp[-2];
+      sp[-2] = JS_DupValue(ctx, sp[0]);
+      sp++;
+      break;
+    case OP_insert3:
+      sp[0] = sp[-1];
+      sp[-1] = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = JS_DupValue(ctx, sp[0]);
+      sp++;
+      break;
+    case OP_insert4:
+      sp[0] = sp[-1];
+      sp[-1] = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = sp[-4];
+      sp[-4] = JS_DupValue(ctx, sp[0]);
+      sp++;
+      break;
+    case OP_perm3:
+      tmp = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = tmp;
+      break;
+    case OP_rot3l:
+      tmp = sp[-3];
+      sp[-3] = sp[-2];
+      sp[-2] = sp[-1];
+      sp[-1] = tmp;
+      break;
+    case OP_rot4l:
+      tmp = sp[-4];
+      sp[-4] = sp[-3];
+      sp[-3] = sp[-2];
+      sp[-2] = sp[-1];
+      sp[-1] = tmp;
+      break;
+    case OP_rot5l:
+      tmp = sp[-5];
+      sp[-5] = sp[-4];
+      sp[-4] = sp[-3];
+      sp[-3] = sp[-2];
+      sp[-2] = sp[-1];
+      sp[-1] = tmp;
+      break;
+    case OP_rot3r:
+      tmp = sp[-1];
+      sp[-1] = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = tmp;
+      break;
+    case OP_perm4:
+      tmp = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = sp[-4];
+      sp[-4] = tmp;
+      break;
+    case OP_perm5:
+      tmp = sp[-2];
+      sp[-2] = sp[-3];
+      sp[-3] = sp[-4];
+      sp[-4] = sp[-5];
+      sp[-5] = tmp;
+      break;
+    case OP_swap:
+      tmp = sp[-2];
+      sp[-2] = sp[-1];
+      sp[-1] = tmp;
+      break;
+    default: /* OP_swap2 */
+      tmp = sp[-4];
+      tmp2 = sp[-3];
+      sp[-4] = sp[-2];
+      sp[-3] = sp[-1];
+      sp[-2] = tmp;
+      sp[-1] = tmp2;
+      break;
+  }
+  return sp;
+}
+
+/* calls */
+
+static JSValue* js_jit_call(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val, *call_argv;
+  const uint8_t* pc_end;
+  int call_argc, i;
+
+  if (*pc >= OP_call0 && *pc <= OP_call3) {
+    call_argc = *pc - OP_call0;
+    pc_end = pc + 1;
+  } else {
+    call_argc = get_u16(pc + 1);
+    pc_end = pc + 3;
+  }
+  call_argv = sp - call_argc;
+  js_jit_set_pc(f, pc_end);
+  ret_val = JS_CallInternal(
+      ctx, call_argv[-1], JS_UNDEFINED, JS_UNDEFINED, call_argc, call_argv, 0);
+  if (unlikely(JS_IsException(ret_val)))
+    return js_jit_throw(f, sp, pc_end);
+  for (i = -1; i < call_argc; i++)
+    JS_FreeValue(ctx, call_argv[i]);
+  sp -= call_argc + 1;
+  *sp++ = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_call_method(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val, *call_argv;
+  int call_argc, i;
+
+  call_argc = get_u16(pc + 1);
+  call_argv = sp - call_argc;
+  js_jit_set_pc(f, pc + 3);
+  ret_val = JS_CallInternal(
+      ctx, call_argv[-1], call_argv[-2], JS_UNDEFINED, call_argc, call_argv, 0);
+  if (unlikely(JS_IsException(ret_val)))
+    return js_jit_throw(f, sp, pc + 3);
+  for (i = -2; i < call_argc; i++)
+    JS_FreeValue(ctx, call_argv[i]);
+  sp -= call_argc + 2;
+  *sp++ = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_call_constructor(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val, *call_argv;
+  int call_argc, i;
+
+  call_argc = get_u16(pc + 1);
+  call_argv = sp - call_argc;
+  js_jit_set_pc(f, pc + 3);
+  ret_val = JS_CallConstructorInternal(
+      ctx, call_argv[-2], call_argv[-1], call_argc, call_argv, 0);
+  if (unlikely(JS_IsException(ret_val)))
+    return js_jit_throw(f, sp, pc + 3);
+  for (i = -2; i < call_argc; i++)
+    JS_FreeValue(ctx, call_argv[i]);
+  sp -= call_argc + 2;
+  *sp++ = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_array_from(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val, *call_argv;
+  int call_argc, i, ret;
+
+  call_argc = get_u16(pc + 1);
+  ret_val = JS_NewArray(ctx);
+  if (unlikely(JS_IsException(ret_val)))
+    return js_jit_throw(f, sp, pc + 3);
+  call_argv = sp - call_argc;
+  for (i = 0; i < call_argc; i++) {
+    ret = JS_DefinePropertyValue(
+        ctx,
+        ret_val,
+        __JS_AtomFromUInt32(i),
+        call_argv[i],
+        JS_PROP_C_W_E | JS_PROP_THROW);
+    call_argv[i] = JS_UNDEFINED;
+    if (ret < 0) {
+      JS_FreeValue(ctx, ret_val);
+      return js_jit_throw(f, sp, pc + 3);
+    }
+  }
+  sp -= call_argc;
+  *sp++ = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_apply(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val;
+
+  js_jit_set_pc(f, pc + 3);
+  ret_val = js_function_apply(
+      ctx, sp[-3], 2, (JSValueConst*)&sp[-2], get_u16(pc + 1));
+  if (unlikely(JS_IsException(ret_val)))
+    return js_jit_throw(f, sp, pc + 3);
+  JS_FreeValue(ctx, sp[-3]);
+  JS_FreeValue(ctx, sp[-2]);
+  JS_FreeValue(ctx, sp[-1]);
+  sp -= 3;
+  *sp++ = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_check_ctor(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+
+  if (*pc == OP_check_ctor) {
+    if (JS_IsUndefined(f->new_target)) {
+      JS_ThrowTypeError(ctx, "class constructors must be invoked with 'new'");
+      return js_jit_throw(f, sp, pc + 1);
+    }
+    return sp;
+  }
+  /* OP_check_ctor_return: push TRUE if 'this' should be returned */
+  if (!JS_IsObject(sp[-1])) {
+    if (!JS_IsUndefined(sp[-1])) {
+      JS_ThrowTypeError(
+          f->caller_ctx,
+          "derived class constructor must return an object or undefined");
+      return js_jit_throw(f, sp, pc + 1);
+    }
+    sp[0] = JS_TRUE;
+  } else {
+    sp[0] = JS_FALSE;
+  }
+  return sp + 1;
+}
+
+static JSValue* js_jit_throw_op(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JS_Throw(f->ctx, *--sp);
+  return js_jit_throw(f, sp, pc + 1);
+}
+
+/* global variables */
+
+static JSValue* js_jit_global_var(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSAtom atom = get_u32(pc + 1);
+  JSValue val;
+  int ret;
+
+  js_jit_set_pc(f, pc + 5);
+  switch (*pc) {
+    case OP_check_var:
+      ret = JS_CheckGlobalVar(ctx, atom);
+      if (ret < 0)
+        return js_jit_throw(f, sp, pc + 5);
+      *sp++ = JS_NewBool(ctx, ret);
+      break;
+    case OP_get_var_undef:
+    case OP_get_var:
+      val = JS_GetGlobalVar(ctx, atom, *pc - OP_get_var_undef);
+      if (unlikely(JS_IsException(val)))
+        return js_jit_throw(f, sp, pc + 5);
+      *sp++ = val;
+      break;
+    case OP_put_var:
+    case OP_put_var_init:
+      ret = JS_SetGlobalVar(ctx, atom, sp[-1], *pc - OP_put_var);
+      sp--;
+      if (unlikely(ret < 0))
+        return js_jit_throw(f, sp, pc + 5);
+      break;
+    default: /* OP_put_var_strict */
+      /* sp[-2] is JS_TRUE or JS_FALSE */
+      if (unlikely(!JS_VALUE_GET_INT(sp[-2]))) {
+        JS_ThrowReferenceErrorNotDefined(ctx, atom);
+        return js_jit_throw(f, sp, pc + 5);
+      }
+      ret = JS_SetGlobalVar(ctx, atom, sp[-1], 2);
+      sp -= 2;
+      if (unlikely(ret < 0))
+        return js_jit_throw(f, sp, pc + 5);
+      break;
+  }
+  return sp;
+}
+
+/* local variables with a TDZ check and closure variables */
+
+static JSValue* js_jit_loc_check(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  int idx = get_u16(pc + 1);
+  JSValue* pv = &f->var_buf[idx];
+
+  switch (*pc) {
+    case OP_get_loc_check:
+    case OP_get_loc_checkthis:
+      if (unlikely(JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceErrorUninitialized2(
+            *pc == OP_get_loc_check ? ctx : f->caller_ctx, f->b, idx, FALSE);
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      *sp++ = JS_DupValue(ctx, *pv);
+      break;
+    case OP_put_loc_check:
+      if (unlikely(JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceErrorUninitialized2(ctx, f->b, idx, FALSE);
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      set_value(ctx, pv, sp[-1]);
+      sp--;
+      break;
+    case OP_put_loc_check_init:
+      if (unlikely(!JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceError(ctx, "'this' can be initialized only once");
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      set_value(ctx, pv, sp[-1]);
+      sp--;
+      break;
+    case OP_set_loc_uninitialized:
+      set_value(ctx, pv, JS_UNINITIALIZED);
+      break;
+    default: /* OP_close_loc */
+      close_lexical_var(ctx, f->sf, idx);
+      break;
+  }
+  return sp;
+}
+
+static JSValue* js_jit_var_ref(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  int op = *pc, idx;
+  JSValue* pv;
+
+  if (op >= OP_put_var_ref0 && op <= OP_put_var_ref3) {
+    set_value(ctx, f->var_refs[op - OP_put_var_ref0]->pvalue, *--sp);
+    return sp;
+  }
+  if (op >= OP_set_var_ref0 && op <= OP_set_var_ref3) {
+    set_value(
+        ctx, f->var_refs[op - OP_set_var_ref0]->pvalue, JS_DupValue(ctx, sp[-1]));
+    return sp;
+  }
+  idx = get_u16(pc + 1);
+  pv = f->var_refs[idx]->pvalue;
+  switch (op) {
+    case OP_put_var_ref:
+      set_value(ctx, pv, *--sp);
+      break;
+    case OP_set_var_ref:
+      set_value(ctx, pv, JS_DupValue(ctx, sp[-1]));
+      break;
+    case OP_get_var_ref_check:
+      if (unlikely(JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceErrorUninitialized2(ctx, f->b, idx, TRUE);
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      *sp++ = JS_DupValue(ctx, *pv);
+      break;
+    case OP_put_var_ref_check:
+      if (unlikely(JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceErrorUninitialized2(ctx, f->b, idx, TRUE);
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      set_value(ctx, pv, *--sp);
+      break;
+    default: /* OP_put_var_ref_check_init */
+      if (unlikely(!JS_IsUninitialized(*pv))) {
+        JS_ThrowReferenceErrorUninitialized2(ctx, f->b, idx, TRUE);
+        return js_jit_throw(f, sp, pc + 3);
+      }
+      set_value(ctx, pv, *--sp);
+      break;
+  }
+  return sp;
+}
+
+/* exceptions and iterators */
+
+static JSValue* js_jit_catch(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  int32_t diff = get_u32(pc + 1);
+  *sp++ = JS_NewCatchOffset(f->ctx, pc + 1 + diff - f->b->byte_code_buf);
+  return sp;
+}
+
+static JSValue* js_jit_nip_catch(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue ret_val;
+
+  /* catch_offset ... ret_val -> ret_eval */
+  ret_val = *--sp;
+  while (sp > f->stack_buf && JS_VALUE_GET_TAG(sp[-1]) != JS_TAG_CATCH_OFFSET)
+    JS_FreeValue(ctx, *--sp);
+  if (unlikely(sp == f->stack_buf)) {
+    JS_ThrowInternalError(ctx, "nip_catch");
+    JS_FreeValue(ctx, ret_val);
+    return js_jit_throw(f, sp, pc + 1);
+  }
+  sp[-1] = ret_val;
+  return sp;
+}
+
+static JSValue* js_jit_iterator(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  const uint8_t* pc_end = pc + 1;
+  JSValue ret;
+
+  js_jit_set_pc(f, pc_end);
+  switch (*pc) {
+    case OP_for_in_start:
+      if (js_for_in_start(ctx, sp))
+        goto exception;
+      break;
+    case OP_for_in_next:
+      if (js_for_in_next(ctx, sp))
+        goto exception;
+      sp += 2;
+      break;
+    case OP_for_of_start:
+      if (js_for_of_start(ctx, sp, FALSE))
+        goto exception;
+      sp += 1;
+      *sp++ = JS_NewCatchOffset(ctx, 0);
+      break;
+    case OP_for_of_next:
+      pc_end = pc + 2;
+      js_jit_set_pc(f, pc_end);
+      if (js_for_of_next(ctx, sp, -3 - pc[1]))
+        goto exception;
+      sp += 2;
+      break;
+    case OP_iterator_get_value_done:
+      if (js_iterator_get_value_done(ctx, sp))
+        goto exception;
+      sp += 1;
+      break;
+    case OP_iterator_check_object:
+      if (unlikely(!JS_IsObject(sp[-1]))) {
+        JS_ThrowTypeError(ctx, "iterator must return an object");
+        goto exception;
+      }
+      break;
+    case OP_iterator_close:
+      /* iter_obj next catch_offset -> */
+      sp--; /* drop the catch offset to avoid getting caught by exception */
+      JS_FreeValue(ctx, sp[-1]); /* drop the next method */
+      sp--;
+      if (!JS_IsUndefined(sp[-1])) {
+        if (JS_IteratorClose(ctx, sp[-1], FALSE))
+          goto exception;
+        JS_FreeValue(ctx, sp[-1]);
+      }
+      sp--;
+      break;
+    case OP_iterator_next:
+      /* stack: iter_obj next catch_offset val */
+      ret = JS_Call(ctx, sp[-3], sp[-4], 1, (JSValueConst*)(sp - 1));
+      if (JS_IsException(ret))
+        goto exception;
+      JS_FreeValue(ctx, sp[-1]);
+      sp[-1] = ret;
+      break;
+    default: /* OP_iterator_call */ {
+      JSValue method;
+      BOOL ret_flag;
+      int flags = pc[1];
+      pc_end = pc + 2;
+      js_jit_set_pc(f, pc_end);
+      method = JS_GetProperty(
+          ctx, sp[-4], (flags & 1) ? JS_ATOM_throw : JS_ATOM_return);
+      if (JS_IsException(method))
+        goto exception;
+      if (JS_IsUndefined(method) || JS_IsNull(method)) {
+        ret_flag = TRUE;
+      } else {
+        if (flags & 2) {
+          /* no argument */
+          ret = JS_CallFree(ctx, method, sp[-4], 0, NULL);
+        } else {
+          ret = JS_CallFree(ctx, method, sp[-4], 1, (JSValueConst*)(sp - 1));
+        }
+        if (JS_IsException(ret))
+          goto exception;
+        JS_FreeValue(ctx, sp[-1]);
+        sp[-1] = ret;
+        ret_flag = FALSE;
+      }
+      sp[0] = JS_NewBool(ctx, ret_flag);
+      sp += 1;
+    } break;
+  }
+  return sp;
+exception:
+  return js_jit_throw(f, sp, pc_end);
+}
+
+/* arithmetic, the native code handles the int cases without overflow */
+
+static JSValue* js_jit_add(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue op1 = sp[-2], op2 = sp[-1];
+
+  if (JS_VALUE_IS_BOTH_FLOAT(op1, op2)) {
+    sp[-2] = __JS_NewFloat64(
+        ctx, JS_VALUE_GET_FLOAT64(op1) + JS_VALUE_GET_FLOAT64(op2));
+  } else if (JS_IsString(op1) && JS_IsString(op2)) {
+    sp[-2] = JS_ConcatString(ctx, op1, op2);
+    if (JS_IsException(sp[-2]))
+      return js_jit_throw(f, sp - 1, pc + 1);
+  } else {
+    js_jit_set_pc(f, pc + 1);
+    if (js_add_slow(ctx, sp))
+      return js_jit_throw(f, sp, pc + 1);
+  }
+  return sp - 1;
+}
+
+static JSValue* js_jit_add_loc(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue* pv = &f->var_buf[pc[1]];
+  JSValue op2 = sp[-1];
+
+  js_jit_set_pc(f, pc + 2);
+  if (JS_VALUE_IS_BOTH_FLOAT(*pv, op2)) {
+    *pv = __JS_NewFloat64(
+        ctx, JS_VALUE_GET_FLOAT64(*pv) + JS_VALUE_GET_FLOAT64(op2));
+    sp--;
+  } else if (JS_VALUE_GET_TAG(*pv) == JS_TAG_STRING) {
+    sp--;
+    op2 = JS_ToPrimitiveFree(ctx, op2, HINT_NONE);
+    if (JS_IsException(op2))
+      return js_jit_throw(f, sp, pc + 2);
+    if (JS_ConcatStringInPlace(ctx, JS_VALUE_GET_STRING(*pv), op2)) {
+      JS_FreeValue(ctx, op2);
+    } else {
+      op2 = JS_ConcatString(ctx, JS_DupValue(ctx, *pv), op2);
+      if (JS_IsException(op2))
+        return js_jit_throw(f, sp, pc + 2);
+      set_value(ctx, pv, op2);
+    }
+  } else {
+    JSValue ops[2];
+    /* In case of exception, js_add_slow frees ops[0]
+       and ops[1], so we must duplicate *pv */
+    ops[0] = JS_DupValue(ctx, *pv);
+    ops[1] = op2;
+    sp--;
+    if (js_add_slow(ctx, ops + 2))
+      return js_jit_throw(f, sp, pc + 2);
+    set_value(ctx, pv, ops[0]);
+  }
+  return sp;
+}
+
+static JSValue* js_jit_binary_arith(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue op1 = sp[-2], op2 = sp[-1];
+  int op = *pc;
+
+  if (JS_VALUE_IS_BOTH_INT(op1, op2)) {
+    int32_t v1 = JS_VALUE_GET_INT(op1), v2 = JS_VALUE_GET_INT(op2);
+    int64_t r;
+    switch (op) {
+      case OP_mul:
+        r = (int64_t)v1 * v2;
+        if (unlikely((int)r != r)) {
+          sp[-2] = __JS_NewFloat64(ctx, (double)r);
+        } else if (unlikely(r == 0 && (v1 | v2) < 0)) {
+          /* -0 result */
+          sp[-2] = __JS_NewFloat64(ctx, -0.0);
+        } else {
+          sp[-2] = JS_NewInt32(ctx, r);
+        }
+        return sp - 1;
+      case OP_div:
+        sp[-2] = JS_NewFloat64(ctx, (double)v1 / (double)v2);
+        return sp - 1;
+      case OP_mod:
+        /* We must avoid v2 = 0, v1 = INT32_MIN and v2 =
+           -1 and the cases where the result is -0. */
+        if (v1 >= 0 && v2 > 0) {
+          sp[-2] = JS_NewInt32(ctx, v1 % v2);
+          return sp - 1;
+        }
+        break;
+      default:
+        break;
+    }
+  } else if (JS_VALUE_IS_BOTH_FLOAT(op1, op2)) {
+    double d1 = JS_VALUE_GET_FLOAT64(op1), d2 = JS_VALUE_GET_FLOAT64(op2);
+    switch (op) {
+      case OP_sub:
+        sp[-2] = __JS_NewFloat64(ctx, d1 - d2);
+        return sp - 1;
+      case OP_mul:
+        sp[-2] = __JS_NewFloat64(ctx, d1 * d2);
+        return sp - 1;
+      default:
+        break;
+    }
+  }
+  js_jit_set_pc(f, pc + 1);
+  if (js_binary_arith_slow(ctx, sp, op))
+    return js_jit_throw(f, sp, pc + 1);
+  return sp - 1;
+}
+
+static JSValue* js_jit_binary_logic(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue op1 = sp[-2], op2 = sp[-1];
+  int op = *pc;
+
+  if (JS_VALUE_IS_BOTH_INT(op1, op2)) {
+    uint32_t v1 = JS_VALUE_GET_INT(op1), v2 = JS_VALUE_GET_INT(op2);
+    switch (op) {
+      case OP_shl:
+        sp[-2] = JS_NewInt32(ctx, v1 << (v2 & 0x1f));
+        break;
+      case OP_sar:
+        sp[-2] = JS_NewInt32(ctx, (int)v1 >> (v2 & 0x1f));
+        break;
+      case OP_shr:
+        sp[-2] = JS_NewUint32(ctx, v1 >> (v2 & 0x1f));
+        break;
+      case OP_and:
+        sp[-2] = JS_NewInt32(ctx, v1 & v2);
+        break;
+      case OP_or:
+        sp[-2] = JS_NewInt32(ctx, v1 | v2);
+        break;
+      default:
+        sp[-2] = JS_NewInt32(ctx, v1 ^ v2);
+        break;
+    }
+    return sp - 1;
+  }
+  js_jit_set_pc(f, pc + 1);
+  if (op == OP_shr) {
+    if (js_shr_slow(ctx, sp))
+      return js_jit_throw(f, sp, pc + 1);
+  } else {
+    if (js_binary_logic_slow(ctx, sp, op))
+      return js_jit_throw(f, sp, pc + 1);
+  }
+  return sp - 1;
+}
+
+static JSValue* js_jit_compare(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  int op = *pc, ret;
+
+  js_jit_set_pc(f, pc + 1);
+  switch (op) {
+    case OP_eq:
+    case OP_neq:
+      ret = js_eq_slow(ctx, sp, op == OP_neq);
+      break;
+    case OP_strict_eq:
+    case OP_strict_neq:
+      ret = js_strict_eq_slow(ctx, sp, op == OP_strict_neq);
+      break;
+    default:
+      ret = js_relational_slow(ctx, sp, op);
+      break;
+  }
+  if (ret)
+    return js_jit_throw(f, sp, pc + 1);
+  return sp - 1;
+}
+
+static JSValue* js_jit_unary_arith(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue op1 = sp[-1];
+  uint32_t tag = JS_VALUE_GET_TAG(op1);
+  int op = *pc;
+
+  switch (op) {
+    case OP_plus:
+      if (tag == JS_TAG_INT || JS_TAG_IS_FLOAT64(tag))
+        return sp;
+      break;
+    case OP_neg:
+      if (tag == JS_TAG_INT) {
+        int val = JS_VALUE_GET_INT(op1);
+        /* Note: -0 cannot be expressed as integer */
+        if (val == 0 || val == INT32_MIN)
+          sp[-1] = __JS_NewFloat64(ctx, -(double)val);
+        else
+          sp[-1] = JS_NewInt32(ctx, -val);
+        return sp;
+      }
+      if (JS_TAG_IS_FLOAT64(tag)) {
+        sp[-1] = __JS_NewFloat64(ctx, -JS_VALUE_GET_FLOAT64(op1));
+        return sp;
+      }
+      break;
+    case OP_not:
+      if (tag == JS_TAG_INT) {
+        sp[-1] = JS_NewInt32(ctx, ~JS_VALUE_GET_INT(op1));
+        return sp;
+      }
+      js_jit_set_pc(f, pc + 1);
+      if (js_not_slow(ctx, sp))
+        return js_jit_throw(f, sp, pc + 1);
+      return sp;
+    case OP_post_inc:
+    case OP_post_dec:
+      js_jit_set_pc(f, pc + 1);
+      if (js_post_inc_slow(ctx, sp, op))
+        return js_jit_throw(f, sp, pc + 1);
+      return sp + 1;
+    default: /* OP_inc, OP_dec */
+      break;
+  }
+  js_jit_set_pc(f, pc + 1);
+  if (js_unary_arith_slow(ctx, sp, op))
+    return js_jit_throw(f, sp, pc + 1);
+  return sp;
+}
+
+static JSValue* js_jit_inc_loc(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue* pv = &f->var_buf[pc[1]];
+  JSValue op1;
+
+  js_jit_set_pc(f, pc + 2);
+  /* must duplicate otherwise the variable value may
+     be destroyed before JS code accesses it */
+  op1 = JS_DupValue(ctx, *pv);
+  if (js_unary_arith_slow(
+          ctx, &op1 + 1, *pc == OP_inc_loc ? OP_inc : OP_dec))
+    return js_jit_throw(f, sp, pc + 2);
+  set_value(ctx, pv, op1);
+  return sp;
+}
+
+static JSValue* js_jit_unary_op(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue op1 = sp[-1], val;
+  BOOL res;
+
+  switch (*pc) {
+    case OP_lnot:
+      if ((uint32_t)JS_VALUE_GET_TAG(op1) <= JS_TAG_UNDEFINED)
+        res = JS_VALUE_GET_INT(op1) != 0;
+      else
+        res = JS_ToBoolFree(ctx, op1);
+      sp[-1] = JS_NewBool(ctx, !res);
+      return sp;
+    case OP_typeof:
+      val = JS_AtomToString(ctx, js_operator_typeof(ctx, op1));
+      JS_FreeValue(ctx, op1);
+      sp[-1] = val;
+      return sp;
+    case OP_is_undefined_or_null:
+      res = JS_IsUndefined(op1) || JS_IsNull(op1);
+      break;
+    case OP_is_undefined:
+      res = JS_IsUndefined(op1);
+      break;
+    case OP_is_null:
+      res = JS_IsNull(op1);
+      break;
+    case OP_typeof_is_undefined:
+      /* different from OP_is_undefined because of isHTMLDDA */
+      res = js_operator_typeof(ctx, op1) == JS_ATOM_undefined;
+      break;
+    default: /* OP_typeof_is_function */
+      res = js_operator_typeof(ctx, op1) == JS_ATOM_function;
+      break;
+  }
+  JS_FreeValue(ctx, op1);
+  sp[-1] = JS_NewBool(ctx, res);
+  return sp;
+}
+
+static JSValue* js_jit_operator(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue val;
+  int ret;
+
+  js_jit_set_pc(f, pc + 1);
+  switch (*pc) {
+    case OP_in:
+      ret = js_operator_in(ctx, sp);
+      break;
+    case OP_instanceof:
+      ret = js_operator_instanceof(ctx, sp);
+      break;
+    case OP_delete:
+      ret = js_operator_delete(ctx, sp);
+      break;
+    case OP_to_object:
+      if (JS_VALUE_GET_TAG(sp[-1]) != JS_TAG_OBJECT) {
+        val = JS_ToObject(ctx, sp[-1]);
+        if (JS_IsException(val))
+          return js_jit_throw(f, sp, pc + 1);
+        JS_FreeValue(ctx, sp[-1]);
+        sp[-1] = val;
+      }
+      return sp;
+    default: /* OP_to_propkey */
+      switch (JS_VALUE_GET_TAG(sp[-1])) {
+        case JS_TAG_INT:
+        case JS_TAG_STRING:
+        case JS_TAG_SYMBOL:
+          break;
+        default:
+          val = JS_ToPropertyKey(ctx, sp[-1]);
+          if (JS_IsException(val))
+            return js_jit_throw(f, sp, pc + 1);
+          JS_FreeValue(ctx, sp[-1]);
+          sp[-1] = val;
+          break;
+      }
+      return sp;
+  }
+  if (ret)
+    return js_jit_throw(f, sp, pc + 1);
+  return sp - 1;
+}
+
+/* properties. The interpreter rewrites the field opcodes to their inline
+   cache variant on first execution, so the opcode is read again here. */
+
+static JSValue* js_jit_get_field(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  InlineCache* ic = f->b->ic;
+  uint8_t* bc = (uint8_t*)pc;
+  JSValue val, obj;
+  JSAtom atom;
+  int op = *pc;
+
+  js_jit_set_pc(f, pc + 5);
+  if (op == OP_get_field_ic || op == OP_get_field2_ic) {
+    int32_t ic_offset = get_u32(pc + 1);
+    atom = get_ic_atom(ic, ic_offset);
+    val = JS_GetPropertyInternalWithIC(
+        ctx, sp[-1], atom, sp[-1], FALSE, ic, ic_offset);
+    ic->updated = FALSE;
+    if (unlikely(JS_IsException(val)))
+      return js_jit_throw(f, sp, pc + 5);
+  } else {
+    obj = sp[-1];
+    atom = get_u32(pc + 1);
+    val = JS_GetPropertyInternal(ctx, obj, atom, obj, FALSE, ic);
+    if (unlikely(JS_IsException(val)))
+      return js_jit_throw(f, sp, pc + 5);
+    if (ic != NULL && ic->updated == TRUE) {
+      ic->updated = FALSE;
+      put_u8(bc, op == OP_get_field ? OP_get_field_ic : OP_get_field2_ic);
+      put_u32(bc + 1, ic->updated_offset);
+      // safe free call because ic struct will retain atom
+      JS_FreeAtom(ctx, atom);
+    }
+  }
+  if (op == OP_get_field || op == OP_get_field_ic) {
+    JS_FreeValue(ctx, sp[-1]);
+    sp[-1] = val;
+  } else {
+    *sp++ = val;
+  }
+  return sp;
+}
+
+static JSValue* js_jit_get_loc_field(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  InlineCache* ic = f->b->ic;
+  uint8_t* bc = (uint8_t*)pc;
+  JSValue val, obj;
+  JSAtom atom;
+  int idx = pc[5];
+
+  /* the getter may modify the variable */
+  obj = JS_DupValue(
+      ctx, (idx & 0x80) ? f->arg_buf[idx & 0x7f] : f->var_buf[idx]);
+  js_jit_set_pc(f, pc + 6);
+  if (*pc == OP_get_loc_field_ic) {
+    int32_t ic_offset = get_u32(pc + 1);
+    atom = get_ic_atom(ic, ic_offset);
+    val = JS_GetPropertyInternalWithIC(
+        ctx, obj, atom, obj, FALSE, ic, ic_offset);
+    ic->updated = FALSE;
+    JS_FreeValue(ctx, obj);
+  } else {
+    atom = get_u32(pc + 1);
+    val = JS_GetPropertyInternal(ctx, obj, atom, obj, FALSE, ic);
+    JS_FreeValue(ctx, obj);
+    if (!JS_IsException(val) && ic != NULL && ic->updated == TRUE) {
+      ic->updated = FALSE;
+      put_u8(bc, OP_get_loc_field_ic);
+      put_u32(bc + 1, ic->updated_offset);
+      // safe free call because ic struct will retain atom
+      JS_FreeAtom(ctx, atom);
+    }
+  }
+  if (unlikely(JS_IsException(val)))
+    return js_jit_throw(f, sp, pc + 6);
+  *sp++ = val;
+  return sp;
+}
+
+static JSValue* js_jit_put_field(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  InlineCache* ic = f->b->ic;
+  uint8_t* bc = (uint8_t*)pc;
+  JSAtom atom;
+  int ret;
+
+  js_jit_set_pc(f, pc + 5);
+  if (*pc == OP_put_field_ic) {
+    int32_t ic_offset = get_u32(pc + 1);
+    atom = get_ic_atom(ic, ic_offset);
+    ret = JS_SetPropertyInternalWithIC(
+        ctx,
+        sp[-2],
+        atom,
+        sp[-1],
+        sp[-2],
+        JS_PROP_THROW_STRICT,
+        ic,
+        ic_offset);
+    ic->updated = FALSE;
+    JS_FreeValue(ctx, sp[-2]);
+    sp -= 2;
+  } else {
+    atom = get_u32(pc + 1);
+    ret = JS_SetPropertyInternal(
+        ctx, sp[-2], atom, sp[-1], sp[-2], JS_PROP_THROW_STRICT, ic);
+    JS_FreeValue(ctx, sp[-2]);
+    sp -= 2;
+    if (ret >= 0 && ic != NULL && ic->updated == TRUE) {
+      ic->updated = FALSE;
+      put_u8(bc, OP_put_field_ic);
+      put_u32(bc + 1, ic->updated_offset);
+      // safe free call because ic struct will retain atom
+      JS_FreeAtom(ctx, atom);
+    }
+  }
+  if (unlikely(ret < 0))
+    return js_jit_throw(f, sp, pc + 5);
+  return sp;
+}
+
+static JSValue* js_jit_get_length(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue val;
+
+  js_jit_set_pc(f, pc + 1);
+  val = JS_GetProperty(ctx, sp[-1], JS_ATOM_length);
+  if (unlikely(JS_IsException(val)))
+    return js_jit_throw(f, sp, pc + 1);
+  JS_FreeValue(ctx, sp[-1]);
+  sp[-1] = val;
+  return sp;
+}
+
+static JSValue* js_jit_array_el(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  JSValue val;
+  int ret;
+
+  js_jit_set_pc(f, pc + 1);
+  switch (*pc) {
+    case OP_get_array_el:
+      val = JS_GetPropertyValue(ctx, sp[-2], sp[-1]);
+      JS_FreeValue(ctx, sp[-2]);
+      sp[-2] = val;
+      sp--;
+      if (unlikely(JS_IsException(val)))
+        return js_jit_throw(f, sp, pc + 1);
+      break;
+    case OP_get_array_el2:
+      val = JS_GetPropertyValue(ctx, sp[-2], sp[-1]);
+      sp[-1] = val;
+      if (unlikely(JS_IsException(val)))
+        return js_jit_throw(f, sp, pc + 1);
+      break;
+    case OP_get_array_el3:
+      switch (JS_VALUE_GET_TAG(sp[-2])) {
+        case JS_TAG_INT:
+        case JS_TAG_STRING:
+        case JS_TAG_SYMBOL:
+          /* undefined and null are tested in JS_GetPropertyValue() */
+          break;
+        default:
+          /* must be tested nefore JS_ToPropertyKey */
+          if (unlikely(JS_IsUndefined(sp[-2]) || JS_IsNull(sp[-2]))) {
+            JS_ThrowTypeError(ctx, "value has no property");
+            return js_jit_throw(f, sp, pc + 1);
+          }
+          val = JS_ToPropertyKey(ctx, sp[-1]);
+          if (JS_IsException(val))
+            return js_jit_throw(f, sp, pc + 1);
+          JS_FreeValue(ctx, sp[-1]);
+          sp[-1] = val;
+          break;
+      }
+      val = JS_GetPropertyValue(ctx, sp[-2], JS_DupValue(ctx, sp[-1]));
+      *sp++ = val;
+      if (unlikely(JS_IsException(val)))
+        return js_jit_throw(f, sp, pc + 1);
+      break;
+    default: /* OP_put_array_el */
+      ret = JS_SetPropertyValue(
+          ctx, sp[-3], sp[-2], sp[-1], JS_PROP_THROW_STRICT);
+      JS_FreeValue(ctx, sp[-3]);
+      sp -= 3;
+      if (unlikely(ret < 0))
+        return js_jit_throw(f, sp, pc + 1);
+      break;
+  }
+  return sp;
+}
+
+/* object and array literals */
+static JSValue* js_jit_define(
+    JSJitFrame* f,
+    JSValue* sp,
+    const uint8_t* pc) {
+  JSContext* ctx = f->ctx;
+  const uint8_t* pc_end;
+  int ret, mask;
+
+  switch (*pc) {
+    case OP_define_field:
+      pc_end = pc + 5;
+      ret = JS_DefinePropertyValue(
+          ctx, sp[-2], get_u32(pc + 1), sp[-1], JS_PROP_C_W_E | JS_PROP_THROW);
+      sp--;
+      break;
+    case OP_set_name:
+      pc_end = pc + 5;
+      ret = JS_DefineObjectName(
+          ctx, sp[-1], get_u32(pc + 1), JS_PROP_CONFIGURABLE);
+      break;
+    case OP_define_array_el:
+      pc_end = pc + 1;
+      ret = JS_DefinePropertyValueValue(
+          ctx,
+          sp[-3],
+          JS_DupValue(ctx, sp[-2]),
+          sp[-1],
+          JS_PROP_C_W_E | JS_PROP_THROW);
+      sp -= 1;
+      break;
+    case OP_append:
+      /* array pos enumobj -- array pos */
+      pc_end = pc + 1;
+      js_jit_set_pc(f, pc_end);
+      ret = js_append_enumerate(ctx, sp);
+      if (!ret)
+        JS_FreeValue(ctx, *--sp);
+      break;
+    default: /* OP_copy_data_properties */
+      /* stack offsets (-1 based):
+         2 bits for target,
+         3 bits for source,
+         2 bits for exclusionList */
+      mask = pc[1];
+      pc_end = pc + 2;
+      js_jit_set_pc(f, pc_end);
+      ret = JS_CopyDataProperties(
+          ctx,
+          sp[-1 - (mask & 3)],
+          sp[-1 - ((mask >> 2) & 7)],
+          sp[-1 - ((mask >> 5) & 7)],
+          0);
+      break;
+  }
+  if (unlikely(ret < 0))
+    return js_jit_throw(f, sp, pc_end);
+  return sp;
+}
+
+/* slow path of the opcodes which are not inlined, NULL if the native code
+   must return to the interpreter ("deopt") */
+static JSJitHelper* js_jit_get_helper(int op) {
+  switch (op) {
+    case OP_push_const:
+    case OP_push_const8:
+      return js_jit_push_const;
+    case OP_fclosure:
+    case OP_fclosure8:
+      return js_jit_fclosure;
+    case OP_push_atom_value:
+    case OP_push_empty_string:
+    case OP_push_bigint_i32:
+    case OP_object:
+      return js_jit_push_value;
+    case OP_push_this:
+      return js_jit_push_this;
+    case OP_special_object:
+      return js_jit_special_object;
+    case OP_rest:
+      return js_jit_rest;
+    case OP_nip:
+    case OP_nip1:
+    case OP_dup1:
+    case OP_dup2:
+    case OP_dup3:
+    case OP_insert2:
+    case OP_insert3:
+    case OP_insert4:
+    case OP_perm3:
+    case OP_perm4:
+    case OP_perm5:
+    case OP_swap:
+    case OP_swap2:
+    case OP_rot3l:
+    case OP_rot3r:
+    case OP_rot4l:
+    case OP_rot5l:
+      return js_jit_stack_op;
+    case OP_call0:
+    case OP_call1:
+    case OP_call2:
+    case OP_call3:
+    case OP_call:
+      return js_jit_call;
+    case OP_call_method:
+      return js_jit_call_method;
+    case OP_call_constructor:
+      return js_jit_call_constructor;
+    case OP_array_from:
+      return js_jit_array_from;
+    case OP_apply:
+      return js_jit_apply;
+    case OP_check_ctor:
+    case OP_check_ctor_return:
+      return js_jit_check_ctor;
+    case OP_throw:
+      return js_jit_throw_op;
+    case OP_check_var:
+    case OP_get_var_undef:
+    case OP_get_var:
+    case OP_put_var:
+    case OP_put_var_init:
+    case OP_put_var_strict:
+      return js_jit_global_var;
+    case OP_get_loc_check:
+    case OP_get_loc_checkthis:
+    case OP_put_loc_check:
+    case OP_put_loc_check_init:
+    case OP_set_loc_uninitialized:
+    case OP_close_loc:
+      return js_jit_loc_check;
+    case OP_put_var_ref:
+    case OP_set_var_ref:
+    case OP_put_var_ref0:
+    case OP_put_var_ref1:
+    case OP_put_var_ref2:
+    case OP_put_var_ref3:
+    case OP_set_var_ref0:
+    case OP_set_var_ref1:
+    case OP_set_var_ref2:
+    case OP_set_var_ref3:
+    case OP_get_var_ref_check:
+    case OP_put_var_ref_check:
+    case OP_put_var_ref_check_init:
+      return js_jit_var_ref;
+    case OP_catch:
+      return js_jit_catch;
+    case OP_nip_catch:
+      return js_jit_nip_catch;
+    case OP_for_in_start:
+    case OP_for_in_next:
+    case OP_for_of_start:
+    case OP_for_of_next:
+    case OP_iterator_get_value_done:
+    case OP_iterator_check_object:
+    case OP_iterator_close:
+    case OP_iterator_next:
+    case OP_iterator_call:
+      return js_jit_iterator;
+    case OP_mul:
+    case OP_div:
+    case OP_mod:
+    case OP_pow:
+      return js_jit_binary_arith;
+    case OP_shl:
+    case OP_sar:
+    case OP_shr:
+      return js_jit_binary_logic;
+    case OP_in:
+    case OP_instanceof:
+    case OP_delete:
+    case OP_to_object:
+    case OP_to_propkey:
+      return js_jit_operator;
+    case OP_neg:
+    case OP_plus:
+    case OP_not:
+    case OP_post_inc:
+    case OP_post_dec:
+      return js_jit_unary_arith;
+    case OP_lnot:
+    case OP_typeof:
+    case OP_is_undefined_or_null:
+    case OP_is_undefined:
+    case OP_is_null:
+    case OP_typeof_is_undefined:
+    case OP_typeof_is_function:
+      return js_jit_unary_op;
+    case OP_get_field:
+    case OP_get_field2:
+    case OP_get_field_ic:
+    case OP_get_field2_ic:
+      return js_jit_get_field;
+    case OP_get_loc_field:
+    case OP_get_loc_field_ic:
+      return js_jit_get_loc_field;
+    case OP_put_field:
+    case OP_put_field_ic:
+      return js_jit_put_field;
+    case OP_get_length:
+      return js_jit_get_length;
+    case OP_get_array_el:
+    case OP_get_array_el2:
+    case OP_get_array_el3:
+    case OP_put_array_el:
+      return js_jit_array_el;
+    case OP_define_field:
+    case OP_set_name:
+    case OP_define_array_el:
+    case OP_append:
+    case OP_copy_data_properties:
+      return js_jit_define;
+    default:
+      return NULL;
+  }
+}
+
+/* code generation */
+
+/* x86 condition codes */
+enum {
+  JIT_CC_O = 0x0,
+  JIT_CC_A = 0x7,
+  JIT_CC_E = 0x4,
+  JIT_CC_NE = 0x5,
+  JIT_CC_L = 0xc,
+  JIT_CC_GE = 0xd,
+  JIT_CC_LE = 0xe,
+  JIT_CC_G = 0xf,
+  JIT_CC_ALWAYS = -1,
+};
+
+/* out of line code of an inlined opcode */
+enum {
+  JIT_STUB_CALL, /* call 'helper' then resume */
+  JIT_STUB_IF, /* to_bool, branch to 'target' on 'cc' or resume */
+  JIT_STUB_CMP_BRANCH, /* compare helper then JIT_STUB_IF on the result */
+  JIT_STUB_POLL, /* poll the interrupts then jump to 'target' */
+};
+
+typedef struct JSJitStub {
+  uint8_t kind;
+  int8_t cc;
+  uint8_t patch_count;
+  int patch[2]; /* rel32 jumping to the stub */
+  int resume; /* native offset of the next inline code */
+  const uint8_t* pc; /* instruction */
+  const uint8_t* pc_end; /* end of the instruction (exception position) */
+  JSJitHelper* helper;
+  uint32_t target; /* bytecode position */
+} JSJitStub;
+
+/* rel32 to the native code of a bytecode position */
+typedef struct JSJitFixup {
+  int pos;
+  uint32_t target;
+} JSJitFixup;
+
+typedef struct JSJitCompiler {
+  JSFunctionBytecode* b;
+  DynBuf code;
+  DynBuf stubs; /* JSJitStub */
+  DynBuf fixups; /* JSJitFixup */
+  int32_t* pc2native;
+  uint8_t* labels; /* TRUE for the jump targets */
+  int epilogue;
+  int exit_exception;
+} JSJitCompiler;
+
+/* The templates use the registers:
+     rbx: stack pointer (JSValue *sp)
+     r12: var_buf
+     r13: arg_buf
+     r14: JSJitFrame *f
+     r15: ctx
+   The holes are patched at the offsets given in the comments:
+   disp32 (D), imm32 (I), imm64 (Q) and rel32 (R). */
+
+/* push rbp; mov rbp, rsp; push rbx; push r12..r15; sub rsp, 8;
+   mov r14, rdi; mov rbx, rsi; mov r12, [rdi + D26]; mov r13, [rdi + D33];
+   mov r15, [rdi + D40]; jmp rdx */
+static const uint8_t jit_prologue[] = {
+    0x55, 0x48, 0x89, 0xe5, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41,
+    0x57, 0x48, 0x83, 0xec, 0x08, 0x49, 0x89, 0xfe, 0x48, 0x89, 0xf3, 0x4c,
+    0x8b, 0xa7, 0, 0, 0, 0, 0x4c, 0x8b, 0xaf, 0, 0, 0, 0, 0x4c, 0x8b, 0xbf,
+    0, 0, 0, 0, 0xff, 0xe2,
+};
+
+/* add rsp, 8; pop r15..r12; pop rbx; pop rbp; ret */
+static const uint8_t jit_epilogue[] = {
+    0x48, 0x83, 0xc4, 0x08, 0x41, 0x5f, 0x41, 0x5e,
+    0x41, 0x5d, 0x41, 0x5c, 0x5b, 0x5d, 0xc3,
+};
+
+/* mov eax, I1; jmp R6 */
+static const uint8_t jit_exit[] = {0xb8, 0, 0, 0, 0, 0xe9, 0, 0, 0, 0};
+
+/* mov [r14 + D3], rbx (f->sp); mov rax, Q9; mov [r14 + D20], rax (f->pc);
+   mov eax, I25; jmp R30 */
+static const uint8_t jit_deopt[] = {
+    0x49, 0x89, 0x9e, 0, 0, 0, 0, 0x48, 0xb8, 0, 0, 0,
+    0, 0, 0, 0, 0, 0x49, 0x89, 0x86, 0, 0, 0, 0,
+    0xb8, 0, 0, 0, 0, 0xe9, 0, 0, 0, 0,
+};
+
+/* mov rdi, r14; mov rsi, rbx; mov rdx, Q8 (pc); mov rax, Q18; call rax;
+   test rax, rax; jz R33; mov rbx, rax */
+static const uint8_t jit_call[] = {
+    0x4c, 0x89, 0xf7, 0x48, 0x89, 0xde, 0x48, 0xba, 0, 0,
+    0, 0, 0, 0, 0, 0, 0x48, 0xb8, 0, 0, 0, 0, 0, 0,
+    0, 0, 0xff, 0xd0, 0x48, 0x85, 0xc0, 0x0f, 0x84, 0,
+    0, 0, 0, 0x48, 0x89, 0xc3,
+};
+
+/* mov qword [rbx], I3; mov qword [rbx + 8], I11; add rbx, 16 */
+static const uint8_t jit_push_imm[] = {
+    0x48, 0xc7, 0x03, 0, 0, 0, 0, 0x48, 0xc7, 0x43,
+    0x08, 0, 0, 0, 0, 0x48, 0x83, 0xc3, 0x10,
+};
+
+/* mov rax, [r12 + D4]; mov rcx, [r12 + D12] */
+static const uint8_t jit_load_loc[] = {
+    0x49, 0x8b, 0x84, 0x24, 0, 0, 0, 0,
+    0x49, 0x8b, 0x8c, 0x24, 0, 0, 0, 0,
+};
+
+/* mov rax, [r13 + D3]; mov rcx, [r13 + D10] */
+static const uint8_t jit_load_arg[] = {
+    0x49, 0x8b, 0x85, 0, 0, 0, 0, 0x49, 0x8b, 0x8d, 0, 0, 0, 0,
+};
+
+/* mov rdx, [r14 + D3] (var_refs); mov rdx, [rdx + D10]; mov rdx, [rdx + D17]
+   (pvalue); mov rax, [rdx]; mov rcx, [rdx + 8] */
+static const uint8_t jit_load_var_ref[] = {
+    0x49, 0x8b, 0x96, 0, 0, 0, 0, 0x48, 0x8b, 0x92, 0, 0, 0, 0,
+    0x48, 0x8b, 0x92, 0, 0, 0, 0, 0x48, 0x8b, 0x02, 0x48, 0x8b,
+    0x4a, 0x08,
+};
+
+/* mov [rbx], rax; mov [rbx + 8], rcx; add rbx, 16;
+   cmp ecx, -9; jb 1f; inc dword [rax]; 1: */
+static const uint8_t jit_dup_push[] = {
+    0x48, 0x89, 0x03, 0x48, 0x89, 0x4b, 0x08, 0x48, 0x83,
+    0xc3, 0x10, 0x83, 0xf9, 0xf7, 0x72, 0x02, 0xff, 0x00,
+};
+
+/* free the value in rax/rcx:
+   cmp ecx, -9; jb 1f; dec dword [rax]; jg 1f; mov rdi, r15; mov rsi, rax;
+   mov rdx, rcx; mov rax, Q20; call rax; 1: */
+static const uint8_t jit_free[] = {
+    0x83, 0xf9, 0xf7, 0x72, 0x19, 0xff, 0x08, 0x7f, 0x15, 0x4c,
+    0x89, 0xff, 0x48, 0x89, 0xc6, 0x48, 0x89, 0xca, 0x48, 0xb8,
+    0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xd0,
+};
+
+/* sub rbx, 16; mov rax, [r12 + D8]; mov rcx, [r12 + D16]; mov rdx, [rbx];
+   mov [r12 + D27], rdx; mov rdx, [rbx + 8]; mov [r12 + D39], rdx */
+static const uint8_t jit_put_loc[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x49, 0x8b, 0x84, 0x24, 0, 0, 0,
+    0, 0x49, 0x8b, 0x8c, 0x24, 0, 0, 0, 0, 0x48, 0x8b,
+    0x13, 0x49, 0x89, 0x94, 0x24, 0, 0, 0, 0, 0x48, 0x8b,
+    0x53, 0x08, 0x49, 0x89, 0x94, 0x24, 0, 0, 0, 0,
+};
+
+/* sub rbx, 16; mov rax, [r13 + D7]; mov rcx, [r13 + D14]; mov rdx, [rbx];
+   mov [r13 + D24], rdx; mov rdx, [rbx + 8]; mov [r13 + D35], rdx */
+static const uint8_t jit_put_arg[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x49, 0x8b, 0x85, 0, 0, 0, 0, 0x49, 0x8b,
+    0x8d, 0, 0, 0, 0, 0x48, 0x8b, 0x13, 0x49, 0x89, 0x95, 0, 0,
+    0, 0, 0x48, 0x8b, 0x53, 0x08, 0x49, 0x89, 0x95, 0, 0, 0, 0,
+};
+
+/* mov rdx, [rbx - 16]; mov rsi, [rbx - 8]; cmp esi, -9; jb 1f;
+   inc dword [rdx]; 1: mov rax, [r12 + D19]; mov rcx, [r12 + D27];
+   mov [r12 + D35], rdx; mov [r12 + D43], rsi */
+static const uint8_t jit_set_loc[] = {
+    0x48, 0x8b, 0x53, 0xf0, 0x48, 0x8b, 0x73, 0xf8, 0x83, 0xfe, 0xf7, 0x72,
+    0x02, 0xff, 0x02, 0x49, 0x8b, 0x84, 0x24, 0, 0, 0, 0, 0x49,
+    0x8b, 0x8c, 0x24, 0, 0, 0, 0, 0x49, 0x89, 0x94, 0x24, 0,
+    0, 0, 0, 0x49, 0x89, 0xb4, 0x24, 0, 0, 0, 0,
+};
+
+/* same as jit_set_loc with r13: D18, D25, D32, D39 */
+static const uint8_t jit_set_arg[] = {
+    0x48, 0x8b, 0x53, 0xf0, 0x48, 0x8b, 0x73, 0xf8, 0x83, 0xfe, 0xf7,
+    0x72, 0x02, 0xff, 0x02, 0x49, 0x8b, 0x85, 0, 0, 0, 0,
+    0x49, 0x8b, 0x8d, 0, 0, 0, 0, 0x49, 0x89, 0x95, 0,
+    0, 0, 0, 0x49, 0x89, 0xb5, 0, 0, 0, 0,
+};
+
+/* sub rbx, 16; mov rax, [rbx]; mov rcx, [rbx + 8] */
+static const uint8_t jit_pop[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x48, 0x8b, 0x03, 0x48, 0x8b, 0x4b, 0x08,
+};
+
+/* mov rax, [rbx - 16]; mov rcx, [rbx - 8] */
+static const uint8_t jit_load_top[] = {
+    0x48, 0x8b, 0x43, 0xf0, 0x48, 0x8b, 0x4b, 0xf8,
+};
+
+/* sub rbx, 16; mov rax, [rbx]; mov [r14 + D10], rax; mov rax, [rbx + 8];
+   mov [r14 + D21], rax (f->ret_val); mov [r14 + D28], rbx (f->sp);
+   mov eax, I33; jmp R38 */
+static const uint8_t jit_return[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x48, 0x8b, 0x03, 0x49, 0x89, 0x86, 0, 0, 0, 0,
+    0x48, 0x8b, 0x43, 0x08, 0x49, 0x89, 0x86, 0, 0, 0, 0, 0x49, 0x89, 0x9e,
+    0, 0, 0, 0, 0xb8, 0, 0, 0, 0, 0xe9, 0, 0, 0, 0,
+};
+
+/* mov qword [r14 + D3], 0; mov qword [r14 + D14], JS_TAG_UNDEFINED;
+   mov [r14 + D25], rbx; mov eax, I30; jmp R35 */
+static const uint8_t jit_return_undef[] = {
+    0x49, 0xc7, 0x86, 0, 0, 0, 0, 0x00, 0x00, 0x00, 0x00, 0x49, 0xc7,
+    0x86, 0, 0, 0, 0, 0x03, 0x00, 0x00, 0x00, 0x49, 0x89, 0x9e, 0,
+    0, 0, 0, 0xb8, 0, 0, 0, 0, 0xe9, 0, 0, 0, 0,
+};
+
+/* both operands are ints: mov eax, [rbx - 24]; or eax, [rbx - 8]; jnz R8 */
+static const uint8_t jit_int_test[] = {
+    0x8b, 0x43, 0xe8, 0x0b, 0x43, 0xf8, 0x0f, 0x85, 0, 0, 0, 0,
+};
+
+/* mov eax, [rbx - 32]; add eax, [rbx - 16] (byte 3: 0x2b for sub); jo R8;
+   mov [rbx - 32], eax; sub rbx, 16 */
+static const uint8_t jit_add_int[] = {
+    0x8b, 0x43, 0xe0, 0x03, 0x43, 0xf0, 0x0f, 0x80, 0, 0,
+    0, 0, 0x89, 0x43, 0xe0, 0x48, 0x83, 0xeb, 0x10,
+};
+
+/* mov eax, [rbx - 32]; and eax, [rbx - 16] (byte 3: 0x0b or, 0x33 xor);
+   mov [rbx - 32], eax; sub rbx, 16 */
+static const uint8_t jit_logic_int[] = {
+    0x8b, 0x43, 0xe0, 0x23, 0x43, 0xf0, 0x89,
+    0x43, 0xe0, 0x48, 0x83, 0xeb, 0x10,
+};
+
+/* mov eax, [rbx - 32]; cmp eax, [rbx - 16]; setcc al (byte 7);
+   movzx eax, al; mov [rbx - 32], rax; mov qword [rbx - 24], JS_TAG_BOOL;
+   sub rbx, 16 */
+static const uint8_t jit_cmp_int[] = {
+    0x8b, 0x43, 0xe0, 0x3b, 0x43, 0xf0, 0x0f, 0x90, 0xc0, 0x0f,
+    0xb6, 0xc0, 0x48, 0x89, 0x43, 0xe0, 0x48, 0xc7, 0x43, 0xe8,
+    0x01, 0x00, 0x00, 0x00, 0x48, 0x83, 0xeb, 0x10,
+};
+
+/* mov eax, [rbx - 32]; mov ecx, [rbx - 16]; sub rbx, 32; cmp eax, ecx
+   (followed by a conditional jump) */
+static const uint8_t jit_cmp_branch[] = {
+    0x8b, 0x43, 0xe0, 0x8b, 0x4b, 0xf0, 0x48, 0x83, 0xeb, 0x20, 0x39, 0xc8,
+};
+
+/* bool result of a compare helper: sub rbx, 16; cmp dword [rbx], 0 */
+static const uint8_t jit_cond_slow[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x83, 0x3b, 0x00,
+};
+
+/* sub rbx, 16; mov ecx, [rbx + 8]; cmp ecx, JS_TAG_UNDEFINED; ja R12;
+   cmp dword [rbx], 0 */
+static const uint8_t jit_if[] = {
+    0x48, 0x83, 0xeb, 0x10, 0x8b, 0x4b, 0x08, 0x83, 0xf9, 0x03,
+    0x0f, 0x87, 0, 0, 0, 0, 0x83, 0x3b, 0x00,
+};
+
+/* mov rdi, r14; mov rsi, rbx; mov rax, Q8; call rax; test eax, eax */
+static const uint8_t jit_to_bool[] = {
+    0x4c, 0x89, 0xf7, 0x48, 0x89, 0xde, 0x48, 0xb8, 0, 0,
+    0, 0, 0, 0, 0, 0, 0xff, 0xd0, 0x85, 0xc0,
+};
+
+/* mov ecx, [r12 + D4]; test ecx, ecx; jnz R12; mov eax, [r12 + D20];
+   add eax, 1 (byte 25: 0xe8 for sub); jo R29; mov [r12 + D37], eax */
+static const uint8_t jit_inc_loc[] = {
+    0x41, 0x8b, 0x8c, 0x24, 0, 0, 0, 0, 0x85, 0xc9,
+    0x0f, 0x85, 0, 0, 0, 0, 0x41, 0x8b, 0x84, 0x24,
+    0, 0, 0, 0, 0x83, 0xc0, 0x01, 0x0f, 0x80, 0,
+    0, 0, 0, 0x41, 0x89, 0x84, 0x24, 0, 0, 0, 0,
+};
+
+/* mov eax, [r12 + D4]; or eax, [rbx - 8]; jnz R13; mov eax, [r12 + D21];
+   add eax, [rbx - 16]; jo R30; mov [r12 + D38], eax; sub rbx, 16 */
+static const uint8_t jit_add_loc[] = {
+    0x41, 0x8b, 0x84, 0x24, 0, 0, 0, 0, 0x0b, 0x43, 0xf8, 0x0f,
+    0x85, 0, 0, 0, 0, 0x41, 0x8b, 0x84, 0x24, 0, 0, 0,
+    0, 0x03, 0x43, 0xf0, 0x0f, 0x80, 0, 0, 0, 0, 0x41, 0x89,
+    0x84, 0x24, 0, 0, 0, 0, 0x48, 0x83, 0xeb, 0x10,
+};
+
+/* cmp dword [rbx - 8], 0; jnz R6; mov eax, [rbx - 16];
+   add eax, 1 (byte 14: 0xe8 for sub); jo R18; mov [rbx - 16], eax */
+static const uint8_t jit_inc[] = {
+    0x83, 0x7b, 0xf8, 0x00, 0x0f, 0x85, 0, 0, 0, 0, 0x8b, 0x43, 0xf0,
+    0x83, 0xc0, 0x01, 0x0f, 0x80, 0, 0, 0, 0, 0x89, 0x43, 0xf0,
+};
+
+/* cmp dword [r12 + D4], JS_TAG_UNINITIALIZED; je R11 */
+static const uint8_t jit_loc_check[] = {
+    0x41, 0x83, 0xbc, 0x24, 0, 0, 0, 0, 0x04, 0x0f, 0x84, 0, 0, 0, 0,
+};
+
+/* sub dword [r15 + D3], 1 (interrupt_counter); jg R10 */
+static const uint8_t jit_poll[] = {
+    0x41, 0x83, 0xaf, 0, 0, 0, 0, 0x01, 0x0f, 0x8f, 0, 0, 0, 0,
+};
+
+static int jit_emit(JSJitCompiler* s, const uint8_t* tpl, size_t len) {
+  int pos = s->code.size;
+  dbuf_put(&s->code, tpl, len);
+  return pos;
+}
+
+static void jit_patch32(JSJitCompiler* s, int pos, uint32_t v) {
+  if (!s->code.error)
+    put_u32(s->code.buf + pos, v);
+}
+
+static void jit_patch64(JSJitCompiler* s, int pos, const void* v) {
+  if (!s->code.error)
+    memcpy(s->code.buf + pos, &v, sizeof(v));
+}
+
+static void jit_patch8(JSJitCompiler* s, int pos, uint8_t v) {
+  if (!s->code.error)
+    s->code.buf[pos] = v;
+}
+
+/* patch the rel32 at 'pos' to jump to the native offset 'target' */
+static void jit_patch_rel(JSJitCompiler* s, int pos, int target) {
+  jit_patch32(s, pos, target - (pos + 4));
+}
+
+/* patch the rel32 at 'pos' to jump to the bytecode position 'target' */
+static void jit_fixup(JSJitCompiler* s, int pos, uint32_t target) {
+  JSJitFixup fx = {pos, target};
+  dbuf_put(&s->fixups, (const uint8_t*)&fx, sizeof(fx));
+}
+
+static JSJitStub* jit_new_stub(
+    JSJitCompiler* s,
+    int kind,
+    const uint8_t* pc,
+    const uint8_t* pc_end,
+    JSJitHelper* helper) {
+  JSJitStub* st;
+
+  if (dbuf_realloc(&s->stubs, s->stubs.size + sizeof(*st)))
+    return NULL;
+  st = (JSJitStub*)(s->stubs.buf + s->stubs.size);
+  s->stubs.size += sizeof(*st);
+  memset(st, 0, sizeof(*st));
+  st->kind = kind;
+  st->pc = pc;
+  st->pc_end = pc_end;
+  st->helper = helper;
+  st->resume = -1;
+  return st;
+}
+
+/* the stubs are stored by index because 's->stubs' may be reallocated */
+static int jit_stub(
+    JSJitCompiler* s,
+    int kind,
+    const uint8_t* pc,
+    const uint8_t* pc_end,
+    JSJitHelper* helper) {
+  if (!jit_new_stub(s, kind, pc, pc_end, helper))
+    return -1;
+  return s->stubs.size / sizeof(JSJitStub) - 1;
+}
+
+static void jit_stub_jump(JSJitCompiler* s, int idx, int pos) {
+  JSJitStub* st;
+  if (idx < 0)
+    return;
+  st = (JSJitStub*)s->stubs.buf + idx;
+  st->patch[st->patch_count++] = pos;
+}
+
+static void jit_stub_resume(JSJitCompiler* s, int idx) {
+  if (idx >= 0)
+    ((JSJitStub*)s->stubs.buf + idx)->resume = s->code.size;
+}
+
+static void jit_emit_exit(JSJitCompiler* s, int ret) {
+  int pos = jit_emit(s, jit_exit, sizeof(jit_exit));
+  jit_patch32(s, pos + 1, ret);
+  jit_patch_rel(s, pos + 6, s->epilogue);
+}
+
+static void jit_emit_deopt(JSJitCompiler* s, const uint8_t* pc) {
+  int pos = jit_emit(s, jit_deopt, sizeof(jit_deopt));
+  jit_patch32(s, pos + 3, offsetof(JSJitFrame, sp));
+  jit_patch64(s, pos + 9, pc);
+  jit_patch32(s, pos + 20, offsetof(JSJitFrame, pc));
+  jit_patch32(s, pos + 25, JS_JIT_DEOPT);
+  jit_patch_rel(s, pos + 30, s->epilogue);
+}
+
+static void jit_emit_call(
+    JSJitCompiler* s,
+    JSJitHelper* helper,
+    const uint8_t* pc) {
+  int pos = jit_emit(s, jit_call, sizeof(jit_call));
+  jit_patch64(s, pos + 8, pc);
+  jit_patch64(s, pos + 18, (void*)helper);
+  jit_patch_rel(s, pos + 33, s->exit_exception);
+}
+
+static void jit_emit_free(JSJitCompiler* s) {
+  int pos = jit_emit(s, jit_free, sizeof(jit_free));
+  jit_patch64(s, pos + 20, (void*)__JS_FreeValue);
+}
+
+static void jit_emit_push_imm(JSJitCompiler* s, int32_t val, int32_t tag) {
+  int pos = jit_emit(s, jit_push_imm, sizeof(jit_push_imm));
+  jit_patch32(s, pos + 3, val);
+  jit_patch32(s, pos + 11, tag);
+}
+
+static int32_t jit_loc_disp(int idx) {
+  return idx * (int32_t)sizeof(JSValue);
+}
+
+static void jit_emit_get(JSJitCompiler* s, int kind, int idx) {
+  int pos;
+  if (kind == 0) {
+    pos = jit_emit(s, jit_load_loc, sizeof(jit_load_loc));
+    jit_patch32(s, pos + 4, jit_loc_disp(idx));
+    jit_patch32(s, pos + 12, jit_loc_disp(idx) + 8);
+  } else if (kind == 1) {
+    pos = jit_emit(s, jit_load_arg, sizeof(jit_load_arg));
+    jit_patch32(s, pos + 3, jit_loc_disp(idx));
+    jit_patch32(s, pos + 10, jit_loc_disp(idx) + 8);
+  } else {
+    pos = jit_emit(s, jit_load_var_ref, sizeof(jit_load_var_ref));
+    jit_patch32(s, pos + 3, offsetof(JSJitFrame, var_refs));
+    jit_patch32(s, pos + 10, idx * (int32_t)sizeof(JSVarRef*));
+    jit_patch32(s, pos + 17, offsetof(JSVarRef, pvalue));
+  }
+  jit_emit(s, jit_dup_push, sizeof(jit_dup_push));
+}
+
+/* kind: 0 = local variable, 1 = argument */
+static void jit_emit_put(JSJitCompiler* s, int kind, int idx) {
+  int d = jit_loc_disp(idx), pos;
+  if (kind == 0) {
+    pos = jit_emit(s, jit_put_loc, sizeof(jit_put_loc));
+    jit_patch32(s, pos + 8, d);
+    jit_patch32(s, pos + 16, d + 8);
+    jit_patch32(s, pos + 27, d);
+    jit_patch32(s, pos + 39, d + 8);
+  } else {
+    pos = jit_emit(s, jit_put_arg, sizeof(jit_put_arg));
+    jit_patch32(s, pos + 7, d);
+    jit_patch32(s, pos + 14, d + 8);
+    jit_patch32(s, pos + 24, d);
+    jit_patch32(s, pos + 35, d + 8);
+  }
+  jit_emit_free(s);
+}
+
+static void jit_emit_set(JSJitCompiler* s, int kind, int idx) {
+  int d = jit_loc_disp(idx), pos;
+  if (kind == 0) {
+    pos = jit_emit(s, jit_set_loc, sizeof(jit_set_loc));
+    jit_patch32(s, pos + 19, d);
+    jit_patch32(s, pos + 27, d + 8);
+    jit_patch32(s, pos + 35, d);
+    jit_patch32(s, pos + 43, d + 8);
+  } else {
+    pos = jit_emit(s, jit_set_arg, sizeof(jit_set_arg));
+    jit_patch32(s, pos + 18, d);
+    jit_patch32(s, pos + 25, d + 8);
+    jit_patch32(s, pos + 32, d);
+    jit_patch32(s, pos + 39, d + 8);
+  }
+  jit_emit_free(s);
+}
+
+/* jump to the bytecode position 'target' if 'cc' (JIT_CC_ALWAYS for an
+   unconditional jump). The backward jumps poll the interrupts. */
+static void jit_emit_jump(
+    JSJitCompiler* s,
+    int cc,
+    uint32_t target,
+    const uint8_t* pc,
+    const uint8_t* pc_end) {
+  uint32_t pos = pc - s->b->byte_code_buf;
+  uint8_t jcc[6] = {0x0f, 0x80, 0, 0, 0, 0};
+  uint8_t jmp[5] = {0xe9, 0, 0, 0, 0};
+  int p, idx;
+
+  if (target <= pos) {
+    if (cc == JIT_CC_ALWAYS) {
+      p = jit_emit(s, jit_poll, sizeof(jit_poll));
+      jit_patch32(s, p + 3, offsetof(JSContext, interrupt_counter));
+      jit_fixup(s, p + 10, target);
+      jit_emit_call(s, js_jit_poll, pc_end);
+      p = jit_emit(s, jmp, sizeof(jmp));
+      jit_fixup(s, p + 1, target);
+    } else {
+      idx = jit_stub(s, JIT_STUB_POLL, pc, pc_end, js_jit_poll);
+      if (idx >= 0)
+        ((JSJitStub*)s->stubs.buf + idx)->target = target;
+      jcc[1] = 0x80 | cc;
+      p = jit_emit(s, jcc, sizeof(jcc));
+      jit_stub_jump(s, idx, p + 2);
+    }
+  } else if (cc == JIT_CC_ALWAYS) {
+    p = jit_emit(s, jmp, sizeof(jmp));
+    jit_fixup(s, p + 1, target);
+  } else {
+    jcc[1] = 0x80 | cc;
+    p = jit_emit(s, jcc, sizeof(jcc));
+    jit_fixup(s, p + 2, target);
+  }
+}
+
+/* bytecode position of the target of a branch instruction, -1 if none */
+static int jit_branch_target(const uint8_t* bc_buf, uint32_t pos) {
+  const uint8_t* pc = bc_buf + pos;
+  switch (short_opcode_info(*pc).fmt) {
+    case OP_FMT_label:
+      return pos + 1 + (int32_t)get_u32(pc + 1);
+    case OP_FMT_label8:
+      return pos + 1 + (int8_t)pc[1];
+    case OP_FMT_label16:
+      return pos + 1 + (int16_t)get_u16(pc + 1);
+    case OP_FMT_atom_label_u8:
+      return pos + 5 + (int32_t)get_u32(pc + 5);
+    default:
+      return -1;
+  }
+}
+
+static int jit_cmp_cc(int op) {
+  switch (op) {
+    case OP_lt:
+      return JIT_CC_L;
+    case OP_lte:
+      return JIT_CC_LE;
+    case OP_gt:
+      return JIT_CC_G;
+    case OP_gte:
+      return JIT_CC_GE;
+    case OP_eq:
+    case OP_strict_eq:
+      return JIT_CC_E;
+    default:
+      return JIT_CC_NE;
+  }
+}
+
+static BOOL jit_is_if(int op) {
+  return op == OP_if_false || op == OP_if_true || op == OP_if_false8 ||
+      op == OP_if_true8;
+}
+
+/* jit_int_test followed by 'tpl' which jumps to the same stub at the
+   rel32 offset 'r' (0 if none). Return the position of 'tpl'. */
+static int jit_emit_int_op(
+    JSJitCompiler* s,
+    const uint8_t* tpl,
+    size_t len,
+    int r,
+    JSJitHelper* helper,
+    const uint8_t* pc) {
+  int idx = jit_stub(s, JIT_STUB_CALL, pc, NULL, helper);
+  int p = jit_emit(s, jit_int_test, sizeof(jit_int_test));
+  jit_stub_jump(s, idx, p + 8);
+  p = jit_emit(s, tpl, len);
+  if (r)
+    jit_stub_jump(s, idx, p + r);
+  jit_stub_resume(s, idx);
+  return p;
+}
+
+/* pop the return value */
+static void jit_emit_return(JSJitCompiler* s) {
+  int p = jit_emit(s, jit_return, sizeof(jit_return));
+  jit_patch32(s, p + 10, offsetof(JSJitFrame, ret_val));
+  jit_patch32(s, p + 21, offsetof(JSJitFrame, ret_val) + 8);
+  jit_patch32(s, p + 28, offsetof(JSJitFrame, sp));
+  jit_patch32(s, p + 33, JS_JIT_RETURN);
+  jit_patch_rel(s, p + 38, s->epilogue);
+}
+
+/* compare, fused with the following if_true/if_false. Return the size of
+   the fused instructions. */
+static int jit_emit_compare(JSJitCompiler* s, const uint8_t* pc) {
+  const uint8_t* bc_buf = s->b->byte_code_buf;
+  uint32_t pos = pc - bc_buf, next = pos + 1;
+  int cc = jit_cmp_cc(*pc), p, idx, op2;
+
+  if (next < s->b->byte_code_len && jit_is_if(bc_buf[next]) &&
+      !s->labels[next]) {
+    op2 = bc_buf[next];
+    if (op2 == OP_if_false || op2 == OP_if_false8)
+      cc ^= 1;
+    idx = jit_stub(s, JIT_STUB_CMP_BRANCH, pc, pc + 1, js_jit_compare);
+    p = jit_emit(s, jit_int_test, sizeof(jit_int_test));
+    jit_stub_jump(s, idx, p + 8);
+    jit_emit(s, jit_cmp_branch, sizeof(jit_cmp_branch));
+    jit_emit_jump(
+        s,
+        cc,
+        jit_branch_target(bc_buf, next),
+        bc_buf + next,
+        bc_buf + next + short_opcode_info(op2).size);
+    jit_stub_resume(s, idx);
+    if (idx >= 0) {
+      JSJitStub* st = (JSJitStub*)s->stubs.buf + idx;
+      /* the slow path tests the boolean result */
+      st->cc = (op2 == OP_if_false || op2 == OP_if_false8) ? JIT_CC_E
+                                                             : JIT_CC_NE;
+      st->target = jit_branch_target(bc_buf, next);
+    }
+    s->pc2native[next] = -1;
+    return 1 + short_opcode_info(op2).size;
+  }
+  p = jit_emit_int_op(
+      s, jit_cmp_int, sizeof(jit_cmp_int), 0, js_jit_compare, pc);
+  jit_patch8(s, p + 7, 0x90 | cc);
+  return 1;
+}
+
+static void jit_emit_if(
+    JSJitCompiler* s,
+    const uint8_t* pc,
+    uint32_t target,
+    int size) {
+  int cc = (*pc == OP_if_false || *pc == OP_if_false8) ? JIT_CC_E : JIT_CC_NE;
+  int idx, p;
+
+  idx = jit_stub(s, JIT_STUB_IF, pc, pc + size, NULL);
+  if (idx >= 0) {
+    ((JSJitStub*)s->stubs.buf + idx)->cc = cc;
+    ((JSJitStub*)s->stubs.buf + idx)->target = target;
+  }
+  p = jit_emit(s, jit_if, sizeof(jit_if));
+  jit_stub_jump(s, idx, p + 12);
+  jit_emit_jump(s, cc, target, pc, pc + size);
+  jit_stub_resume(s, idx);
+}
+
+/* 'tpl' jumps to a JIT_STUB_CALL stub at the rel32 offsets 'r1' and 'r2'
+   (0 if none) */
+static int jit_emit_with_stub(
+    JSJitCompiler* s,
+    const uint8_t* tpl,
+    size_t len,
+    int r1,
+    int r2,
+    JSJitHelper* helper,
+    const uint8_t* pc) {
+  int idx = jit_stub(s, JIT_STUB_CALL, pc, NULL, helper);
+  int p = jit_emit(s, tpl, len);
+  jit_stub_jump(s, idx, p + r1);
+  if (r2)
+    jit_stub_jump(s, idx, p + r2);
+  jit_stub_resume(s, idx);
+  return p;
+}
+
+static void jit_emit_stubs(JSJitCompiler* s) {
+  int i, j, n = s->stubs.size / sizeof(JSJitStub), p;
+  uint8_t jmp[5] = {0xe9, 0, 0, 0, 0};
+
+  /* the branches of the stubs may add JIT_STUB_POLL stubs */
+  for (i = 0; i < n; i++) {
+    JSJitStub st = ((JSJitStub*)s->stubs.buf)[i];
+    for (j = 0; j < st.patch_count; j++)
+      jit_patch_rel(s, st.patch[j], s->code.size);
+    switch (st.kind) {
+      case JIT_STUB_CALL:
+        jit_emit_call(s, st.helper, st.pc);
+        break;
+      case JIT_STUB_IF:
+        p = jit_emit(s, jit_to_bool, sizeof(jit_to_bool));
+        jit_patch64(s, p + 8, (void*)js_jit_to_bool);
+        jit_emit_jump(s, st.cc, st.target, st.pc, st.pc_end);
+        break;
+      case JIT_STUB_CMP_BRANCH:
+        jit_emit_call(s, st.helper, st.pc);
+        jit_emit(s, jit_cond_slow, sizeof(jit_cond_slow));
+        /* the if instruction follows the compare */
+        jit_emit_jump(
+            s,
+            st.cc,
+            st.target,
+            st.pc + 1,
+            st.pc + 1 + short_opcode_info(st.pc[1]).size);
+        break;
+      default: /* JIT_STUB_POLL */
+        p = jit_emit(s, jit_poll, sizeof(jit_poll));
+        jit_patch32(s, p + 3, offsetof(JSContext, interrupt_counter));
+        jit_fixup(s, p + 10, st.target);
+        jit_emit_call(s, js_jit_poll, st.pc_end);
+        p = jit_emit(s, jmp, sizeof(jmp));
+        jit_fixup(s, p + 1, st.target);
+        continue;
+    }
+    p = jit_emit(s, jmp, sizeof(jmp));
+    jit_patch_rel(s, p + 1, st.resume);
+  }
+  if (n < (int)(s->stubs.size / sizeof(JSJitStub))) {
+    /* emit the poll stubs created by the stubs */
+    JSJitStub* tab = (JSJitStub*)s->stubs.buf;
+    int n1 = s->stubs.size / sizeof(JSJitStub);
+    memmove(tab, tab + n, (n1 - n) * sizeof(JSJitStub));
+    s->stubs.size = (n1 - n) * sizeof(JSJitStub);
+    jit_emit_stubs(s);
+  }
+}
+
+/* emit the native code of the instruction at 'pc'. Return its size, more
+   than one instruction if fused. */
+static int jit_emit_op(JSJitCompiler* s, const uint8_t* pc) {
+  int op = *pc, size = short_opcode_info(op).size, p;
+  const uint8_t* pc_end = pc + size;
+  JSJitHelper* helper;
+
+  switch (op) {
+    /* constants */
+    case OP_push_i32:
+      jit_emit_push_imm(s, get_u32(pc + 1), JS_TAG_INT);
+      break;
+    case OP_push_i8:
+      jit_emit_push_imm(s, (int8_t)pc[1], JS_TAG_INT);
+      break;
+    case OP_push_i16:
+      jit_emit_push_imm(s, (int16_t)get_u16(pc + 1), JS_TAG_INT);
+      break;
+    case OP_push_minus1:
+    case OP_push_0:
+    case OP_push_1:
+    case OP_push_2:
+    case OP_push_3:
+    case OP_push_4:
+    case OP_push_5:
+    case OP_push_6:
+    case OP_push_7:
+      jit_emit_push_imm(s, op - OP_push_0, JS_TAG_INT);
+      break;
+    case OP_push_false:
+    case OP_push_true:
+      jit_emit_push_imm(s, op == OP_push_true, JS_TAG_BOOL);
+      break;
+    case OP_undefined:
+      jit_emit_push_imm(s, 0, JS_TAG_UNDEFINED);
+      break;
+    case OP_null:
+      jit_emit_push_imm(s, 0, JS_TAG_NULL);
+      break;
+
+    /* variables */
+    case OP_get_loc:
+      jit_emit_get(s, 0, get_u16(pc + 1));
+      break;
+    case OP_get_loc8:
+      jit_emit_get(s, 0, pc[1]);
+      break;
+    case OP_get_loc0:
+    case OP_get_loc1:
+    case OP_get_loc2:
+    case OP_get_loc3:
+      jit_emit_get(s, 0, op - OP_get_loc0);
+      break;
+    case OP_get_arg:
+      jit_emit_get(s, 1, get_u16(pc + 1));
+      break;
+    case OP_get_arg0:
+    case OP_get_arg1:
+    case OP_get_arg2:
+    case OP_get_arg3:
+      jit_emit_get(s, 1, op - OP_get_arg0);
+      break;
+    case OP_get_var_ref:
+      jit_emit_get(s, 2, get_u16(pc + 1));
+      break;
+    case OP_get_var_ref0:
+    case OP_get_var_ref1:
+    case OP_get_var_ref2:
+    case OP_get_var_ref3:
+      jit_emit_get(s, 2, op - OP_get_var_ref0);
+      break;
+    case OP_get_loc_check:
+      p = jit_emit_with_stub(
+          s, jit_loc_check, sizeof(jit_loc_check), 11, 0, js_jit_loc_check, pc);
+      jit_patch32(s, p + 4, jit_loc_disp(get_u16(pc + 1)) + 8);
+      jit_emit_get(s, 0, get_u16(pc + 1));
+      break;
+    case OP_put_loc:
+      jit_emit_put(s, 0, get_u16(pc + 1));
+      break;
+    case OP_put_loc8:
+      jit_emit_put(s, 0, pc[1]);
+      break;
+    case OP_put_loc0:
+    case OP_put_loc1:
+    case OP_put_loc2:
+    case OP_put_loc3:
+      jit_emit_put(s, 0, op - OP_put_loc0);
+      break;
+    case OP_put_arg:
+      jit_emit_put(s, 1, get_u16(pc + 1));
+      break;
+    case OP_put_arg0:
+    case OP_put_arg1:
+    case OP_put_arg2:
+    case OP_put_arg3:
+      jit_emit_put(s, 1, op - OP_put_arg0);
+      break;
+    case OP_set_loc:
+      jit_emit_set(s, 0, get_u16(pc + 1));
+      break;
+    case OP_set_loc8:
+      jit_emit_set(s, 0, pc[1]);
+      break;
+    case OP_set_loc0:
+    case OP_set_loc1:
+    case OP_set_loc2:
+    case OP_set_loc3:
+      jit_emit_set(s, 0, op - OP_set_loc0);
+      break;
+    case OP_set_arg:
+      jit_emit_set(s, 1, get_u16(pc + 1));
+      break;
+    case OP_set_arg0:
+    case OP_set_arg1:
+    case OP_set_arg2:
+    case OP_set_arg3:
+      jit_emit_set(s, 1, op - OP_set_arg0);
+      break;
+
+    /* stack */
+    case OP_drop:
+      jit_emit(s, jit_pop, sizeof(jit_pop));
+      jit_emit_free(s);
+      break;
+    case OP_dup:
+      jit_emit(s, jit_load_top, sizeof(jit_load_top));
+      jit_emit(s, jit_dup_push, sizeof(jit_dup_push));
+      break;
+    case OP_nop:
+    case OP_debugger:
+      break;
+
+    /* integer arithmetic */
+    case OP_add:
+    case OP_sub:
+      p = jit_emit_int_op(
+          s,
+          jit_add_int,
+          sizeof(jit_add_int),
+          8,
+          op == OP_add ? js_jit_add : js_jit_binary_arith,
+          pc);
+      if (op == OP_sub)
+        jit_patch8(s, p + 3, 0x2b);
+      break;
+    case OP_and:
+    case OP_or:
+    case OP_xor:
+      p = jit_emit_int_op(
+          s, jit_logic_int, sizeof(jit_logic_int), 0, js_jit_binary_logic, pc);
+      jit_patch8(s, p + 3, op == OP_and ? 0x23 : op == OP_or ? 0x0b : 0x33);
+      break;
+    case OP_lt:
+    case OP_lte:
+    case OP_gt:
+    case OP_gte:
+    case OP_eq:
+    case OP_neq:
+    case OP_strict_eq:
+    case OP_strict_neq:
+      return jit_emit_compare(s, pc);
+    case OP_inc:
+    case OP_dec:
+      p = jit_emit_with_stub(
+          s, jit_inc, sizeof(jit_inc), 6, 18, js_jit_unary_arith, pc);
+      if (op == OP_dec)
+        jit_patch8(s, p + 14, 0xe8);
+      break;
+    case OP_inc_loc:
+    case OP_dec_loc:
+      p = jit_emit_with_stub(
+          s, jit_inc_loc, sizeof(jit_inc_loc), 12, 29, js_jit_inc_loc, pc);
+      jit_patch32(s, p + 4, jit_loc_disp(pc[1]) + 8);
+      jit_patch32(s, p + 20, jit_loc_disp(pc[1]));
+      jit_patch32(s, p + 37, jit_loc_disp(pc[1]));
+      if (op == OP_dec_loc)
+        jit_patch8(s, p + 25, 0xe8);
+      break;
+    case OP_add_loc:
+      p = jit_emit_with_stub(
+          s, jit_add_loc, sizeof(jit_add_loc), 13, 30, js_jit_add_loc, pc);
+      jit_patch32(s, p + 4, jit_loc_disp(pc[1]) + 8);
+      jit_patch32(s, p + 21, jit_loc_disp(pc[1]));
+      jit_patch32(s, p + 38, jit_loc_disp(pc[1]));
+      break;
+
+    /* control flow */
+    case OP_goto:
+    case OP_goto16:
+    case OP_goto8:
+      jit_emit_jump(
+          s,
+          JIT_CC_ALWAYS,
+          jit_branch_target(s->b->byte_code_buf, pc - s->b->byte_code_buf),
+          pc,
+          pc_end);
+      break;
+    case OP_if_false:
+    case OP_if_true:
+    case OP_if_false8:
+    case OP_if_true8:
+      jit_emit_if(
+          s,
+          pc,
+          jit_branch_target(s->b->byte_code_buf, pc - s->b->byte_code_buf),
+          size);
+      break;
+    case OP_return:
+      jit_emit_return(s);
+      break;
+    case OP_return_undef:
+      p = jit_emit(s, jit_return_undef, sizeof(jit_return_undef));
+      jit_patch32(s, p + 3, offsetof(JSJitFrame, ret_val));
+      jit_patch32(s, p + 14, offsetof(JSJitFrame, ret_val) + 8);
+      jit_patch32(s, p + 25, offsetof(JSJitFrame, sp));
+      jit_patch32(s, p + 30, JS_JIT_RETURN);
+      jit_patch_rel(s, p + 35, s->epilogue);
+      break;
+    case OP_tail_call:
+    case OP_tail_call_method:
+      /* call and return the result */
+      jit_emit_call(
+          s, op == OP_tail_call ? js_jit_call : js_jit_call_method, pc);
+      jit_emit_return(s);
+      break;
+
+    default:
+      helper = js_jit_get_helper(op);
+      if (helper)
+        jit_emit_call(s, helper, pc);
+      else
+        jit_emit_deopt(s, pc);
+      break;
+  }
+  return size;
+}
+
+static void jit_free_compiler(JSRuntime* rt, JSJitCompiler* s) {
+  dbuf_free(&s->code);
+  dbuf_free(&s->stubs);
+  dbuf_free(&s->fixups);
+  js_free_rt(rt, s->pc2native);
+  js_free_rt(rt, s->labels);
+}
+
+static JSJitCode* js_jit_compile(JSRuntime* rt, JSFunctionBytecode* b) {
+  JSJitCompiler s_s, *s = &s_s;
+  const uint8_t* bc_buf = b->byte_code_buf;
+  uint32_t len = b->byte_code_len, pos;
+  JSJitCode* jc = NULL;
+  JSJitFixup* fx;
+  size_t size, page_size;
+  uint8_t* code;
+  int i, p, n, target;
+
+  memset(s, 0, sizeof(*s));
+  s->b = b;
+  dbuf_init2(&s->code, rt, (DynBufReallocFunc*)js_realloc_rt);
+  dbuf_init2(&s->stubs, rt, (DynBufReallocFunc*)js_realloc_rt);
+  dbuf_init2(&s->fixups, rt, (DynBufReallocFunc*)js_realloc_rt);
+  s->pc2native = js_malloc_rt(rt, sizeof(s->pc2native[0]) * (len + 1));
+  s->labels = js_mallocz_rt(rt, len + 1);
+  if (!s->pc2native || !s->labels)
+    goto fail;
+  for (pos = 0; pos < len; pos++)
+    s->pc2native[pos] = -1;
+
+  /* a compare is not fused with a branch which is a jump target */
+  for (pos = 0; pos < len; pos += short_opcode_info(bc_buf[pos]).size) {
+    target = jit_branch_target(bc_buf, pos);
+    if (target >= 0) {
+      if ((uint32_t)target >= len)
+        goto fail;
+      s->labels[target] = TRUE;
+    }
+  }
+
+  p = jit_emit(s, jit_prologue, sizeof(jit_prologue));
+  jit_patch32(s, p + 26, offsetof(JSJitFrame, var_buf));
+  jit_patch32(s, p + 33, offsetof(JSJitFrame, arg_buf));
+  jit_patch32(s, p + 40, offsetof(JSJitFrame, ctx));
+  s->epilogue = jit_emit(s, jit_epilogue, sizeof(jit_epilogue));
+  /* the helper has set f->sp and f->pc */
+  s->exit_exception = s->code.size;
+  jit_emit_exit(s, JS_JIT_EXCEPTION);
+
+  for (pos = 0; pos < len;) {
+    s->pc2native[pos] = s->code.size;
+    pos += jit_emit_op(s, bc_buf + pos);
+  }
+  jit_emit_stubs(s);
+  if (s->code.error || s->stubs.error || s->fixups.error)
+    goto fail;
+
+  fx = (JSJitFixup*)s->fixups.buf;
+  n = s->fixups.size / sizeof(JSJitFixup);
+  for (i = 0; i < n; i++) {
+    if (s->pc2native[fx[i].target] < 0)
+      goto fail;
+    jit_patch_rel(s, fx[i].pos, s->pc2native[fx[i].target]);
+  }
+
+  jc = js_malloc_rt(rt, sizeof(*jc) + sizeof(jc->pc2native[0]) * len);
+  if (!jc)
+    goto fail;
+  page_size = sysconf(_SC_PAGESIZE);
+  size = (s->code.size + page_size - 1) & ~(page_size - 1);
+  code = mmap(
+      NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (code == MAP_FAILED)
+    goto fail;
+  memcpy(code, s->code.buf, s->code.size);
+  if (mprotect(code, size, PROT_READ | PROT_EXEC)) {
+    munmap(code, size);
+    goto fail;
+  }
+  jc->code = code;
+  jc->code_size = size;
+  memcpy(jc->pc2native, s->pc2native, sizeof(jc->pc2native[0]) * len);
+  jit_free_compiler(rt, s);
+  return jc;
+fail:
+  js_free_rt(rt, jc);
+  jit_free_compiler(rt, s);
+  return NULL;
+}
+
+int js_jit_run(JSJitFrame* f, JSValue* sp, const uint8_t* pc) {
+  JSFunctionBytecode* b = f->b;
+  JSJitCode* jc = b->jit_code;
+  int32_t offset;
+
+  if (!jc) {
+    jc = js_jit_compile(f->ctx->rt, b);
+    if (!jc) {
+      b->jit_disabled = TRUE;
+      return JS_JIT_NONE;
+    }
+    b->jit_code = jc;
+  }
+  offset = jc->pc2native[pc - b->byte_code_buf];
+  if (offset < 0)
+    return JS_JIT_NONE;
+  return ((JSJitEntry*)jc->code)(f, sp, jc->code + offset);
+}
+
+void js_jit_free(JSRuntime* rt, JSFunctionBytecode* b) {
+  JSJitCode* jc = b->jit_code;
+
+  if (jc) {
+    munmap(jc->code, jc->code_size);
+    js_free_rt(rt, jc);
+    b->jit_code = NULL;
+  }
+}
+
+#endif /* ENABLE_JIT */
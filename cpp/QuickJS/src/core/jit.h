@@ -0,0 +1,97 @@
+/*
+ * QuickJS Javascript Engine
+ *
+ * Copyright (c) 2017-2025 Fabrice Bellard
+ * Copyright (c) 2017-2025 Charlie Gordon
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_JIT
+
+/* Baseline native code for the hot bytecode functions (x86-64 only).
+
+   The native code of a function is made of copies of small machine code
+   templates (stencils) with their operands patched, one per opcode: the
+   simple opcodes are inlined (constants, local variables, integer
+   arithmetic and comparisons, branches) and the others call the same
+   slow paths as JS_CallInternal(). The values stay in the interpreter
+   frame (local variables and value stack), so the native code can be
+   entered at any instruction and left at any instruction ("deopt"): the
+   interpreter then continues at the same bytecode position. */
+
+/* result of js_jit_run() */
+enum {
+  JS_JIT_NONE, /* no native code for this position: interpret */
+  JS_JIT_RETURN, /* the function returned 'ret_val' */
+  JS_JIT_EXCEPTION, /* exception raised at 'pc' */
+  JS_JIT_DEOPT, /* continue interpreting at 'pc' */
+};
+
+/* interpreter state shared with the native code */
+typedef struct JSJitFrame {
+  JSContext* ctx; /* realm of the function */
+  JSContext* caller_ctx;
+  JSStackFrame* sf;
+  JSFunctionBytecode* b;
+  JSValue* var_buf;
+  JSValue* arg_buf;
+  JSValue* stack_buf;
+  JSVarRef** var_refs;
+  JSValueConst this_obj;
+  JSValueConst new_target;
+  int argc;
+  JSValue* argv;
+  /* output */
+  JSValue* sp;
+  const uint8_t* pc;
+  JSValue ret_val;
+} JSJitFrame;
+
+/* Return TRUE if the interpreter should continue in the native code of 'b'
+   at a function entry or a loop back edge. */
+static inline BOOL js_jit_is_hot(JSRuntime* rt, JSFunctionBytecode* b) {
+#if QUICKJS_DEBUG
+  /* the native code does not call the debugger */
+  if (rt->debugger_info.notify_fun)
+    return FALSE;
+#endif
+  return rt->jit_threshold != 0 && b->func_kind == JS_FUNC_NORMAL &&
+      !b->jit_disabled &&
+      (b->jit_code != NULL || ++b->jit_counter >= rt->jit_threshold);
+}
+
+/* Run the native code of f->b from the bytecode position 'pc' with the
+   stack pointer 'sp', compiling it first if needed. */
+int js_jit_run(JSJitFrame* f, JSValue* sp, const uint8_t* pc);
+void js_jit_free(JSRuntime* rt, JSFunctionBytecode* b);
+
+#endif /* ENABLE_JIT */
+
+#ifdef __cplusplus
+} /* extern "C" { */
+#endif
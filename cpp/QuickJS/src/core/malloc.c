@@ -64,16 +64,49 @@ size_t js_malloc_usable_size_unknown(const void* ptr) {
   return 0;
 }
 
+static no_inline void
+js_malloc_sample(JSRuntime* rt, void* old_ptr, void* ptr, size_t size) {
+  JSMallocSampler* s = rt->malloc_sampler;
+
+  if (s->busy)
+    return;
+  s->busy = TRUE;
+  if (old_ptr) {
+    if (!ptr)
+      s->release(rt, s->opaque, old_ptr);
+    else
+      s->move(rt, s->opaque, old_ptr, ptr, size);
+  }
+  if (ptr) {
+    s->countdown -= size;
+    if (s->countdown <= 0) {
+      s->countdown = s->interval;
+      s->sample(rt, s->opaque, ptr, size);
+    }
+  }
+  s->busy = FALSE;
+}
+
 void* js_malloc_rt(JSRuntime* rt, size_t size) {
-  return rt->mf.js_malloc(&rt->malloc_state, size);
+  void* ptr;
+  ptr = rt->mf.js_malloc(&rt->malloc_state, size);
+  if (unlikely(rt->malloc_sampler != NULL))
+    js_malloc_sample(rt, NULL, ptr, size);
+  return ptr;
 }
 
 void js_free_rt(JSRuntime* rt, void* ptr) {
+  if (unlikely(rt->malloc_sampler != NULL) && ptr)
+    js_malloc_sample(rt, ptr, NULL, 0);
   rt->mf.js_free(&rt->malloc_state, ptr);
 }
 
 void* js_realloc_rt(JSRuntime* rt, void* ptr, size_t size) {
-  return rt->mf.js_realloc(&rt->malloc_state, ptr, size);
+  void* new_ptr;
+  new_ptr = rt->mf.js_realloc(&rt->malloc_state, ptr, size);
+  if (unlikely(rt->malloc_sampler != NULL) && (new_ptr || size == 0))
+    js_malloc_sample(rt, ptr, new_ptr, size);
+  return new_ptr;
 }
 
 size_t js_malloc_usable_size_rt(JSRuntime* rt, const void* ptr) {
@@ -179,6 +212,218 @@ no_inline int js_realloc_array(
   return 0;
 }
 
+#define JS_ARENA_ALIGN(size) (((size) + 7) & ~(size_t)7)
+#define JS_ARENA_MIN_CHUNK_SIZE 4096
+#define JS_ARENA_MAX_CHUNK_SIZE (64 * 1024)
+/* larger blocks get a chunk of their own */
+#define JS_ARENA_LARGE_SIZE (JS_ARENA_MAX_CHUNK_SIZE / 4)
+/* the low bit of the block header marks the large blocks */
+#define JS_ARENA_LARGE_FLAG 1
+
+typedef struct JSArenaChunk {
+  struct list_head link;
+  size_t size;
+} JSArenaChunk;
+
+#define JS_ARENA_CHUNK_HEADER JS_ARENA_ALIGN(sizeof(JSArenaChunk))
+#define JS_ARENA_BLOCK_HEADER JS_ARENA_ALIGN(sizeof(size_t))
+
+static inline size_t* js_arena_block_header(void* ptr) {
+  return (size_t*)((uint8_t*)ptr - JS_ARENA_BLOCK_HEADER);
+}
+
+void js_arena_init(JSContext* ctx, JSArena* a) {
+  a->ctx = ctx;
+  init_list_head(&a->chunk_list);
+  a->ptr = NULL;
+  a->end = NULL;
+  a->last = NULL;
+  a->chunk_size = JS_ARENA_MIN_CHUNK_SIZE;
+  a->size = 0;
+  a->max_size = 0;
+}
+
+void js_arena_free_all(JSArena* a) {
+  struct list_head *el, *el1;
+
+  list_for_each_safe(el, el1, &a->chunk_list) {
+    js_free(a->ctx, list_entry(el, JSArenaChunk, link));
+  }
+  init_list_head(&a->chunk_list);
+  a->ptr = NULL;
+  a->end = NULL;
+  a->last = NULL;
+  a->chunk_size = JS_ARENA_MIN_CHUNK_SIZE;
+  a->size = 0;
+}
+
+static JSArenaChunk* js_arena_new_chunk(JSArena* a, size_t size) {
+  JSArenaChunk* c;
+
+  c = js_malloc(a->ctx, size);
+  if (!c)
+    return NULL;
+  c->size = size;
+  list_add_tail(&c->link, &a->chunk_list);
+  a->size += size;
+  if (a->size > a->max_size)
+    a->max_size = a->size;
+  return c;
+}
+
+static void* js_arena_malloc_large(JSArena* a, size_t size) {
+  JSArenaChunk* c;
+  size_t* hdr;
+
+  c = js_arena_new_chunk(
+      a, JS_ARENA_CHUNK_HEADER + JS_ARENA_BLOCK_HEADER + size);
+  if (!c)
+    return NULL;
+  hdr = (size_t*)((uint8_t*)c + JS_ARENA_CHUNK_HEADER);
+  *hdr = size | JS_ARENA_LARGE_FLAG;
+  return (uint8_t*)hdr + JS_ARENA_BLOCK_HEADER;
+}
+
+/* Throw out of memory in case of error */
+void* js_arena_malloc(JSArena* a, size_t size) {
+  uint8_t* ptr;
+  size_t needed;
+
+  size = JS_ARENA_ALIGN(size ? size : 1);
+  if (size >= JS_ARENA_LARGE_SIZE)
+    return js_arena_malloc_large(a, size);
+
+  needed = JS_ARENA_BLOCK_HEADER + size;
+  if (unlikely((size_t)(a->end - a->ptr) < needed)) {
+    JSArenaChunk* c;
+    size_t chunk_size = a->chunk_size;
+    while (chunk_size < JS_ARENA_CHUNK_HEADER + needed)
+      chunk_size *= 2;
+    c = js_arena_new_chunk(a, chunk_size);
+    if (!c)
+      return NULL;
+    if (a->chunk_size < JS_ARENA_MAX_CHUNK_SIZE)
+      a->chunk_size *= 2;
+    a->ptr = (uint8_t*)c + JS_ARENA_CHUNK_HEADER;
+    a->end = (uint8_t*)c + chunk_size;
+  }
+
+  ptr = a->ptr + JS_ARENA_BLOCK_HEADER;
+  *js_arena_block_header(ptr) = size;
+  a->ptr = ptr + size;
+  a->last = ptr;
+  return ptr;
+}
+
+void* js_arena_mallocz(JSArena* a, size_t size) {
+  void* ptr;
+
+  ptr = js_arena_malloc(a, size);
+  if (!ptr)
+    return NULL;
+  return memset(ptr, 0, size);
+}
+
+void* js_arena_realloc(JSArena* a, void* ptr, size_t size) {
+  size_t *hdr, old_size;
+  void* new_ptr;
+
+  if (!ptr)
+    return js_arena_malloc(a, size);
+
+  hdr = js_arena_block_header(ptr);
+  old_size = *hdr & ~(size_t)JS_ARENA_LARGE_FLAG;
+  size = JS_ARENA_ALIGN(size ? size : 1);
+
+  if (*hdr & JS_ARENA_LARGE_FLAG) {
+    /* resize the whole chunk */
+    JSArenaChunk *c, *new_c;
+    struct list_head* prev;
+    size_t chunk_size;
+
+    if (size <= old_size)
+      return ptr;
+    c = (JSArenaChunk*)((uint8_t*)hdr - JS_ARENA_CHUNK_HEADER);
+    prev = c->link.prev;
+    list_del(&c->link);
+    chunk_size = JS_ARENA_CHUNK_HEADER + JS_ARENA_BLOCK_HEADER + size;
+    new_c = js_realloc(a->ctx, c, chunk_size);
+    if (!new_c) {
+      list_add(&c->link, prev);
+      return NULL;
+    }
+    list_add(&new_c->link, prev);
+    a->size += chunk_size - new_c->size;
+    if (a->size > a->max_size)
+      a->max_size = a->size;
+    new_c->size = chunk_size;
+    hdr = (size_t*)((uint8_t*)new_c + JS_ARENA_CHUNK_HEADER);
+    *hdr = size | JS_ARENA_LARGE_FLAG;
+    return (uint8_t*)hdr + JS_ARENA_BLOCK_HEADER;
+  }
+
+  if (size <= old_size)
+    return ptr;
+  if (ptr == a->last && size < JS_ARENA_LARGE_SIZE &&
+      (size_t)(a->end - (uint8_t*)ptr) >= size) {
+    /* grow the last block in place */
+    *hdr = size;
+    a->ptr = (uint8_t*)ptr + size;
+    return ptr;
+  }
+  new_ptr = js_arena_malloc(a, size);
+  if (!new_ptr)
+    return NULL;
+  memcpy(new_ptr, ptr, old_size);
+  return new_ptr;
+}
+
+void js_arena_free(JSArena* a, void* ptr) {
+  size_t* hdr;
+
+  if (!ptr)
+    return;
+  hdr = js_arena_block_header(ptr);
+  if (*hdr & JS_ARENA_LARGE_FLAG) {
+    JSArenaChunk* c = (JSArenaChunk*)((uint8_t*)hdr - JS_ARENA_CHUNK_HEADER);
+    list_del(&c->link);
+    a->size -= c->size;
+    js_free(a->ctx, c);
+  } else if (ptr == a->last) {
+    a->ptr = (uint8_t*)hdr;
+    a->last = NULL;
+  }
+}
+
+/* DynBufReallocFunc, 'opaque' is the JSArena */
+void* js_arena_dbuf_realloc(void* opaque, void* ptr, size_t size) {
+  JSArena* a = opaque;
+
+  if (size == 0) {
+    js_arena_free(a, ptr);
+    return NULL;
+  }
+  return js_arena_realloc(a, ptr, size);
+}
+
+no_inline int js_arena_realloc_array(
+    JSArena* a,
+    void** parray,
+    int elem_size,
+    int* psize,
+    int req_size) {
+  int new_size;
+  void* new_array;
+  /* XXX: potential arithmetic overflow */
+  new_size = max_int(req_size, *psize * BUFFER_EXPANSION_FACTOR);
+  new_array = js_arena_realloc(a, *parray, new_size * elem_size);
+  if (!new_array)
+    return -1;
+  *psize = new_size;
+  *parray = new_array;
+  return 0;
+}
+
 void* js_def_malloc(JSMallocState* s, size_t size) {
   void* ptr;
 
@@ -94,6 +94,27 @@
 extern "C" {
 #endif
 
+/* Allocation sampler: 'sample' is called with the allocation that crosses
+   each 'interval' bytes allocated through js_malloc_rt()/js_realloc_rt().
+   'move' and 'release' report every reallocation and free while the sampler
+   is installed so that the sampled blocks can be tracked. 'finalize' is
+   called by JS_FreeRuntime(). */
+typedef struct JSMallocSampler {
+  int64_t interval;
+  int64_t countdown;
+  BOOL busy; /* no sampling from the sampler callbacks */
+  void (*sample)(JSRuntime* rt, void* opaque, void* ptr, size_t size);
+  void (*move)(
+      JSRuntime* rt,
+      void* opaque,
+      void* old_ptr,
+      void* ptr,
+      size_t size);
+  void (*release)(JSRuntime* rt, void* opaque, void* ptr);
+  void (*finalize)(JSRuntime* rt, void* opaque);
+  void* opaque;
+} JSMallocSampler;
+
 void js_trigger_gc(JSRuntime* rt, size_t size);
 no_inline int js_realloc_array(
     JSContext* ctx,
@@ -119,6 +140,51 @@ static inline void js_dbuf_init(JSContext* ctx, DynBuf* s) {
   dbuf_init2(s, ctx->rt, (DynBufReallocFunc*)js_realloc_rt);
 }
 
+/* Bump allocator for data sharing the same lifetime, e.g. the compiler
+   state of one eval. js_arena_realloc() grows the last block in place and
+   js_arena_free() only releases the last block or a large block. All the
+   remaining memory is released by js_arena_free_all(). */
+typedef struct JSArena {
+  JSContext* ctx;
+  struct list_head chunk_list;
+  uint8_t* ptr; /* free space in the current chunk */
+  uint8_t* end;
+  void* last; /* last block of the current chunk */
+  size_t chunk_size; /* size of the next chunk */
+  size_t size; /* total size of the chunks */
+  size_t max_size;
+} JSArena;
+
+void js_arena_init(JSContext* ctx, JSArena* a);
+void js_arena_free_all(JSArena* a);
+void* js_arena_malloc(JSArena* a, size_t size);
+void* js_arena_mallocz(JSArena* a, size_t size);
+void* js_arena_realloc(JSArena* a, void* ptr, size_t size);
+void js_arena_free(JSArena* a, void* ptr);
+void* js_arena_dbuf_realloc(void* opaque, void* ptr, size_t size);
+no_inline int js_arena_realloc_array(
+    JSArena* a,
+    void** parray,
+    int elem_size,
+    int* psize,
+    int req_size);
+
+static inline int js_arena_resize_array(
+    JSArena* a,
+    void** parray,
+    int elem_size,
+    int* psize,
+    int req_size) {
+  if (unlikely(req_size > *psize))
+    return js_arena_realloc_array(a, parray, elem_size, psize, req_size);
+  else
+    return 0;
+}
+
+static inline void js_arena_dbuf_init(JSArena* a, DynBuf* s) {
+  dbuf_init2(s, a, js_arena_dbuf_realloc);
+}
+
 void* js_def_malloc(JSMallocState* s, size_t size);
 void js_def_free(JSMallocState* s, void* ptr);
 void* js_def_realloc(JSMallocState* s, void* ptr, size_t size);
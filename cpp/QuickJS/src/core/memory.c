@@ -50,10 +50,15 @@ static void compute_jsstring_size(JSString* str, JSMemoryUsage_helper* hp) {
   if (!str->atom_type) { /* atoms are handled separately */
     double s_ref_count = str->header.ref_count;
     hp->str_count += 1 / s_ref_count;
-    hp->str_size +=
-        ((sizeof(*str) + (str->len << str->is_wide_char) + 1 -
-          str->is_wide_char) /
-         s_ref_count);
+    if (str->is_slice) {
+      hp->str_size += sizeof(JSStringSlice) / s_ref_count;
+      compute_jsstring_size(((JSStringSlice*)str)->parent, hp);
+    } else {
+      hp->str_size +=
+          ((sizeof(*str) + (str->len << str->is_wide_char) + 1 -
+            str->is_wide_char) /
+           s_ref_count);
+    }
   }
 }
 
@@ -77,24 +82,30 @@ static void compute_bytecode_size(
   if (b->closure_var) {
     js_func_size += b->closure_var_count * sizeof(*b->closure_var);
   }
-  if (!b->read_only_bytecode && b->byte_code_buf) {
-    hp->js_func_code_size += b->byte_code_len;
-  }
-  if (b->has_debug) {
+  if (b->has_debug)
     js_func_size += sizeof(*b) - offsetof(JSFunctionBytecode, debug);
-    if (b->debug.source) {
+  if (b->code_template) {
+    /* the code and the debug buffers are counted with the templates */
+  } else {
+    if (!b->read_only_bytecode && b->byte_code_buf) {
       memory_used_count++;
-      js_func_size += b->debug.source_len + 1;
+      hp->js_func_code_size += b->byte_code_len;
     }
-    if (b->debug.pc2line_len) {
-      memory_used_count++;
-      hp->js_func_pc2line_count += 1;
-      hp->js_func_pc2line_size += b->debug.pc2line_len;
-    }
-    if (b->debug.pc2column_len) {
-      memory_used_count++;
-      hp->js_func_pc2column_count += 1;
-      hp->js_func_pc2column_size += b->debug.pc2column_len;
+    if (b->has_debug) {
+      if (b->debug.source) {
+        memory_used_count++;
+        js_func_size += b->debug.source_len + 1;
+      }
+      if (b->debug.pc2line_len) {
+        memory_used_count++;
+        hp->js_func_pc2line_count += 1;
+        hp->js_func_pc2line_size += b->debug.pc2line_len;
+      }
+      if (b->debug.pc2column_len) {
+        memory_used_count++;
+        hp->js_func_pc2column_count += 1;
+        hp->js_func_pc2column_size += b->debug.pc2column_len;
+      }
     }
   }
 
@@ -357,6 +368,31 @@ void JS_ComputeMemoryUsage(JSRuntime* rt, JSMemoryUsage* s) {
   }
   s->obj_size += s->obj_count * sizeof(JSObject);
 
+  /* code templates, shared by the bytecode functions */
+  if (rt->code_template_hash) {
+    s->memory_used_count++;
+    s->memory_used_size +=
+        sizeof(rt->code_template_hash[0]) * rt->code_template_hash_size;
+  }
+  for (i = 0; i < rt->code_template_hash_size; i++) {
+    JSCodeTemplate* t;
+    for (t = rt->code_template_hash[i]; t != NULL; t = t->hash_next) {
+      mem.memory_used_count++;
+      mem.js_func_size += sizeof(*t) + sizeof(t->ic_atoms[0]) * t->ic_count;
+      mem.js_func_code_size += t->byte_code_len;
+      if (t->source)
+        mem.js_func_size += t->source_len + 1;
+      if (t->pc2line_len) {
+        mem.js_func_pc2line_count++;
+        mem.js_func_pc2line_size += t->pc2line_len;
+      }
+      if (t->pc2column_len) {
+        mem.js_func_pc2column_count++;
+        mem.js_func_pc2column_size += t->pc2column_len;
+      }
+    }
+  }
+
   /* hashed shapes */
   s->memory_used_count++; /* rt->shape_hash */
   s->memory_used_size += sizeof(rt->shape_hash[0]) * rt->shape_hash_size;
@@ -366,6 +402,10 @@ void JS_ComputeMemoryUsage(JSRuntime* rt, JSMemoryUsage* s) {
       int hash_size = sh->prop_hash_mask + 1;
       s->shape_count++;
       s->shape_size += get_shape_size(hash_size, sh->prop_size);
+      if (sh->enum_cache) {
+        s->shape_size += sizeof(JSShapeEnumCache) +
+            sizeof(JSPropertyEnum) * sh->enum_cache->count;
+      }
     }
   }
 
@@ -383,6 +423,8 @@ void JS_ComputeMemoryUsage(JSRuntime* rt, JSMemoryUsage* s) {
   }
   s->str_count = round(mem.str_count);
   s->str_size = round(mem.str_size);
+  s->str_dedup_count = rt->string_dedup_count;
+  s->str_dedup_size = rt->string_dedup_size;
   s->js_func_count = mem.js_func_count;
   s->js_func_size = round(mem.js_func_size);
   s->js_func_code_size = mem.js_func_code_size;
@@ -520,6 +562,15 @@ void JS_DumpMemoryUsage(FILE* fp, const JSMemoryUsage* s, JSRuntime* rt) {
         s->str_size,
         (double)s->str_size / s->str_count);
   }
+  if (s->str_dedup_count) {
+    fprintf(
+        fp,
+        "%-20s %8" PRId64 " %8" PRId64 "  (%0.1f per string)\n",
+        "  deduplicated",
+        s->str_dedup_count,
+        s->str_dedup_size,
+        (double)s->str_dedup_size / s->str_dedup_count);
+  }
   if (s->obj_count) {
     fprintf(
         fp,
@@ -208,7 +208,12 @@ add_property(JSContext* ctx, JSObject* p, JSAtom prop, int prop_flags) {
   JSShape *sh, *new_sh;
 
   sh = p->shape;
-  if (sh->is_hashed) {
+  if (unlikely(sh->is_hashed && sh->prop_count >= JS_SHAPE_DICT_PROP_COUNT)) {
+    /* too many properties to share the shape: switch to the dictionary
+       mode */
+    if (js_shape_prepare_update(ctx, p, NULL))
+      return NULL;
+  } else if (sh->is_hashed) {
     /* try to find an existing shape */
     new_sh = find_hashed_shape_prop(ctx->rt, sh, prop, prop_flags);
     if (new_sh) {
@@ -417,6 +422,7 @@ static JSAutoInitFunc* js_autoinit_func_table[] = {
     js_instantiate_prototype, /* JS_AUTOINIT_ID_PROTOTYPE */
     js_module_ns_autoinit, /* JS_AUTOINIT_ID_MODULE_NS */
     JS_InstantiateFunctionListItem2, /* JS_AUTOINIT_ID_PROP */
+    js_backtrace_autoinit, /* JS_AUTOINIT_ID_BACKTRACE */
 };
 
 /* warning: 'prs' is reallocated after it */
@@ -634,6 +640,7 @@ JSValue JS_GetOwnPropertyNames2(
   JSObject* p;
   JSPropertyEnum* atoms;
   uint32_t len, i, j;
+  BOOL check_enum;
 
   r = JS_UNDEFINED;
   val = JS_UNDEFINED;
@@ -641,15 +648,19 @@ JSValue JS_GetOwnPropertyNames2(
   if (JS_IsException(obj))
     return JS_EXCEPTION;
   p = JS_VALUE_GET_OBJ(obj);
+  /* no code is run while the keys of an ordinary object are collected, so
+     their enumerable flag cannot change */
+  check_enum = (flags & JS_GPN_ENUM_ONLY) &&
+      (kind != JS_ITERATOR_KIND_KEY || p->is_exotic);
   if (JS_GetOwnPropertyNamesInternal(
-          ctx, &atoms, &len, p, flags & ~JS_GPN_ENUM_ONLY))
+          ctx, &atoms, &len, p, check_enum ? flags & ~JS_GPN_ENUM_ONLY : flags))
     goto exception;
   r = JS_NewArray(ctx);
   if (JS_IsException(r))
     goto exception;
   for (j = i = 0; i < len; i++) {
     JSAtom atom = atoms[i].atom;
-    if (flags & JS_GPN_ENUM_ONLY) {
+    if (check_enum) {
       JSPropertyDescriptor desc;
       int res;
 
@@ -1163,6 +1174,71 @@ static int num_keys_cmp(const void* p1, const void* p2, void* opaque) {
     return 1;
 }
 
+/* return the enumeration of the own string keys of the ordinary object
+   'p', cached in its shape, or NULL if the shape cannot cache it. It is
+   valid until the shape is modified. */
+JSShapeEnumCache* js_object_get_enum_cache(JSContext* ctx, JSObject* p) {
+  JSShape* sh = p->shape;
+  JSShapeEnumCache* ec;
+  JSShapeProperty* prs;
+  JSAtom atom;
+  uint32_t i, j, num_keys_count, str_keys_count, enum_count;
+  uint32_t num_index, str_index, num_key;
+
+  if (likely(sh->enum_cache != NULL))
+    return sh->enum_cache;
+  /* the properties of a dictionary object are modified in place */
+  if (p->is_exotic || !sh->is_hashed)
+    return NULL;
+
+  num_keys_count = 0;
+  str_keys_count = 0;
+  enum_count = 0;
+  for (i = 0, prs = get_shape_prop(sh); i < sh->prop_count; i++, prs++) {
+    atom = prs->atom;
+    if (atom == JS_ATOM_NULL ||
+        JS_AtomGetKind(ctx, atom) != JS_ATOM_KIND_STRING)
+      continue;
+    /* the module name space must be checked at each enumeration */
+    if ((prs->flags & JS_PROP_TMASK) == JS_PROP_VARREF)
+      return NULL;
+    if (JS_AtomIsArrayIndex(ctx, &num_key, atom))
+      num_keys_count++;
+    else
+      str_keys_count++;
+    if (prs->flags & JS_PROP_ENUMERABLE)
+      enum_count++;
+  }
+
+  /* no exception: the caller uses the uncached path */
+  ec = js_malloc_rt(
+      ctx->rt,
+      sizeof(*ec) + sizeof(ec->tab[0]) * (num_keys_count + str_keys_count));
+  if (!ec)
+    return NULL;
+  ec->count = num_keys_count + str_keys_count;
+  ec->enum_count = enum_count;
+  num_index = 0;
+  str_index = num_keys_count;
+  for (i = 0, prs = get_shape_prop(sh); i < sh->prop_count; i++, prs++) {
+    atom = prs->atom;
+    if (atom == JS_ATOM_NULL ||
+        JS_AtomGetKind(ctx, atom) != JS_ATOM_KIND_STRING)
+      continue;
+    if (JS_AtomIsArrayIndex(ctx, &num_key, atom))
+      j = num_index++;
+    else
+      j = str_index++;
+    ec->tab[j].atom = atom;
+    ec->tab[j].is_enumerable = ((prs->flags & JS_PROP_ENUMERABLE) != 0);
+  }
+  if (num_keys_count > 1) {
+    rqsort(ec->tab, num_keys_count, sizeof(ec->tab[0]), num_keys_cmp, ctx);
+  }
+  sh->enum_cache = ec;
+  return ec;
+}
+
 /* return < 0 in case if exception, 0 if OK. ptab and its atoms must
    be freed by the user. */
 int __exception JS_GetOwnPropertyNamesInternal(
@@ -1186,6 +1262,26 @@ int __exception JS_GetOwnPropertyNamesInternal(
   *ptab = NULL;
   *plen = 0;
 
+  if ((flags & ~(JS_GPN_ENUM_ONLY | JS_GPN_SET_ENUM)) == JS_GPN_STRING_MASK) {
+    JSShapeEnumCache* ec = js_object_get_enum_cache(ctx, p);
+    if (ec) {
+      atom_count = (flags & JS_GPN_ENUM_ONLY) ? ec->enum_count : ec->count;
+      tab_atom = js_malloc(ctx, sizeof(tab_atom[0]) * max_int(atom_count, 1));
+      if (!tab_atom)
+        return -1;
+      for (i = j = 0; i < ec->count; i++) {
+        if ((flags & JS_GPN_ENUM_ONLY) && !ec->tab[i].is_enumerable)
+          continue;
+        tab_atom[j].atom = JS_DupAtom(ctx, ec->tab[i].atom);
+        tab_atom[j].is_enumerable = ec->tab[i].is_enumerable;
+        j++;
+      }
+      *ptab = tab_atom;
+      *plen = atom_count;
+      return 0;
+    }
+  }
+
   /* compute the number of returned properties */
   num_keys_count = 0;
   str_keys_count = 0;
@@ -138,6 +138,10 @@ int JS_CheckBrand(JSContext* ctx, JSValueConst obj, JSValueConst func);
 
 uint32_t js_string_obj_get_length(JSContext* ctx, JSValueConst obj);
 
+/* return the enumeration of the own string keys of the ordinary object
+   'p', cached in its shape, or NULL if the shape cannot cache it. It is
+   valid until the shape is modified. */
+JSShapeEnumCache* js_object_get_enum_cache(JSContext* ctx, JSObject* p);
 /* return < 0 in case if exception, 0 if OK. ptab and its atoms must
    be freed by the user. */
 int __exception JS_GetOwnPropertyNamesInternal(
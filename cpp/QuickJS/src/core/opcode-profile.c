@@ -0,0 +1,158 @@
+/*
+ * QuickJS Javascript Engine
+ *
+ * Copyright (c) 2017-2025 Fabrice Bellard
+ * Copyright (c) 2017-2025 Charlie Gordon
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "opcode-profile.h"
+
+#ifdef ENABLE_OPCODE_PROFILE
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* names of the opcodes of the final bytecode */
+static const char* const js_opcode_names[256] = {
+#define FMT(f)
+#define DEF(id, size, n_pop, n_push, f) #id,
+#define def(id, size, n_pop, n_push, f)
+#include "QuickJS/quickjs-opcode.h"
+#undef def
+#undef DEF
+#undef FMT
+};
+
+static const char* js_opcode_name(int op) {
+  return js_opcode_names[op] ? js_opcode_names[op] : "?";
+}
+
+void js_opcode_profile_init(JSRuntime* rt) {
+  JSOpcodeProfile* p;
+
+  if (!getenv("QJS_OPCODE_PROFILE"))
+    return;
+  p = js_mallocz_rt(rt, sizeof(*p));
+  if (!p)
+    return;
+  p->triple_size = 1 << 12;
+  p->triples = calloc(p->triple_size, sizeof(p->triples[0]));
+  if (!p->triples) {
+    js_free_rt(rt, p);
+    return;
+  }
+  rt->opcode_profile = p;
+}
+
+static JSOpcodeTriple* js_opcode_profile_find(
+    JSOpcodeTriple* tab,
+    uint32_t size,
+    uint32_t key) {
+  uint32_t h = (key * 0x9e3779b1) >> 8;
+  for (;;) {
+    JSOpcodeTriple* e = &tab[h & (size - 1)];
+    if (e->key == key || e->key == 0)
+      return e;
+    h++;
+  }
+}
+
+void js_opcode_profile_add_triple(JSOpcodeProfile* p, uint32_t key) {
+  JSOpcodeTriple* e = js_opcode_profile_find(p->triples, p->triple_size, key);
+  uint32_t i;
+
+  if (likely(e->key != 0)) {
+    e->count++;
+    return;
+  }
+  /* keep the table at most half full. It is allocated with malloc()
+     because the runtime is not known here. */
+  if (2 * (p->triple_count + 1) > p->triple_size) {
+    uint32_t new_size = p->triple_size * 2;
+    JSOpcodeTriple* tab = calloc(new_size, sizeof(tab[0]));
+    if (!tab)
+      return;
+    for (i = 0; i < p->triple_size; i++) {
+      if (p->triples[i].key)
+        *js_opcode_profile_find(tab, new_size, p->triples[i].key) =
+            p->triples[i];
+    }
+    free(p->triples);
+    p->triples = tab;
+    p->triple_size = new_size;
+    e = js_opcode_profile_find(tab, new_size, key);
+  }
+  e->key = key;
+  e->count = 1;
+  p->triple_count++;
+}
+
+static void js_opcode_profile_dump(JSOpcodeProfile* p, FILE* f) {
+  uint32_t i, j;
+
+  for (i = 0; i < 256; i++) {
+    if (p->op_count[i])
+      fprintf(f, "%" PRIu64 " %s\n", p->op_count[i], js_opcode_name(i));
+  }
+  for (i = 0; i < 256; i++) {
+    for (j = 0; j < 256; j++) {
+      if (p->pair_count[i][j])
+        fprintf(
+            f,
+            "%" PRIu64 " %s %s\n",
+            p->pair_count[i][j],
+            js_opcode_name(i),
+            js_opcode_name(j));
+    }
+  }
+  for (i = 0; i < p->triple_size; i++) {
+    JSOpcodeTriple* e = &p->triples[i];
+    if (e->key)
+      fprintf(
+          f,
+          "%" PRIu64 " %s %s %s\n",
+          e->count,
+          js_opcode_name(e->key >> 16),
+          js_opcode_name((e->key >> 8) & 0xff),
+          js_opcode_name(e->key & 0xff));
+  }
+}
+
+void js_opcode_profile_free(JSRuntime* rt) {
+  JSOpcodeProfile* p = rt->opcode_profile;
+  const char* filename;
+  FILE* f;
+
+  if (!p)
+    return;
+  filename = getenv("QJS_OPCODE_PROFILE");
+  f = filename ? fopen(filename, "a") : NULL;
+  if (f) {
+    js_opcode_profile_dump(p, f);
+    fclose(f);
+  }
+  free(p->triples);
+  js_free_rt(rt, p);
+  rt->opcode_profile = NULL;
+}
+
+#endif /* ENABLE_OPCODE_PROFILE */
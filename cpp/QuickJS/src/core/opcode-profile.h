@@ -0,0 +1,86 @@
+/*
+ * QuickJS Javascript Engine
+ *
+ * Copyright (c) 2017-2025 Fabrice Bellard
+ * Copyright (c) 2017-2025 Charlie Gordon
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_OPCODE_PROFILE
+
+/* Counts of the opcodes, opcode pairs and opcode triples executed by
+   JS_CallInternal(), used to choose the fused opcodes. The counts are
+   written when the runtime is freed to the file named by the
+   QJS_OPCODE_PROFILE environment variable, one entry per line:
+
+     <count> <opcode> [<opcode> [<opcode>]]
+
+   so that the files of several runs can be summed (see
+   __tests__/opcode_profile.sh). */
+
+typedef struct JSOpcodeTriple {
+  uint32_t key; /* op1 << 16 | op2 << 8 | op3, 0 if empty entry */
+  uint64_t count;
+} JSOpcodeTriple;
+
+typedef struct JSOpcodeProfile {
+  uint64_t op_count[256];
+  uint64_t pair_count[256][256];
+  JSOpcodeTriple* triples; /* open addressing hash table */
+  uint32_t triple_size; /* power of two */
+  uint32_t triple_count;
+} JSOpcodeProfile;
+
+void js_opcode_profile_init(JSRuntime* rt);
+void js_opcode_profile_add_triple(JSOpcodeProfile* p, uint32_t key);
+void js_opcode_profile_free(JSRuntime* rt);
+
+/* 'history' holds the previous opcodes of the current frame, OP_invalid
+   if none. Return 'op'. */
+static inline int js_opcode_profile_add(
+    JSOpcodeProfile* p,
+    uint32_t* history,
+    int op) {
+  uint32_t h = ((*history << 8) | op) & 0xffffff;
+  *history = h;
+  if (unlikely(!p))
+    return op;
+  p->op_count[op]++;
+  if (h & 0xff00) {
+    p->pair_count[(h >> 8) & 0xff][op]++;
+    if (h & 0xff0000)
+      js_opcode_profile_add_triple(p, h);
+  }
+  return op;
+}
+
+#endif /* ENABLE_OPCODE_PROFILE */
+
+#ifdef __cplusplus
+} /* extern "C" { */
+#endif
@@ -123,19 +123,21 @@ static void __attribute((unused)) dump_token(
 /* return the zero based line and column number in the source. */
 /* Note: we no longer support '\r' as line terminator */
 static int get_line_col(int* pcol_num, const uint8_t* buf, size_t len) {
-  int line_num, col_num, c;
-  size_t i;
+  const uint8_t *p, *q, *end;
+  int line_num, col_num;
 
+  /* memchr() is much faster than a byte loop to skip the lines */
   line_num = 0;
+  p = buf;
+  end = buf + len;
+  while ((q = memchr(p, '\n', end - p)) != NULL) {
+    line_num++;
+    p = q + 1;
+  }
+  /* the column only counts the first byte of the UTF-8 sequences */
   col_num = 0;
-  for (i = 0; i < len; i++) {
-    c = buf[i];
-    if (c == '\n') {
-      line_num++;
-      col_num = 0;
-    } else if (c < 0x80 || c >= 0xc0) {
-      col_num++;
-    }
+  for (; p < end; p++) {
+    col_num += (*p < 0x80 || *p >= 0xc0);
   }
   *pcol_num = col_num;
   return line_num;
@@ -1816,8 +1818,8 @@ static int new_label_fd(JSFunctionDef* fd) {
   int label;
   LabelSlot* ls;
 
-  if (js_resize_array(
-          fd->ctx,
+  if (js_arena_resize_array(
+          fd->arena,
           (void*)&fd->label_slots,
           sizeof(fd->label_slots[0]),
           &fd->label_size,
@@ -1881,8 +1883,8 @@ static int emit_goto(JSParseState* s, int opcode, int label) {
 static int cpool_add(JSParseState* s, JSValue val) {
   JSFunctionDef* fd = s->cur_func;
 
-  if (js_resize_array(
-          s->ctx,
+  if (js_arena_resize_array(
+          fd->arena,
           (void*)&fd->cpool,
           sizeof(fd->cpool[0]),
           &fd->cpool_size,
@@ -2029,24 +2031,21 @@ int push_scope(JSParseState* s) {
     /* XXX: should check for scope overflow */
     if ((fd->scope_count + 1) > fd->scope_size) {
       int new_size;
-      size_t slack;
       JSVarScope* new_buf;
       /* XXX: potential arithmetic overflow */
       new_size = max_int(
           fd->scope_count + 1, fd->scope_size * BUFFER_EXPANSION_FACTOR);
       if (fd->scopes == fd->def_scope_array) {
-        new_buf =
-            js_realloc2(s->ctx, NULL, new_size * sizeof(*fd->scopes), &slack);
+        new_buf = js_arena_malloc(fd->arena, new_size * sizeof(*fd->scopes));
         if (!new_buf)
           return -1;
         memcpy(new_buf, fd->scopes, fd->scope_count * sizeof(*fd->scopes));
       } else {
-        new_buf = js_realloc2(
-            s->ctx, fd->scopes, new_size * sizeof(*fd->scopes), &slack);
+        new_buf = js_arena_realloc(
+            fd->arena, fd->scopes, new_size * sizeof(*fd->scopes));
         if (!new_buf)
           return -1;
       }
-      new_size += slack / sizeof(*new_buf);
       fd->scopes = new_buf;
       fd->scope_size = new_size;
     }
@@ -2099,8 +2098,8 @@ static int add_var(JSContext* ctx, JSFunctionDef* fd, JSAtom name) {
     JS_ThrowInternalError(ctx, "too many local variables");
     return -1;
   }
-  if (js_resize_array(
-          ctx,
+  if (js_arena_resize_array(
+          fd->arena,
           (void**)&fd->vars,
           sizeof(fd->vars[0]),
           &fd->var_size,
@@ -2181,8 +2180,8 @@ static int add_arg(JSContext* ctx, JSFunctionDef* fd, JSAtom name) {
     JS_ThrowInternalError(ctx, "too many arguments");
     return -1;
   }
-  if (js_resize_array(
-          ctx,
+  if (js_arena_resize_array(
+          fd->arena,
           (void**)&fd->args,
           sizeof(fd->args[0]),
           &fd->arg_size,
@@ -2200,8 +2199,8 @@ static JSGlobalVar*
 add_global_var(JSContext* ctx, JSFunctionDef* s, JSAtom name) {
   JSGlobalVar* hf;
 
-  if (js_resize_array(
-          ctx,
+  if (js_arena_resize_array(
+          s->arena,
           (void**)&s->global_vars,
           sizeof(s->global_vars[0]),
           &s->global_var_size,
@@ -3048,6 +3047,7 @@ static __exception int js_parse_class_default_ctor(
 
   fd = js_new_function_def(
       s->ctx,
+      &s->arena,
       fd,
       FALSE,
       FALSE,
@@ -8211,6 +8211,7 @@ static __exception int js_parse_source_element(JSParseState* s) {
 
 JSFunctionDef* js_new_function_def(
     JSContext* ctx,
+    JSArena* arena,
     JSFunctionDef* parent,
     BOOL is_eval,
     BOOL is_func_expr,
@@ -8219,11 +8220,12 @@ JSFunctionDef* js_new_function_def(
     GetLineColCache* get_line_col_cache) {
   JSFunctionDef* fd;
 
-  fd = js_mallocz(ctx, sizeof(*fd));
+  fd = js_arena_mallocz(arena, sizeof(*fd));
   if (!fd)
     return NULL;
 
   fd->ctx = ctx;
+  fd->arena = arena;
   init_list_head(&fd->child_list);
 
   /* insert in parent list */
@@ -8240,7 +8242,7 @@ JSFunctionDef* js_new_function_def(
 
   fd->is_eval = is_eval;
   fd->is_func_expr = is_func_expr;
-  js_dbuf_init(ctx, &fd->byte_code);
+  js_arena_dbuf_init(arena, &fd->byte_code);
   fd->last_opcode_pos = -1;
   fd->func_name = JS_ATOM_NULL;
   fd->var_object_idx = -1;
@@ -8296,39 +8298,39 @@ void js_free_function_def(JSContext* ctx, JSFunctionDef* fd) {
     free_ic(fd->ic);
   }
   dbuf_free(&fd->byte_code);
-  js_free(ctx, fd->jump_slots);
-  js_free(ctx, fd->label_slots);
-  js_free(ctx, fd->line_number_slots);
+  js_arena_free(fd->arena, fd->jump_slots);
+  js_arena_free(fd->arena, fd->label_slots);
+  js_arena_free(fd->arena, fd->line_number_slots);
 
   for (i = 0; i < fd->cpool_count; i++) {
     JS_FreeValue(ctx, fd->cpool[i]);
   }
-  js_free(ctx, fd->cpool);
+  js_arena_free(fd->arena, fd->cpool);
 
   JS_FreeAtom(ctx, fd->func_name);
 
   for (i = 0; i < fd->var_count; i++) {
     JS_FreeAtom(ctx, fd->vars[i].var_name);
   }
-  js_free(ctx, fd->vars);
+  js_arena_free(fd->arena, fd->vars);
   for (i = 0; i < fd->arg_count; i++) {
     JS_FreeAtom(ctx, fd->args[i].var_name);
   }
-  js_free(ctx, fd->args);
+  js_arena_free(fd->arena, fd->args);
 
   for (i = 0; i < fd->global_var_count; i++) {
     JS_FreeAtom(ctx, fd->global_vars[i].var_name);
   }
-  js_free(ctx, fd->global_vars);
+  js_arena_free(fd->arena, fd->global_vars);
 
   for (i = 0; i < fd->closure_var_count; i++) {
     JSClosureVar* cv = &fd->closure_var[i];
     JS_FreeAtom(ctx, cv->var_name);
   }
-  js_free(ctx, fd->closure_var);
+  js_arena_free(fd->arena, fd->closure_var);
 
   if (fd->scopes != fd->def_scope_array)
-    js_free(ctx, fd->scopes);
+    js_arena_free(fd->arena, fd->scopes);
 
   JS_FreeAtom(ctx, fd->filename);
   dbuf_free(&fd->pc2line);
@@ -8340,7 +8342,7 @@ void js_free_function_def(JSContext* ctx, JSFunctionDef* fd) {
     /* remove in parent list */
     list_del(&fd->link);
   }
-  js_free(ctx, fd);
+  js_arena_free(fd->arena, fd);
 }
 
 #ifdef DUMP_BYTECODE
@@ -8823,8 +8825,8 @@ static int add_closure_var(
     return -1;
   }
 
-  if (js_resize_array(
-          ctx,
+  if (js_arena_resize_array(
+          s->arena,
           (void**)&s->closure_var,
           sizeof(s->closure_var[0]),
           &s->closure_var_size,
@@ -8836,6 +8838,9 @@ static int add_closure_var(
   cv->is_const = is_const;
   cv->is_lexical = is_lexical;
   cv->var_kind = var_kind;
+  /* hoisted function declarations are created before the lexical
+     variables of the scope are initialized */
+  cv->is_immutable = is_local && is_const && !is_arg && s->is_func_expr;
   cv->var_idx = var_idx;
   cv->var_name = JS_DupAtom(ctx, var_name);
   return s->closure_var_count - 1;
@@ -10017,6 +10022,7 @@ static void set_closure_from_var(
   cv->is_const = vd->is_const;
   cv->is_lexical = vd->is_lexical;
   cv->var_kind = vd->var_kind;
+  cv->is_immutable = FALSE;
   cv->var_idx = var_idx;
   cv->var_name = JS_DupAtom(ctx, vd->var_name);
 }
@@ -10038,7 +10044,8 @@ __exception int add_closure_variables(
   s->closure_var_size = count;
   if (count == 0)
     return 0;
-  s->closure_var = js_malloc(ctx, sizeof(s->closure_var[0]) * count);
+  s->closure_var =
+      js_arena_malloc(s->arena, sizeof(s->closure_var[0]) * count);
   if (!s->closure_var)
     return -1;
   /* Add lexical variables in scope at the point of evaluation */
@@ -10072,6 +10079,7 @@ __exception int add_closure_variables(
       cv->is_const = FALSE;
       cv->is_lexical = FALSE;
       cv->var_kind = JS_VAR_NORMAL;
+      cv->is_immutable = FALSE;
       cv->var_idx = i;
       cv->var_name = JS_DupAtom(ctx, vd->var_name);
     }
@@ -10101,6 +10109,7 @@ __exception int add_closure_variables(
     cv->is_const = cv0->is_const;
     cv->is_lexical = cv0->is_lexical;
     cv->var_kind = cv0->var_kind;
+    cv->is_immutable = FALSE;
     cv->var_idx = i;
     cv->var_name = JS_DupAtom(ctx, cv0->var_name);
   }
@@ -10367,7 +10376,7 @@ instantiate_hoisted_definitions(JSContext* ctx, JSFunctionDef* s, DynBuf* bc) {
     s->label_slots[label_next].pos2 = bc->size;
   }
 
-  js_free(ctx, s->global_vars);
+  js_arena_free(s->arena, s->global_vars);
   s->global_vars = NULL;
   s->global_var_count = 0;
   s->global_var_size = 0;
@@ -10459,7 +10468,7 @@ static __exception int resolve_variables(JSContext* ctx, JSFunctionDef* s) {
 
   cc.bc_buf = bc_buf = s->byte_code.buf;
   cc.bc_len = bc_len = s->byte_code.size;
-  js_dbuf_init(ctx, &bc_out);
+  js_arena_dbuf_init(s->arena, &bc_out);
 
   /* first pass for runtime checks (must be done before the
      variables are created) */
@@ -11099,19 +11108,20 @@ static __exception int resolve_labels(JSContext* ctx, JSFunctionDef* s) {
 
   cc.bc_buf = bc_buf = s->byte_code.buf;
   cc.bc_len = bc_len = s->byte_code.size;
-  js_dbuf_init(ctx, &bc_out);
+  js_arena_dbuf_init(s->arena, &bc_out);
 
 #if SHORT_OPCODES
   if (s->jump_size) {
-    s->jump_slots = js_mallocz(s->ctx, sizeof(*s->jump_slots) * s->jump_size);
+    s->jump_slots =
+        js_arena_mallocz(s->arena, sizeof(*s->jump_slots) * s->jump_size);
     if (s->jump_slots == NULL)
       return -1;
   }
 #endif
   /* XXX: Should skip this phase if not generating SHORT_OPCODES */
   if (s->line_number_size && !s->strip_debug) {
-    s->line_number_slots =
-        js_mallocz(s->ctx, sizeof(*s->line_number_slots) * s->line_number_size);
+    s->line_number_slots = js_arena_mallocz(
+        s->arena, sizeof(*s->line_number_slots) * s->line_number_size);
     if (s->line_number_slots == NULL)
       return -1;
     s->line_number_last = s->source_pos;
@@ -11852,6 +11862,18 @@ static __exception int resolve_labels(JSContext* ctx, JSFunctionDef* s) {
             pos_next = cc.pos;
             break;
           }
+          /* transformation: get_loc(n) get_field(x) -> get_loc_field(x, n) */
+          if (idx < 0x80 && code_match(&cc, pos_next, OP_get_field, -1) &&
+              cc.atom != JS_ATOM_length) {
+            if (cc.line_num >= 0)
+              line_num = cc.line_num;
+            add_pc2line_info(s, bc_out.size, line_num);
+            dbuf_putc(&bc_out, OP_get_loc_field);
+            dbuf_put_u32(&bc_out, cc.atom);
+            dbuf_putc(&bc_out, idx);
+            pos_next = cc.pos;
+            break;
+          }
           add_pc2line_info(s, bc_out.size, line_num);
           put_short_code(&bc_out, op, idx);
           break;
@@ -11863,6 +11885,20 @@ static __exception int resolve_labels(JSContext* ctx, JSFunctionDef* s) {
         if (OPTIMIZE) {
           int idx;
           idx = get_u16(bc_buf + pos + 1);
+          /* transformation:
+             get_arg(n) get_field(x) -> get_loc_field(x, 0x80 | n) */
+          if (op == OP_get_arg && idx < 0x80 &&
+              code_match(&cc, pos_next, OP_get_field, -1) &&
+              cc.atom != JS_ATOM_length) {
+            if (cc.line_num >= 0)
+              line_num = cc.line_num;
+            add_pc2line_info(s, bc_out.size, line_num);
+            dbuf_putc(&bc_out, OP_get_loc_field);
+            dbuf_put_u32(&bc_out, cc.atom);
+            dbuf_putc(&bc_out, 0x80 | idx);
+            pos_next = cc.pos;
+            break;
+          }
           add_pc2line_info(s, bc_out.size, line_num);
           put_short_code(&bc_out, op, idx);
           break;
@@ -12093,14 +12129,14 @@ static __exception int resolve_labels(JSContext* ctx, JSFunctionDef* s) {
       }
     }
   }
-  js_free(ctx, s->jump_slots);
+  js_arena_free(s->arena, s->jump_slots);
   s->jump_slots = NULL;
 #endif
-  js_free(ctx, s->label_slots);
+  js_arena_free(s->arena, s->label_slots);
   s->label_slots = NULL;
   /* XXX: should delay until copying to runtime bytecode function */
   compute_pc2line_info(s);
-  js_free(ctx, s->line_number_slots);
+  js_arena_free(s->arena, s->line_number_slots);
   s->line_number_slots = NULL;
   /* set the new byte code */
   dbuf_free(&s->byte_code);
@@ -12429,6 +12465,30 @@ static int add_module_variables(JSContext* ctx, JSFunctionDef* fd) {
   return 0;
 }
 
+/* monotonic clock for JSCompileStats, in nanoseconds */
+static int64_t js_compile_clock(void) {
+#if defined(_WIN32)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static inline int64_t compile_stats_start(JSContext* ctx) {
+  return ctx->rt->compile_stats ? js_compile_clock() : 0;
+}
+
+#define compile_stats_add(ctx, field, start)                 \
+  do {                                                       \
+    JSCompileStats* cs__ = (ctx)->rt->compile_stats;         \
+    if (cs__)                                                \
+      cs__->field += js_compile_clock() - (start);           \
+  } while (0)
+
 /* create a function object from a function definition. The function
    definition is freed. All the child functions are also created. It
    must be done this way to resolve all the variables. */
@@ -12437,8 +12497,10 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
   JSFunctionBytecode* b;
   struct list_head *el, *el1;
   int stack_size, scope, idx;
-  int function_size, byte_code_offset, cpool_offset;
+  int function_size, cpool_offset;
+  uint8_t* byte_code_buf;
   int closure_var_offset, vardefs_offset;
+  int64_t start;
 
   /* recompute scope linkage */
   for (scope = 0; scope < fd->scope_count; scope++) {
@@ -12517,8 +12579,10 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
   }
 #endif
 
+  start = compile_stats_start(ctx);
   if (resolve_variables(ctx, fd))
     goto fail;
+  compile_stats_add(ctx, resolve_variables_time, start);
 
 #if defined(DUMP_BYTECODE) && (DUMP_BYTECODE & 2)
   if (!fd->strip_debug) {
@@ -12543,11 +12607,15 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
   }
 #endif
 
+  start = compile_stats_start(ctx);
   if (resolve_labels(ctx, fd))
     goto fail;
+  compile_stats_add(ctx, resolve_labels_time, start);
 
+  start = compile_stats_start(ctx);
   if (compute_stack_size(ctx, fd, &stack_size) < 0)
     goto fail;
+  compile_stats_add(ctx, stack_size_time, start);
 
   if (fd->strip_debug) {
     function_size = offsetof(JSFunctionBytecode, debug);
@@ -12562,19 +12630,22 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
   }
   closure_var_offset = function_size;
   function_size += fd->closure_var_count * sizeof(*fd->closure_var);
-  byte_code_offset = function_size;
-  function_size += fd->byte_code.size;
 
+  /* moved to the code template of the function */
+  byte_code_buf = js_malloc(ctx, fd->byte_code.size);
+  if (!byte_code_buf)
+    goto fail;
   b = js_mallocz(ctx, function_size);
-  if (!b)
+  if (!b) {
+    js_free(ctx, byte_code_buf);
     goto fail;
+  }
   b->header.ref_count = 1;
 
-  b->byte_code_buf = (void*)((uint8_t*)b + byte_code_offset);
+  b->byte_code_buf = byte_code_buf;
   b->byte_code_len = fd->byte_code.size;
   memcpy(b->byte_code_buf, fd->byte_code.buf, fd->byte_code.size);
-  js_free(ctx, fd->byte_code.buf);
-  fd->byte_code.buf = NULL;
+  dbuf_free(&fd->byte_code);
 
   b->func_name = fd->func_name;
   if (fd->arg_count + fd->var_count > 0) {
@@ -12602,15 +12673,15 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
     b->var_count = fd->var_count;
     b->arg_count = fd->arg_count;
     b->defined_arg_count = fd->defined_arg_count;
-    js_free(ctx, fd->args);
-    js_free(ctx, fd->vars);
+    js_arena_free(fd->arena, fd->args);
+    js_arena_free(fd->arena, fd->vars);
   }
   b->cpool_count = fd->cpool_count;
   if (b->cpool_count) {
     b->cpool = (void*)((uint8_t*)b + cpool_offset);
     memcpy(b->cpool, fd->cpool, b->cpool_count * sizeof(*b->cpool));
   }
-  js_free(ctx, fd->cpool);
+  js_arena_free(fd->arena, fd->cpool);
   fd->cpool = NULL;
 
   b->stack_size = stack_size;
@@ -12646,7 +12717,7 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
     b->debug.source_len = fd->source_len;
   }
   if (fd->scopes != fd->def_scope_array)
-    js_free(ctx, fd->scopes);
+    js_arena_free(fd->arena, fd->scopes);
 
   b->closure_var_count = fd->closure_var_count;
   if (b->closure_var_count) {
@@ -12656,7 +12727,7 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
         fd->closure_var,
         b->closure_var_count * sizeof(*b->closure_var));
   }
-  js_free(ctx, fd->closure_var);
+  js_arena_free(fd->arena, fd->closure_var);
   fd->closure_var = NULL;
 
   b->has_prototype = fd->has_prototype;
@@ -12682,7 +12753,10 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
     b->ic = NULL;
   }
 
+  js_function_set_code_template(ctx, b);
   add_gc_object(ctx->rt, &b->header, JS_GC_OBJ_TYPE_FUNCTION_BYTECODE);
+  if (ctx->rt->compile_stats)
+    ctx->rt->compile_stats->function_count++;
 
 #if defined(DUMP_BYTECODE) && (DUMP_BYTECODE & 1)
   if (!fd->strip_debug) {
@@ -12695,7 +12769,7 @@ JSValue js_create_function(JSContext* ctx, JSFunctionDef* fd) {
     list_del(&fd->link);
   }
 
-  js_free(ctx, fd);
+  js_arena_free(fd->arena, fd);
   return JS_MKPTR(JS_TAG_FUNCTION_BYTECODE, b);
 fail:
   js_free_function_def(ctx, fd);
@@ -12858,6 +12932,7 @@ static JSFunctionDef* js_parse_function_class_fields_init(JSParseState* s) {
 
   fd = js_new_function_def(
       s->ctx,
+      &s->arena,
       s->cur_func,
       FALSE,
       FALSE,
@@ -13006,7 +13081,14 @@ static __exception int js_parse_function_decl2(
   }
 
   fd = js_new_function_def(
-      ctx, fd, FALSE, is_expr, s->filename, ptr, &s->get_line_col_cache);
+      ctx,
+      &s->arena,
+      fd,
+      FALSE,
+      is_expr,
+      s->filename,
+      ptr,
+      &s->get_line_col_cache);
   if (!fd) {
     JS_FreeAtom(ctx, func_name);
     return -1;
@@ -13545,6 +13627,7 @@ void js_parse_init(
   s->get_line_col_cache.buf_start = s->buf_start;
   s->get_line_col_cache.line_num = 0;
   s->get_line_col_cache.col_num = 0;
+  js_arena_init(ctx, &s->arena);
 }
 
 void skip_shebang(const uint8_t** pp, const uint8_t* buf_end) {
@@ -13588,9 +13671,14 @@ JSValue __JS_EvalInternal(
   JSFunctionBytecode* b;
   JSFunctionDef* fd;
   JSModuleDef* m;
+  JSCompileStats* stats;
+  int64_t start;
 
+  /* all the JSFunctionDefs live in s->arena which is released once the
+     bytecode is created */
   js_parse_init(ctx, s, input, input_len, filename);
   skip_shebang(&s->buf_ptr, s->buf_end);
+  start = compile_stats_start(ctx);
 
   eval_type = flags & JS_EVAL_TYPE_MASK;
   m = NULL;
@@ -13622,7 +13710,14 @@ JSValue __JS_EvalInternal(
     }
   }
   fd = js_new_function_def(
-      ctx, NULL, TRUE, FALSE, filename, s->buf_start, &s->get_line_col_cache);
+      ctx,
+      &s->arena,
+      NULL,
+      TRUE,
+      FALSE,
+      filename,
+      s->buf_start,
+      &s->get_line_col_cache);
   if (!fd)
     goto fail1;
   s->cur_func = fd;
@@ -13663,14 +13758,25 @@ JSValue __JS_EvalInternal(
     js_free_function_def(ctx, fd);
     goto fail1;
   }
+  compile_stats_add(ctx, parse_time, start);
 
   if (m != NULL)
     m->has_tla = fd->has_await;
 
   /* create the function object and all the enclosed functions */
+  start = compile_stats_start(ctx);
   fun_obj = js_create_function(ctx, fd);
   if (JS_IsException(fun_obj))
     goto fail1;
+  compile_stats_add(ctx, compile_time, start);
+  stats = ctx->rt->compile_stats;
+  if (stats) {
+    stats->eval_count++;
+    stats->source_size += input_len;
+    stats->arena_max_size =
+        max_int64(stats->arena_max_size, s->arena.max_size);
+  }
+  js_arena_free_all(&s->arena);
   /* Could add a flag to avoid resolution if necessary */
   if (m) {
     m->func_obj = fun_obj;
@@ -13685,6 +13791,7 @@ JSValue __JS_EvalInternal(
   }
   return ret_val;
 fail1:
+  js_arena_free_all(&s->arena);
   /* XXX: should free all the unresolved dependencies */
   if (m)
     JS_FreeValue(ctx, JS_MKPTR(JS_TAG_MODULE, m));
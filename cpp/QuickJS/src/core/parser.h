@@ -28,6 +28,7 @@
 #include "QuickJS/cutils.h"
 #include "QuickJS/list.h"
 #include "ic.h"
+#include "malloc.h"
 #include "types.h"
 
 /* JS parser */
@@ -223,6 +224,7 @@ typedef enum JSParseExportEnum {
 
 typedef struct JSFunctionDef {
   JSContext* ctx;
+  JSArena* arena; /* compiler data of the whole eval, see __JS_EvalInternal */
   struct JSFunctionDef* parent;
   int parent_cpool_idx; /* index in the constant pool of the parent
                                          or -1 if none */
@@ -389,6 +391,7 @@ typedef struct JSParseState {
   BOOL allow_html_comments;
   BOOL ext_json; /* true if accepting JSON superset */
   GetLineColCache get_line_col_cache;
+  JSArena arena; /* allocator of the JSFunctionDefs */
 } JSParseState;
 
 typedef struct JSOpCode {
@@ -443,6 +446,7 @@ JSExportEntry* add_export_entry2(
     JSExportTypeEnum export_type);
 JSFunctionDef* js_new_function_def(
     JSContext* ctx,
+    JSArena* arena,
     JSFunctionDef* parent,
     BOOL is_eval,
     BOOL is_func_expr,
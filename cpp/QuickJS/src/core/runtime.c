@@ -27,6 +27,7 @@
 #include <math.h>
 #include "QuickJS/dtoa.h"
 #include "builtins/js-array.h"
+#include "builtins/js-async-function.h"
 #include "builtins/js-big-num.h"
 #include "builtins/js-boolean.h"
 #include "builtins/js-closures.h"
@@ -49,6 +50,7 @@
 #include "malloc.h"
 #include "module.h"
 #include "object.h"
+#include "opcode-profile.h"
 #include "parser.h"
 #include "shape.h"
 #include "string-utils.h"
@@ -1204,6 +1206,25 @@ done:
   return ret;
 }
 
+/* Error.stack is captured as (function, pc) pairs and only formatted on
+   the first read of the property (JS_AUTOINIT_ID_BACKTRACE). */
+typedef struct JSBacktraceFrame {
+  JSValue func;
+  int pc; /* -1 if the function has no debug info */
+} JSBacktraceFrame;
+
+typedef struct JSBacktrace {
+  int frame_count;
+  JSBacktraceFrame frames[0];
+} JSBacktrace;
+
+static void js_backtrace_free(JSRuntime* rt, JSBacktrace* bt) {
+  int i;
+  for (i = 0; i < bt->frame_count; i++)
+    JS_FreeValueRT(rt, bt->frames[i].func);
+  js_free_rt(rt, bt);
+}
+
 JSContext* js_autoinit_get_realm(JSProperty* pr) {
   return (JSContext*)(pr->u.init.realm_and_id & ~3);
 }
@@ -1213,10 +1234,18 @@ JSAutoInitIDEnum js_autoinit_get_id(JSProperty* pr) {
 }
 
 void js_autoinit_free(JSRuntime* rt, JSProperty* pr) {
+  if (js_autoinit_get_id(pr) == JS_AUTOINIT_ID_BACKTRACE)
+    js_backtrace_free(rt, pr->u.init.opaque);
   JS_FreeContext(js_autoinit_get_realm(pr));
 }
 
 void js_autoinit_mark(JSRuntime* rt, JSProperty* pr, JS_MarkFunc* mark_func) {
+  if (js_autoinit_get_id(pr) == JS_AUTOINIT_ID_BACKTRACE) {
+    JSBacktrace* bt = pr->u.init.opaque;
+    int i;
+    for (i = 0; i < bt->frame_count; i++)
+      JS_MarkValue(rt, bt->frames[i].func, mark_func);
+  }
   mark_func(rt, &js_autoinit_get_realm(pr)->header);
 }
 
@@ -1265,24 +1294,61 @@ const char* get_func_name(JSContext* ctx, JSValueConst func) {
   return JS_ToCString(ctx, val);
 }
 
+static JSBacktrace* js_backtrace_capture(JSContext* ctx, int backtrace_flags) {
+  JSStackFrame* sf;
+  JSBacktrace* bt;
+  JSBacktraceFrame* f;
+  JSObject* p;
+  int n, skip;
+
+  skip = (backtrace_flags & JS_BACKTRACE_FLAG_SKIP_FIRST_LEVEL) != 0;
+  n = 0;
+  for (sf = ctx->rt->current_stack_frame; sf != NULL; sf = sf->prev_frame) {
+    if (sf->js_mode & JS_MODE_BACKTRACE_BARRIER)
+      break;
+    n++;
+  }
+  if (n > 0)
+    n -= skip;
+
+  bt = js_malloc(ctx, sizeof(*bt) + sizeof(bt->frames[0]) * max_int(n, 0));
+  if (!bt)
+    return NULL;
+  bt->frame_count = n;
+  f = bt->frames;
+  for (sf = ctx->rt->current_stack_frame; f < bt->frames + n;
+       sf = sf->prev_frame) {
+    if (skip) {
+      skip = 0;
+      continue;
+    }
+    f->func = JS_DupValue(ctx, sf->cur_func);
+    f->pc = -1;
+    p = JS_VALUE_GET_OBJ(sf->cur_func);
+    if (js_class_has_bytecode(p->class_id)) {
+      JSFunctionBytecode* b = p->u.func.function_bytecode;
+      if (b->has_debug)
+        f->pc = sf->cur_pc - b->byte_code_buf - 1;
+    }
+    f++;
+  }
+  return bt;
+}
+
 /* if filename != NULL, an additional level is added with the filename
-   and line number information (used for parse error). */
-void build_backtrace(
+   and line number information. Return JS_NULL if out of memory. */
+static JSValue js_backtrace_to_string(
     JSContext* ctx,
-    JSValueConst error_obj,
+    JSBacktrace* bt,
     const char* filename,
     int line_num,
-    int col_num,
-    int backtrace_flags) {
-  JSStackFrame* sf;
+    int col_num) {
   JSValue str;
   DynBuf dbuf;
   const char* func_name_str;
   const char* str1;
   JSObject* p;
-
-  if (!JS_IsObject(error_obj))
-    return; /* protection in the out of memory case */
+  int i;
 
   js_dbuf_init(ctx, &dbuf);
   if (filename) {
@@ -1290,39 +1356,10 @@ void build_backtrace(
     if (line_num != -1)
       dbuf_printf(&dbuf, ":%d:%d", line_num, col_num);
     dbuf_putc(&dbuf, '\n');
-    str = JS_NewString(ctx, filename);
-    if (JS_IsException(str))
-      return;
-    /* Note: SpiderMonkey does that, could update once there is a standard */
-    if (JS_DefinePropertyValue(
-            ctx,
-            error_obj,
-            JS_ATOM_fileName,
-            str,
-            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0 ||
-        JS_DefinePropertyValue(
-            ctx,
-            error_obj,
-            JS_ATOM_lineNumber,
-            JS_NewInt32(ctx, line_num),
-            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0 ||
-        JS_DefinePropertyValue(
-            ctx,
-            error_obj,
-            JS_ATOM_columnNumber,
-            JS_NewInt32(ctx, col_num),
-            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0) {
-      return;
-    }
   }
-  for (sf = ctx->rt->current_stack_frame; sf != NULL; sf = sf->prev_frame) {
-    if (sf->js_mode & JS_MODE_BACKTRACE_BARRIER)
-      break;
-    if (backtrace_flags & JS_BACKTRACE_FLAG_SKIP_FIRST_LEVEL) {
-      backtrace_flags &= ~JS_BACKTRACE_FLAG_SKIP_FIRST_LEVEL;
-      continue;
-    }
-    func_name_str = get_func_name(ctx, sf->cur_func);
+  for (i = 0; i < bt->frame_count; i++) {
+    JSBacktraceFrame* f = &bt->frames[i];
+    func_name_str = get_func_name(ctx, f->func);
     if (!func_name_str || func_name_str[0] == '\0')
       str1 = "<anonymous>";
     else
@@ -1330,7 +1367,7 @@ void build_backtrace(
     dbuf_printf(&dbuf, "    at %s", str1);
     JS_FreeCString(ctx, func_name_str);
 
-    p = JS_VALUE_GET_OBJ(sf->cur_func);
+    p = JS_VALUE_GET_OBJ(f->func);
     if (js_class_has_bytecode(p->class_id)) {
       JSFunctionBytecode* b;
       const char* atom_str;
@@ -1338,8 +1375,7 @@ void build_backtrace(
 
       b = p->u.func.function_bytecode;
       if (b->has_debug) {
-        line_num1 =
-            find_line_num(ctx, b, sf->cur_pc - b->byte_code_buf - 1, &col_num1);
+        line_num1 = find_line_num(ctx, b, f->pc, &col_num1);
         atom_str = JS_AtomToCString(ctx, b->debug.filename);
         dbuf_printf(&dbuf, " (%s", atom_str ? atom_str : "<null>");
         JS_FreeCString(ctx, atom_str);
@@ -1358,6 +1394,80 @@ void build_backtrace(
   else
     str = JS_NewString(ctx, (char*)dbuf.buf);
   dbuf_free(&dbuf);
+  return str;
+}
+
+JSValue
+js_backtrace_autoinit(JSContext* ctx, JSObject* p, JSAtom atom, void* opaque) {
+  /* 'opaque' is freed by js_autoinit_free() */
+  return js_backtrace_to_string(ctx, opaque, NULL, 0, 0);
+}
+
+/* if filename != NULL, an additional level is added with the filename
+   and line number information (used for parse error). */
+void build_backtrace(
+    JSContext* ctx,
+    JSValueConst error_obj,
+    const char* filename,
+    int line_num,
+    int col_num,
+    int backtrace_flags) {
+  JSValue str;
+  JSBacktrace* bt;
+  JSObject* p;
+
+  if (!JS_IsObject(error_obj))
+    return; /* protection in the out of memory case */
+
+  if (filename) {
+    str = JS_NewString(ctx, filename);
+    if (JS_IsException(str))
+      return;
+    /* Note: SpiderMonkey does that, could update once there is a standard */
+    if (JS_DefinePropertyValue(
+            ctx,
+            error_obj,
+            JS_ATOM_fileName,
+            str,
+            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0 ||
+        JS_DefinePropertyValue(
+            ctx,
+            error_obj,
+            JS_ATOM_lineNumber,
+            JS_NewInt32(ctx, line_num),
+            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0 ||
+        JS_DefinePropertyValue(
+            ctx,
+            error_obj,
+            JS_ATOM_columnNumber,
+            JS_NewInt32(ctx, col_num),
+            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0) {
+      return;
+    }
+  }
+
+  bt = js_backtrace_capture(ctx, backtrace_flags);
+  p = JS_VALUE_GET_OBJ(error_obj);
+  if (bt && !filename && p->extensible &&
+      !find_own_property1(p, JS_ATOM_stack)) {
+    if (JS_DefineAutoInitProperty(
+            ctx,
+            error_obj,
+            JS_ATOM_stack,
+            JS_AUTOINIT_ID_BACKTRACE,
+            bt,
+            JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE) < 0)
+      js_backtrace_free(ctx->rt, bt);
+    return;
+  }
+
+  /* parse errors and redefinitions are formatted immediately */
+  if (bt) {
+    str = js_backtrace_to_string(ctx, bt, filename, line_num, col_num);
+    js_backtrace_free(ctx->rt, bt);
+  } else {
+    str = JS_NULL;
+  }
   JS_DefinePropertyValue(
       ctx,
       error_obj,
@@ -1379,9 +1489,39 @@ BOOL is_backtrace_needed(JSContext* ctx, JSValueConst obj) {
   return TRUE;
 }
 
+int64_t js_get_monotonic_time(void) {
+#if defined(_WIN32)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* The clock is only read when the interrupt counter of a context reaches
+   zero, so a budget is exceeded by at most JS_INTERRUPT_COUNTER_INIT
+   instructions. */
+BOOL js_check_budget(JSRuntime* rt) {
+  if (!rt->budget_deadline)
+    return FALSE;
+  if (!rt->budget_expired) {
+    if (js_get_monotonic_time() < rt->budget_deadline)
+      return FALSE;
+    rt->budget_expired = TRUE;
+  }
+  return TRUE;
+}
+
 no_inline __exception int __js_poll_interrupts(JSContext* ctx) {
   JSRuntime* rt = ctx->rt;
   ctx->interrupt_counter = JS_INTERRUPT_COUNTER_INIT;
+  if (js_check_budget(rt)) {
+    JS_ThrowInterrupted(ctx);
+    return -1;
+  }
   if (rt->interrupt_handler) {
     if (rt->interrupt_handler(rt, rt->interrupt_opaque)) {
       JS_ThrowInterrupted(ctx);
@@ -1885,6 +2025,23 @@ int JS_GetStripInfo(JSRuntime* rt) {
   return rt->strip_flags;
 }
 
+void JS_SetCompileStats(JSRuntime* rt, JSCompileStats* s) {
+  rt->compile_stats = s;
+}
+
+void JS_SetStringDedup(JSRuntime* rt, uint32_t max_len) {
+  rt->string_dedup_max_len = min_uint32(max_len, JS_STRING_LEN_MAX);
+}
+
+JS_BOOL JS_SetJITThreshold(JSRuntime* rt, int threshold) {
+#ifdef ENABLE_JIT
+  rt->jit_threshold = max_int(threshold, 0);
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 /* return 0 if OK, < 0 if exception */
 int JS_EnqueueJob(
     JSContext* ctx,
@@ -3197,6 +3354,11 @@ void JS_FreeRuntime(JSRuntime* rt) {
   if (rt->state == JS_RUNTIME_STATE_SHUTDOWN)
     return;
   rt->state = JS_RUNTIME_STATE_SHUTDOWN;
+  if (rt->malloc_sampler) {
+    JSMallocSampler* s = rt->malloc_sampler;
+    rt->malloc_sampler = NULL;
+    s->finalize(rt, s->opaque);
+  }
   JS_FreeValueRT(rt, rt->current_exception);
 
   list_for_each_safe(el, el1, &rt->job_list) {
@@ -3255,6 +3417,11 @@ void JS_FreeRuntime(JSRuntime* rt) {
   // JS_ASSERT(list_empty(&rt->gc_obj_list));
   // JS_ASSERT(list_empty(&rt->weakref_list));
 
+  async_func_pool_free(rt);
+#ifdef ENABLE_OPCODE_PROFILE
+  js_opcode_profile_free(rt);
+#endif
+
   /* free the classes */
   for (i = 0; i < rt->class_count; i++) {
     JSClass* cl = &rt->class_array[i];
@@ -3338,6 +3505,8 @@ void JS_FreeRuntime(JSRuntime* rt) {
   js_free_rt(rt, rt->atom_array);
   js_free_rt(rt, rt->atom_hash);
   js_free_rt(rt, rt->shape_hash);
+  js_free_rt(rt, rt->code_template_hash);
+  js_free_rt(rt, rt->timezone_cache.tz);
 #ifdef DUMP_LEAKS
   if (!list_empty(&rt->string_list)) {
     if (rt->rt_info) {
@@ -3519,6 +3688,7 @@ void JS_FreeContext(JSContext* ctx) {
   JS_FreeValue(ctx, ctx->function_proto);
 
   js_free_shape_null(ctx->rt, ctx->array_shape);
+  js_proxy_free_trap_cache(rt, ctx);
 
   list_del(&ctx->link);
   remove_gc_object(&ctx->header);
@@ -3596,6 +3766,7 @@ JSRuntime* JS_NewRuntime2(const JSMallocFunctions* mf, void* opaque) {
 #ifdef DUMP_LEAKS
   init_list_head(&rt->string_list);
 #endif
+  init_list_head(&rt->string_slice_list);
   init_list_head(&rt->job_list);
 
   if (JS_InitAtoms(rt))
@@ -3622,6 +3793,9 @@ JSRuntime* JS_NewRuntime2(const JSMallocFunctions* mf, void* opaque) {
 
   rt->current_exception = JS_NULL;
   rt->state = JS_RUNTIME_STATE_INIT;
+#ifdef ENABLE_OPCODE_PROFILE
+  js_opcode_profile_init(rt);
+#endif
 
   return rt;
 fail:
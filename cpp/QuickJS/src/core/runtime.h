@@ -225,6 +225,8 @@ void build_backtrace(
     int column_num,
     int backtrace_flags);
 BOOL is_backtrace_needed(JSContext* ctx, JSValueConst obj);
+JSValue
+js_backtrace_autoinit(JSContext* ctx, JSObject* p, JSAtom atom, void* opaque);
 
 void JS_SetImmutablePrototype(JSContext* ctx, JSValueConst obj);
 
@@ -305,6 +307,10 @@ JSAutoInitIDEnum js_autoinit_get_id(JSProperty* pr);
 void js_autoinit_free(JSRuntime* rt, JSProperty* pr);
 void js_autoinit_mark(JSRuntime* rt, JSProperty* pr, JS_MarkFunc* mark_func);
 
+/* monotonic clock in nanoseconds */
+int64_t js_get_monotonic_time(void);
+/* return TRUE if the deadline of the current budget is reached */
+BOOL js_check_budget(JSRuntime* rt);
 no_inline __exception int __js_poll_interrupts(JSContext* ctx);
 static inline __exception int js_poll_interrupts(JSContext* ctx) {
   if (unlikely(--ctx->interrupt_counter <= 0)) {
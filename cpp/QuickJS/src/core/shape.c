@@ -141,6 +141,7 @@ js_new_shape2(JSContext* ctx, JSObject* proto, int hash_size, int prop_size) {
   sh->is_hashed = TRUE;
   sh->has_small_array_index = FALSE;
   sh->watchpoint = NULL;
+  sh->enum_cache = NULL;
   js_shape_hash_link(ctx->rt, sh);
   return sh;
 }
@@ -171,6 +172,7 @@ JSShape* js_clone_shape(JSContext* ctx, JSShape* sh1) {
   add_gc_object(ctx->rt, &sh->header, JS_GC_OBJ_TYPE_SHAPE);
   sh->is_hashed = FALSE;
   sh->watchpoint = NULL;
+  sh->enum_cache = NULL;
   if (sh->proto) {
     JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, sh->proto));
   }
@@ -196,6 +198,7 @@ void js_free_shape0(JSRuntime* rt, JSShape* sh) {
     JS_FreeValueRT(rt, JS_MKPTR(JS_TAG_OBJECT, sh->proto));
   }
   js_shape_free_watchpoints(rt, sh);
+  js_shape_free_enum_cache(rt, sh);
   pr = get_shape_prop(sh);
   for (i = 0; i < sh->prop_count; i++) {
     JS_FreeAtomRT(rt, pr->atom);
@@ -347,9 +350,42 @@ int compact_properties(JSContext* ctx, JSObject* p) {
   new_prop = js_realloc(ctx, p->prop, sizeof(new_prop[0]) * new_size);
   if (new_prop)
     p->prop = new_prop;
+
+  /* the object no longer looks like a map */
+  if (sh->prop_count <= JS_SHAPE_FAST_PROP_COUNT)
+    js_shape_rehash(ctx->rt, p);
   return 0;
 }
 
+/* insert the shape of the dictionary object 'p' in the shape hash table
+   so that it can be shared again. Its properties must be compacted. */
+void js_shape_rehash(JSRuntime* rt, JSObject* p) {
+  JSShape* sh = p->shape;
+  JSShapeProperty* pr;
+  uint32_t h, i;
+
+  JS_ASSERT(!sh->is_hashed && sh->deleted_prop_count == 0);
+  if (sh->header.ref_count != 1)
+    return;
+  /* same hash as the one computed by add_shape_property() */
+  h = shape_initial_hash(sh->proto);
+  for (i = 0, pr = get_shape_prop(sh); i < sh->prop_count; i++, pr++)
+    h = shape_hash(shape_hash(h, pr->atom), pr->flags);
+  if (2 * (rt->shape_hash_count + 1) > rt->shape_hash_size)
+    resize_shape_hash(rt, rt->shape_hash_bits + 1);
+  sh->hash = h;
+  sh->is_hashed = TRUE;
+  js_shape_hash_link(rt, sh);
+}
+
+/* must be called before the properties of the shape are modified */
+void js_shape_free_enum_cache(JSRuntime* rt, JSShape* sh) {
+  if (sh->enum_cache) {
+    js_free_rt(rt, sh->enum_cache);
+    sh->enum_cache = NULL;
+  }
+}
+
 int add_shape_property(
     JSContext* ctx,
     JSShape** psh,
@@ -362,6 +398,7 @@ int add_shape_property(
   uint32_t hash_mask, new_shape_hash = 0;
   intptr_t h;
 
+  js_shape_free_enum_cache(rt, sh);
   /* update the shape hash */
   if (sh->is_hashed) {
     js_shape_hash_unlink(rt, sh);
@@ -625,6 +662,7 @@ int js_shape_prepare_update(
         *pprs = get_shape_prop(sh) + idx;
     } else {
       js_shape_hash_unlink(ctx->rt, sh);
+      js_shape_free_enum_cache(ctx->rt, sh);
       sh->is_hashed = FALSE;
     }
   }
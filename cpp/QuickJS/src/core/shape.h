@@ -54,6 +54,17 @@ static inline JSShapeProperty* get_shape_prop(JSShape* sh) {
   return sh->prop;
 }
 
+/* An object whose shape is not hashed owns it: its properties are found
+   with the hash table of the shape and are added or deleted in place,
+   without creating new shapes. It is the dictionary mode used for the
+   objects used as maps. An object switches to it on the first property
+   deletion or when it has more than JS_SHAPE_DICT_PROP_COUNT properties.
+   The inline caches ignore these objects. A dictionary object returns to
+   the fast mode when the compaction of its deleted properties leaves at
+   most JS_SHAPE_FAST_PROP_COUNT properties. */
+#define JS_SHAPE_DICT_PROP_COUNT 128
+#define JS_SHAPE_FAST_PROP_COUNT 32
+
 int init_shape_hash(JSRuntime* rt);
 /* same magic hash multiplier as the Linux kernel */
 uint32_t shape_hash(uint32_t h, uint32_t val);
@@ -80,6 +91,11 @@ no_inline int
 resize_properties(JSContext* ctx, JSShape** psh, JSObject* p, uint32_t count);
 /* remove the deleted properties. */
 int compact_properties(JSContext* ctx, JSObject* p);
+/* insert the shape of the dictionary object 'p' in the shape hash table
+   so that it can be shared again. Its properties must be compacted. */
+void js_shape_rehash(JSRuntime* rt, JSObject* p);
+/* must be called before the properties of the shape are modified */
+void js_shape_free_enum_cache(JSRuntime* rt, JSShape* sh);
 int add_shape_property(
     JSContext* ctx,
     JSShape** psh,
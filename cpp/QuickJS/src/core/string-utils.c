@@ -32,6 +32,7 @@
 #include "convertion.h"
 #include "exception.h"
 #include "runtime.h"
+#include "shape.h"
 
 #ifdef ANDROID_PRINT
 #include <android/log.h>
@@ -40,7 +41,7 @@
 #endif
 
 inline int string_get(const JSString* p, int idx) {
-  return p->is_wide_char ? p->u.str16[idx] : p->u.str8[idx];
+  return p->is_wide_char ? js_string_str16(p)[idx] : js_string_str8(p)[idx];
 }
 
 /* Note: the string contents are uninitialized */
@@ -52,6 +53,7 @@ JSString* js_alloc_string_rt(JSRuntime* rt, int max_len, int is_wide_char) {
     return NULL;
   str->header.ref_count = 1;
   str->is_wide_char = is_wide_char;
+  str->is_slice = 0;
   str->len = max_len;
   str->atom_type = 0;
   str->hash = 0; /* optional but costless */
@@ -134,9 +136,9 @@ int JS_InitAtoms(JSRuntime* rt) {
 
 uint32_t hash_string(const JSString* str, uint32_t h) {
   if (str->is_wide_char)
-    h = hash_string16(str->u.str16, str->len, h);
+    h = hash_string16(js_string_str16(str), str->len, h);
   else
-    h = hash_string8(str->u.str8, str->len, h);
+    h = hash_string8(js_string_str8(str), str->len, h);
   return h;
 }
 
@@ -311,15 +313,22 @@ int js_string_memcmp(
   int res;
 
   if (likely(!p1->is_wide_char)) {
-    if (likely(!p2->is_wide_char))
-      res = memcmp(p1->u.str8 + pos1, p2->u.str8 + pos2, len);
-    else
-      res = -memcmp16_8(p2->u.str16 + pos2, p1->u.str8 + pos1, len);
+    const uint8_t* s1 = js_string_str8(p1) + pos1;
+    if (likely(!p2->is_wide_char)) {
+      const uint8_t* s2 = js_string_str8(p2) + pos2;
+      /* e.g. two slices of the same range of a string */
+      res = s1 == s2 ? 0 : memcmp(s1, s2, len);
+    } else {
+      res = -memcmp16_8(js_string_str16(p2) + pos2, s1, len);
+    }
   } else {
-    if (!p2->is_wide_char)
-      res = memcmp16_8(p1->u.str16 + pos1, p2->u.str8 + pos2, len);
-    else
-      res = memcmp16(p1->u.str16 + pos1, p2->u.str16 + pos2, len);
+    const uint16_t* s1 = js_string_str16(p1) + pos1;
+    if (!p2->is_wide_char) {
+      res = memcmp16_8(s1, js_string_str8(p2) + pos2, len);
+    } else {
+      const uint16_t* s2 = js_string_str16(p2) + pos2;
+      res = s1 == s2 ? 0 : memcmp16(s1, s2, len);
+    }
   }
   return res;
 }
@@ -342,9 +351,9 @@ int js_string_compare(JSContext* ctx, const JSString* p1, const JSString* p2) {
 
 void copy_str16(uint16_t* dst, const JSString* p, int offset, int len) {
   if (p->is_wide_char) {
-    memcpy(dst, p->u.str16 + offset, len * 2);
+    memcpy(dst, js_string_str16(p) + offset, len * 2);
   } else {
-    const uint8_t* src1 = p->u.str8 + offset;
+    const uint8_t* src1 = js_string_str8(p) + offset;
     int i;
 
     for (i = 0; i < len; i++)
@@ -366,8 +375,8 @@ JS_ConcatString1(JSContext* ctx, const JSString* p1, const JSString* p2) {
   if (!p)
     return JS_EXCEPTION;
   if (!is_wide_char) {
-    memcpy(p->u.str8, p1->u.str8, p1->len);
-    memcpy(p->u.str8 + p1->len, p2->u.str8, p2->len);
+    memcpy(p->u.str8, js_string_str8(p1), p1->len);
+    memcpy(p->u.str8 + p1->len, js_string_str8(p2), p2->len);
     p->u.str8[len] = '\0';
   } else {
     copy_str16(p->u.str16, p1, 0, p1->len);
@@ -383,26 +392,27 @@ BOOL JS_ConcatStringInPlace(JSContext* ctx, JSString* p1, JSValueConst op2) {
 
     if (p2->len == 0)
       return TRUE;
-    if (p1->header.ref_count != 1)
+    if (p1->header.ref_count != 1 || p1->is_slice)
       return FALSE;
     size1 = js_malloc_usable_size(ctx, p1);
     if (p1->is_wide_char) {
       if (size1 >= sizeof(*p1) + ((p1->len + p2->len) << 1)) {
         if (p2->is_wide_char) {
-          memcpy(p1->u.str16 + p1->len, p2->u.str16, p2->len << 1);
+          memcpy(p1->u.str16 + p1->len, js_string_str16(p2), p2->len << 1);
           p1->len += p2->len;
           return TRUE;
         } else {
+          const uint8_t* src = js_string_str8(p2);
           size_t i;
           for (i = 0; i < p2->len; i++) {
-            p1->u.str16[p1->len++] = p2->u.str8[i];
+            p1->u.str16[p1->len++] = src[i];
           }
           return TRUE;
         }
       }
     } else if (!p2->is_wide_char) {
       if (size1 >= sizeof(*p1) + p1->len + p2->len + 1) {
-        memcpy(p1->u.str8 + p1->len, p2->u.str8, p2->len);
+        memcpy(p1->u.str8 + p1->len, js_string_str8(p2), p2->len);
         p1->len += p2->len;
         p1->u.str8[p1->len] = '\0';
         return TRUE;
@@ -508,7 +518,7 @@ JSAtom __JS_NewAtom(JSRuntime* rt, JSString* str, int atom_type) {
   }
 
   if (str) {
-    if (str->atom_type == 0) {
+    if (str->atom_type == 0 && !str->is_slice) {
       p = str;
       p->atom_type = atom_type;
     } else {
@@ -520,14 +530,17 @@ JSAtom __JS_NewAtom(JSRuntime* rt, JSString* str, int atom_type) {
         goto fail;
       p->header.ref_count = 1;
       p->is_wide_char = str->is_wide_char;
+      p->is_slice = 0;
       p->len = str->len;
 #ifdef DUMP_LEAKS
       list_add_tail(&p->link, &rt->string_list);
 #endif
-      memcpy(
-          p->u.str8,
-          str->u.str8,
-          (str->len << str->is_wide_char) + 1 - str->is_wide_char);
+      if (str->is_wide_char) {
+        memcpy(p->u.str16, js_string_str16(str), str->len << 1);
+      } else {
+        memcpy(p->u.str8, js_string_str8(str), str->len);
+        p->u.str8[str->len] = '\0';
+      }
       js_free_string(rt, str);
     }
   } else {
@@ -536,6 +549,7 @@ JSAtom __JS_NewAtom(JSRuntime* rt, JSString* str, int atom_type) {
       return JS_ATOM_NULL;
     p->header.ref_count = 1;
     p->is_wide_char = 1; /* Hack to represent NULL as a JSString */
+    p->is_slice = 0;
     p->len = 0;
 #ifdef DUMP_LEAKS
     list_add_tail(&p->link, &rt->string_list);
@@ -1832,16 +1846,17 @@ int string_getc(const JSString* p, int* pidx) {
   int idx, c, c1;
   idx = *pidx;
   if (p->is_wide_char) {
-    c = p->u.str16[idx++];
+    const uint16_t* str16 = js_string_str16(p);
+    c = str16[idx++];
     if (is_hi_surrogate(c) && idx < p->len) {
-      c1 = p->u.str16[idx];
+      c1 = str16[idx];
       if (is_lo_surrogate(c1)) {
         c = from_surrogate(c, c1);
         idx++;
       }
     }
   } else {
-    c = p->u.str8[idx++];
+    c = js_string_str8(p)[idx++];
   }
   *pidx = idx;
   return c;
@@ -1904,9 +1919,9 @@ int string_buffer_concat(
   if (to <= from)
     return 0;
   if (p->is_wide_char)
-    return string_buffer_write16(s, p->u.str16 + from, to - from);
+    return string_buffer_write16(s, js_string_str16(p) + from, to - from);
   else
-    return string_buffer_write8(s, p->u.str8 + from, to - from);
+    return string_buffer_write8(s, js_string_str8(p) + from, to - from);
 }
 
 int string_buffer_concat_value(StringBuffer* s, JSValueConst v) {
@@ -2042,31 +2057,294 @@ JSValue js_new_string_char(JSContext* ctx, uint16_t c) {
   }
 }
 
+/* 'len' characters of 'p' from 'start' without copying them */
+static JSValue
+js_new_string_slice(JSContext* ctx, JSString* p, int start, int len) {
+  JSRuntime* rt = ctx->rt;
+  JSStringSlice* s;
+
+  if (p->is_slice) {
+    JSStringSlice* ps = (JSStringSlice*)p;
+    start += ps->start;
+    p = ps->parent;
+  }
+  s = js_malloc(ctx, sizeof(*s));
+  if (!s)
+    return JS_EXCEPTION;
+  s->str.header.ref_count = 1;
+  s->str.is_wide_char = p->is_wide_char;
+  s->str.is_slice = 1;
+  s->str.len = len;
+  s->str.atom_type = 0;
+  s->str.hash = 0;
+  s->str.hash_next = 0;
+#ifdef DUMP_LEAKS
+  list_add_tail(&s->str.link, &rt->string_list);
+#endif
+  s->start = start;
+  s->parent = p;
+  p->header.ref_count++;
+  list_add_tail(&s->link, &rt->string_slice_list);
+  return JS_MKPTR(JS_TAG_STRING, &s->str);
+}
+
+void js_free_string_slice(JSRuntime* rt, JSString* str) {
+  JSStringSlice* s = (JSStringSlice*)str;
+  list_del(&s->link);
+#ifdef DUMP_LEAKS
+  list_del(&str->link);
+#endif
+  js_free_string(rt, s->parent);
+  js_free_rt(rt, s);
+}
+
+/* Replace the parent of 's' by a copy of its characters */
+static void js_flatten_string_slice(JSRuntime* rt, JSStringSlice* s) {
+  JSString* str = &s->str;
+  JSString* p;
+
+  p = js_alloc_string_rt(rt, str->len, str->is_wide_char);
+  if (!p)
+    return;
+  if (str->is_wide_char) {
+    memcpy(p->u.str16, js_string_str16(str), str->len << 1);
+  } else {
+    memcpy(p->u.str8, js_string_str8(str), str->len);
+    p->u.str8[str->len] = '\0';
+  }
+  js_free_string(rt, s->parent);
+  s->parent = p;
+  s->start = 0;
+}
+
+/* A parent only referenced by slices which use less than half of its
+   characters is replaced by copies of the slices. The slice count
+   and the used length of the parents are temporarily stored in their
+   'hash_next' and 'hash' fields, which are unused if not an atom. */
+void js_flatten_string_slices(JSRuntime* rt) {
+  struct list_head* el;
+  JSStringSlice* s;
+  JSString* p;
+
+  list_for_each(el, &rt->string_slice_list) {
+    s = list_entry(el, JSStringSlice, link);
+    p = s->parent;
+    if (!p->atom_type) {
+      p->hash = 0;
+      p->hash_next = 0;
+    }
+  }
+  list_for_each(el, &rt->string_slice_list) {
+    s = list_entry(el, JSStringSlice, link);
+    p = s->parent;
+    if (!p->atom_type) {
+      p->hash_next++;
+      p->hash = min_uint32(p->hash + s->str.len, JS_STRING_LEN_MAX);
+    }
+  }
+  list_for_each(el, &rt->string_slice_list) {
+    s = list_entry(el, JSStringSlice, link);
+    p = s->parent;
+    if (p->atom_type || p->len <= p->hash * 2)
+      continue;
+    if (p->header.ref_count == p->hash_next) {
+      /* the parent is freed with its last slice */
+      p->hash_next--;
+      js_flatten_string_slice(rt, s);
+    } else {
+      p->hash = 0;
+      p->hash_next = 0;
+    }
+  }
+  list_for_each(el, &rt->string_slice_list) {
+    s = list_entry(el, JSStringSlice, link);
+    p = s->parent;
+    if (!p->atom_type) {
+      p->hash = 0;
+      p->hash_next = 0;
+    }
+  }
+}
+
+typedef struct JSStringDedupEntry {
+  uint32_t hash; /* 0 if the entry is free */
+  JSString* str;
+} JSStringDedupEntry;
+
+typedef struct JSStringDedupState {
+  JSRuntime* rt;
+  uint32_t max_len;
+  int size; /* power of two */
+  int count;
+  JSStringDedupEntry* tab;
+  BOOL failed; /* out of memory: the remaining strings are kept */
+} JSStringDedupState;
+
+static BOOL js_dedup_resize(JSStringDedupState* s) {
+  JSStringDedupEntry *new_tab, *e;
+  int i, j, new_size;
+
+  new_size = s->size * 2;
+  new_tab = js_mallocz_rt(s->rt, sizeof(new_tab[0]) * new_size);
+  if (!new_tab)
+    return FALSE;
+  for (i = 0; i < s->size; i++) {
+    e = &s->tab[i];
+    if (!e->hash)
+      continue;
+    j = e->hash & (new_size - 1);
+    while (new_tab[j].hash)
+      j = (j + 1) & (new_size - 1);
+    new_tab[j] = *e;
+  }
+  js_free_rt(s->rt, s->tab);
+  s->tab = new_tab;
+  s->size = new_size;
+  return TRUE;
+}
+
+/* Return the string atom equal to 'str' or NULL. Its reference count is
+   not modified. */
+static JSString* js_dedup_find_atom(JSRuntime* rt, JSString* str, uint32_t h) {
+  JSAtomStruct* p;
+  uint32_t i;
+
+  i = rt->atom_hash[h & (rt->atom_hash_size - 1)];
+  while (i != 0) {
+    p = rt->atom_array[i];
+    if (p->hash == h && p->atom_type == JS_ATOM_TYPE_STRING &&
+        p->len == str->len && js_string_memcmp(p, 0, str, 0, str->len) == 0)
+      return p;
+    i = p->hash_next;
+  }
+  return NULL;
+}
+
+/* Replace the string in '*pval' by the first equal string seen */
+static void js_dedup_value(JSStringDedupState* s, JSValue* pval) {
+  JSRuntime* rt = s->rt;
+  JSStringDedupEntry* e;
+  JSString *str, *p;
+  uint32_t h, key;
+  int i;
+
+  if (JS_VALUE_GET_TAG(*pval) != JS_TAG_STRING)
+    return;
+  str = JS_VALUE_GET_STRING(*pval);
+  if (str->is_slice || str->atom_type || str->len > s->max_len)
+    return;
+  /* same hash as the string atoms. The table key is never 0 as 0 marks
+     the free entries. */
+  h = hash_string(str, JS_ATOM_TYPE_STRING) & JS_ATOM_HASH_MASK;
+  key = h | 1;
+  i = key & (s->size - 1);
+  for (;;) {
+    e = &s->tab[i];
+    if (!e->hash)
+      break;
+    p = e->str;
+    if (e->hash == key && p->len == str->len &&
+        js_string_memcmp(p, 0, str, 0, str->len) == 0)
+      goto found;
+    i = (i + 1) & (s->size - 1);
+  }
+  /* first occurrence: an equal atom is preferred as it is already shared
+     with the property names */
+  p = js_dedup_find_atom(rt, str, h);
+  if (!p)
+    p = str;
+  e->hash = key;
+  e->str = p;
+  if (++s->count * 2 > s->size && !js_dedup_resize(s))
+    s->failed = TRUE;
+found:
+  if (p == str)
+    return;
+  if (str->header.ref_count == 1) {
+    rt->string_dedup_size +=
+        sizeof(*str) + (str->len << str->is_wide_char) + 1 - str->is_wide_char;
+  }
+  rt->string_dedup_count++;
+  p->header.ref_count++;
+  js_free_string(rt, str);
+  *pval = JS_MKPTR(JS_TAG_STRING, p);
+}
+
+/* Merge the identical strings held by the object properties and the fast
+   arrays. Only the strings which survived a GC cycle are considered:
+   they are the ones which are likely to stay alive. */
+void js_dedup_strings(JSRuntime* rt) {
+  JSStringDedupState s_s, *s = &s_s;
+  struct list_head* el;
+  JSGCObjectHeader* gp;
+  JSObject* p;
+  JSShape* sh;
+  JSShapeProperty* prs;
+  uint32_t i;
+
+  s->rt = rt;
+  s->max_len = rt->string_dedup_max_len;
+  s->size = 256;
+  s->count = 0;
+  s->failed = FALSE;
+  s->tab = js_mallocz_rt(rt, sizeof(s->tab[0]) * s->size);
+  if (!s->tab)
+    return;
+  list_for_each(el, &rt->gc_obj_list) {
+    gp = list_entry(el, JSGCObjectHeader, link);
+    if (gp->gc_obj_type != JS_GC_OBJ_TYPE_JS_OBJECT)
+      continue;
+    p = (JSObject*)gp;
+    sh = p->shape;
+    prs = get_shape_prop(sh);
+    for (i = 0; i < sh->prop_count && !s->failed; i++, prs++) {
+      if (prs->atom != JS_ATOM_NULL &&
+          (prs->flags & JS_PROP_TMASK) == JS_PROP_NORMAL)
+        js_dedup_value(s, &p->prop[i].u.value);
+    }
+    if (p->fast_array &&
+        (p->class_id == JS_CLASS_ARRAY || p->class_id == JS_CLASS_ARGUMENTS)) {
+      for (i = 0; i < p->u.array.count && !s->failed; i++)
+        js_dedup_value(s, &p->u.array.u.values[i]);
+    }
+    if (s->failed)
+      break;
+  }
+  js_free_rt(rt, s->tab);
+}
+
 JSValue js_sub_string(JSContext* ctx, JSString* p, int start, int end) {
   int len = end - start;
   if (start == 0 && end == p->len) {
     return JS_DupValue(ctx, JS_MKPTR(JS_TAG_STRING, p));
   }
   if (p->is_wide_char && len > 0) {
+    const uint16_t* src = js_string_str16(p) + start;
     JSString* str;
     int i;
     uint16_t c = 0;
-    for (i = start; i < end; i++) {
-      c |= p->u.str16[i];
+    for (i = 0; i < len; i++) {
+      c |= src[i];
+    }
+    if (c > 0xFF) {
+      if (len >= JS_STRING_SLICE_MIN_LEN)
+        return js_new_string_slice(ctx, p, start, len);
+      return js_new_string16_len(ctx, src, len);
     }
-    if (c > 0xFF)
-      return js_new_string16_len(ctx, p->u.str16 + start, len);
 
     str = js_alloc_string(ctx, len, 0);
     if (!str)
       return JS_EXCEPTION;
     for (i = 0; i < len; i++) {
-      str->u.str8[i] = p->u.str16[start + i];
+      str->u.str8[i] = src[i];
     }
     str->u.str8[len] = '\0';
     return JS_MKPTR(JS_TAG_STRING, str);
+  } else if (len >= JS_STRING_SLICE_MIN_LEN) {
+    return js_new_string_slice(ctx, p, start, len);
   } else {
-    return js_new_string8_len(ctx, (const char*)(p->u.str8 + start), len);
+    return js_new_string8_len(
+        ctx, (const char*)(js_string_str8(p) + start), len);
   }
 }
 
@@ -2195,7 +2473,7 @@ JS_ToCStringLen2(JSContext* ctx, size_t* plen, JSValueConst val1, BOOL cesu8) {
   str = JS_VALUE_GET_STRING(val);
   len = str->len;
   if (!str->is_wide_char) {
-    const uint8_t* src = str->u.str8;
+    const uint8_t* src = js_string_str8(str);
     int count;
 
     /* count the number of non-ASCII characters */
@@ -2208,7 +2486,7 @@ JS_ToCStringLen2(JSContext* ctx, size_t* plen, JSValueConst val1, BOOL cesu8) {
     for (pos = 0; pos < len; pos++) {
       count += src[pos] >> 7;
     }
-    if (count == 0) {
+    if (count == 0 && !str->is_slice) {
       if (plen)
         *plen = len;
       return (const char*)src;
@@ -2227,7 +2505,7 @@ JS_ToCStringLen2(JSContext* ctx, size_t* plen, JSValueConst val1, BOOL cesu8) {
       }
     }
   } else {
-    const uint16_t* src = str->u.str16;
+    const uint16_t* src = js_string_str16(str);
     /* Allocate 3 bytes per 16 bit code point. Surrogate pairs may
        produce 4 bytes but use 2 code points.
      */
@@ -124,11 +124,38 @@ uint32_t hash_string_rope(JSValueConst val, uint32_t h);
 __maybe_unused void JS_DumpChar(FILE* fo, int c, int sep);
 __maybe_unused void JS_DumpString(JSRuntime* rt, const JSString* p);
 
+/* Return the characters of 'p'. They are not zero terminated if 'p'
+   is a slice. */
+static inline const uint8_t* js_string_str8(const JSString* p) {
+  if (unlikely(p->is_slice)) {
+    const JSStringSlice* s = (const JSStringSlice*)p;
+    return s->parent->u.str8 + s->start;
+  }
+  return p->u.str8;
+}
+
+static inline const uint16_t* js_string_str16(const JSString* p) {
+  if (unlikely(p->is_slice)) {
+    const JSStringSlice* s = (const JSStringSlice*)p;
+    return s->parent->u.str16 + s->start;
+  }
+  return p->u.str16;
+}
+
+void js_free_string_slice(JSRuntime* rt, JSString* str);
+/* flatten the slices which keep alive a much larger parent string */
+void js_flatten_string_slices(JSRuntime* rt);
+/* merge the identical short strings held by objects (see
+   JS_SetStringDedup()) */
+void js_dedup_strings(JSRuntime* rt);
+
 /* same as JS_FreeValueRT() but faster */
 static inline void js_free_string(JSRuntime* rt, JSString* str) {
   if (--str->header.ref_count <= 0) {
     if (str->atom_type) {
       JS_FreeAtomStruct(rt, str);
+    } else if (str->is_slice) {
+      js_free_string_slice(rt, str);
     } else {
 #ifdef DUMP_LEAKS
       list_del(&str->link);
@@ -173,9 +200,9 @@ static inline BOOL is_num_string(uint32_t* pval, const JSString* p) {
   if (len == 0 || len > 10)
     return FALSE;
   if (p->is_wide_char)
-    c = p->u.str16[0];
+    c = js_string_str16(p)[0];
   else
-    c = p->u.str8[0];
+    c = js_string_str8(p)[0];
   if (is_num(c)) {
     if (c == '0') {
       if (len != 1)
@@ -185,9 +212,9 @@ static inline BOOL is_num_string(uint32_t* pval, const JSString* p) {
       n = c - '0';
       for (i = 1; i < len; i++) {
         if (p->is_wide_char)
-          c = p->u.str16[i];
+          c = js_string_str16(p)[i];
         else
-          c = p->u.str8[i];
+          c = js_string_str8(p)[i];
         if (!is_num(c))
           return FALSE;
         n64 = (uint64_t)n * 10 + (c - '0');
@@ -136,6 +136,16 @@ static const uint8_t typed_array_size_log2[JS_TYPED_ARRAY_COUNT] = {
 #define JS_STRING_ROPE_SHORT2_LEN 8192
 /* rope depth at which we rebalance */
 #define JS_STRING_ROPE_MAX_DEPTH 60
+/* substrings >= this length share the characters of their parent
+   string (see JSStringSlice) */
+#define JS_STRING_SLICE_MIN_LEN 32
+
+/* generator and async function frames of up to
+   (JS_ASYNC_FRAME_POOL_MIN << (JS_ASYNC_FRAME_POOL_BUCKETS - 1)) values are
+   recycled, at most JS_ASYNC_FRAME_POOL_MAX per size */
+#define JS_ASYNC_FRAME_POOL_MIN 8
+#define JS_ASYNC_FRAME_POOL_BUCKETS 6
+#define JS_ASYNC_FRAME_POOL_MAX 64
 
 #define __exception __attribute__((warn_unused_result))
 
@@ -180,6 +190,53 @@ typedef struct JSDebuggerFunctionInfo {
   int last_line_num;
 } JSDebuggerFunctionInfo;
 
+#ifdef ENABLE_EXEC_STATS
+/* see exec-stats.h */
+typedef struct JSExecStats {
+  BOOL enabled;
+  /* time in ns spent in the bytecode functions called by the current
+     JS_CallInternal() frame */
+  int64_t callee_time;
+  uint64_t op_count[256];
+} JSExecStats;
+
+typedef struct JSFunctionExecStats {
+  uint64_t call_count;
+  uint64_t back_edge_count;
+  int64_t self_time; /* in ns */
+} JSFunctionExecStats;
+#endif
+
+#define JS_TZ_PERIOD_BITS 25 /* about 388 days */
+#define JS_TZ_CACHE_SIZE 16 /* must be a power of two */
+#define JS_TZ_MAX_TRANSITIONS 4
+
+typedef enum {
+  JS_TZ_PERIOD_EMPTY,
+  JS_TZ_PERIOD_SEEN, /* used once: the offsets are computed directly */
+  JS_TZ_PERIOD_READY,
+  JS_TZ_PERIOD_UNCACHEABLE, /* too many transitions */
+} JSTimezonePeriodStateEnum;
+
+/* timezone offsets (in minutes) of the seconds of a period of
+   2^JS_TZ_PERIOD_BITS seconds */
+typedef struct JSTimezonePeriod {
+  int64_t period; /* time >> JS_TZ_PERIOD_BITS */
+  uint8_t state; /* JSTimezonePeriodStateEnum */
+  uint8_t transition_count;
+  int16_t offset; /* offset at the start of the period */
+  int16_t transition_offset[JS_TZ_MAX_TRANSITIONS];
+  /* first second with transition_offset[i] */
+  int64_t transition_time[JS_TZ_MAX_TRANSITIONS];
+} JSTimezonePeriod;
+
+/* cache of the local time offsets returned by localtime_r() */
+typedef struct JSTimezoneCache {
+  BOOL tz_valid; /* 'tz' is the value of TZ for the cached periods */
+  char* tz; /* NULL if TZ is not set */
+  JSTimezonePeriod periods[JS_TZ_CACHE_SIZE];
+} JSTimezoneCache;
+
 struct JSRuntime {
   JSMallocFunctions mf;
   JSMallocState malloc_state;
@@ -210,6 +267,11 @@ struct JSRuntime {
 #ifdef DUMP_LEAKS
   struct list_head string_list; /* list of JSString.link */
 #endif
+  struct list_head string_slice_list; /* list of JSStringSlice.link */
+  /* see JS_SetStringDedup(), 0 if disabled */
+  uint32_t string_dedup_max_len;
+  int64_t string_dedup_count; /* number of merged strings */
+  int64_t string_dedup_size; /* bytes freed by the merges */
   /* stack limitation */
   uintptr_t stack_size; /* in bytes, 0 if no limit */
   uintptr_t stack_top;
@@ -225,6 +287,10 @@ struct JSRuntime {
 
   JSInterruptHandler* interrupt_handler;
   void* interrupt_opaque;
+  /* monotonic time in ns at which the running code is interrupted, 0 if
+     none (see taro_js_run_with_budget()) */
+  int64_t budget_deadline;
+  BOOL budget_expired : 8; /* TRUE once the deadline is reached */
 
   JSHostPromiseRejectionTracker* host_promise_rejection_tracker;
   void* host_promise_rejection_tracker_opaque;
@@ -247,12 +313,40 @@ struct JSRuntime {
   JSSharedArrayBufferFunctions sab_funcs;
   /* see JS_SetStripInfo() */
   uint8_t strip_flags;
+  /* see JS_SetCompileStats() */
+  JSCompileStats* compile_stats;
+  /* see JSMallocSampler, NULL if none */
+  struct JSMallocSampler* malloc_sampler;
+  /* freed generator and async function states and frames kept for
+     reuse (see async_func_init()), linked through their first word */
+  void* async_state_pool;
+  int async_state_pool_count;
+  void* async_frame_pool[JS_ASYNC_FRAME_POOL_BUCKETS];
+  int async_frame_pool_count[JS_ASYNC_FRAME_POOL_BUCKETS];
+#ifdef ENABLE_OPCODE_PROFILE
+  /* see js_opcode_profile_init(), NULL if disabled */
+  struct JSOpcodeProfile* opcode_profile;
+#endif
+#ifdef ENABLE_JIT
+  /* see JS_SetJITThreshold(), 0 if disabled */
+  uint32_t jit_threshold;
+#endif
+#ifdef ENABLE_EXEC_STATS
+  /* see exec-stats.h */
+  JSExecStats exec_stats;
+#endif
 
   /* Shape hash table */
   int shape_hash_bits;
   int shape_hash_size;
   int shape_hash_count; /* number of hashed shapes */
   JSShape** shape_hash;
+  /* Code template hash table (see JSCodeTemplate) */
+  int code_template_hash_bits;
+  int code_template_hash_size;
+  int code_template_count;
+  struct JSCodeTemplate** code_template_hash;
+  JSTimezoneCache timezone_cache; /* see getTimezoneOffset() */
   void* user_opaque;
   JSRuntimeState state; /** @todo diff */
 #if QUICKJS_DEBUG
@@ -286,6 +380,7 @@ typedef enum {
   JS_AUTOINIT_ID_PROTOTYPE,
   JS_AUTOINIT_ID_MODULE_NS,
   JS_AUTOINIT_ID_PROP,
+  JS_AUTOINIT_ID_BACKTRACE,
 } JSAutoInitIDEnum;
 
 typedef enum JSStrictEqModeEnum {
@@ -322,7 +417,8 @@ typedef enum {
 
 struct JSString {
   JSRefCountHeader header; /* must come first, 32-bit */
-  uint32_t len : 31;
+  uint32_t len : 30;
+  uint8_t is_slice : 1; /* characters stored in JSStringSlice.parent */
   uint8_t is_wide_char : 1; /* 0 = 8 bits, 1 = 16 bits characters */
   /* for JS_ATOM_TYPE_SYMBOL: hash = weakref_count, atom_type = 3,
       for JS_ATOM_TYPE_PRIVATE: hash = JS_ATOM_HASH_PRIVATE, atom_type = 3
@@ -339,6 +435,16 @@ struct JSString {
   } u;
 };
 
+/* A string whose characters are the range [start, start + len) of
+   'parent'. Slices are never atoms, the parent is never a slice and
+   the characters are not zero terminated. */
+typedef struct JSStringSlice {
+  JSString str; /* must come first, no inline characters */
+  uint32_t start;
+  JSString* parent;
+  struct list_head link; /* rt->string_slice_list */
+} JSStringSlice;
+
 typedef struct JSStringRope {
     JSRefCountHeader header; /* must come first, 32-bit */
     uint32_t len;
@@ -356,7 +462,11 @@ typedef struct JSClosureVar {
   uint8_t is_const : 1;
   uint8_t is_lexical : 1;
   uint8_t var_kind : 4; /* see JSVarKindEnum */
-  /* 8 bits available */
+  /* is_local = TRUE and the variable cannot change once initialized
+     before the closure is created: its value can be captured instead of
+     a reference to the stack frame */
+  uint8_t is_immutable : 1;
+  /* 7 bits available */
   uint16_t var_idx; /* is_local = TRUE: index to a normal variable of the
                   parent function. otherwise: index to a closure
                   variable of the parent function */
@@ -458,6 +568,10 @@ typedef struct InlineCacheRingSlot {
   JSAtom atom;
   InlineCacheRingItem buffer[IC_CACHE_ITEM_CAPACITY];
   uint8_t index;
+#ifdef ENABLE_EXEC_STATS
+  uint64_t hit_count;
+  uint64_t miss_count;
+#endif
 } InlineCacheRingSlot;
 
 typedef struct InlineCacheHashSlot {
@@ -477,6 +591,31 @@ typedef struct InlineCache {
   BOOL updated;
 } InlineCache;
 
+/* Immutable code of a bytecode function, shared by all the functions of
+   the runtime compiled or read from the same code (e.g. a bundle
+   evaluated in several contexts). The functions keep their realm, inline
+   cache, constant pool and closure variables.
+
+   The interpreter patches the field opcodes of 'byte_code_buf' to their
+   inline cache variant: a template is only shared by functions whose
+   inline caches have the same atoms at the same indexes, so that the
+   patched opcodes are valid for all of them. */
+typedef struct JSCodeTemplate {
+  int ref_count;
+  uint32_t hash; /* computed on the unpatched code */
+  struct JSCodeTemplate* hash_next; /* in rt->code_template_hash */
+  int byte_code_len;
+  int pc2line_len;
+  int pc2column_len;
+  int source_len;
+  uint32_t ic_count;
+  JSAtom* ic_atoms; /* inline cache atoms by index */
+  uint8_t* byte_code_buf;
+  uint8_t* pc2line_buf;
+  uint8_t* pc2column_buf;
+  char* source;
+} JSCodeTemplate;
+
 typedef struct JSFunctionBytecode {
   JSGCObjectHeader header; /* must come first */
   uint8_t js_mode;
@@ -494,7 +633,12 @@ typedef struct JSFunctionBytecode {
   uint8_t read_only_bytecode : 1;
   uint8_t
       is_direct_or_indirect_eval : 1; /* used by JS_GetScriptOrModuleName() */
+#ifdef ENABLE_JIT
+  uint8_t jit_disabled : 1; /* the native code could not be generated */
+  /* XXX: 9 bits available */
+#else
   /* XXX: 10 bits available */
+#endif
   uint8_t* byte_code_buf; /* (self pointer) */
   int byte_code_len;
   JSAtom func_name;
@@ -511,6 +655,17 @@ typedef struct JSFunctionBytecode {
   int cpool_count;
   int closure_var_count;
   InlineCache* ic;
+  /* owns 'byte_code_buf' and the debug buffers, NULL if
+     read_only_bytecode */
+  JSCodeTemplate* code_template;
+#ifdef ENABLE_JIT
+  /* function calls and loop iterations before compiling (see jit.h) */
+  uint32_t jit_counter;
+  struct JSJitCode* jit_code; /* NULL if not compiled */
+#endif
+#ifdef ENABLE_EXEC_STATS
+  JSFunctionExecStats exec_stats;
+#endif
   struct {
     /* debug info, move to separate structure to save memory? */
     JSAtom filename;
@@ -539,6 +694,15 @@ typedef enum JSIteratorKindEnum {
   JS_ITERATOR_KIND_KEY_AND_VALUE,
 } JSIteratorKindEnum;
 
+/* own string keys of a hashed shape in the enumeration order: the
+   array index keys sorted, then the other keys in creation order. The
+   atoms belong to the shape. */
+typedef struct JSShapeEnumCache {
+  uint32_t count;
+  uint32_t enum_count; /* number of enumerable keys */
+  JSPropertyEnum tab[0];
+} JSShapeEnumCache;
+
 typedef struct JSForInIterator {
   JSValue obj;
   uint32_t idx;
@@ -546,6 +710,9 @@ typedef struct JSForInIterator {
   uint8_t in_prototype_chain;
   uint8_t is_array;
   JSPropertyEnum* tab_atom; /* is_array = FALSE */
+  /* if not NULL, tab_atom is the enumeration cache of this shape of
+     'obj' */
+  JSShape* enum_shape;
 } JSForInIterator;
 
 typedef struct JSRegExp {
@@ -577,6 +744,10 @@ typedef struct JSStackFrame {
   JSValue* arg_buf; /* arguments */
   JSValue* var_buf; /* variables */
   struct list_head var_ref_list; /* list of JSVarRef.link */
+  /* detached references to the immutable variables captured by the
+     closures of the frame, indexed by variable (see js_closure2()) */
+  struct JSVarRef** const_var_refs;
+  int const_var_ref_count;
   uint8_t* cur_pc; /* only used in bytecode functions : PC of the
                       instruction after the call */
   int arg_count;
@@ -608,6 +779,8 @@ typedef struct JSAsyncFunctionState {
   JSGCObjectHeader header;
   JSValue this_val; /* 'this' argument */
   int argc; /* number of function arguments */
+  int frame_bucket; /* JSRuntime.async_frame_pool bucket of
+                       frame.arg_buf, -1 if not pooled */
   JS_BOOL throw_flag; /* used to throw an exception in JS_CallInternal() */
   JS_BOOL is_completed; /* TRUE if the function has returned. The stack
                         frame is no longer valid */
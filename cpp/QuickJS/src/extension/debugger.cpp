@@ -1931,7 +1931,7 @@ static JSValue js_debugger_eval(
   var_refs = p->u.func.var_refs;
   js_mode = b->js_mode;
 
-  fd = js_new_function_def(ctx, NULL, TRUE, FALSE, filename, s->token.ptr, &s->get_line_col_cache);
+  fd = js_new_function_def(ctx, &s->arena, NULL, TRUE, FALSE, filename, s->token.ptr, &s->get_line_col_cache);
   if (!fd)
     goto fail1;
   s->cur_func = fd;
@@ -1972,6 +1972,7 @@ static JSValue js_debugger_eval(
   fun_obj = js_create_function(ctx, fd);
   if (taro_is_exception(fun_obj))
     goto fail1;
+  js_arena_free_all(&s->arena);
   if (flags & JS_EVAL_FLAG_COMPILE_ONLY) {
     ret_val = fun_obj;
   } else {
@@ -1979,6 +1980,7 @@ static JSValue js_debugger_eval(
   }
   return ret_val;
 fail1:
+  js_arena_free_all(&s->arena);
   return JS_EXCEPTION;
 }
 
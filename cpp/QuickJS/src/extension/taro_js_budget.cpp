@@ -0,0 +1,53 @@
+#include "QuickJS/extension/taro_js_budget.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "../core/runtime.h"
+
+JSValue taro_js_run_with_budget(
+    JSContext* ctx,
+    JSValueConst fn,
+    int64_t budget_ns,
+    JSValueConst this_obj,
+    int argc,
+    JSValueConst* argv) {
+  JSRuntime* rt = ctx->rt;
+  int64_t saved_deadline = rt->budget_deadline;
+  BOOL saved_expired = rt->budget_expired;
+  int64_t start = js_get_monotonic_time();
+  /* a huge budget means no deadline: avoid the overflow */
+  budget_ns = std::clamp<int64_t>(budget_ns, 1, INT64_MAX - start);
+  int64_t deadline = start + budget_ns;
+
+  if (saved_deadline)
+    deadline = std::min(deadline, saved_deadline);
+  rt->budget_deadline = deadline;
+  rt->budget_expired = FALSE;
+
+  JSValue ret = JS_Call(ctx, fn, this_obj, argc, argv);
+
+  BOOL expired = rt->budget_expired;
+  rt->budget_deadline = saved_deadline;
+  rt->budget_expired = saved_expired || (expired && saved_deadline == deadline);
+
+  JSBudgetStats* s = &ctx->budget_stats;
+  s->call_count++;
+  s->time += js_get_monotonic_time() - start;
+  if (expired && JS_IsException(ret))
+    s->expired_count++;
+  return ret;
+}
+
+JSValue
+taro_js_run_with_budget(JSContext* ctx, JSValueConst fn, int64_t budget_ns) {
+  return taro_js_run_with_budget(ctx, fn, budget_ns, JS_UNDEFINED, 0, nullptr);
+}
+
+JSBudgetStats taro_js_get_budget_stats(JSContext* ctx) {
+  return ctx->budget_stats;
+}
+
+void taro_js_reset_budget_stats(JSContext* ctx) {
+  ctx->budget_stats = JSBudgetStats{};
+}
@@ -2,6 +2,7 @@
 
 #include "QuickJS/quickjs.h"
 
+#include "../core/common.h"
 #include "../core/exception.h"
 #include "../core/runtime.h"
 #include "../core/types.h"
@@ -25,6 +26,10 @@ int taro_js_new_class(
   return JS_NewClass(rt, class_id, class_def);
 }
 
+bool taro_js_is_registered_class(JSRuntime* rt, JSClassID class_id) {
+  return JS_IsRegisteredClass(rt, class_id);
+}
+
 JSValue taro_js_new_object_class_proto(
     JSContext* ctx,
     JSClassID class_id,
@@ -0,0 +1,207 @@
+#include "QuickJS/extension/taro_js_compile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "QuickJS/extension/taro_js_module.h"
+#include "QuickJS/extension/taro_js_type.h"
+#include "QuickJS/quickjs.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define TARO_JS_COMPILE_THREADS 0
+#else
+#define TARO_JS_COMPILE_THREADS 1
+#endif
+
+static int taro_js_compile_stub_init(JSContext* ctx, JSModuleDef* m) {
+  return 0;
+}
+
+/* compilation only needs the import graph to be resolvable: every import
+   becomes an empty C module */
+static JSModuleDef* taro_js_compile_stub_loader(
+    JSContext* ctx,
+    const char* module_name,
+    void* opaque) {
+  return taro_js_new_c_module(ctx, module_name, taro_js_compile_stub_init);
+}
+
+static JSContext* taro_js_compile_new_context() {
+  JSRuntime* rt = JS_NewRuntime();
+  if (!rt)
+    return NULL;
+  JSContext* ctx = JS_NewContextRaw(rt);
+  if (!ctx) {
+    JS_FreeRuntime(rt);
+    return NULL;
+  }
+  JS_AddIntrinsicBaseObjects(ctx);
+  JS_AddIntrinsicEval(ctx);
+  JS_AddIntrinsicRegExpCompiler(ctx);
+  JS_SetModuleLoaderFunc(rt, NULL, taro_js_compile_stub_loader, NULL);
+  return ctx;
+}
+
+static void taro_js_compile_free_context(JSContext* ctx) {
+  JSRuntime* rt = JS_GetRuntime(ctx);
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+}
+
+static std::string taro_js_compile_exception(JSContext* ctx) {
+  JSValue exception = JS_GetException(ctx);
+  JSValue stack = JS_GetPropertyStr(ctx, exception, "stack");
+  std::string error;
+
+  const char* str = JS_ToCString(ctx, exception);
+  if (str) {
+    error = str;
+    JS_FreeCString(ctx, str);
+  }
+  if (!taro_is_undefined(stack)) {
+    str = JS_ToCString(ctx, stack);
+    if (str) {
+      error += "\n";
+      error += str;
+      JS_FreeCString(ctx, str);
+    }
+  }
+
+  JS_FreeValue(ctx, stack);
+  JS_FreeValue(ctx, exception);
+  return error;
+}
+
+static void taro_js_compile_one(
+    JSContext* ctx,
+    const TaroJSCompileSource& input,
+    int eval_flags,
+    TaroJSCompileResult& result) {
+  JSValue obj = JS_Eval(
+      ctx,
+      input.source.c_str(),
+      input.source.length(),
+      input.filename.c_str(),
+      eval_flags | JS_EVAL_FLAG_COMPILE_ONLY);
+  if (taro_is_exception(obj)) {
+    result.error = taro_js_compile_exception(ctx);
+    return;
+  }
+
+  size_t len;
+  uint8_t* buf = JS_WriteObject(ctx, &len, obj, JS_WRITE_OBJ_BYTECODE);
+  JS_FreeValue(ctx, obj);
+  if (!buf) {
+    result.error = taro_js_compile_exception(ctx);
+    return;
+  }
+  result.bytecode.assign(buf, buf + len);
+  js_free(ctx, buf);
+}
+
+static void taro_js_compile_worker(
+    const std::vector<TaroJSCompileSource>* sources,
+    std::vector<TaroJSCompileResult>* results,
+    std::atomic<size_t>* next,
+    int eval_flags) {
+  JSContext* ctx = taro_js_compile_new_context();
+  size_t i;
+
+  while ((i = next->fetch_add(1)) < sources->size()) {
+    if (!ctx) {
+      (*results)[i].error = "out of memory";
+      continue;
+    }
+    taro_js_compile_one(ctx, (*sources)[i], eval_flags, (*results)[i]);
+  }
+
+  if (ctx)
+    taro_js_compile_free_context(ctx);
+}
+
+/* re-read every compiled module in one runtime and write them back as one
+   array so that the atom table is shared by the whole bundle */
+static int taro_js_compile_merge(
+    const std::vector<TaroJSCompileResult>& results,
+    std::vector<uint8_t>& bundle) {
+  JSContext* ctx = taro_js_compile_new_context();
+  if (!ctx)
+    return -1;
+
+  int ret = -1;
+  uint32_t idx = 0;
+  size_t len;
+  uint8_t* buf;
+  JSValue arr = JS_NewArray(ctx);
+  if (taro_is_exception(arr))
+    goto done;
+
+  for (const auto& result : results) {
+    if (result.bytecode.empty())
+      continue;
+    JSValue obj = JS_ReadObject(
+        ctx,
+        result.bytecode.data(),
+        result.bytecode.size(),
+        JS_READ_OBJ_BYTECODE);
+    if (taro_is_exception(obj))
+      goto done;
+    if (JS_SetPropertyUint32(ctx, arr, idx++, obj) < 0)
+      goto done;
+  }
+
+  buf = JS_WriteObject(ctx, &len, arr, JS_WRITE_OBJ_BYTECODE);
+  if (!buf)
+    goto done;
+  bundle.assign(buf, buf + len);
+  js_free(ctx, buf);
+  ret = 0;
+
+done:
+  JS_FreeValue(ctx, arr);
+  taro_js_compile_free_context(ctx);
+  return ret;
+}
+
+int taro_js_compile_batch(
+    const std::vector<TaroJSCompileSource>& sources,
+    std::vector<TaroJSCompileResult>& results,
+    std::vector<uint8_t>* bundle,
+    int eval_flags,
+    int thread_count) {
+  std::atomic<size_t> next(0);
+
+  results.clear();
+  results.resize(sources.size());
+
+  if (thread_count <= 0)
+    thread_count = (int)std::thread::hardware_concurrency();
+  thread_count = std::max(
+      1, std::min(thread_count, (int)std::max<size_t>(sources.size(), 1)));
+
+#if TARO_JS_COMPILE_THREADS
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count - 1);
+  for (int i = 1; i < thread_count; i++) {
+    workers.emplace_back(
+        taro_js_compile_worker, &sources, &results, &next, eval_flags);
+  }
+  /* the calling thread takes its share of the work too */
+  taro_js_compile_worker(&sources, &results, &next, eval_flags);
+  for (auto& worker : workers)
+    worker.join();
+#else
+  taro_js_compile_worker(&sources, &results, &next, eval_flags);
+#endif
+
+  int failed = 0;
+  for (const auto& result : results) {
+    if (!result.error.empty())
+      failed++;
+  }
+
+  if (bundle && taro_js_compile_merge(results, *bundle) < 0)
+    return -1;
+  return failed;
+}
@@ -0,0 +1,209 @@
+#include "QuickJS/extension/taro_js_exec_stats.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../core/gc.h"
+#include "../core/runtime.h"
+#include "../core/string-utils.h"
+
+#ifdef ENABLE_EXEC_STATS
+
+namespace {
+
+/* names of the opcodes of the final bytecode */
+const char* const exec_stats_opcode_names[256] = {
+#define FMT(f)
+#define DEF(id, size, n_pop, n_push, f) #id,
+#define def(id, size, n_pop, n_push, f)
+#include "QuickJS/quickjs-opcode.h"
+#undef def
+#undef DEF
+#undef FMT
+};
+
+void exec_stats_put_string(std::string& out, const char* str) {
+  out += '"';
+  for (const char* p = str; *p; p++) {
+    unsigned char c = *p;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+void exec_stats_put_uint(std::string& out, uint64_t v) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%" PRIu64, v);
+  out += buf;
+}
+
+template <typename F>
+void exec_stats_for_each_bytecode(JSRuntime* rt, F f) {
+  struct list_head* el;
+  list_for_each(el, &rt->gc_obj_list) {
+    JSGCObjectHeader* h = list_entry(el, JSGCObjectHeader, link);
+    if (h->gc_obj_type == JS_GC_OBJ_TYPE_FUNCTION_BYTECODE)
+      f((JSFunctionBytecode*)h);
+  }
+}
+
+void exec_stats_put_function(
+    JSRuntime* rt,
+    std::string& out,
+    JSFunctionBytecode* b) {
+  char buf[ATOM_GET_STR_BUF_SIZE];
+  int line = 0, col = 0;
+
+  out += "{\"name\":";
+  if (b->func_name == JS_ATOM_NULL)
+    exec_stats_put_string(out, "<anonymous>");
+  else
+    exec_stats_put_string(
+        out, JS_AtomGetStrRT(rt, buf, sizeof(buf), b->func_name));
+  out += ",\"file\":";
+  if (b->has_debug) {
+    exec_stats_put_string(
+        out, JS_AtomGetStrRT(rt, buf, sizeof(buf), b->debug.filename));
+    line = find_line_num(b->realm, b, -1, &col);
+  } else {
+    exec_stats_put_string(out, "");
+  }
+  out += ",\"line\":";
+  exec_stats_put_uint(out, line);
+  out += ",\"column\":";
+  exec_stats_put_uint(out, col);
+  out += ",\"calls\":";
+  exec_stats_put_uint(out, b->exec_stats.call_count);
+  out += ",\"back_edges\":";
+  exec_stats_put_uint(out, b->exec_stats.back_edge_count);
+  out += ",\"self_time_ns\":";
+  exec_stats_put_uint(out, std::max<int64_t>(b->exec_stats.self_time, 0));
+  out += ",\"ic\":[";
+  bool first = true;
+  if (b->ic) {
+    for (uint32_t i = 0; i < b->ic->count; i++) {
+      InlineCacheRingSlot* cr = &b->ic->cache[i];
+      if (!cr->hit_count && !cr->miss_count)
+        continue;
+      if (!first)
+        out += ',';
+      first = false;
+      out += "{\"property\":";
+      exec_stats_put_string(
+          out, JS_AtomGetStrRT(rt, buf, sizeof(buf), cr->atom));
+      out += ",\"hits\":";
+      exec_stats_put_uint(out, cr->hit_count);
+      out += ",\"misses\":";
+      exec_stats_put_uint(out, cr->miss_count);
+      out += '}';
+    }
+  }
+  out += "]}";
+}
+
+} // namespace
+
+int taro_js_exec_stats_start(JSRuntime* rt) {
+  exec_stats_for_each_bytecode(rt, [](JSFunctionBytecode* b) {
+    b->exec_stats = JSFunctionExecStats{};
+    if (b->ic) {
+      for (uint32_t i = 0; i < b->ic->count; i++) {
+        b->ic->cache[i].hit_count = 0;
+        b->ic->cache[i].miss_count = 0;
+      }
+    }
+  });
+  rt->exec_stats = JSExecStats{};
+  rt->exec_stats.enabled = TRUE;
+  return 0;
+}
+
+void taro_js_exec_stats_stop(JSRuntime* rt) {
+  rt->exec_stats.enabled = FALSE;
+}
+
+bool taro_js_exec_stats_is_running(JSRuntime* rt) {
+  return rt->exec_stats.enabled;
+}
+
+int taro_js_exec_stats_write(JSRuntime* rt, std::string& out) {
+  std::vector<JSFunctionBytecode*> functions;
+
+  exec_stats_for_each_bytecode(rt, [&](JSFunctionBytecode* b) {
+    const JSFunctionExecStats* s = &b->exec_stats;
+    if (s->call_count || s->back_edge_count || s->self_time > 0)
+      functions.push_back(b);
+  });
+  std::stable_sort(
+      functions.begin(),
+      functions.end(),
+      [](JSFunctionBytecode* a, JSFunctionBytecode* b) {
+        return a->exec_stats.self_time > b->exec_stats.self_time;
+      });
+
+  out += "{\"functions\":[";
+  for (size_t i = 0; i < functions.size(); i++) {
+    if (i)
+      out += ',';
+    exec_stats_put_function(rt, out, functions[i]);
+  }
+  out += "],\"opcodes\":{";
+  bool first = true;
+  for (int op = 0; op < 256; op++) {
+    uint64_t n = rt->exec_stats.op_count[op];
+    if (!n)
+      continue;
+    if (!first)
+      out += ',';
+    first = false;
+    exec_stats_put_string(
+        out, exec_stats_opcode_names[op] ? exec_stats_opcode_names[op] : "?");
+    out += ':';
+    exec_stats_put_uint(out, n);
+  }
+  out += "}}";
+  return 0;
+}
+
+#else
+
+int taro_js_exec_stats_start(JSRuntime* rt) {
+  return -1;
+}
+
+void taro_js_exec_stats_stop(JSRuntime* rt) {}
+
+bool taro_js_exec_stats_is_running(JSRuntime* rt) {
+  return false;
+}
+
+int taro_js_exec_stats_write(JSRuntime* rt, std::string& out) {
+  return -1;
+}
+
+#endif /* ENABLE_EXEC_STATS */
+
+int taro_js_exec_stats_dump(JSRuntime* rt, const char* filename) {
+  std::string out;
+  if (taro_js_exec_stats_write(rt, out) < 0)
+    return -1;
+  FILE* f = fopen(filename, "wb");
+  if (!f)
+    return -1;
+  int ret = fwrite(out.data(), 1, out.size(), f) == out.size() ? 0 : -1;
+  if (fclose(f) != 0)
+    ret = -1;
+  return ret;
+}
@@ -0,0 +1,330 @@
+#include "QuickJS/extension/taro_js_heap_profile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "../core/malloc.h"
+#include "../core/runtime.h"
+#include "../core/string-utils.h"
+
+#define TARO_JS_HEAP_PROFILE_MAX_DEPTH 64
+
+namespace {
+
+struct HeapProfileAlloc {
+  uint32_t stack;
+  size_t size;
+};
+
+struct HeapProfile {
+  JSMallocSampler sampler;
+
+  /* pprof tables, index 0 of 'strings' is the empty string and the ids of
+     the functions and locations start at 1 */
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, int64_t> string_ids;
+  std::map<std::pair<int64_t, int64_t>, uint64_t> function_ids;
+  std::vector<std::pair<int64_t, int64_t>> functions;
+  std::map<std::pair<uint64_t, int>, uint64_t> location_ids;
+  std::vector<std::pair<uint64_t, int>> locations;
+  std::map<std::vector<uint64_t>, uint32_t> stack_ids;
+  std::vector<std::vector<uint64_t>> stacks;
+
+  std::unordered_map<void*, HeapProfileAlloc> live;
+
+  int64_t string_id(const char* str) {
+    auto it = string_ids.find(str);
+    if (it != string_ids.end())
+      return it->second;
+    int64_t id = strings.size();
+    strings.emplace_back(str);
+    string_ids.emplace(strings.back(), id);
+    return id;
+  }
+
+  uint64_t function_id(const char* name, const char* filename) {
+    auto key = std::make_pair(string_id(name), string_id(filename));
+    auto it = function_ids.find(key);
+    if (it != function_ids.end())
+      return it->second;
+    functions.push_back(key);
+    function_ids.emplace(key, functions.size());
+    return functions.size();
+  }
+
+  uint64_t location_id(uint64_t function, int line) {
+    auto key = std::make_pair(function, line);
+    auto it = location_ids.find(key);
+    if (it != location_ids.end())
+      return it->second;
+    locations.push_back(key);
+    location_ids.emplace(key, locations.size());
+    return locations.size();
+  }
+
+  uint32_t stack_id(std::vector<uint64_t>& frames) {
+    auto it = stack_ids.find(frames);
+    if (it != stack_ids.end())
+      return it->second;
+    uint32_t id = stacks.size();
+    stacks.push_back(frames);
+    stack_ids.emplace(frames, id);
+    return id;
+  }
+};
+
+/* minimal protobuf encoder for profile.proto */
+class ProtoWriter {
+ public:
+  std::vector<uint8_t> buf;
+
+  void varint(uint64_t v) {
+    while (v >= 0x80) {
+      buf.push_back((uint8_t)(v | 0x80));
+      v >>= 7;
+    }
+    buf.push_back((uint8_t)v);
+  }
+
+  void int_field(int field, uint64_t v) {
+    varint((uint64_t)field << 3);
+    varint(v);
+  }
+
+  void bytes_field(int field, const void* data, size_t len) {
+    varint(((uint64_t)field << 3) | 2);
+    varint(len);
+    buf.insert(buf.end(), (const uint8_t*)data, (const uint8_t*)data + len);
+  }
+
+  void message_field(int field, const ProtoWriter& msg) {
+    bytes_field(field, msg.buf.data(), msg.buf.size());
+  }
+
+  template <typename T>
+  void packed_field(int field, const std::vector<T>& values) {
+    ProtoWriter packed;
+    for (T v : values)
+      packed.varint((uint64_t)v);
+    message_field(field, packed);
+  }
+};
+
+void taro_js_heap_profile_sample(
+    JSRuntime* rt,
+    void* opaque,
+    void* ptr,
+    size_t size) {
+  HeapProfile* profile = static_cast<HeapProfile*>(opaque);
+  std::vector<uint64_t> frames;
+  char name_buf[ATOM_GET_STR_BUF_SIZE];
+  char filename_buf[ATOM_GET_STR_BUF_SIZE];
+
+  /* the atoms are read without allocation, the line numbers come from
+     the pc2line table of each frame */
+  for (JSStackFrame* sf = rt->current_stack_frame;
+       sf != NULL && frames.size() < TARO_JS_HEAP_PROFILE_MAX_DEPTH;
+       sf = sf->prev_frame) {
+    if (JS_VALUE_GET_TAG(sf->cur_func) != JS_TAG_OBJECT)
+      continue;
+    JSObject* p = JS_VALUE_GET_OBJ(sf->cur_func);
+    const char* name = "(native)";
+    const char* filename = "";
+    int line = 0;
+
+    if (js_class_has_bytecode(p->class_id)) {
+      JSFunctionBytecode* b = p->u.func.function_bytecode;
+      name = "<anonymous>";
+      if (b->func_name != JS_ATOM_NULL)
+        name = JS_AtomGetStrRT(rt, name_buf, sizeof(name_buf), b->func_name);
+      if (b->has_debug) {
+        int col;
+        filename = JS_AtomGetStrRT(
+            rt, filename_buf, sizeof(filename_buf), b->debug.filename);
+        line = find_line_num(
+            b->realm,
+            b,
+            sf->cur_pc ? sf->cur_pc - b->byte_code_buf - 1 : -1,
+            &col);
+      }
+    }
+    frames.push_back(
+        profile->location_id(profile->function_id(name, filename), line));
+  }
+
+  if (frames.empty()) {
+    /* allocated by the runtime itself */
+    frames.push_back(
+        profile->location_id(profile->function_id("(no JS stack)", ""), 0));
+  }
+  profile->live[ptr] = {profile->stack_id(frames), size};
+}
+
+void taro_js_heap_profile_move(
+    JSRuntime* rt,
+    void* opaque,
+    void* old_ptr,
+    void* ptr,
+    size_t size) {
+  HeapProfile* profile = static_cast<HeapProfile*>(opaque);
+  auto it = profile->live.find(old_ptr);
+  if (it == profile->live.end())
+    return;
+  HeapProfileAlloc alloc = it->second;
+  alloc.size = size;
+  profile->live.erase(it);
+  profile->live[ptr] = alloc;
+}
+
+void taro_js_heap_profile_release(JSRuntime* rt, void* opaque, void* ptr) {
+  HeapProfile* profile = static_cast<HeapProfile*>(opaque);
+  profile->live.erase(ptr);
+}
+
+void taro_js_heap_profile_finalize(JSRuntime* rt, void* opaque) {
+  delete static_cast<HeapProfile*>(opaque);
+}
+
+HeapProfile* taro_js_heap_profile_get(JSRuntime* rt) {
+  JSMallocSampler* s = rt->malloc_sampler;
+  if (!s || s->sample != taro_js_heap_profile_sample)
+    return nullptr;
+  return static_cast<HeapProfile*>(s->opaque);
+}
+
+} // namespace
+
+int taro_js_heap_profile_start(JSRuntime* rt, size_t interval) {
+  if (rt->malloc_sampler)
+    return -1;
+
+  HeapProfile* profile = new HeapProfile();
+  profile->strings.emplace_back("");
+  profile->string_ids.emplace("", 0);
+
+  JSMallocSampler* s = &profile->sampler;
+  s->interval = interval ? interval : 1;
+  s->countdown = s->interval;
+  s->busy = FALSE;
+  s->sample = taro_js_heap_profile_sample;
+  s->move = taro_js_heap_profile_move;
+  s->release = taro_js_heap_profile_release;
+  s->finalize = taro_js_heap_profile_finalize;
+  s->opaque = profile;
+  rt->malloc_sampler = s;
+  return 0;
+}
+
+void taro_js_heap_profile_stop(JSRuntime* rt) {
+  HeapProfile* profile = taro_js_heap_profile_get(rt);
+  if (!profile)
+    return;
+  rt->malloc_sampler = NULL;
+  delete profile;
+}
+
+bool taro_js_heap_profile_is_running(JSRuntime* rt) {
+  return taro_js_heap_profile_get(rt) != nullptr;
+}
+
+int taro_js_heap_profile_write(JSRuntime* rt, std::vector<uint8_t>& out) {
+  HeapProfile* profile = taro_js_heap_profile_get(rt);
+  if (!profile)
+    return -1;
+
+  /* an allocation of 'size' bytes is sampled with a probability of
+     size / interval, scale the values back */
+  int64_t interval = profile->sampler.interval;
+  std::vector<std::pair<int64_t, int64_t>> values(profile->stacks.size());
+  for (const auto& entry : profile->live) {
+    int64_t size = entry.second.size;
+    int64_t count = size > 0 && size < interval ? interval / size : 1;
+    auto& v = values[entry.second.stack];
+    v.first += count;
+    v.second += count * size;
+  }
+
+  int64_t objects = profile->string_id("inuse_objects");
+  int64_t count = profile->string_id("count");
+  int64_t space = profile->string_id("inuse_space");
+  int64_t bytes = profile->string_id("bytes");
+
+  ProtoWriter w, msg;
+
+  /* sample_type */
+  msg.int_field(1, objects);
+  msg.int_field(2, count);
+  w.message_field(1, msg);
+  msg.buf.clear();
+  msg.int_field(1, space);
+  msg.int_field(2, bytes);
+  w.message_field(1, msg);
+  msg.buf.clear();
+
+  /* sample */
+  for (size_t i = 0; i < profile->stacks.size(); i++) {
+    if (values[i].first == 0)
+      continue;
+    msg.packed_field(1, profile->stacks[i]);
+    msg.packed_field(
+        2, std::vector<int64_t>{values[i].first, values[i].second});
+    w.message_field(2, msg);
+    msg.buf.clear();
+  }
+
+  /* location */
+  for (size_t i = 0; i < profile->locations.size(); i++) {
+    ProtoWriter line;
+    line.int_field(1, profile->locations[i].first);
+    line.int_field(2, profile->locations[i].second);
+    msg.int_field(1, i + 1);
+    msg.message_field(4, line);
+    w.message_field(4, msg);
+    msg.buf.clear();
+  }
+
+  /* function */
+  for (size_t i = 0; i < profile->functions.size(); i++) {
+    msg.int_field(1, i + 1);
+    msg.int_field(2, profile->functions[i].first);
+    msg.int_field(3, profile->functions[i].first);
+    msg.int_field(4, profile->functions[i].second);
+    w.message_field(5, msg);
+    msg.buf.clear();
+  }
+
+  /* string_table */
+  for (const auto& str : profile->strings)
+    w.bytes_field(6, str.data(), str.size());
+
+  /* time_nanos, period_type, period */
+  w.int_field(
+      9,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  msg.int_field(1, space);
+  msg.int_field(2, bytes);
+  w.message_field(11, msg);
+  w.int_field(12, interval);
+
+  out.swap(w.buf);
+  return 0;
+}
+
+int taro_js_heap_profile_dump(JSRuntime* rt, const char* filename) {
+  std::vector<uint8_t> buf;
+  if (taro_js_heap_profile_write(rt, buf) < 0)
+    return -1;
+
+  FILE* f = fopen(filename, "wb");
+  if (!f)
+    return -1;
+  size_t n = fwrite(buf.data(), 1, buf.size(), f);
+  if (fclose(f) != 0 || n != buf.size())
+    return -1;
+  return 0;
+}
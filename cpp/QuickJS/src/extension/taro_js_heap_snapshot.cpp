@@ -0,0 +1,801 @@
+#include "QuickJS/extension/taro_js_heap_snapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../core/gc.h"
+#include "../core/module.h"
+#include "../core/object.h"
+#include "../core/runtime.h"
+#include "../core/shape.h"
+#include "../core/string-utils.h"
+
+/* number of characters of a string kept as the name of its node */
+#define TARO_JS_HEAP_SNAPSHOT_STRING_NAME_LEN 256
+
+namespace {
+
+/* indexes in the "node_types" and "edge_types" tables of the header */
+enum HeapSnapshotNodeType {
+  NODE_HIDDEN,
+  NODE_ARRAY,
+  NODE_STRING,
+  NODE_OBJECT,
+  NODE_CODE,
+  NODE_CLOSURE,
+  NODE_REGEXP,
+  NODE_NUMBER,
+  NODE_NATIVE,
+  NODE_SYNTHETIC,
+  NODE_CONCATENATED_STRING,
+  NODE_SLICED_STRING,
+  NODE_SYMBOL,
+  NODE_BIGINT,
+  NODE_OBJECT_SHAPE,
+};
+
+enum HeapSnapshotEdgeType {
+  EDGE_CONTEXT,
+  EDGE_ELEMENT,
+  EDGE_PROPERTY,
+  EDGE_INTERNAL,
+  EDGE_HIDDEN,
+  EDGE_SHORTCUT,
+  EDGE_WEAK,
+};
+
+const char heap_snapshot_meta[] =
+    "{\"snapshot\":{\"meta\":{"
+    "\"node_fields\":[\"type\",\"name\",\"id\",\"self_size\",\"edge_count\","
+    "\"trace_node_id\",\"detachedness\"],"
+    "\"node_types\":[[\"hidden\",\"array\",\"string\",\"object\",\"code\","
+    "\"closure\",\"regexp\",\"number\",\"native\",\"synthetic\","
+    "\"concatenated string\",\"sliced string\",\"symbol\",\"bigint\","
+    "\"object shape\"],\"string\",\"number\",\"number\",\"number\","
+    "\"number\",\"number\"],"
+    "\"edge_fields\":[\"type\",\"name_or_index\",\"to_node\"],"
+    "\"edge_types\":[[\"context\",\"element\",\"property\",\"internal\","
+    "\"hidden\",\"shortcut\",\"weak\"],\"string_or_number\",\"node\"],"
+    "\"trace_function_info_fields\":[\"function_id\",\"name\","
+    "\"script_name\",\"script_id\",\"line\",\"column\"],"
+    "\"trace_node_fields\":[\"id\",\"function_info_index\",\"count\","
+    "\"size\",\"children\"],"
+    "\"sample_fields\":[\"timestamp_us\",\"last_assigned_id\"],"
+    "\"location_fields\":[\"object_index\",\"script_id\",\"line\","
+    "\"column\"]},";
+
+/* number of entries of "node_fields": the edges refer to the nodes by
+   their offset in the "nodes" array */
+const uint32_t heap_snapshot_node_fields = 7;
+
+const uint32_t heap_snapshot_no_node = UINT32_MAX;
+
+enum HeapSnapshotNodeKind : uint8_t {
+  KIND_ROOT,
+  KIND_GC_OBJECT,
+  KIND_STRING,
+  KIND_STRING_ROPE,
+};
+
+struct HeapSnapshotNode {
+  void* ptr;
+  uint32_t edge_count;
+  HeapSnapshotNodeKind kind;
+};
+
+/* buffered writer to a file descriptor */
+class HeapSnapshotWriter {
+ public:
+  explicit HeapSnapshotWriter(int fd)
+      : fd(fd), buf(64 * 1024), len(0), failed(false) {}
+
+  void put(const char* str, size_t n) {
+    while (n > 0) {
+      if (len == buf.size())
+        flush();
+      size_t l = std::min(n, buf.size() - len);
+      memcpy(buf.data() + len, str, l);
+      len += l;
+      str += l;
+      n -= l;
+    }
+  }
+
+  void put(const char* str) {
+    put(str, strlen(str));
+  }
+
+  void put_char(char c) {
+    if (len == buf.size())
+      flush();
+    buf[len++] = c;
+  }
+
+  void put_uint(uint64_t v) {
+    char tmp[24];
+    char* q = tmp + sizeof(tmp);
+    do {
+      *--q = '0' + v % 10;
+      v /= 10;
+    } while (v != 0);
+    put(q, tmp + sizeof(tmp) - q);
+  }
+
+  void put_string(const std::string& str) {
+    put_char('"');
+    for (unsigned char c : str) {
+      if (c == '"' || c == '\\') {
+        put_char('\\');
+        put_char(c);
+      } else if (c < 0x20) {
+        char tmp[8];
+        snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+        put(tmp, 6);
+      } else {
+        put_char(c);
+      }
+    }
+    put_char('"');
+  }
+
+  bool flush() {
+    size_t pos = 0;
+    while (pos < len && !failed) {
+#ifdef _WIN32
+      int n = _write(fd, buf.data() + pos, (unsigned int)(len - pos));
+#else
+      ssize_t n = write(fd, buf.data() + pos, len - pos);
+#endif
+      if (n < 0) {
+        if (errno != EINTR)
+          failed = true;
+        continue;
+      }
+      pos += n;
+    }
+    len = 0;
+    return !failed;
+  }
+
+ private:
+  int fd;
+  std::vector<char> buf;
+  size_t len;
+  bool failed;
+};
+
+class HeapSnapshot;
+
+/* the JS_MarkFunc callbacks have no opaque */
+thread_local HeapSnapshot* heap_snapshot_current;
+
+void heap_snapshot_mark(JSRuntime* rt, JSGCObjectHeader* h);
+
+class HeapSnapshot {
+ public:
+  HeapSnapshot(JSRuntime* rt, HeapSnapshotWriter* w)
+      : rt(rt), w(w), mode(MODE_COUNT_REFS), cur(0), edge_total(0) {
+    names.emplace_back("");
+    name_ids.emplace(names.back(), 0);
+  }
+
+  void write() {
+    HeapSnapshot* prev = heap_snapshot_current;
+    heap_snapshot_current = this;
+    collect_nodes();
+
+    /* the counts of the edges come first in the JSON */
+    mode = MODE_COUNT_EDGES;
+    for (uint32_t i = 0; i < nodes.size(); i++)
+      visit(i);
+
+    w->put(heap_snapshot_meta);
+    w->put("\"node_count\":");
+    w->put_uint(nodes.size());
+    w->put(",\"edge_count\":");
+    w->put_uint(edge_total);
+    w->put(",\"trace_function_count\":0},\n\"nodes\":[");
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+      if (i > 0)
+        w->put(",\n");
+      write_node(i);
+    }
+
+    w->put("],\n\"edges\":[");
+    mode = MODE_WRITE_EDGES;
+    first_edge = true;
+    for (uint32_t i = 0; i < nodes.size(); i++)
+      visit(i);
+
+    w->put(
+        "],\n\"trace_function_infos\":[],\"trace_tree\":[],\"samples\":[],"
+        "\"locations\":[],\n\"strings\":[");
+    for (size_t i = 0; i < names.size(); i++) {
+      if (i > 0)
+        w->put(",\n");
+      w->put_string(names[i]);
+    }
+    w->put("]}\n");
+    heap_snapshot_current = prev;
+  }
+
+  void mark_edge(JSGCObjectHeader* h) {
+    uint32_t to = gc_node(h);
+    if (to == heap_snapshot_no_node)
+      return;
+    if (mode == MODE_COUNT_REFS)
+      incoming[to]++;
+    else
+      edge(EDGE_INTERNAL, mark_name, to);
+  }
+
+ private:
+  enum Mode {
+    MODE_COUNT_REFS, /* count the references between the GC objects */
+    MODE_COUNT_EDGES,
+    MODE_WRITE_EDGES,
+  };
+
+  JSRuntime* rt;
+  HeapSnapshotWriter* w;
+  Mode mode;
+
+  /* nodes[0] is the root, then the GC objects sorted by address, then the
+     strings in the order they are found */
+  std::vector<HeapSnapshotNode> nodes;
+  uint32_t gc_node_end;
+  std::unordered_map<void*, uint32_t> string_nodes;
+  std::vector<uint32_t> incoming;
+  std::vector<uint32_t> roots;
+
+  /* "strings" table, the deque keeps the keys of 'name_ids' valid */
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, uint32_t> name_ids;
+  std::unordered_map<JSAtom, uint32_t> atom_names;
+  std::string string_buf;
+
+  uint32_t cur; /* node whose edges are visited */
+  uint32_t mark_name; /* name of the edges reported by mark_children() */
+  uint64_t edge_total;
+  bool first_edge;
+
+  uint32_t name_id(std::string_view str) {
+    auto it = name_ids.find(str);
+    if (it != name_ids.end())
+      return it->second;
+    uint32_t id = names.size();
+    names.emplace_back(str);
+    name_ids.emplace(names.back(), id);
+    return id;
+  }
+
+  uint32_t atom_name(JSAtom atom) {
+    auto it = atom_names.find(atom);
+    if (it != atom_names.end())
+      return it->second;
+    char buf[TARO_JS_HEAP_SNAPSHOT_STRING_NAME_LEN];
+    uint32_t id = name_id(
+        atom == JS_ATOM_NULL ? "" : JS_AtomGetStrRT(rt, buf, sizeof(buf), atom));
+    atom_names.emplace(atom, id);
+    return id;
+  }
+
+  uint32_t string_name(JSString* p) {
+    std::string& str = string_buf;
+    uint32_t len = std::min<uint32_t>(
+        p->len, TARO_JS_HEAP_SNAPSHOT_STRING_NAME_LEN);
+    uint8_t buf[UTF8_CHAR_LEN_MAX];
+
+    str.clear();
+    for (uint32_t i = 0; i < len; i++) {
+      uint32_t c;
+      if (!p->is_wide_char) {
+        c = js_string_str8(p)[i];
+      } else {
+        const uint16_t* str16 = js_string_str16(p);
+        c = str16[i];
+        if (is_hi_surrogate(c) && i + 1 < p->len &&
+            is_lo_surrogate(str16[i + 1])) {
+          c = from_surrogate(c, str16[++i]);
+        } else if (is_surrogate(c)) {
+          c = 0xfffd;
+        }
+      }
+      str.append((char*)buf, unicode_to_utf8(buf, c));
+    }
+    return name_id(str);
+  }
+
+  void collect_nodes() {
+    struct list_head* el;
+
+    nodes.push_back({nullptr, 0, KIND_ROOT});
+    list_for_each(el, &rt->gc_obj_list) {
+      JSGCObjectHeader* h = list_entry(el, JSGCObjectHeader, link);
+      nodes.push_back({h, 0, KIND_GC_OBJECT});
+    }
+    std::sort(
+        nodes.begin() + 1,
+        nodes.end(),
+        [](const HeapSnapshotNode& a, const HeapSnapshotNode& b) {
+          return a.ptr < b.ptr;
+        });
+    gc_node_end = nodes.size();
+
+    /* the objects referenced from outside of the GC objects (C code, the
+       stack, the atoms...) have more references than the GC edges */
+    mode = MODE_COUNT_REFS;
+    incoming.assign(gc_node_end, 0);
+    for (uint32_t i = 1; i < gc_node_end; i++) {
+      cur = i;
+      mark_children(
+          rt, (JSGCObjectHeader*)nodes[i].ptr, heap_snapshot_mark);
+    }
+    for (uint32_t i = 1; i < gc_node_end; i++) {
+      JSGCObjectHeader* h = (JSGCObjectHeader*)nodes[i].ptr;
+      if ((uint32_t)h->ref_count > incoming[i])
+        roots.push_back(i);
+    }
+    std::vector<uint32_t>().swap(incoming);
+  }
+
+  uint32_t gc_node(void* ptr) {
+    auto it = std::lower_bound(
+        nodes.begin() + 1,
+        nodes.begin() + gc_node_end,
+        ptr,
+        [](const HeapSnapshotNode& n, void* p) { return n.ptr < p; });
+    if (it == nodes.begin() + gc_node_end || it->ptr != ptr)
+      return heap_snapshot_no_node;
+    return it - nodes.begin();
+  }
+
+  uint32_t string_node(void* ptr, HeapSnapshotNodeKind kind) {
+    auto it = string_nodes.find(ptr);
+    if (it != string_nodes.end())
+      return it->second;
+    if (mode != MODE_COUNT_EDGES)
+      return heap_snapshot_no_node;
+    uint32_t id = nodes.size();
+    nodes.push_back({ptr, 0, kind});
+    string_nodes.emplace(ptr, id);
+    return id;
+  }
+
+  uint32_t value_node(JSValueConst val) {
+    switch (JS_VALUE_GET_TAG(val)) {
+      case JS_TAG_OBJECT:
+      case JS_TAG_FUNCTION_BYTECODE:
+      case JS_TAG_MODULE:
+        return gc_node(JS_VALUE_GET_PTR(val));
+      case JS_TAG_STRING:
+        return string_node(JS_VALUE_GET_PTR(val), KIND_STRING);
+      case JS_TAG_STRING_ROPE:
+        return string_node(JS_VALUE_GET_PTR(val), KIND_STRING_ROPE);
+      default:
+        return heap_snapshot_no_node;
+    }
+  }
+
+  void edge(HeapSnapshotEdgeType type, uint32_t name_or_index, uint32_t to) {
+    if (to == heap_snapshot_no_node)
+      return;
+    if (mode == MODE_COUNT_EDGES) {
+      nodes[cur].edge_count++;
+      edge_total++;
+      return;
+    }
+    if (!first_edge)
+      w->put(",\n");
+    first_edge = false;
+    w->put_uint(type);
+    w->put_char(',');
+    w->put_uint(name_or_index);
+    w->put_char(',');
+    w->put_uint((uint64_t)to * heap_snapshot_node_fields);
+  }
+
+  void internal_edge(const char* name, uint32_t to) {
+    if (to != heap_snapshot_no_node)
+      edge(EDGE_INTERNAL, name_id(name), to);
+  }
+
+  void property_edge(JSAtom atom, uint32_t to) {
+    if (to == heap_snapshot_no_node)
+      return;
+    if (__JS_AtomIsTaggedInt(atom))
+      edge(EDGE_ELEMENT, __JS_AtomToUInt32(atom), to);
+    else
+      edge(EDGE_PROPERTY, atom_name(atom), to);
+  }
+
+  void accessor_edge(const char* prefix, JSAtom atom, JSObject* p) {
+    if (!p)
+      return;
+    uint32_t to = gc_node(p);
+    if (to == heap_snapshot_no_node)
+      return;
+    char buf[ATOM_GET_STR_BUF_SIZE];
+    std::string name(prefix);
+    name += JS_AtomGetStrRT(rt, buf, sizeof(buf), atom);
+    edge(EDGE_PROPERTY, name_id(name), to);
+  }
+
+  void mark_edges(const char* name, JSGCObjectHeader* h) {
+    mark_name = name_id(name);
+    mark_children(rt, h, heap_snapshot_mark);
+  }
+
+  void visit(uint32_t i) {
+    HeapSnapshotNode& n = nodes[i];
+    cur = i;
+    switch (n.kind) {
+      case KIND_ROOT:
+        for (uint32_t k = 0; k < roots.size(); k++)
+          edge(EDGE_ELEMENT, k, roots[k]);
+        break;
+      case KIND_STRING: {
+        JSString* p = (JSString*)n.ptr;
+        if (p->is_slice)
+          internal_edge(
+              "parent",
+              string_node(((JSStringSlice*)p)->parent, KIND_STRING));
+      } break;
+      case KIND_STRING_ROPE: {
+        JSStringRope* r = (JSStringRope*)n.ptr;
+        internal_edge("first", value_node(r->left));
+        internal_edge("second", value_node(r->right));
+      } break;
+      case KIND_GC_OBJECT:
+        visit_gc_object((JSGCObjectHeader*)n.ptr);
+        break;
+    }
+  }
+
+  void visit_gc_object(JSGCObjectHeader* h) {
+    switch (h->gc_obj_type) {
+      case JS_GC_OBJ_TYPE_JS_OBJECT:
+        visit_object((JSObject*)h);
+        break;
+      case JS_GC_OBJ_TYPE_FUNCTION_BYTECODE:
+        visit_bytecode((JSFunctionBytecode*)h);
+        break;
+      case JS_GC_OBJ_TYPE_SHAPE: {
+        JSShape* sh = (JSShape*)h;
+        if (sh->proto)
+          edge(EDGE_PROPERTY, name_id("__proto__"), gc_node(sh->proto));
+      } break;
+      case JS_GC_OBJ_TYPE_VAR_REF: {
+        JSVarRef* var_ref = (JSVarRef*)h;
+        if (var_ref->is_detached)
+          internal_edge("value", value_node(*var_ref->pvalue));
+        else if (var_ref->async_func)
+          internal_edge("frame", gc_node(var_ref->async_func));
+      } break;
+      case JS_GC_OBJ_TYPE_JS_CONTEXT:
+        visit_context((JSContext*)h);
+        break;
+      default:
+        mark_edges("internal", h);
+        break;
+    }
+  }
+
+  void visit_object(JSObject* p) {
+    JSShape* sh = p->shape;
+    JSShapeProperty* prs = get_shape_prop(sh);
+    int i;
+
+    internal_edge("map", gc_node(sh));
+    for (i = 0; i < sh->prop_count; i++, prs++) {
+      JSProperty* pr = &p->prop[i];
+      if (prs->atom == JS_ATOM_NULL)
+        continue;
+      switch (prs->flags & JS_PROP_TMASK) {
+        case JS_PROP_GETSET:
+          accessor_edge("get ", prs->atom, pr->u.getset.getter);
+          accessor_edge("set ", prs->atom, pr->u.getset.setter);
+          break;
+        case JS_PROP_VARREF:
+          property_edge(prs->atom, gc_node(pr->u.var_ref));
+          break;
+        case JS_PROP_AUTOINIT:
+          /* realm and captured backtrace */
+          mark_name = atom_name(prs->atom);
+          js_autoinit_mark(rt, pr, heap_snapshot_mark);
+          break;
+        default:
+          property_edge(prs->atom, value_node(pr->u.value));
+          break;
+      }
+    }
+
+    if (p->class_id == JS_CLASS_ARRAY || p->class_id == JS_CLASS_ARGUMENTS) {
+      if (p->fast_array) {
+        for (uint32_t k = 0; k < p->u.array.count; k++)
+          edge(EDGE_ELEMENT, k, value_node(p->u.array.u.values[k]));
+      }
+    } else if (js_class_has_bytecode(p->class_id)) {
+      JSFunctionBytecode* b = p->u.func.function_bytecode;
+      if (p->u.func.home_object)
+        internal_edge("home_object", gc_node(p->u.func.home_object));
+      if (b && p->u.func.var_refs) {
+        for (i = 0; i < b->closure_var_count; i++) {
+          JSVarRef* var_ref = p->u.func.var_refs[i];
+          if (var_ref && var_ref->is_detached) {
+            edge(
+                EDGE_CONTEXT,
+                atom_name(b->closure_var[i].var_name),
+                gc_node(var_ref));
+          }
+        }
+      }
+      if (b)
+        internal_edge("shared", gc_node(b));
+    } else if (p->class_id == JS_CLASS_REGEXP) {
+      if (p->u.regexp.pattern)
+        internal_edge("source", string_node(p->u.regexp.pattern, KIND_STRING));
+      if (p->u.regexp.bytecode)
+        internal_edge("bytecode", string_node(p->u.regexp.bytecode, KIND_STRING));
+    } else if (p->class_id != JS_CLASS_OBJECT) {
+      JSClassGCMark* gc_mark = rt->class_array[p->class_id].gc_mark;
+      if (gc_mark) {
+        mark_name = name_id("internal");
+        gc_mark(rt, JS_MKPTR(JS_TAG_OBJECT, p), heap_snapshot_mark);
+      }
+    }
+  }
+
+  void visit_bytecode(JSFunctionBytecode* b) {
+    int i, j;
+
+    for (i = 0; i < b->cpool_count; i++)
+      internal_edge("constant_pool", value_node(b->cpool[i]));
+    if (b->realm)
+      internal_edge("realm", gc_node(b->realm));
+    if (b->ic) {
+      for (i = 0; i < (int)b->ic->count; i++) {
+        InlineCacheRingItem* buffer = b->ic->cache[i].buffer;
+        for (j = 0; j < IC_CACHE_ITEM_CAPACITY; j++) {
+          if (buffer[j].shape)
+            internal_edge("inline_cache", gc_node(buffer[j].shape));
+          if (buffer[j].proto)
+            internal_edge("inline_cache", gc_node(buffer[j].proto));
+        }
+      }
+    }
+  }
+
+  /* same edges as JS_MarkContext() */
+  void visit_context(JSContext* ctx) {
+    struct list_head* el;
+    int i;
+
+    list_for_each(el, &ctx->loaded_modules) {
+      JSModuleDef* m = list_entry(el, JSModuleDef, link);
+      edge(EDGE_INTERNAL, atom_name(m->module_name), gc_node(m));
+    }
+    internal_edge("global_object", value_node(ctx->global_obj));
+    internal_edge("global_lexicals", value_node(ctx->global_var_obj));
+    internal_edge("throw_type_error", value_node(ctx->throw_type_error));
+    internal_edge("eval", value_node(ctx->eval_obj));
+    internal_edge("array_proto_values", value_node(ctx->array_proto_values));
+    for (i = 0; i < JS_NATIVE_ERROR_COUNT; i++)
+      internal_edge("native_error_proto", value_node(ctx->native_error_proto[i]));
+    for (i = 0; i < rt->class_count; i++)
+      internal_edge("class_proto", value_node(ctx->class_proto[i]));
+    internal_edge("iterator_proto", value_node(ctx->iterator_proto));
+    internal_edge(
+        "async_iterator_proto", value_node(ctx->async_iterator_proto));
+    internal_edge("promise_ctor", value_node(ctx->promise_ctor));
+    internal_edge("array_ctor", value_node(ctx->array_ctor));
+    internal_edge("regexp_ctor", value_node(ctx->regexp_ctor));
+    internal_edge("function_ctor", value_node(ctx->function_ctor));
+    internal_edge("function_proto", value_node(ctx->function_proto));
+    if (ctx->array_shape)
+      internal_edge("array_shape", gc_node(ctx->array_shape));
+  }
+
+  /* name of a function: the name of its bytecode, else its "name"
+     property (class constructors, C functions) */
+  uint32_t function_name(JSObject* f) {
+    JSProperty* pr;
+    if (js_class_has_bytecode(f->class_id) && f->u.func.function_bytecode &&
+        f->u.func.function_bytecode->func_name != JS_ATOM_NULL)
+      return atom_name(f->u.func.function_bytecode->func_name);
+    JSShapeProperty* prs = find_own_property(&pr, f, JS_ATOM_name);
+    if (!prs || (prs->flags & JS_PROP_TMASK) ||
+        JS_VALUE_GET_TAG(pr->u.value) != JS_TAG_STRING)
+      return 0;
+    return string_name(JS_VALUE_GET_STRING(pr->u.value));
+  }
+
+  /* name of the constructor found in the prototype chain */
+  uint32_t constructor_name(JSObject* p) {
+    JSObject* proto = p->shape->proto;
+    JSProperty* pr;
+    if (!proto)
+      return 0;
+    JSShapeProperty* prs = find_own_property(&pr, proto, JS_ATOM_constructor);
+    if (!prs || (prs->flags & JS_PROP_TMASK) ||
+        JS_VALUE_GET_TAG(pr->u.value) != JS_TAG_OBJECT)
+      return 0;
+    return function_name(JS_VALUE_GET_OBJ(pr->u.value));
+  }
+
+  void object_info(JSObject* p, int* type, uint32_t* name, size_t* size) {
+    JSAtom class_name = rt->class_array[p->class_id].class_name;
+
+    *type = NODE_OBJECT;
+    *size = sizeof(JSObject);
+    if (p->prop)
+      *size += p->shape->prop_size * sizeof(JSProperty);
+
+    if (p->class_id == JS_CLASS_OBJECT) {
+      *name = constructor_name(p);
+      if (*name == 0)
+        *name = atom_name(class_name);
+    } else if (js_class_has_bytecode(p->class_id)) {
+      JSFunctionBytecode* b = p->u.func.function_bytecode;
+      *type = NODE_CLOSURE;
+      *name = function_name(p);
+      if (b && p->u.func.var_refs)
+        *size += b->closure_var_count * sizeof(JSVarRef*);
+    } else {
+      *name = atom_name(class_name);
+      switch (p->class_id) {
+        case JS_CLASS_ARRAY:
+        case JS_CLASS_ARGUMENTS:
+          *type = NODE_ARRAY;
+          if (p->fast_array)
+            *size += p->u.array.count * sizeof(JSValue);
+          break;
+        case JS_CLASS_C_FUNCTION:
+        case JS_CLASS_BOUND_FUNCTION:
+        case JS_CLASS_C_FUNCTION_DATA:
+          *type = NODE_CLOSURE;
+          if (uint32_t fname = function_name(p))
+            *name = fname;
+          break;
+        case JS_CLASS_REGEXP:
+          *type = NODE_REGEXP;
+          if (p->u.regexp.pattern)
+            *name = string_name(p->u.regexp.pattern);
+          break;
+        case JS_CLASS_ARRAY_BUFFER:
+        case JS_CLASS_SHARED_ARRAY_BUFFER:
+          if (p->u.array_buffer)
+            *size += sizeof(JSArrayBuffer) + p->u.array_buffer->byte_length;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  void write_node(uint32_t i) {
+    const HeapSnapshotNode& n = nodes[i];
+    int type = NODE_HIDDEN;
+    uint32_t name = 0;
+    size_t size = 0;
+
+    switch (n.kind) {
+      case KIND_ROOT:
+        type = NODE_SYNTHETIC;
+        break;
+      case KIND_STRING: {
+        JSString* p = (JSString*)n.ptr;
+        name = string_name(p);
+        if (p->is_slice) {
+          type = NODE_SLICED_STRING;
+          size = sizeof(JSStringSlice);
+        } else {
+          type = NODE_STRING;
+          size = sizeof(JSString) + (p->len << p->is_wide_char) + 1 -
+              p->is_wide_char;
+        }
+      } break;
+      case KIND_STRING_ROPE:
+        type = NODE_CONCATENATED_STRING;
+        name = name_id("(concatenated string)");
+        size = sizeof(JSStringRope);
+        break;
+      case KIND_GC_OBJECT: {
+        JSGCObjectHeader* h = (JSGCObjectHeader*)n.ptr;
+        switch (h->gc_obj_type) {
+          case JS_GC_OBJ_TYPE_JS_OBJECT:
+            object_info((JSObject*)h, &type, &name, &size);
+            break;
+          case JS_GC_OBJ_TYPE_FUNCTION_BYTECODE: {
+            JSFunctionBytecode* b = (JSFunctionBytecode*)h;
+            type = NODE_CODE;
+            name = atom_name(b->func_name);
+            size = sizeof(JSFunctionBytecode) + b->byte_code_len +
+                (b->arg_count + b->var_count) * sizeof(JSVarDef) +
+                b->cpool_count * sizeof(JSValue) +
+                b->closure_var_count * sizeof(JSClosureVar);
+            if (b->has_debug) {
+              size += b->debug.pc2line_len + b->debug.pc2column_len +
+                  b->debug.source_len;
+            }
+          } break;
+          case JS_GC_OBJ_TYPE_SHAPE: {
+            JSShape* sh = (JSShape*)h;
+            type = NODE_OBJECT_SHAPE;
+            name = name_id("(object shape)");
+            size = get_shape_size(sh->prop_hash_mask + 1, sh->prop_size);
+          } break;
+          case JS_GC_OBJ_TYPE_VAR_REF:
+            name = name_id("(closure variable)");
+            size = sizeof(JSVarRef);
+            break;
+          case JS_GC_OBJ_TYPE_ASYNC_FUNCTION:
+            name = name_id("(async function)");
+            size = sizeof(JSAsyncFunctionState);
+            break;
+          case JS_GC_OBJ_TYPE_JS_CONTEXT:
+            name = name_id("(context)");
+            size = sizeof(JSContext) + rt->class_count * sizeof(JSValue);
+            break;
+          case JS_GC_OBJ_TYPE_MODULE:
+            name = atom_name(((JSModuleDef*)h)->module_name);
+            size = sizeof(JSModuleDef);
+            break;
+          default:
+            break;
+        }
+      } break;
+    }
+
+    w->put_uint(type);
+    w->put_char(',');
+    w->put_uint(name);
+    w->put_char(',');
+    /* the addresses are stable while the objects are alive so that the
+       snapshots can be compared */
+    w->put_uint(n.ptr ? (uint64_t)(uintptr_t)n.ptr : 1);
+    w->put_char(',');
+    w->put_uint(size);
+    w->put_char(',');
+    w->put_uint(n.edge_count);
+    w->put(",0,0");
+  }
+};
+
+void heap_snapshot_mark(JSRuntime* rt, JSGCObjectHeader* h) {
+  heap_snapshot_current->mark_edge(h);
+}
+
+} // namespace
+
+int taro_js_heap_snapshot_write(JSRuntime* rt, int fd) {
+  /* only the reachable objects are part of the snapshot */
+  JS_RunGC(rt);
+
+  HeapSnapshotWriter w(fd);
+  HeapSnapshot snapshot(rt, &w);
+  snapshot.write();
+  return w.flush() ? 0 : -1;
+}
+
+int taro_js_heap_snapshot_dump(JSRuntime* rt, const char* filename) {
+  FILE* f = fopen(filename, "wb");
+  if (!f)
+    return -1;
+  int ret = taro_js_heap_snapshot_write(rt, fileno(f));
+  if (fclose(f) != 0)
+    ret = -1;
+  return ret;
+}
@@ -1,5 +1,7 @@
 #include "QuickJS/extension/taro_js_json.h"
 
+#include <string.h>
+
 #include "../core/builtins/js-json.h"
 #include "../core/common.h"
 #include "QuickJS/quickjs.h"
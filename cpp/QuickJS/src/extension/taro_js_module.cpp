@@ -113,3 +113,12 @@ void taro_js_free_module_def(JSContext* ctx, JSModuleDef* m) {
 void taro_js_free_module_def(JSRuntime* rt, JSModuleDef* m) {
   js_free_module_def(rt, m);
 }
+
+void taro_js_unload_module(JSContext* ctx, JSModuleDef* m) {
+  if (m->link.next) {
+    list_del(&m->link);
+    m->link.prev = NULL;
+    m->link.next = NULL;
+    JS_FreeValue(ctx, JS_MKPTR(JS_TAG_MODULE, m));
+  }
+}
@@ -0,0 +1,197 @@
+#include "QuickJS/extension/taro_js_property_key.h"
+
+#include <vector>
+
+#include "../core/object.h"
+#include "../core/runtime.h"
+#include "../core/shape.h"
+
+/* number of shapes remembered by a key set */
+#define TARO_JS_PROPERTY_KEY_SET_SHAPES 4
+
+/* slot of a key in a cached shape: index in JSObject.prop shifted left by
+   one with the writable flag in bit 0, or -1 if the key must be looked up
+   (not an own data property) */
+#define TARO_JS_PROPERTY_KEY_SLOW (-1)
+
+struct TaroJSPropertyKeySet {
+  std::vector<JSAtom> atoms;
+  /* a referenced shape is never modified in place (the object clones it
+     first, see js_shape_prepare_update()), so the slots stay valid as long
+     as the object still points to it */
+  JSShape* shapes[TARO_JS_PROPERTY_KEY_SET_SHAPES];
+  std::vector<int32_t> slots; /* TARO_JS_PROPERTY_KEY_SET_SHAPES * count */
+  int next_shape; /* entry replaced on the next miss */
+};
+
+namespace {
+
+/* return the cache entry of the shape of 'p' or -1 if its properties
+   cannot be accessed directly */
+int taro_js_property_key_set_lookup(
+    JSContext* ctx,
+    TaroJSPropertyKeySet* set,
+    JSObject* p) {
+  JSShape* sh = p->shape;
+  int count = set->atoms.size();
+  int i, k;
+
+  if (p->is_exotic || p->fast_array || !sh->is_hashed)
+    return -1;
+  for (k = 0; k < TARO_JS_PROPERTY_KEY_SET_SHAPES; k++) {
+    if (set->shapes[k] == sh)
+      return k;
+  }
+
+  /* resolve all the keys in one pass over the shape */
+  k = set->next_shape;
+  set->next_shape = (k + 1) % TARO_JS_PROPERTY_KEY_SET_SHAPES;
+  if (set->shapes[k])
+    js_free_shape(ctx->rt, set->shapes[k]);
+  set->shapes[k] = js_dup_shape(sh);
+  int32_t* slots = &set->slots[k * count];
+  JSShapeProperty* prop = get_shape_prop(sh);
+  for (i = 0; i < count; i++) {
+    JSShapeProperty* prs = find_own_property1(p, set->atoms[i]);
+    if (prs && (prs->flags & JS_PROP_TMASK) == JS_PROP_NORMAL &&
+        !(prs->flags & JS_PROP_LENGTH)) {
+      slots[i] = ((int32_t)(prs - prop) << 1) |
+          ((prs->flags & JS_PROP_WRITABLE) != 0);
+    } else {
+      slots[i] = TARO_JS_PROPERTY_KEY_SLOW;
+    }
+  }
+  return k;
+}
+
+TaroJSPropertyKeySet* taro_js_property_key_set_alloc(int count) {
+  TaroJSPropertyKeySet* set = new TaroJSPropertyKeySet();
+  set->atoms.reserve(count);
+  for (int k = 0; k < TARO_JS_PROPERTY_KEY_SET_SHAPES; k++)
+    set->shapes[k] = NULL;
+  set->slots.resize(TARO_JS_PROPERTY_KEY_SET_SHAPES * count);
+  set->next_shape = 0;
+  return set;
+}
+
+} // namespace
+
+taro_js_property_key taro_js_property_key_new(JSContext* ctx, const char* name) {
+  return JS_NewAtom(ctx, name);
+}
+
+void taro_js_property_key_free(JSContext* ctx, taro_js_property_key key) {
+  JS_FreeAtom(ctx, key);
+}
+
+TaroJSPropertyKeySet*
+taro_js_property_key_set_new(JSContext* ctx, const char* const* names, int count) {
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_alloc(count);
+  for (int i = 0; i < count; i++) {
+    JSAtom atom = JS_NewAtom(ctx, names[i]);
+    if (atom == JS_ATOM_NULL) {
+      taro_js_property_key_set_free(ctx, set);
+      return NULL;
+    }
+    set->atoms.push_back(atom);
+  }
+  return set;
+}
+
+TaroJSPropertyKeySet* taro_js_property_key_set_new(
+    JSContext* ctx,
+    const taro_js_property_key* keys,
+    int count) {
+  TaroJSPropertyKeySet* set = taro_js_property_key_set_alloc(count);
+  for (int i = 0; i < count; i++)
+    set->atoms.push_back(JS_DupAtom(ctx, keys[i]));
+  return set;
+}
+
+void taro_js_property_key_set_free(JSContext* ctx, TaroJSPropertyKeySet* set) {
+  if (!set)
+    return;
+  for (JSAtom atom : set->atoms)
+    JS_FreeAtom(ctx, atom);
+  for (int k = 0; k < TARO_JS_PROPERTY_KEY_SET_SHAPES; k++) {
+    if (set->shapes[k])
+      js_free_shape(ctx->rt, set->shapes[k]);
+  }
+  delete set;
+}
+
+int taro_js_property_key_set_size(const TaroJSPropertyKeySet* set) {
+  return set->atoms.size();
+}
+
+int taro_js_get_properties(
+    JSContext* ctx,
+    JSValueConst obj,
+    TaroJSPropertyKeySet* set,
+    JSValue* values) {
+  int count = set->atoms.size();
+  JSObject* p = NULL;
+  int32_t* slots = NULL;
+  int i, k = -1;
+
+  if (JS_VALUE_GET_TAG(obj) == JS_TAG_OBJECT) {
+    p = JS_VALUE_GET_OBJ(obj);
+    k = taro_js_property_key_set_lookup(ctx, set, p);
+    if (k >= 0)
+      slots = &set->slots[k * count];
+  }
+  for (i = 0; i < count; i++) {
+    /* a getter may have modified the object or reused the set */
+    if (slots && slots[i] != TARO_JS_PROPERTY_KEY_SLOW &&
+        p->shape == set->shapes[k]) {
+      values[i] = JS_DupValue(ctx, p->prop[slots[i] >> 1].u.value);
+      continue;
+    }
+    values[i] = JS_GetProperty(ctx, obj, set->atoms[i]);
+    if (taro_is_exception(values[i])) {
+      while (--i >= 0)
+        JS_FreeValue(ctx, values[i]);
+      for (i = 0; i < count; i++)
+        values[i] = JS_UNDEFINED;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int taro_js_set_properties(
+    JSContext* ctx,
+    JSValueConst obj,
+    TaroJSPropertyKeySet* set,
+    JSValue* values) {
+  int count = set->atoms.size();
+  JSObject* p = NULL;
+  int32_t* slots = NULL;
+  int i, k = -1;
+
+  if (JS_VALUE_GET_TAG(obj) == JS_TAG_OBJECT) {
+    p = JS_VALUE_GET_OBJ(obj);
+    k = taro_js_property_key_set_lookup(ctx, set, p);
+    if (k >= 0)
+      slots = &set->slots[k * count];
+  }
+  for (i = 0; i < count; i++) {
+    /* a setter may have modified the object or reused the set */
+    if (slots && slots[i] != TARO_JS_PROPERTY_KEY_SLOW && (slots[i] & 1) &&
+        p->shape == set->shapes[k]) {
+      JSProperty* pr = &p->prop[slots[i] >> 1];
+      JSValue old = pr->u.value;
+      pr->u.value = values[i];
+      JS_FreeValue(ctx, old);
+    } else if (JS_SetProperty(ctx, obj, set->atoms[i], values[i]) < 0) {
+      values[i] = JS_UNDEFINED;
+      while (++i < count) {
+        JS_FreeValue(ctx, values[i]);
+        values[i] = JS_UNDEFINED;
+      }
+      return -1;
+    }
+    values[i] = JS_UNDEFINED;
+  }
+  return 0;
+}
@@ -148,6 +148,171 @@ static int lre_case_conv_entry(uint32_t *res, uint32_t c, int conv_type, uint32_
     return 1;
 }
 
+/* Two-stage bitmaps of the BMP for the per character property
+   tests: each block of 256 code points of a property is mapped to a
+   256 bit block shared by all the properties. They are built once
+   from the compressed tables. Until then, or if they could not be
+   built, the binary searches are used. */
+typedef enum {
+    UNICODE_BMP_CASE_CONV, /* in case_conv_table1 */
+    UNICODE_BMP_CASED,
+    UNICODE_BMP_CASE_IGNORABLE,
+    UNICODE_BMP_ID_START,
+    UNICODE_BMP_ID_CONTINUE,
+    UNICODE_BMP_COUNT,
+} UnicodeBMPPropEnum;
+
+#define UNICODE_BMP_BLOCKS_MAX 256
+
+enum {
+    UNICODE_BMP_STATE_NONE,
+    UNICODE_BMP_STATE_BUILDING,
+    UNICODE_BMP_STATE_READY,
+    UNICODE_BMP_STATE_FAILED,
+};
+
+static int unicode_bmp_state;
+static uint8_t unicode_bmp_index[UNICODE_BMP_COUNT][256];
+static uint32_t unicode_bmp_blocks[UNICODE_BMP_BLOCKS_MAX][8];
+
+/* set the BMP code points of a compressed table in 'bitmap' */
+static void unicode_bmp_set_table(uint32_t *bitmap, const uint8_t *p,
+                                  int table_len)
+{
+    const uint8_t *p_end = p + table_len;
+    uint32_t c, c0, b, bit;
+
+    c = 0;
+    bit = 0;
+    while (p < p_end && c < 0x10000) {
+        c0 = c;
+        b = *p++;
+        if (b < 64) {
+            c += (b >> 3) + 1;
+            if (bit) {
+                for(; c0 < c; c0++)
+                    bitmap[c0 >> 5] |= 1U << (c0 & 31);
+            }
+            bit ^= 1;
+            c0 = c;
+            c += (b & 7) + 1;
+        } else if (b >= 0x80) {
+            c += b - 0x80 + 1;
+        } else if (b < 0x60) {
+            c += (((b - 0x40) << 8) | p[0]) + 1;
+            p++;
+        } else {
+            c += (((b - 0x60) << 16) | (p[0] << 8) | p[1]) + 1;
+            p += 2;
+        }
+        if (bit) {
+            for(; c0 < c && c0 < 0x10000; c0++)
+                bitmap[c0 >> 5] |= 1U << (c0 & 31);
+        }
+        bit ^= 1;
+    }
+}
+
+static void unicode_bmp_set_case_conv(uint32_t *bitmap)
+{
+    uint32_t v, code, len, i, c;
+
+    for(i = 0; i < countof(case_conv_table1); i++) {
+        v = case_conv_table1[i];
+        code = v >> (32 - 17);
+        len = (v >> (32 - 17 - 7)) & 0x7f;
+        for(c = code; c < code + len && c < 0x10000; c++)
+            bitmap[c >> 5] |= 1U << (c & 31);
+    }
+}
+
+/* return FALSE if there are too many distinct blocks */
+static BOOL unicode_bmp_add_bitmap(int *pblock_count, int prop,
+                                   const uint32_t *bitmap)
+{
+    int i, j, n = *pblock_count;
+
+    for(i = 0; i < 256; i++) {
+        const uint32_t *block = bitmap + i * 8;
+        for(j = 0; j < n; j++) {
+            if (!memcmp(unicode_bmp_blocks[j], block, 32))
+                break;
+        }
+        if (j == n) {
+            if (n == UNICODE_BMP_BLOCKS_MAX)
+                return FALSE;
+            memcpy(unicode_bmp_blocks[n++], block, 32);
+        }
+        unicode_bmp_index[prop][i] = j;
+    }
+    *pblock_count = n;
+    return TRUE;
+}
+
+static BOOL unicode_bmp_build(void)
+{
+    uint32_t bitmap[0x10000 / 32];
+    int prop, block_count = 0;
+
+    for(prop = 0; prop < UNICODE_BMP_COUNT; prop++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        switch(prop) {
+        case UNICODE_BMP_CASE_CONV:
+            unicode_bmp_set_case_conv(bitmap);
+            break;
+        case UNICODE_BMP_CASED:
+            unicode_bmp_set_case_conv(bitmap);
+            unicode_bmp_set_table(bitmap, unicode_prop_Cased1_table,
+                                  sizeof(unicode_prop_Cased1_table));
+            break;
+        case UNICODE_BMP_CASE_IGNORABLE:
+            unicode_bmp_set_table(bitmap, unicode_prop_Case_Ignorable_table,
+                                  sizeof(unicode_prop_Case_Ignorable_table));
+            break;
+        case UNICODE_BMP_ID_START:
+            unicode_bmp_set_table(bitmap, unicode_prop_ID_Start_table,
+                                  sizeof(unicode_prop_ID_Start_table));
+            break;
+        case UNICODE_BMP_ID_CONTINUE:
+            unicode_bmp_set_table(bitmap, unicode_prop_ID_Start_table,
+                                  sizeof(unicode_prop_ID_Start_table));
+            unicode_bmp_set_table(bitmap, unicode_prop_ID_Continue1_table,
+                                  sizeof(unicode_prop_ID_Continue1_table));
+            break;
+        }
+        if (!unicode_bmp_add_bitmap(&block_count, prop, bitmap))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* return TRUE if the BMP bitmaps can be used. Only one thread builds
+   them, the other ones use the binary searches meanwhile. */
+static BOOL unicode_bmp_ready(void)
+{
+    int state = __atomic_load_n(&unicode_bmp_state, __ATOMIC_ACQUIRE);
+
+    if (likely(state == UNICODE_BMP_STATE_READY))
+        return TRUE;
+    if (state == UNICODE_BMP_STATE_NONE &&
+        __atomic_compare_exchange_n(&unicode_bmp_state, &state,
+                                    UNICODE_BMP_STATE_BUILDING, FALSE,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        state = unicode_bmp_build() ? UNICODE_BMP_STATE_READY :
+            UNICODE_BMP_STATE_FAILED;
+        __atomic_store_n(&unicode_bmp_state, state, __ATOMIC_RELEASE);
+        return state == UNICODE_BMP_STATE_READY;
+    }
+    return FALSE;
+}
+
+/* 'c' must be < 0x10000 and the bitmaps ready */
+static inline BOOL unicode_bmp_get(int prop, uint32_t c)
+{
+    const uint32_t *block = unicode_bmp_blocks[unicode_bmp_index[prop][c >> 8]];
+    return (block[(c >> 5) & 7] >> (c & 31)) & 1;
+}
+
 /* conv_type:
    0 = to upper
    1 = to lower
@@ -165,6 +330,9 @@ int lre_case_conv(uint32_t *res, uint32_t c, int conv_type)
                 c = c - 'a' + 'A';
             }
         }
+    } else if (c < 0x10000 && unicode_bmp_ready() &&
+               !unicode_bmp_get(UNICODE_BMP_CASE_CONV, c)) {
+        /* no case conversion */
     } else {
         uint32_t v, code, len;
         int idx, idx_min, idx_max;
@@ -237,6 +405,9 @@ int lre_canonicalize(uint32_t c, BOOL is_unicode)
                 c = c - 'a' + 'A';
             }
         }
+    } else if (c < 0x10000 && unicode_bmp_ready() &&
+               !unicode_bmp_get(UNICODE_BMP_CASE_CONV, c)) {
+        /* no case conversion */
     } else {
         uint32_t v, code, len;
         int idx, idx_min, idx_max;
@@ -349,6 +520,8 @@ BOOL lre_is_cased(uint32_t c)
     uint32_t v, code, len;
     int idx, idx_min, idx_max;
 
+    if (c < 0x10000 && unicode_bmp_ready())
+        return unicode_bmp_get(UNICODE_BMP_CASED, c);
     idx_min = 0;
     idx_max = countof(case_conv_table1) - 1;
     while (idx_min <= idx_max) {
@@ -371,6 +544,8 @@ BOOL lre_is_cased(uint32_t c)
 
 BOOL lre_is_case_ignorable(uint32_t c)
 {
+    if (c < 0x10000 && unicode_bmp_ready())
+        return unicode_bmp_get(UNICODE_BMP_CASE_IGNORABLE, c);
     return lre_is_in_table(c, unicode_prop_Case_Ignorable_table,
                            unicode_prop_Case_Ignorable_index,
                            sizeof(unicode_prop_Case_Ignorable_index) / 3);
@@ -544,6 +719,8 @@ int cr_invert(CharRange *cr)
 
 BOOL lre_is_id_start(uint32_t c)
 {
+    if (c < 0x10000 && unicode_bmp_ready())
+        return unicode_bmp_get(UNICODE_BMP_ID_START, c);
     return lre_is_in_table(c, unicode_prop_ID_Start_table,
                            unicode_prop_ID_Start_index,
                            sizeof(unicode_prop_ID_Start_index) / 3);
@@ -551,6 +728,8 @@ BOOL lre_is_id_start(uint32_t c)
 
 BOOL lre_is_id_continue(uint32_t c)
 {
+    if (c < 0x10000 && unicode_bmp_ready())
+        return unicode_bmp_get(UNICODE_BMP_ID_CONTINUE, c);
     return lre_is_id_start(c) ||
         lre_is_in_table(c, unicode_prop_ID_Continue1_table,
                         unicode_prop_ID_Continue1_index,